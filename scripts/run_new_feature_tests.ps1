@@ -171,6 +171,29 @@ if (-not $SkipGpu) {
         "--ocl-enable",
         "--log-verbosity", "1"
     ) -ExpectExit 0 -MustContain @("Toxic-Hist")
+
+    # 8) CPU vs. device equivalence (diffusion, reductions, mycel/resources). Runs on PoCL as well.
+    Run-Test -Name "GPU self-test (optional)" -CliArgs @(
+        "--ocl-self-test"
+    ) -ExpectExit 0 -MustContain @("ecology_diff=", "self-test passed")
+
+    # 9) Band decomposition over two sub-devices (device fission, e.g. PoCL on a CPU host).
+    Run-Test -Name "GPU band self-test (optional)" -CliArgs @(
+        "--ocl-self-test",
+        "--ocl-fission", "2"
+    ) -ExpectExit 0 -MustContain @("band self-test bands=2", "self-test passed")
+
+    # 10) Offline LWS autotune writes a tuning file.
+    Run-Test -Name "GPU LWS autotune (optional)" -CliArgs @(
+        "--ocl-autotune",
+        "--ocl-tuning-file", "ocl_tuning_test.json"
+    ) -ExpectExit 0 -MustContain @("tuning saved")
+
+    # 11) Buffer vs. image2d diffusion (requires CL_DEVICE_IMAGE_SUPPORT).
+    Run-Test -Name "GPU image2d bench (optional)" -CliArgs @(
+        "--ocl-image-bench",
+        "--steps", "20"
+    ) -ExpectExit 0 -MustContain @("image bench", "max_abs=")
 }
 
 Write-Host "\nSummary: $pass passed, $fail failed"
@@ -0,0 +1,312 @@
+#include "opencl_bands.h"
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+bool parse_ocl_device_list(const std::string &text, std::vector<OpenCLDeviceSelector> &out) {
+    out.clear();
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos || colon == 0 || colon + 1 >= item.size()) {
+            return false;
+        }
+        OpenCLDeviceSelector sel;
+        try {
+            size_t used = 0;
+            sel.platform = std::stoi(item.substr(0, colon), &used);
+            if (used != colon) return false;
+            std::string dev = item.substr(colon + 1);
+            sel.device = std::stoi(dev, &used);
+            if (used != dev.size()) return false;
+        } catch (...) {
+            return false;
+        }
+        if (sel.platform < 0 || sel.device < 0) {
+            return false;
+        }
+        out.push_back(sel);
+    }
+    return !out.empty();
+}
+
+bool OpenCLBandRuntime::init(const std::vector<OpenCLDeviceSelector> &devices, int fission, std::string &error) {
+    bands.clear();
+    if (devices.empty() || fission < 1) {
+        error = "No OpenCL devices selected";
+        return false;
+    }
+    for (const auto &sel : devices) {
+        for (int sub = 0; sub < fission; ++sub) {
+            Band band;
+            band.runtime.reset(new OpenCLRuntime());
+            bool ok = (fission > 1)
+                ? band.runtime->init_sub_device(sel.platform, sel.device, fission, sub, error)
+                : band.runtime->init(sel.platform, sel.device, error);
+            if (!ok || !band.runtime->build_kernels(error)) {
+                error = "device " + std::to_string(sel.platform) + ":" + std::to_string(sel.device) + ": " + error;
+                bands.clear();
+                return false;
+            }
+            bands.push_back(std::move(band));
+        }
+    }
+    return true;
+}
+
+bool OpenCLBandRuntime::init_fields(const GridField &phero_food,
+                                    const GridField &phero_danger,
+                                    const GridField &phero_gamma,
+                                    const GridField &molecules,
+                                    std::string &error) {
+    if (bands.empty()) {
+        error = "OpenCL bands not initialized";
+        return false;
+    }
+    int count = static_cast<int>(bands.size());
+    if (phero_food.height < count) {
+        error = "Grid height smaller than band count";
+        return false;
+    }
+    width = phero_food.width;
+    height = phero_food.height;
+    for (int i = 0; i < count; ++i) {
+        Band &band = bands[static_cast<size_t>(i)];
+        band.y0 = height * i / count;
+        band.y1 = height * (i + 1) / count;
+        band.halo_top = (i > 0) ? 1 : 0;
+        band.halo_bottom = (i < count - 1) ? 1 : 0;
+        int local_h = band.y1 - band.y0 + band.halo_top + band.halo_bottom;
+        for (auto &f : band.staging) {
+            f = GridField(width, local_h, 0.0f);
+        }
+    }
+    if (!fill_staging(phero_food, phero_danger, phero_gamma, molecules, error)) {
+        return false;
+    }
+    for (auto &band : bands) {
+        if (!band.runtime->init_fields(band.staging[0], band.staging[1], band.staging[2], band.staging[3], error)) {
+            return false;
+        }
+    }
+    halos_current = true;
+    return true;
+}
+
+bool OpenCLBandRuntime::upload_fields(const GridField &phero_food,
+                                      const GridField &phero_danger,
+                                      const GridField &phero_gamma,
+                                      const GridField &molecules,
+                                      std::string &error) {
+    if (phero_food.width != width || phero_food.height != height) {
+        error = "Host field size mismatch";
+        return false;
+    }
+    // Straight from the host rows; the halo rows come along, so no exchange is needed afterwards.
+    const GridField *host[4] = {&phero_food, &phero_danger, &phero_gamma, &molecules};
+    for (auto &band : bands) {
+        int src_y = band.y0 - band.halo_top;
+        int rows = band.y1 - band.y0 + band.halo_top + band.halo_bottom;
+        for (int f = 0; f < 4; ++f) {
+            const float *src = host[f]->data.data() + static_cast<size_t>(src_y) * width;
+            if (!band.runtime->write_field_rows(f, 0, rows, src, error)) {
+                return false;
+            }
+        }
+    }
+    halos_current = true;
+    return true;
+}
+
+bool OpenCLBandRuntime::fill_staging(const GridField &phero_food,
+                                     const GridField &phero_danger,
+                                     const GridField &phero_gamma,
+                                     const GridField &molecules,
+                                     std::string &error) {
+    if (phero_food.width != width || phero_food.height != height) {
+        error = "Host field size mismatch";
+        return false;
+    }
+    const GridField *host[4] = {&phero_food, &phero_danger, &phero_gamma, &molecules};
+    for (auto &band : bands) {
+        int src_y = band.y0 - band.halo_top;
+        for (int f = 0; f < 4; ++f) {
+            GridField &dst = band.staging[f];
+            auto first = host[f]->data.begin() + static_cast<std::ptrdiff_t>(src_y) * width;
+            std::copy(first, first + static_cast<std::ptrdiff_t>(dst.height) * width, dst.data.begin());
+        }
+    }
+    return true;
+}
+
+bool OpenCLBandRuntime::exchange_halos(std::string &error) {
+    std::vector<float> row(static_cast<size_t>(width));
+    for (size_t i = 0; i + 1 < bands.size(); ++i) {
+        Band &upper = bands[i];
+        Band &lower = bands[i + 1];
+        int upper_last = upper.halo_top + (upper.y1 - upper.y0) - 1;
+        int upper_halo = upper_last + 1;
+        int lower_first = lower.halo_top;
+        for (int f = 0; f < 4; ++f) {
+            if (!upper.runtime->read_field_rows(f, upper_last, 1, row.data(), error) ||
+                !lower.runtime->write_field_rows(f, 0, 1, row.data(), error) ||
+                !lower.runtime->read_field_rows(f, lower_first, 1, row.data(), error) ||
+                !upper.runtime->write_field_rows(f, upper_halo, 1, row.data(), error)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool OpenCLBandRuntime::step_diffuse(const FieldParams &pheromone_params,
+                                     const FieldParams &molecule_params,
+                                     bool do_copyback,
+                                     GridField &phero_food,
+                                     GridField &phero_danger,
+                                     GridField &phero_gamma,
+                                     GridField &molecules,
+                                     std::string &error) {
+    if (bands.empty()) {
+        error = "OpenCL bands not initialized";
+        return false;
+    }
+    if (!halos_current && !exchange_halos(error)) {
+        return false;
+    }
+    // One host thread per band so the devices run concurrently.
+    std::vector<std::string> errors(bands.size());
+    std::vector<char> ok(bands.size(), 0);
+    std::vector<std::thread> workers;
+    workers.reserve(bands.size());
+    for (size_t i = 0; i < bands.size(); ++i) {
+        workers.emplace_back([&, i]() {
+            Band &band = bands[i];
+            ok[i] = band.runtime->step_diffuse(pheromone_params, molecule_params, false,
+                                               band.staging[0], band.staging[1], band.staging[2], band.staging[3],
+                                               errors[i]) ? 1 : 0;
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+    last_exhaustion_ns = 0.0f;
+    for (size_t i = 0; i < bands.size(); ++i) {
+        if (!ok[i]) {
+            error = "band " + std::to_string(i) + ": " + errors[i];
+            return false;
+        }
+        last_exhaustion_ns = std::max(last_exhaustion_ns, bands[i].runtime->last_hardware_exhaustion_ns());
+    }
+    halos_current = false;
+    if (do_copyback) {
+        return copyback(phero_food, phero_danger, phero_gamma, molecules, error);
+    }
+    return true;
+}
+
+bool OpenCLBandRuntime::copyback(GridField &phero_food, GridField &phero_danger, GridField &phero_gamma, GridField &molecules, std::string &error) {
+    if (phero_food.width != width || phero_food.height != height) {
+        error = "Host field size mismatch";
+        return false;
+    }
+    GridField *host[4] = {&phero_food, &phero_danger, &phero_gamma, &molecules};
+    for (int f = 0; f < 4; ++f) {
+        if (!read_rows(f, *host[f], error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool OpenCLBandRuntime::copyback_field(int field_index, GridField &field, std::string &error) {
+    if (field.width != width || field.height != height) {
+        error = "Host field size mismatch";
+        return false;
+    }
+    if (field_index < 0 || field_index > 3) {
+        error = "Invalid field index";
+        return false;
+    }
+    return read_rows(field_index, field, error);
+}
+
+bool OpenCLBandRuntime::read_rows(int field_index, GridField &field, std::string &error) {
+    for (auto &band : bands) {
+        float *dst = field.data.data() + static_cast<size_t>(band.y0) * width;
+        if (!band.runtime->read_field_rows(field_index, band.halo_top, band.y1 - band.y0, dst, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool OpenCLBandRuntime::reduce_fields(FieldReduction out[4], std::string &error) {
+    if (bands.empty()) {
+        error = "OpenCL bands not initialized";
+        return false;
+    }
+    // Current halos are plain copies of neighbour rows: harmless for min/max, subtracted from the sums.
+    if (!halos_current && !exchange_halos(error)) {
+        return false;
+    }
+    halos_current = true;
+    std::vector<float> row(static_cast<size_t>(width));
+    for (size_t i = 0; i < bands.size(); ++i) {
+        Band &band = bands[i];
+        FieldReduction part[4];
+        if (!band.runtime->reduce_fields(part, error)) {
+            return false;
+        }
+        int halo_rows[2] = {-1, -1};
+        if (band.halo_top) halo_rows[0] = 0;
+        if (band.halo_bottom) halo_rows[1] = band.halo_top + (band.y1 - band.y0);
+        for (int f = 0; f < 4; ++f) {
+            for (int y : halo_rows) {
+                if (y < 0) continue;
+                if (!band.runtime->read_field_rows(f, y, 1, row.data(), error)) {
+                    return false;
+                }
+                for (float v : row) part[f].sum -= v;
+            }
+            if (i == 0) {
+                out[f] = part[f];
+            } else {
+                out[f].sum += part[f].sum;
+                out[f].min = std::min(out[f].min, part[f].min);
+                out[f].max = std::max(out[f].max, part[f].max);
+            }
+        }
+    }
+    return true;
+}
+
+bool OpenCLBandRuntime::add_field_rect(int field_index, int x0, int y0, int x1, int y1, float value, std::string &error) {
+    for (auto &band : bands) {
+        // Local row 0 is global row y0 - halo_top; the band runtime clips to its own rows.
+        int origin = band.y0 - band.halo_top;
+        if (!band.runtime->add_field_rect(field_index, x0, y0 - origin, x1, y1 - origin, value, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int OpenCLBandRuntime::band_count() const {
+    return static_cast<int>(bands.size());
+}
+
+float OpenCLBandRuntime::last_hardware_exhaustion_ns() const {
+    return last_exhaustion_ns;
+}
+
+std::string OpenCLBandRuntime::device_info() const {
+    std::ostringstream ss;
+    for (size_t i = 0; i < bands.size(); ++i) {
+        if (i > 0) ss << "; ";
+        ss << "band " << i << " rows " << bands[i].y0 << "-" << bands[i].y1 << ": " << bands[i].runtime->device_info();
+    }
+    return ss.str();
+}
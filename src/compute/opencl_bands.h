@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "opencl_runtime.h"
+#include "sim/fields.h"
+
+struct OpenCLDeviceSelector {
+    int platform = 0;
+    int device = 0;
+};
+
+// Parses "0:0,0:1" (platform:device pairs).
+bool parse_ocl_device_list(const std::string &text, std::vector<OpenCLDeviceSelector> &out);
+
+// Diffusion split into horizontal bands, one OpenCLRuntime (device or sub-device) per band.
+// Fields stay resident on the devices. Each band keeps one halo row per interior edge, swapped
+// between neighbours before a step only if no upload has refreshed it since the last step.
+class OpenCLBandRuntime {
+public:
+    bool init(const std::vector<OpenCLDeviceSelector> &devices, int fission, std::string &error);
+    bool init_fields(const GridField &phero_food,
+                     const GridField &phero_danger,
+                     const GridField &phero_gamma,
+                     const GridField &molecules,
+                     std::string &error);
+    bool upload_fields(const GridField &phero_food,
+                       const GridField &phero_danger,
+                       const GridField &phero_gamma,
+                       const GridField &molecules,
+                       std::string &error);
+    bool step_diffuse(const FieldParams &pheromone_params,
+                      const FieldParams &molecule_params,
+                      bool do_copyback,
+                      GridField &phero_food,
+                      GridField &phero_danger,
+                      GridField &phero_gamma,
+                      GridField &molecules,
+                      std::string &error);
+    bool copyback(GridField &phero_food, GridField &phero_danger, GridField &phero_gamma, GridField &molecules, std::string &error);
+    // Reads one field back (0=phero_food, 1=phero_danger, 2=phero_gamma, 3=molecules), halos excluded.
+    bool copyback_field(int field_index, GridField &field, std::string &error);
+    // Sums cover the grid once (halo rows excluded); min/max come from halo-current bands.
+    bool reduce_fields(FieldReduction out[4], std::string &error);
+    // Adds value to [x0,x1) x [y0,y1) in global coordinates, halo copies included.
+    bool add_field_rect(int field_index, int x0, int y0, int x1, int y1, float value, std::string &error);
+    int band_count() const;
+    float last_hardware_exhaustion_ns() const;
+    std::string device_info() const;
+
+private:
+    struct Band {
+        std::unique_ptr<OpenCLRuntime> runtime;
+        int y0 = 0;
+        int y1 = 0;
+        int halo_top = 0;
+        int halo_bottom = 0;
+        GridField staging[4];
+    };
+
+    bool fill_staging(const GridField &phero_food,
+                      const GridField &phero_danger,
+                      const GridField &phero_gamma,
+                      const GridField &molecules,
+                      std::string &error);
+    bool exchange_halos(std::string &error);
+    bool read_rows(int field_index, GridField &field, std::string &error);
+
+    std::vector<Band> bands;
+    int width = 0;
+    int height = 0;
+    float last_exhaustion_ns = 0.0f;
+    bool halos_current = false;
+};
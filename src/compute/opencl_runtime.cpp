@@ -1,10 +1,17 @@
 #include "opencl_runtime.h"
+#include "opencl_tuning.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <vector>
 #include <filesystem>
 #include <utility>
+#include <limits>
+#include <map>
 
 #ifndef MICRO_SWARM_OPENCL
 #define MICRO_SWARM_OPENCL 0
@@ -177,6 +184,188 @@ std::string build_evolved_kernel_source(const int codons[4], int toxic_stride, i
     return ss.str();
 }
 
+// Same stencil as diffuse.cl, reading through a clamp-to-edge sampler: neighbour reads never
+// leave the image, so the border only selects the result instead of branching around the loads.
+// Built only on devices with CL_DEVICE_IMAGE_SUPPORT.
+const char *kImageKernelSource = R"CLC(
+__constant sampler_t kClampSampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;
+
+__kernel void diffuse_and_evaporate_image(__read_only image2d_t input,
+                                          __global float *output,
+                                          int width,
+                                          int height,
+                                          float diffusion,
+                                          float evaporation) {
+    int x = (int)get_global_id(0);
+    int y = (int)get_global_id(1);
+    if (x >= width || y >= height) {
+        return;
+    }
+    float center = read_imagef(input, kClampSampler, (int2)(x, y)).x;
+    float sum = center * (1.0f - diffusion);
+    sum += read_imagef(input, kClampSampler, (int2)(x - 1, y)).x * (diffusion * 0.25f);
+    sum += read_imagef(input, kClampSampler, (int2)(x + 1, y)).x * (diffusion * 0.25f);
+    sum += read_imagef(input, kClampSampler, (int2)(x, y - 1)).x * (diffusion * 0.25f);
+    sum += read_imagef(input, kClampSampler, (int2)(x, y + 1)).x * (diffusion * 0.25f);
+    int interior = x > 0 && y > 0 && x < width - 1 && y < height - 1;
+    float value = (interior ? sum : center) * (1.0f - evaporation);
+    output[y * width + x] = fmax(value, 0.0f);
+}
+)CLC";
+
+// Kept separate from diffuse.cl: the main program is replaced by evolved kernels.
+// mycel_update/resource_regenerate mirror MycelNetwork::update and Environment::regenerate.
+// add_field_rect applies host-side injections (gamma, logic pulses) to resident fields.
+const char *kAuxKernelSource = R"CLC(
+__kernel void reduce_stats(__global const float *input,
+                           int count,
+                           __global float *partials,
+                           int partial_base,
+                           __local float *scratch_sum,
+                           __local float *scratch_min,
+                           __local float *scratch_max) {
+    int lid = (int)get_local_id(0);
+    int lsize = (int)get_local_size(0);
+    float sum = 0.0f;
+    float mn = INFINITY;
+    float mx = -INFINITY;
+    for (int i = (int)get_global_id(0); i < count; i += (int)get_global_size(0)) {
+        float v = input[i];
+        sum += v;
+        mn = fmin(mn, v);
+        mx = fmax(mx, v);
+    }
+    scratch_sum[lid] = sum;
+    scratch_min[lid] = mn;
+    scratch_max[lid] = mx;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int offset = lsize / 2; offset > 0; offset >>= 1) {
+        if (lid < offset) {
+            scratch_sum[lid] += scratch_sum[lid + offset];
+            scratch_min[lid] = fmin(scratch_min[lid], scratch_min[lid + offset]);
+            scratch_max[lid] = fmax(scratch_max[lid], scratch_max[lid + offset]);
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    if (lid == 0) {
+        int g = partial_base + (int)get_group_id(0);
+        partials[g * 3 + 0] = scratch_sum[0];
+        partials[g * 3 + 1] = scratch_min[0];
+        partials[g * 3 + 2] = scratch_max[0];
+    }
+}
+
+__kernel void histogram_bins(__global const float *input,
+                             int count,
+                             float min_val,
+                             float scale,
+                             int bins,
+                             __global volatile int *hist,
+                             __local volatile int *local_hist) {
+    int lid = (int)get_local_id(0);
+    int lsize = (int)get_local_size(0);
+    for (int b = lid; b < bins; b += lsize) {
+        local_hist[b] = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int i = (int)get_global_id(0); i < count; i += (int)get_global_size(0)) {
+        int bin = (int)floor((input[i] - min_val) * scale);
+        bin = clamp(bin, 0, bins - 1);
+        atomic_inc(&local_hist[bin]);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int b = lid; b < bins; b += lsize) {
+        int c = local_hist[b];
+        if (c > 0) {
+            atomic_add(&hist[b], c);
+        }
+    }
+}
+
+__kernel void mycel_update(__global const float *density,
+                           __global const float *inhibitor,
+                           __global const float *pheromone,
+                           __global const float *resources,
+                           __global float *density_out,
+                           __global float *inhibitor_out,
+                           int width,
+                           int height,
+                           float drive_p,
+                           float drive_r,
+                           float drive_threshold,
+                           float transport_rate,
+                           float inhibitor_weight,
+                           float growth_rate,
+                           float decay_rate,
+                           float inhibitor_threshold,
+                           float inhibitor_gain,
+                           float inhibitor_decay) {
+    int x = (int)get_global_id(0);
+    int y = (int)get_global_id(1);
+    if (x >= width || y >= height) {
+        return;
+    }
+    int idx = y * width + x;
+    float current = density[idx];
+    float current_inhib = inhibitor[idx];
+
+    float drive = clamp(drive_p * pheromone[idx] + drive_r * resources[idx], 0.0f, 1.0f);
+    if (drive > drive_threshold) {
+        drive = (drive - drive_threshold) / (1.0f - drive_threshold);
+    } else {
+        drive = 0.0f;
+    }
+
+    float neighbor_sum = 0.0f;
+    int neighbor_count = 0;
+    if (x > 0) { neighbor_sum += density[idx - 1]; neighbor_count++; }
+    if (x < width - 1) { neighbor_sum += density[idx + 1]; neighbor_count++; }
+    if (y > 0) { neighbor_sum += density[idx - width]; neighbor_count++; }
+    if (y < height - 1) { neighbor_sum += density[idx + width]; neighbor_count++; }
+    float neighbor_avg = (neighbor_count > 0) ? (neighbor_sum / (float)neighbor_count) : current;
+
+    float transport = transport_rate * (neighbor_avg - current);
+    float inhibition = clamp(inhibitor_weight * current_inhib, 0.0f, 1.0f);
+    float growth = growth_rate * (drive * (1.0f - inhibition)) * (1.0f - current);
+    float decay = decay_rate * current;
+    density_out[idx] = clamp(current + growth + transport - decay, 0.0f, 1.0f);
+
+    float inhibitor_drive = fmax(current - inhibitor_threshold, 0.0f);
+    float inhib_next = current_inhib + (inhibitor_gain * inhibitor_drive) - (inhibitor_decay * current_inhib);
+    inhibitor_out[idx] = clamp(inhib_next, 0.0f, 1.0f);
+}
+
+__kernel void resource_regenerate(__global float *resources,
+                                  __global const uchar *blocked,
+                                  int count,
+                                  float regen,
+                                  float max_value) {
+    int idx = (int)get_global_id(0);
+    if (idx >= count || blocked[idx] != 0) {
+        return;
+    }
+    resources[idx] = fmin(resources[idx] + regen, max_value);
+}
+
+__kernel void add_field_rect(__global float *field,
+                             int width,
+                             int x0,
+                             int y0,
+                             int x1,
+                             int y1,
+                             float value) {
+    int x = x0 + (int)get_global_id(0);
+    int y = y0 + (int)get_global_id(1);
+    if (x >= x1 || y >= y1) {
+        return;
+    }
+    field[y * width + x] += value;
+}
+)CLC";
+
+const size_t kReduceMaxGroups = 64;
+const int kHistogramMaxBins = 4096;
+
 
 #if MICRO_SWARM_OPENCL_DYNAMIC
 struct OpenCLApi {
@@ -212,6 +401,13 @@ struct OpenCLApi {
     decltype(&clReleaseProgram) clReleaseProgram_fn = nullptr;
     decltype(&clReleaseCommandQueue) clReleaseCommandQueue_fn = nullptr;
     decltype(&clReleaseContext) clReleaseContext_fn = nullptr;
+    decltype(&clGetKernelWorkGroupInfo) clGetKernelWorkGroupInfo_fn = nullptr;
+    decltype(&clEnqueueCopyBufferToImage) clEnqueueCopyBufferToImage_fn = nullptr;
+#ifdef CL_VERSION_1_2
+    decltype(&clCreateSubDevices) clCreateSubDevices_fn = nullptr;
+    decltype(&clReleaseDevice) clReleaseDevice_fn = nullptr;
+    decltype(&clCreateImage) clCreateImage_fn = nullptr;
+#endif
 
     bool load(std::string &error) {
 #if defined(_WIN32)
@@ -262,6 +458,13 @@ struct OpenCLApi {
         ok &= load_sym(clReleaseProgram_fn, "clReleaseProgram");
         ok &= load_sym(clReleaseCommandQueue_fn, "clReleaseCommandQueue");
         ok &= load_sym(clReleaseContext_fn, "clReleaseContext");
+        load_sym(clGetKernelWorkGroupInfo_fn, "clGetKernelWorkGroupInfo");
+        load_sym(clEnqueueCopyBufferToImage_fn, "clEnqueueCopyBufferToImage");
+#ifdef CL_VERSION_1_2
+        load_sym(clCreateSubDevices_fn, "clCreateSubDevices");
+        load_sym(clReleaseDevice_fn, "clReleaseDevice");
+        load_sym(clCreateImage_fn, "clCreateImage");
+#endif
 
         if (!ok) {
             error = "OpenCL symbols missing";
@@ -292,6 +495,29 @@ OpenCLApi g_api;
 #define OCL_CALL(fn) fn
 #endif
 
+// FNV-1a, stable across compilers so tuning files stay valid between builds.
+std::string source_variant_key(const std::string &source) {
+    uint64_t hash = 1469598103934665603ull;
+    for (unsigned char c : source) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    std::ostringstream ss;
+    ss << "source:" << std::hex << hash;
+    return ss.str();
+}
+
+std::string evolved_variant_key(const int codons[4], int toxic_stride, int toxic_iters) {
+    std::ostringstream ss;
+    ss << "evolved:" << codons[0] << "." << codons[1] << "." << codons[2] << "." << codons[3]
+       << "/" << toxic_stride << "." << toxic_iters;
+    return ss.str();
+}
+
+std::string lws_key(const std::string &variant, size_t width, size_t height) {
+    return variant + "@" + std::to_string(width) + "x" + std::to_string(height);
+}
+
 bool codons_match(const int a[4], const int b[4]) {
     for (int i = 0; i < 4; ++i) {
         if (a[i] != b[i]) {
@@ -306,7 +532,8 @@ bool build_kernel_from_source(cl_context context,
                               const std::string &source,
                               cl_program &program,
                               cl_kernel &kernel,
-                              std::string &error) {
+                              std::string &error,
+                              const char *kernel_name = "diffuse_and_evaporate") {
     const char *src_ptr = source.c_str();
     size_t src_len = source.size();
     cl_int err = CL_SUCCESS;
@@ -325,7 +552,7 @@ bool build_kernel_from_source(cl_context context,
         OCL_CALL(clReleaseProgram)(new_program);
         return false;
     }
-    cl_kernel new_kernel = OCL_CALL(clCreateKernel)(new_program, "diffuse_and_evaporate", &err);
+    cl_kernel new_kernel = OCL_CALL(clCreateKernel)(new_program, kernel_name, &err);
     if (!new_kernel || err != CL_SUCCESS) {
         error = std::string("clCreateKernel failed: ") + cl_err_to_string(err);
         OCL_CALL(clReleaseProgram)(new_program);
@@ -347,6 +574,7 @@ bool build_kernel_from_source(cl_context context,
 struct OpenCLRuntime::Impl {
     cl_platform_id platform = nullptr;
     cl_device_id device = nullptr;
+    bool sub_device = false;
     cl_context context = nullptr;
     cl_command_queue queue = nullptr;
     cl_program program = nullptr;
@@ -355,7 +583,41 @@ struct OpenCLRuntime::Impl {
     cl_kernel evolved_kernels[4] = {nullptr, nullptr, nullptr, nullptr};
     int evolved_codons[4][4] = {{-1, -1, -1, -1}, {-1, -1, -1, -1}, {-1, -1, -1, -1}, {-1, -1, -1, -1}};
     int quadrant_lws[4][2] = {{0, 0}, {0, 0}, {0, 0}, {0, 0}};
+    std::string diffuse_variant = "diffuse";
+    std::string evolved_variant[4];
+    std::string device_key;
+    // lws_key(variant, w, h) -> tuned local size for this device.
+    std::map<std::string, std::array<int, 2>> tuned_lws;
     bool use_quadrant_kernels = false;
+    cl_program aux_program = nullptr;
+    cl_kernel reduce_kernel = nullptr;
+    cl_kernel histogram_kernel = nullptr;
+    cl_kernel mycel_kernel = nullptr;
+    cl_kernel regen_kernel = nullptr;
+    cl_kernel add_rect_kernel = nullptr;
+    size_t reduce_local = 0;
+    cl_mem reduce_partials = nullptr;
+    cl_mem histogram_buffer = nullptr;
+    int histogram_capacity = 0;
+
+    cl_mem density_a = nullptr;
+    cl_mem density_b = nullptr;
+    cl_mem inhibitor_a = nullptr;
+    cl_mem inhibitor_b = nullptr;
+    cl_mem resources_buf = nullptr;
+    cl_mem blocked_buf = nullptr;
+    bool mycel_ping = true;
+    bool ecology_ready = false;
+
+    // image2d backend for the plain diffusion kernel. Buffers stay the field storage; the
+    // images either alias them (cl_khr_image2d_from_buffer) or are refreshed per step.
+    bool image_backend = false;
+    bool images_alias = false;
+    bool images_ready = false;
+    std::string image_error;
+    cl_program image_program = nullptr;
+    cl_kernel image_kernel = nullptr;
+    cl_mem field_images[4][2] = {{nullptr, nullptr}, {nullptr, nullptr}, {nullptr, nullptr}, {nullptr, nullptr}};
 
     cl_mem phero_food_a = nullptr;
     cl_mem phero_food_b = nullptr;
@@ -393,6 +655,78 @@ struct OpenCLRuntime::Impl {
         for (int i = 0; i < 4; ++i) {
             evolved_codons[quadrant][i] = -1;
         }
+        evolved_variant[quadrant].clear();
+    }
+
+    // Evolved kernels without their own entry fall back to the plain kernel's tuning.
+    bool lookup_tuned_lws(const std::string &variant, size_t gw, size_t gh, size_t out[2]) const {
+        auto it = tuned_lws.find(lws_key(variant, gw, gh));
+        if (it == tuned_lws.end() && variant != "diffuse") {
+            it = tuned_lws.find(lws_key("diffuse", gw, gh));
+        }
+        if (it == tuned_lws.end()) {
+            return false;
+        }
+        int lx = it->second[0];
+        int ly = it->second[1];
+        if (lx <= 0 || ly <= 0 || gw % static_cast<size_t>(lx) != 0 || gh % static_cast<size_t>(ly) != 0) {
+            return false;
+        }
+        out[0] = static_cast<size_t>(lx);
+        out[1] = static_cast<size_t>(ly);
+        return true;
+    }
+
+    // Runs the kernel on the phero_food buffers and returns the fastest of reps launches.
+    bool time_kernel(cl_kernel kernel, const size_t *offset, const size_t *global, const size_t *local, int reps, double &best_ns, std::string &error) {
+        cl_mem in_buf = food_ping ? phero_food_a : phero_food_b;
+        cl_mem out_buf = food_ping ? phero_food_b : phero_food_a;
+        float diffusion = 0.15f;
+        float evaporation = 0.02f;
+        cl_int err = CL_SUCCESS;
+        err |= OCL_CALL(clSetKernelArg)(kernel, 0, sizeof(cl_mem), &in_buf);
+        err |= OCL_CALL(clSetKernelArg)(kernel, 1, sizeof(cl_mem), &out_buf);
+        err |= OCL_CALL(clSetKernelArg)(kernel, 2, sizeof(int), &width);
+        err |= OCL_CALL(clSetKernelArg)(kernel, 3, sizeof(int), &height);
+        err |= OCL_CALL(clSetKernelArg)(kernel, 4, sizeof(float), &diffusion);
+        err |= OCL_CALL(clSetKernelArg)(kernel, 5, sizeof(float), &evaporation);
+        if (err != CL_SUCCESS) {
+            error = std::string("clSetKernelArg failed: ") + cl_err_to_string(err);
+            return false;
+        }
+        best_ns = -1.0;
+        // The first launch is a warm-up and is not counted.
+        for (int r = 0; r <= reps; ++r) {
+            cl_event event = nullptr;
+            auto t0 = std::chrono::steady_clock::now();
+            err = OCL_CALL(clEnqueueNDRangeKernel)(queue, kernel, 2, offset, global, local, 0, nullptr, profiling_enabled ? &event : nullptr);
+            if (err != CL_SUCCESS) {
+                error = std::string("clEnqueueNDRangeKernel failed: ") + cl_err_to_string(err);
+                return false;
+            }
+            err = OCL_CALL(clFinish)(queue);
+            auto t1 = std::chrono::steady_clock::now();
+            if (err != CL_SUCCESS) {
+                if (event) OCL_CALL(clReleaseEvent)(event);
+                error = std::string("clFinish failed: ") + cl_err_to_string(err);
+                return false;
+            }
+            double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+            if (event) {
+                cl_ulong start = 0;
+                cl_ulong end = 0;
+                if (OCL_CALL(clGetEventProfilingInfo)(event, CL_PROFILING_COMMAND_START, sizeof(start), &start, nullptr) == CL_SUCCESS &&
+                    OCL_CALL(clGetEventProfilingInfo)(event, CL_PROFILING_COMMAND_END, sizeof(end), &end, nullptr) == CL_SUCCESS &&
+                    end >= start) {
+                    ns = static_cast<double>(end - start);
+                }
+                OCL_CALL(clReleaseEvent)(event);
+            }
+            if (r > 0 && (best_ns < 0.0 || ns < best_ns)) {
+                best_ns = ns;
+            }
+        }
+        return true;
     }
 
     void release_buffers() {
@@ -428,10 +762,326 @@ struct OpenCLRuntime::Impl {
             OCL_CALL(clReleaseMemObject)(molecules_b);
             molecules_b = nullptr;
         }
+        if (reduce_partials) {
+            OCL_CALL(clReleaseMemObject)(reduce_partials);
+            reduce_partials = nullptr;
+        }
+        if (histogram_buffer) {
+            OCL_CALL(clReleaseMemObject)(histogram_buffer);
+            histogram_buffer = nullptr;
+        }
+        histogram_capacity = 0;
+        release_images();
+        release_ecology();
+    }
+
+    void release_images() {
+        for (auto &pair : field_images) {
+            for (cl_mem &img : pair) {
+                if (img) {
+                    OCL_CALL(clReleaseMemObject)(img);
+                    img = nullptr;
+                }
+            }
+        }
+        images_alias = false;
+        images_ready = false;
+    }
+
+    void release_image_kernel() {
+        if (image_kernel) {
+            OCL_CALL(clReleaseKernel)(image_kernel);
+            image_kernel = nullptr;
+        }
+        if (image_program) {
+            OCL_CALL(clReleaseProgram)(image_program);
+            image_program = nullptr;
+        }
+    }
+
+    // Creates the per-field images after the buffers exist. Failure leaves the buffer path active.
+    bool create_images(std::string &error) {
+        release_images();
+#ifdef CL_VERSION_1_2
+#if MICRO_SWARM_OPENCL_DYNAMIC
+        if (!OCL_CALL(clCreateImage) || !OCL_CALL(clEnqueueCopyBufferToImage)) {
+            error = "clCreateImage not available (OpenCL 1.2 required)";
+            return false;
+        }
+#endif
+        size_t max_w = 0;
+        size_t max_h = 0;
+        OCL_CALL(clGetDeviceInfo)(device, CL_DEVICE_IMAGE2D_MAX_WIDTH, sizeof(max_w), &max_w, nullptr);
+        OCL_CALL(clGetDeviceInfo)(device, CL_DEVICE_IMAGE2D_MAX_HEIGHT, sizeof(max_h), &max_h, nullptr);
+        if (static_cast<size_t>(width) > max_w || static_cast<size_t>(height) > max_h) {
+            error = "Grid exceeds CL_DEVICE_IMAGE2D_MAX_WIDTH/HEIGHT";
+            return false;
+        }
+        cl_image_format format;
+        format.image_channel_order = CL_R;
+        format.image_channel_data_type = CL_FLOAT;
+        cl_image_desc desc;
+        std::memset(&desc, 0, sizeof(desc));
+        desc.image_type = CL_MEM_OBJECT_IMAGE2D;
+        desc.image_width = static_cast<size_t>(width);
+        desc.image_height = static_cast<size_t>(height);
+
+        bool can_alias = false;
+#ifdef CL_DEVICE_IMAGE_PITCH_ALIGNMENT
+        size_t ext_size = 0;
+        OCL_CALL(clGetDeviceInfo)(device, CL_DEVICE_EXTENSIONS, 0, nullptr, &ext_size);
+        std::string extensions(ext_size, '\0');
+        if (ext_size > 0) {
+            OCL_CALL(clGetDeviceInfo)(device, CL_DEVICE_EXTENSIONS, ext_size, &extensions[0], nullptr);
+        }
+        cl_uint pitch_alignment = 0;
+        OCL_CALL(clGetDeviceInfo)(device, CL_DEVICE_IMAGE_PITCH_ALIGNMENT, sizeof(pitch_alignment), &pitch_alignment, nullptr);
+        can_alias = extensions.find("cl_khr_image2d_from_buffer") != std::string::npos &&
+                    pitch_alignment > 0 && static_cast<cl_uint>(width) % pitch_alignment == 0;
+#endif
+        cl_mem buffers[4][2] = {
+            {phero_food_a, phero_food_b},
+            {phero_danger_a, phero_danger_b},
+            {phero_gamma_a, phero_gamma_b},
+            {molecules_a, molecules_b}
+        };
+        cl_int err = CL_SUCCESS;
+        if (can_alias) {
+            desc.image_row_pitch = static_cast<size_t>(width) * sizeof(float);
+            for (int f = 0; f < 4 && can_alias; ++f) {
+                for (int side = 0; side < 2; ++side) {
+                    desc.buffer = buffers[f][side];
+                    field_images[f][side] = OCL_CALL(clCreateImage)(context, CL_MEM_READ_ONLY, &format, &desc, nullptr, &err);
+                    if (!field_images[f][side] || err != CL_SUCCESS) {
+                        can_alias = false;
+                        break;
+                    }
+                }
+            }
+            if (can_alias) {
+                images_alias = true;
+                images_ready = true;
+                return true;
+            }
+            release_images();
+            desc.image_row_pitch = 0;
+            desc.buffer = nullptr;
+        }
+        for (int f = 0; f < 4; ++f) {
+            field_images[f][0] = OCL_CALL(clCreateImage)(context, CL_MEM_READ_ONLY, &format, &desc, nullptr, &err);
+            if (!field_images[f][0] || err != CL_SUCCESS) {
+                error = std::string("clCreateImage failed: ") + cl_err_to_string(err);
+                release_images();
+                return false;
+            }
+        }
+        images_ready = true;
+        return true;
+#else
+        error = "image2d backend requires OpenCL 1.2 headers";
+        return false;
+#endif
+    }
+
+    // Image view of the field's current buffer; the copy path refreshes it on the device.
+    cl_mem image_for(int field, cl_mem in_buf, std::string &error) {
+        cl_mem buffers[4] = {phero_food_a, phero_danger_a, phero_gamma_a, molecules_a};
+        if (images_alias) {
+            return field_images[field][in_buf == buffers[field] ? 0 : 1];
+        }
+        size_t origin[3] = {0, 0, 0};
+        size_t region[3] = {static_cast<size_t>(width), static_cast<size_t>(height), 1};
+        cl_int err = OCL_CALL(clEnqueueCopyBufferToImage)(queue, in_buf, field_images[field][0], 0, origin, region, 0, nullptr, nullptr);
+        if (err != CL_SUCCESS) {
+            error = std::string("clEnqueueCopyBufferToImage failed: ") + cl_err_to_string(err);
+            return nullptr;
+        }
+        return field_images[field][0];
+    }
+
+    void release_ecology() {
+        cl_mem *bufs[] = {&density_a, &density_b, &inhibitor_a, &inhibitor_b, &resources_buf, &blocked_buf};
+        for (cl_mem *buf : bufs) {
+            if (*buf) {
+                OCL_CALL(clReleaseMemObject)(*buf);
+                *buf = nullptr;
+            }
+        }
+        mycel_ping = true;
+        ecology_ready = false;
+    }
+
+    void release_aux() {
+        if (reduce_kernel) {
+            OCL_CALL(clReleaseKernel)(reduce_kernel);
+            reduce_kernel = nullptr;
+        }
+        if (histogram_kernel) {
+            OCL_CALL(clReleaseKernel)(histogram_kernel);
+            histogram_kernel = nullptr;
+        }
+        if (mycel_kernel) {
+            OCL_CALL(clReleaseKernel)(mycel_kernel);
+            mycel_kernel = nullptr;
+        }
+        if (regen_kernel) {
+            OCL_CALL(clReleaseKernel)(regen_kernel);
+            regen_kernel = nullptr;
+        }
+        if (add_rect_kernel) {
+            OCL_CALL(clReleaseKernel)(add_rect_kernel);
+            add_rect_kernel = nullptr;
+        }
+        if (aux_program) {
+            OCL_CALL(clReleaseProgram)(aux_program);
+            aux_program = nullptr;
+        }
+        reduce_local = 0;
+    }
+
+    bool ensure_aux_kernels(std::string &error) {
+        if (reduce_kernel && histogram_kernel && mycel_kernel && regen_kernel && add_rect_kernel) {
+            return true;
+        }
+        release_aux();
+        const char *src_ptr = kAuxKernelSource;
+        size_t src_len = std::strlen(kAuxKernelSource);
+        cl_int err = CL_SUCCESS;
+        aux_program = OCL_CALL(clCreateProgramWithSource)(context, 1, &src_ptr, &src_len, &err);
+        if (!aux_program || err != CL_SUCCESS) {
+            error = std::string("clCreateProgramWithSource reduce failed: ") + cl_err_to_string(err);
+            return false;
+        }
+        err = OCL_CALL(clBuildProgram)(aux_program, 1, &device, nullptr, nullptr, nullptr);
+        if (err != CL_SUCCESS) {
+            size_t log_size = 0;
+            OCL_CALL(clGetProgramBuildInfo)(aux_program, device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &log_size);
+            std::string log(log_size, '\0');
+            OCL_CALL(clGetProgramBuildInfo)(aux_program, device, CL_PROGRAM_BUILD_LOG, log_size, &log[0], nullptr);
+            error = std::string("clBuildProgram reduce failed: ") + cl_err_to_string(err) + "\n" + log;
+            release_aux();
+            return false;
+        }
+        reduce_kernel = OCL_CALL(clCreateKernel)(aux_program, "reduce_stats", &err);
+        if (!reduce_kernel || err != CL_SUCCESS) {
+            error = std::string("clCreateKernel reduce_stats failed: ") + cl_err_to_string(err);
+            release_aux();
+            return false;
+        }
+        histogram_kernel = OCL_CALL(clCreateKernel)(aux_program, "histogram_bins", &err);
+        if (!histogram_kernel || err != CL_SUCCESS) {
+            error = std::string("clCreateKernel histogram_bins failed: ") + cl_err_to_string(err);
+            release_aux();
+            return false;
+        }
+        mycel_kernel = OCL_CALL(clCreateKernel)(aux_program, "mycel_update", &err);
+        if (!mycel_kernel || err != CL_SUCCESS) {
+            error = std::string("clCreateKernel mycel_update failed: ") + cl_err_to_string(err);
+            release_aux();
+            return false;
+        }
+        regen_kernel = OCL_CALL(clCreateKernel)(aux_program, "resource_regenerate", &err);
+        if (!regen_kernel || err != CL_SUCCESS) {
+            error = std::string("clCreateKernel resource_regenerate failed: ") + cl_err_to_string(err);
+            release_aux();
+            return false;
+        }
+        add_rect_kernel = OCL_CALL(clCreateKernel)(aux_program, "add_field_rect", &err);
+        if (!add_rect_kernel || err != CL_SUCCESS) {
+            error = std::string("clCreateKernel add_field_rect failed: ") + cl_err_to_string(err);
+            release_aux();
+            return false;
+        }
+        size_t max_wg = 0;
+        OCL_CALL(clGetDeviceInfo)(device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(max_wg), &max_wg, nullptr);
+        // The tree reduction needs a power-of-two work-group size.
+        reduce_local = 1;
+        while (reduce_local * 2 <= 256 && reduce_local * 2 <= max_wg) {
+            reduce_local *= 2;
+        }
+        return true;
+    }
+
+    // Reduces up to four fields into one partials buffer with a single read.
+    bool reduce(const int *fields, int n, FieldReduction *out, std::string &error) {
+        if (!ensure_aux_kernels(error)) {
+            return false;
+        }
+        int count = width * height;
+        size_t local = reduce_local;
+        size_t groups = std::min(kReduceMaxGroups, (static_cast<size_t>(count) + local - 1) / local);
+        if (groups == 0) {
+            groups = 1;
+        }
+        cl_int err = CL_SUCCESS;
+        if (!reduce_partials) {
+            reduce_partials = OCL_CALL(clCreateBuffer)(context, CL_MEM_READ_WRITE, sizeof(float) * kReduceMaxGroups * 3 * 4, nullptr, &err);
+            if (!reduce_partials || err != CL_SUCCESS) {
+                error = std::string("clCreateBuffer reduce_partials failed: ") + cl_err_to_string(err);
+                return false;
+            }
+        }
+        size_t global = groups * local;
+        for (int f = 0; f < n; ++f) {
+            cl_mem input = current_field(fields[f]);
+            int partial_base = f * static_cast<int>(groups);
+            err = CL_SUCCESS;
+            err |= OCL_CALL(clSetKernelArg)(reduce_kernel, 0, sizeof(cl_mem), &input);
+            err |= OCL_CALL(clSetKernelArg)(reduce_kernel, 1, sizeof(int), &count);
+            err |= OCL_CALL(clSetKernelArg)(reduce_kernel, 2, sizeof(cl_mem), &reduce_partials);
+            err |= OCL_CALL(clSetKernelArg)(reduce_kernel, 3, sizeof(int), &partial_base);
+            err |= OCL_CALL(clSetKernelArg)(reduce_kernel, 4, sizeof(float) * local, nullptr);
+            err |= OCL_CALL(clSetKernelArg)(reduce_kernel, 5, sizeof(float) * local, nullptr);
+            err |= OCL_CALL(clSetKernelArg)(reduce_kernel, 6, sizeof(float) * local, nullptr);
+            if (err != CL_SUCCESS) {
+                error = std::string("clSetKernelArg reduce_stats failed: ") + cl_err_to_string(err);
+                return false;
+            }
+            err = OCL_CALL(clEnqueueNDRangeKernel)(queue, reduce_kernel, 1, nullptr, &global, &local, 0, nullptr, nullptr);
+            if (err != CL_SUCCESS) {
+                error = std::string("clEnqueueNDRangeKernel reduce_stats failed: ") + cl_err_to_string(err);
+                return false;
+            }
+        }
+        std::vector<float> partials(groups * 3 * static_cast<size_t>(n), 0.0f);
+        err = OCL_CALL(clEnqueueReadBuffer)(queue, reduce_partials, CL_TRUE, 0, partials.size() * sizeof(float), partials.data(), 0, nullptr, nullptr);
+        if (err != CL_SUCCESS) {
+            error = std::string("clEnqueueReadBuffer reduce_partials failed: ") + cl_err_to_string(err);
+            return false;
+        }
+        for (int f = 0; f < n; ++f) {
+            FieldReduction r;
+            r.min = std::numeric_limits<float>::infinity();
+            r.max = -std::numeric_limits<float>::infinity();
+            for (size_t g = 0; g < groups; ++g) {
+                const float *p = &partials[(static_cast<size_t>(f) * groups + g) * 3];
+                r.sum += static_cast<double>(p[0]);
+                r.min = std::min(r.min, p[1]);
+                r.max = std::max(r.max, p[2]);
+            }
+            out[f] = r;
+        }
+        return true;
+    }
+
+    cl_mem current_field(int field_index) const {
+        switch (field_index) {
+            case 0: return food_ping ? phero_food_a : phero_food_b;
+            case 1: return danger_ping ? phero_danger_a : phero_danger_b;
+            case 2: return gamma_ping ? phero_gamma_a : phero_gamma_b;
+            case 3: return molecules_ping ? molecules_a : molecules_b;
+            case 4: return mycel_ping ? density_a : density_b;
+            case 5: return mycel_ping ? inhibitor_a : inhibitor_b;
+            case 6: return resources_buf;
+            default: return nullptr;
+        }
     }
 
     void release_all() {
         release_buffers();
+        release_aux();
+        release_image_kernel();
+        image_backend = false;
         if (diffuse_kernel) {
             OCL_CALL(clReleaseKernel)(diffuse_kernel);
             diffuse_kernel = nullptr;
@@ -451,6 +1101,13 @@ struct OpenCLRuntime::Impl {
             OCL_CALL(clReleaseContext)(context);
             context = nullptr;
         }
+#ifdef CL_VERSION_1_2
+        if (sub_device && device) {
+            OCL_CALL(clReleaseDevice)(device);
+        }
+#endif
+        sub_device = false;
+        device = nullptr;
     }
 };
 
@@ -469,6 +1126,11 @@ OpenCLRuntime::~OpenCLRuntime() {
 }
 
 bool OpenCLRuntime::init(int platform_index, int device_index, std::string &error) {
+    return init_sub_device(platform_index, device_index, 1, 0, error);
+}
+
+bool OpenCLRuntime::init_sub_device(int platform_index, int device_index, int sub_count, int sub_index, std::string &error) {
+    impl->release_all();
 #if MICRO_SWARM_OPENCL_DYNAMIC
     if (!g_api.loaded) {
         if (!g_api.load(error)) {
@@ -512,11 +1174,62 @@ bool OpenCLRuntime::init(int platform_index, int device_index, std::string &erro
     }
     impl->device = devices[device_index];
 
+    if (sub_count > 1) {
+        if (sub_index < 0 || sub_index >= sub_count) {
+            error = "Invalid OpenCL sub-device index";
+            return false;
+        }
+#ifdef CL_VERSION_1_2
+#if MICRO_SWARM_OPENCL_DYNAMIC
+        if (!OCL_CALL(clCreateSubDevices) || !OCL_CALL(clReleaseDevice)) {
+            error = "clCreateSubDevices not available (OpenCL 1.2 required)";
+            return false;
+        }
+#endif
+        cl_uint compute_units = 0;
+        OCL_CALL(clGetDeviceInfo)(impl->device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(compute_units), &compute_units, nullptr);
+        cl_uint units = compute_units / static_cast<cl_uint>(sub_count);
+        if (units == 0) {
+            error = "Not enough compute units for device fission";
+            return false;
+        }
+        cl_device_partition_property part_props[] = {CL_DEVICE_PARTITION_EQUALLY, static_cast<cl_device_partition_property>(units), 0};
+        cl_uint sub_total = 0;
+        err = OCL_CALL(clCreateSubDevices)(impl->device, part_props, 0, nullptr, &sub_total);
+        if (err != CL_SUCCESS || sub_total < static_cast<cl_uint>(sub_count)) {
+            error = std::string("clCreateSubDevices failed: ") + cl_err_to_string(err);
+            return false;
+        }
+        std::vector<cl_device_id> subs(sub_total);
+        err = OCL_CALL(clCreateSubDevices)(impl->device, part_props, sub_total, subs.data(), nullptr);
+        if (err != CL_SUCCESS) {
+            error = std::string("clCreateSubDevices failed: ") + cl_err_to_string(err);
+            return false;
+        }
+        for (cl_uint i = 0; i < sub_total; ++i) {
+            if (static_cast<int>(i) != sub_index) {
+                OCL_CALL(clReleaseDevice)(subs[i]);
+            }
+        }
+        impl->device = subs[static_cast<size_t>(sub_index)];
+        impl->sub_device = true;
+#else
+        error = "Device fission requires OpenCL 1.2 headers";
+        return false;
+#endif
+    }
+
     char device_name[256] = {};
     OCL_CALL(clGetDeviceInfo)(impl->device, CL_DEVICE_NAME, sizeof(device_name), device_name, nullptr);
     char platform_name[256] = {};
     OCL_CALL(clGetPlatformInfo)(impl->platform, CL_PLATFORM_NAME, sizeof(platform_name), platform_name, nullptr);
     impl->device_info = std::string(platform_name) + " / " + device_name;
+    if (impl->sub_device) {
+        impl->device_info += " [sub " + std::to_string(sub_index) + "/" + std::to_string(sub_count) + "]";
+    }
+    char driver_version[128] = {};
+    OCL_CALL(clGetDeviceInfo)(impl->device, CL_DRIVER_VERSION, sizeof(driver_version), driver_version, nullptr);
+    impl->device_key = impl->device_info + " | " + driver_version;
 
     cl_context_properties props[] = {CL_CONTEXT_PLATFORM, (cl_context_properties)impl->platform, 0};
     impl->context = OCL_CALL(clCreateContext)(props, 1, &impl->device, nullptr, nullptr, &err);
@@ -614,6 +1327,7 @@ bool OpenCLRuntime::build_kernels(std::string &error) {
         error = std::string("clCreateKernel failed: ") + cl_err_to_string(err);
         return false;
     }
+    impl->diffuse_variant = impl->kernel_source.empty() ? "diffuse" : source_variant_key(impl->kernel_source);
     return true;
 }
 
@@ -631,7 +1345,11 @@ bool OpenCLRuntime::assemble_evolved_kernel(const int codons[4], int toxic_strid
     }
     std::string source = build_evolved_kernel_source(codons, toxic_stride, toxic_iters);
     set_kernel_source(std::move(source));
-    return build_kernels(error);
+    if (!build_kernels(error)) {
+        return false;
+    }
+    impl->diffuse_variant = evolved_variant_key(codons, toxic_stride, toxic_iters);
+    return true;
 }
 
 bool OpenCLRuntime::assemble_evolved_kernel_quadrant(int quadrant, const int codons[4], int toxic_stride, int toxic_iters, std::string &error) {
@@ -658,6 +1376,7 @@ bool OpenCLRuntime::assemble_evolved_kernel_quadrant(int quadrant, const int cod
     for (int i = 0; i < 4; ++i) {
         impl->evolved_codons[quadrant][i] = codons[i];
     }
+    impl->evolved_variant[quadrant] = evolved_variant_key(codons, toxic_stride, toxic_iters);
     impl->use_quadrant_kernels = true;
     return true;
 }
@@ -757,9 +1476,54 @@ bool OpenCLRuntime::init_fields(const GridField &phero_food,
         error = std::string("clEnqueueWriteBuffer molecules failed: ") + cl_err_to_string(err);
         return false;
     }
+    if (impl->image_backend) {
+        impl->image_error.clear();
+        impl->create_images(impl->image_error);
+    }
+    return true;
+}
+
+bool OpenCLRuntime::enable_image_backend(bool enable, std::string &error) {
+    if (!enable) {
+        impl->image_backend = false;
+        impl->release_images();
+        impl->release_image_kernel();
+        return true;
+    }
+    if (!impl->context || !impl->device) {
+        error = "OpenCL runtime not initialized";
+        return false;
+    }
+    cl_bool image_support = CL_FALSE;
+    cl_int err = OCL_CALL(clGetDeviceInfo)(impl->device, CL_DEVICE_IMAGE_SUPPORT, sizeof(image_support), &image_support, nullptr);
+    if (err != CL_SUCCESS || image_support != CL_TRUE) {
+        error = "Device has no image support (CL_DEVICE_IMAGE_SUPPORT)";
+        return false;
+    }
+    if (!impl->image_kernel &&
+        !build_kernel_from_source(impl->context, impl->device, kImageKernelSource,
+                                  impl->image_program, impl->image_kernel, error, "diffuse_and_evaporate_image")) {
+        return false;
+    }
+    impl->image_backend = true;
+    impl->image_error.clear();
+    if (impl->phero_food_a && !impl->create_images(impl->image_error)) {
+        error = impl->image_error;
+        return false;
+    }
     return true;
 }
 
+std::string OpenCLRuntime::image_backend_status() const {
+    if (!impl->image_backend) {
+        return "off";
+    }
+    if (!impl->images_ready) {
+        return impl->image_error.empty() ? "pending" : "off: " + impl->image_error;
+    }
+    return impl->images_alias ? "image2d (buffer alias)" : "image2d (device copy per step)";
+}
+
 bool OpenCLRuntime::upload_fields(const GridField &phero_food,
                                   const GridField &phero_danger,
                                   const GridField &phero_gamma,
@@ -866,10 +1630,25 @@ bool OpenCLRuntime::step_diffuse(const FieldParams &pheromone_params,
     double quad_ns[4] = {0.0, 0.0, 0.0, 0.0};
     double elapsed_ns = 0.0;
 
-    auto enqueue_field = [&](cl_mem in_buf, cl_mem out_buf, const FieldParams &params) -> bool {
+    // The image kernel replaces only the plain diffusion kernel, never custom or evolved sources.
+    bool use_images = impl->image_backend && impl->images_ready && impl->image_kernel && impl->kernel_source.empty();
+    const std::string image_variant = "diffuse_image";
+
+    auto enqueue_field = [&](int field, cl_mem in_buf, cl_mem out_buf, const FieldParams &params) -> bool {
+        cl_mem in_image = nullptr;
+        if (use_images) {
+            in_image = impl->image_for(field, in_buf, error);
+            if (!in_image) {
+                return false;
+            }
+        }
         if (!impl->use_quadrant_kernels) {
             size_t global[2] = {static_cast<size_t>(impl->width), static_cast<size_t>(impl->height)};
-            if (!run_kernel(impl->diffuse_kernel, in_buf, out_buf, params, nullptr, global, nullptr, elapsed_ns)) {
+            size_t tuned[2] = {0u, 0u};
+            cl_kernel kernel = in_image ? impl->image_kernel : impl->diffuse_kernel;
+            const std::string &variant = in_image ? image_variant : impl->diffuse_variant;
+            const size_t *local = impl->lookup_tuned_lws(variant, global[0], global[1], tuned) ? tuned : nullptr;
+            if (!run_kernel(kernel, in_image ? in_image : in_buf, out_buf, params, nullptr, global, local, elapsed_ns)) {
                 return false;
             }
             total_ns += elapsed_ns;
@@ -895,7 +1674,9 @@ bool OpenCLRuntime::step_diffuse(const FieldParams &pheromone_params,
             if (quads[q].w == 0 || quads[q].h == 0) {
                 continue;
             }
-            cl_kernel kernel = impl->evolved_kernels[q] ? impl->evolved_kernels[q] : impl->diffuse_kernel;
+            bool quad_image = in_image && !impl->evolved_kernels[q];
+            cl_kernel kernel = impl->evolved_kernels[q] ? impl->evolved_kernels[q]
+                             : (quad_image ? impl->image_kernel : impl->diffuse_kernel);
             size_t offset[2] = {quads[q].x, quads[q].y};
             size_t global[2] = {quads[q].w, quads[q].h};
             size_t local_storage[2] = {0u, 0u};
@@ -910,7 +1691,15 @@ bool OpenCLRuntime::step_diffuse(const FieldParams &pheromone_params,
                     local = local_storage;
                 }
             }
-            if (!run_kernel(kernel, in_buf, out_buf, params, offset, global, local, elapsed_ns)) {
+            // Genome LWS unset or not dividing the quadrant: use the tuned shape instead.
+            if (!local) {
+                const std::string &variant = impl->evolved_kernels[q] ? impl->evolved_variant[q]
+                                           : (quad_image ? image_variant : impl->diffuse_variant);
+                if (impl->lookup_tuned_lws(variant, global[0], global[1], local_storage)) {
+                    local = local_storage;
+                }
+            }
+            if (!run_kernel(kernel, quad_image ? in_image : in_buf, out_buf, params, offset, global, local, elapsed_ns)) {
                 return false;
             }
             total_ns += elapsed_ns;
@@ -921,28 +1710,28 @@ bool OpenCLRuntime::step_diffuse(const FieldParams &pheromone_params,
 
     cl_mem food_in = impl->food_ping ? impl->phero_food_a : impl->phero_food_b;
     cl_mem food_out = impl->food_ping ? impl->phero_food_b : impl->phero_food_a;
-    if (!enqueue_field(food_in, food_out, pheromone_params)) {
+    if (!enqueue_field(0, food_in, food_out, pheromone_params)) {
         return false;
     }
     impl->food_ping = !impl->food_ping;
 
     cl_mem danger_in = impl->danger_ping ? impl->phero_danger_a : impl->phero_danger_b;
     cl_mem danger_out = impl->danger_ping ? impl->phero_danger_b : impl->phero_danger_a;
-    if (!enqueue_field(danger_in, danger_out, pheromone_params)) {
+    if (!enqueue_field(1, danger_in, danger_out, pheromone_params)) {
         return false;
     }
     impl->danger_ping = !impl->danger_ping;
 
     cl_mem gamma_in = impl->gamma_ping ? impl->phero_gamma_a : impl->phero_gamma_b;
     cl_mem gamma_out = impl->gamma_ping ? impl->phero_gamma_b : impl->phero_gamma_a;
-    if (!enqueue_field(gamma_in, gamma_out, pheromone_params)) {
+    if (!enqueue_field(2, gamma_in, gamma_out, pheromone_params)) {
         return false;
     }
     impl->gamma_ping = !impl->gamma_ping;
 
     cl_mem m_in = impl->molecules_ping ? impl->molecules_a : impl->molecules_b;
     cl_mem m_out = impl->molecules_ping ? impl->molecules_b : impl->molecules_a;
-    if (!enqueue_field(m_in, m_out, molecule_params)) {
+    if (!enqueue_field(3, m_in, m_out, molecule_params)) {
         return false;
     }
     impl->molecules_ping = !impl->molecules_ping;
@@ -996,6 +1785,467 @@ bool OpenCLRuntime::copyback(GridField &phero_food, GridField &phero_danger, Gri
     return true;
 }
 
+bool OpenCLRuntime::init_ecology(const MycelNetwork &mycel, const Environment &env, std::string &error) {
+    if (!impl->queue || !impl->phero_food_a) {
+        error = "OpenCL runtime not initialized";
+        return false;
+    }
+    if (mycel.width != impl->width || mycel.height != impl->height ||
+        env.width != impl->width || env.height != impl->height) {
+        error = "Ecology field size mismatch";
+        return false;
+    }
+    if (!impl->ensure_aux_kernels(error)) {
+        return false;
+    }
+    impl->release_ecology();
+    size_t count = static_cast<size_t>(impl->width) * impl->height;
+    size_t bytes = count * sizeof(float);
+    cl_int err = CL_SUCCESS;
+    struct NamedBuffer {
+        cl_mem *buf;
+        size_t bytes;
+        const char *name;
+    };
+    NamedBuffer buffers[] = {
+        {&impl->density_a, bytes, "density_a"},
+        {&impl->density_b, bytes, "density_b"},
+        {&impl->inhibitor_a, bytes, "inhibitor_a"},
+        {&impl->inhibitor_b, bytes, "inhibitor_b"},
+        {&impl->resources_buf, bytes, "resources"},
+        {&impl->blocked_buf, count, "blocked"},
+    };
+    for (const NamedBuffer &b : buffers) {
+        *b.buf = OCL_CALL(clCreateBuffer)(impl->context, CL_MEM_READ_WRITE, b.bytes, nullptr, &err);
+        if (!*b.buf || err != CL_SUCCESS) {
+            error = std::string("clCreateBuffer ") + b.name + " failed: " + cl_err_to_string(err);
+            impl->release_ecology();
+            return false;
+        }
+    }
+    impl->mycel_ping = true;
+    if (!upload_ecology(mycel, env, error)) {
+        impl->release_ecology();
+        return false;
+    }
+    impl->ecology_ready = true;
+    return true;
+}
+
+bool OpenCLRuntime::upload_ecology(const MycelNetwork &mycel, const Environment &env, std::string &error) {
+    if (!impl->density_a) {
+        error = "Ecology buffers not initialized";
+        return false;
+    }
+    if (mycel.width != impl->width || mycel.height != impl->height ||
+        env.width != impl->width || env.height != impl->height) {
+        error = "Ecology field size mismatch";
+        return false;
+    }
+    size_t count = static_cast<size_t>(impl->width) * impl->height;
+    size_t bytes = count * sizeof(float);
+    cl_int err = OCL_CALL(clEnqueueWriteBuffer)(impl->queue, impl->current_field(4), CL_TRUE, 0, bytes, mycel.density.data.data(), 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueWriteBuffer density failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    err = OCL_CALL(clEnqueueWriteBuffer)(impl->queue, impl->current_field(5), CL_TRUE, 0, bytes, mycel.inhibitor.data.data(), 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueWriteBuffer inhibitor failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    err = OCL_CALL(clEnqueueWriteBuffer)(impl->queue, impl->resources_buf, CL_TRUE, 0, bytes, env.resources.data.data(), 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueWriteBuffer resources failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    // An empty blocked mask means nothing is blocked.
+    std::vector<uint8_t> blocked = env.blocked;
+    blocked.resize(count, 0);
+    err = OCL_CALL(clEnqueueWriteBuffer)(impl->queue, impl->blocked_buf, CL_TRUE, 0, count, blocked.data(), 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueWriteBuffer blocked failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    return true;
+}
+
+bool OpenCLRuntime::step_ecology(const SimParams &params, std::string &error) {
+    if (!impl->ecology_ready) {
+        error = "Ecology buffers not initialized";
+        return false;
+    }
+    cl_mem density_in = impl->current_field(4);
+    cl_mem inhibitor_in = impl->current_field(5);
+    cl_mem density_out = impl->mycel_ping ? impl->density_b : impl->density_a;
+    cl_mem inhibitor_out = impl->mycel_ping ? impl->inhibitor_b : impl->inhibitor_a;
+    cl_mem pheromone = impl->current_field(0);
+    int width = impl->width;
+    int height = impl->height;
+    cl_int err = CL_SUCCESS;
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 0, sizeof(cl_mem), &density_in);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 1, sizeof(cl_mem), &inhibitor_in);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 2, sizeof(cl_mem), &pheromone);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 3, sizeof(cl_mem), &impl->resources_buf);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 4, sizeof(cl_mem), &density_out);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 5, sizeof(cl_mem), &inhibitor_out);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 6, sizeof(int), &width);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 7, sizeof(int), &height);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 8, sizeof(float), &params.mycel_drive_p);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 9, sizeof(float), &params.mycel_drive_r);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 10, sizeof(float), &params.mycel_drive_threshold);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 11, sizeof(float), &params.mycel_transport);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 12, sizeof(float), &params.mycel_inhibitor_weight);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 13, sizeof(float), &params.mycel_growth);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 14, sizeof(float), &params.mycel_decay);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 15, sizeof(float), &params.mycel_inhibitor_threshold);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 16, sizeof(float), &params.mycel_inhibitor_gain);
+    err |= OCL_CALL(clSetKernelArg)(impl->mycel_kernel, 17, sizeof(float), &params.mycel_inhibitor_decay);
+    if (err != CL_SUCCESS) {
+        error = std::string("clSetKernelArg mycel_update failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    size_t global2[2] = {static_cast<size_t>(width), static_cast<size_t>(height)};
+    err = OCL_CALL(clEnqueueNDRangeKernel)(impl->queue, impl->mycel_kernel, 2, nullptr, global2, nullptr, 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueNDRangeKernel mycel_update failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    impl->mycel_ping = !impl->mycel_ping;
+
+    int count = width * height;
+    err = CL_SUCCESS;
+    err |= OCL_CALL(clSetKernelArg)(impl->regen_kernel, 0, sizeof(cl_mem), &impl->resources_buf);
+    err |= OCL_CALL(clSetKernelArg)(impl->regen_kernel, 1, sizeof(cl_mem), &impl->blocked_buf);
+    err |= OCL_CALL(clSetKernelArg)(impl->regen_kernel, 2, sizeof(int), &count);
+    err |= OCL_CALL(clSetKernelArg)(impl->regen_kernel, 3, sizeof(float), &params.resource_regen);
+    err |= OCL_CALL(clSetKernelArg)(impl->regen_kernel, 4, sizeof(float), &params.resource_max);
+    if (err != CL_SUCCESS) {
+        error = std::string("clSetKernelArg resource_regenerate failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    size_t global1 = static_cast<size_t>(count);
+    err = OCL_CALL(clEnqueueNDRangeKernel)(impl->queue, impl->regen_kernel, 1, nullptr, &global1, nullptr, 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueNDRangeKernel resource_regenerate failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    return true;
+}
+
+bool OpenCLRuntime::copyback_ecology(MycelNetwork &mycel, Environment &env, std::string &error) {
+    if (!impl->ecology_ready) {
+        error = "Ecology buffers not initialized";
+        return false;
+    }
+    if (mycel.width != impl->width || mycel.height != impl->height ||
+        env.width != impl->width || env.height != impl->height) {
+        error = "Ecology field size mismatch";
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(impl->width) * impl->height * sizeof(float);
+    cl_int err = OCL_CALL(clEnqueueReadBuffer)(impl->queue, impl->current_field(4), CL_TRUE, 0, bytes, mycel.density.data.data(), 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueReadBuffer density failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    err = OCL_CALL(clEnqueueReadBuffer)(impl->queue, impl->current_field(5), CL_TRUE, 0, bytes, mycel.inhibitor.data.data(), 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueReadBuffer inhibitor failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    err = OCL_CALL(clEnqueueReadBuffer)(impl->queue, impl->resources_buf, CL_TRUE, 0, bytes, env.resources.data.data(), 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueReadBuffer resources failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    return true;
+}
+
+bool OpenCLRuntime::ecology_active() const {
+    return impl->ecology_ready;
+}
+
+bool OpenCLRuntime::read_field_rows(int field_index, int y, int rows, float *dst, std::string &error) {
+    cl_mem buf = impl->current_field(field_index);
+    if (!buf || !dst) {
+        error = "Invalid field index";
+        return false;
+    }
+    if (y < 0 || rows <= 0 || y + rows > impl->height) {
+        error = "Row range out of bounds";
+        return false;
+    }
+    size_t row_bytes = static_cast<size_t>(impl->width) * sizeof(float);
+    cl_int err = OCL_CALL(clEnqueueReadBuffer)(impl->queue, buf, CL_TRUE, row_bytes * static_cast<size_t>(y), row_bytes * static_cast<size_t>(rows), dst, 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueReadBuffer rows failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    return true;
+}
+
+bool OpenCLRuntime::write_field_rows(int field_index, int y, int rows, const float *src, std::string &error) {
+    cl_mem buf = impl->current_field(field_index);
+    if (!buf || !src) {
+        error = "Invalid field index";
+        return false;
+    }
+    if (y < 0 || rows <= 0 || y + rows > impl->height) {
+        error = "Row range out of bounds";
+        return false;
+    }
+    size_t row_bytes = static_cast<size_t>(impl->width) * sizeof(float);
+    cl_int err = OCL_CALL(clEnqueueWriteBuffer)(impl->queue, buf, CL_TRUE, row_bytes * static_cast<size_t>(y), row_bytes * static_cast<size_t>(rows), src, 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueWriteBuffer rows failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    return true;
+}
+
+bool OpenCLRuntime::add_field_rect(int field_index, int x0, int y0, int x1, int y1, float value, std::string &error) {
+    cl_mem buf = impl->current_field(field_index);
+    if (!buf) {
+        error = "Invalid field index";
+        return false;
+    }
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, impl->width);
+    y1 = std::min(y1, impl->height);
+    if (x0 >= x1 || y0 >= y1) {
+        return true;
+    }
+    if (!impl->ensure_aux_kernels(error)) {
+        return false;
+    }
+    cl_int err = CL_SUCCESS;
+    err |= OCL_CALL(clSetKernelArg)(impl->add_rect_kernel, 0, sizeof(cl_mem), &buf);
+    err |= OCL_CALL(clSetKernelArg)(impl->add_rect_kernel, 1, sizeof(int), &impl->width);
+    err |= OCL_CALL(clSetKernelArg)(impl->add_rect_kernel, 2, sizeof(int), &x0);
+    err |= OCL_CALL(clSetKernelArg)(impl->add_rect_kernel, 3, sizeof(int), &y0);
+    err |= OCL_CALL(clSetKernelArg)(impl->add_rect_kernel, 4, sizeof(int), &x1);
+    err |= OCL_CALL(clSetKernelArg)(impl->add_rect_kernel, 5, sizeof(int), &y1);
+    err |= OCL_CALL(clSetKernelArg)(impl->add_rect_kernel, 6, sizeof(float), &value);
+    if (err != CL_SUCCESS) {
+        error = std::string("clSetKernelArg add_field_rect failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    size_t global[2] = {static_cast<size_t>(x1 - x0), static_cast<size_t>(y1 - y0)};
+    err = OCL_CALL(clEnqueueNDRangeKernel)(impl->queue, impl->add_rect_kernel, 2, nullptr, global, nullptr, 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueNDRangeKernel add_field_rect failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    return true;
+}
+
+bool OpenCLRuntime::reduce_fields(FieldReduction out[4], std::string &error) {
+    if (!out) {
+        error = "Invalid reduction output";
+        return false;
+    }
+    if (!impl->queue || !impl->phero_food_a) {
+        error = "OpenCL runtime not initialized";
+        return false;
+    }
+    const int fields[4] = {0, 1, 2, 3};
+    return impl->reduce(fields, 4, out, error);
+}
+
+bool OpenCLRuntime::reduce_field(int field_index, FieldReduction &out, std::string &error) {
+    if (!impl->queue || !impl->phero_food_a) {
+        error = "OpenCL runtime not initialized";
+        return false;
+    }
+    if (field_index < 0 || field_index > 6 || !impl->current_field(field_index)) {
+        error = "Invalid field index";
+        return false;
+    }
+    return impl->reduce(&field_index, 1, &out, error);
+}
+
+bool OpenCLRuntime::histogram_field(int field_index, float min_val, float max_val, int bins, std::vector<int> &hist, std::string &error) {
+    if (!impl->queue || !impl->phero_food_a) {
+        error = "OpenCL runtime not initialized";
+        return false;
+    }
+    if (field_index < 0 || field_index > 6 || !impl->current_field(field_index)) {
+        error = "Invalid field index";
+        return false;
+    }
+    if (bins <= 0 || bins > kHistogramMaxBins) {
+        error = "Invalid histogram bin count";
+        return false;
+    }
+    if (!impl->ensure_aux_kernels(error)) {
+        return false;
+    }
+    cl_int err = CL_SUCCESS;
+    if (impl->histogram_capacity < bins) {
+        if (impl->histogram_buffer) {
+            OCL_CALL(clReleaseMemObject)(impl->histogram_buffer);
+            impl->histogram_buffer = nullptr;
+            impl->histogram_capacity = 0;
+        }
+        impl->histogram_buffer = OCL_CALL(clCreateBuffer)(impl->context, CL_MEM_READ_WRITE, sizeof(int) * static_cast<size_t>(bins), nullptr, &err);
+        if (!impl->histogram_buffer || err != CL_SUCCESS) {
+            error = std::string("clCreateBuffer histogram failed: ") + cl_err_to_string(err);
+            return false;
+        }
+        impl->histogram_capacity = bins;
+    }
+    hist.assign(static_cast<size_t>(bins), 0);
+    err = OCL_CALL(clEnqueueWriteBuffer)(impl->queue, impl->histogram_buffer, CL_FALSE, 0, sizeof(int) * hist.size(), hist.data(), 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueWriteBuffer histogram failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    int count = impl->width * impl->height;
+    float range = max_val - min_val;
+    float scale = range > 0.0f ? static_cast<float>(bins) / range : 0.0f;
+    cl_mem input = impl->current_field(field_index);
+    size_t local = impl->reduce_local;
+    size_t groups = std::min(kReduceMaxGroups, (static_cast<size_t>(count) + local - 1) / local);
+    if (groups == 0) {
+        groups = 1;
+    }
+    size_t global = groups * local;
+    err = CL_SUCCESS;
+    err |= OCL_CALL(clSetKernelArg)(impl->histogram_kernel, 0, sizeof(cl_mem), &input);
+    err |= OCL_CALL(clSetKernelArg)(impl->histogram_kernel, 1, sizeof(int), &count);
+    err |= OCL_CALL(clSetKernelArg)(impl->histogram_kernel, 2, sizeof(float), &min_val);
+    err |= OCL_CALL(clSetKernelArg)(impl->histogram_kernel, 3, sizeof(float), &scale);
+    err |= OCL_CALL(clSetKernelArg)(impl->histogram_kernel, 4, sizeof(int), &bins);
+    err |= OCL_CALL(clSetKernelArg)(impl->histogram_kernel, 5, sizeof(cl_mem), &impl->histogram_buffer);
+    err |= OCL_CALL(clSetKernelArg)(impl->histogram_kernel, 6, sizeof(int) * static_cast<size_t>(bins), nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clSetKernelArg histogram_bins failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    err = OCL_CALL(clEnqueueNDRangeKernel)(impl->queue, impl->histogram_kernel, 1, nullptr, &global, &local, 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueNDRangeKernel histogram_bins failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    err = OCL_CALL(clEnqueueReadBuffer)(impl->queue, impl->histogram_buffer, CL_TRUE, 0, sizeof(int) * hist.size(), hist.data(), 0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        error = std::string("clEnqueueReadBuffer histogram failed: ") + cl_err_to_string(err);
+        return false;
+    }
+    return true;
+}
+
+void OpenCLRuntime::set_lws_tuning(const LwsTuningDb &db) {
+    impl->tuned_lws.clear();
+    for (const auto &e : db.entries()) {
+        if (e.device == impl->device_key) {
+            impl->tuned_lws[lws_key(e.kernel, static_cast<size_t>(e.width), static_cast<size_t>(e.height))] = {e.lws_x, e.lws_y};
+        }
+    }
+}
+
+bool OpenCLRuntime::autotune_lws(LwsTuningDb &db, int reps, std::string &report, std::string &error) {
+    if (!impl->diffuse_kernel || !impl->queue || !impl->phero_food_a) {
+        error = "OpenCL runtime not initialized";
+        return false;
+    }
+    if (reps < 1) {
+        reps = 1;
+    }
+    struct Target {
+        cl_kernel kernel;
+        std::string variant;
+        size_t offset[2];
+        size_t global[2];
+    };
+    std::vector<Target> targets;
+    auto add_target = [&](cl_kernel kernel, const std::string &variant, size_t ox, size_t oy, size_t gw, size_t gh) {
+        if (gw == 0 || gh == 0) return;
+        for (const auto &t : targets) {
+            if (t.variant == variant && t.global[0] == gw && t.global[1] == gh) return;
+        }
+        targets.push_back(Target{kernel, variant, {ox, oy}, {gw, gh}});
+    };
+    size_t w = static_cast<size_t>(impl->width);
+    size_t h = static_cast<size_t>(impl->height);
+    size_t mid_x = w / 2;
+    size_t mid_y = h / 2;
+    add_target(impl->diffuse_kernel, impl->diffuse_variant, 0, 0, w, h);
+    const size_t quads[4][4] = {
+        {0, 0, mid_x, mid_y},
+        {mid_x, 0, w - mid_x, mid_y},
+        {0, mid_y, mid_x, h - mid_y},
+        {mid_x, mid_y, w - mid_x, h - mid_y}
+    };
+    for (int q = 0; q < 4; ++q) {
+        cl_kernel kernel = impl->evolved_kernels[q] ? impl->evolved_kernels[q] : impl->diffuse_kernel;
+        const std::string &variant = impl->evolved_kernels[q] ? impl->evolved_variant[q] : impl->diffuse_variant;
+        add_target(kernel, variant, quads[q][0], quads[q][1], quads[q][2], quads[q][3]);
+    }
+
+    size_t item_sizes[3] = {1, 1, 1};
+    OCL_CALL(clGetDeviceInfo)(impl->device, CL_DEVICE_MAX_WORK_ITEM_SIZES, sizeof(item_sizes), item_sizes, nullptr);
+    size_t device_wg = 1;
+    OCL_CALL(clGetDeviceInfo)(impl->device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(device_wg), &device_wg, nullptr);
+
+    std::ostringstream out;
+    for (const auto &t : targets) {
+        size_t kernel_wg = device_wg;
+#if MICRO_SWARM_OPENCL_DYNAMIC
+        if (OCL_CALL(clGetKernelWorkGroupInfo)) {
+#endif
+            OCL_CALL(clGetKernelWorkGroupInfo)(t.kernel, impl->device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernel_wg), &kernel_wg, nullptr);
+#if MICRO_SWARM_OPENCL_DYNAMIC
+        }
+#endif
+        // Candidate {0,0} is the driver's own choice.
+        std::vector<std::array<size_t, 2>> shapes = {{0u, 0u}};
+        for (size_t lx = 1; lx <= item_sizes[0] && lx <= kernel_wg; lx *= 2) {
+            for (size_t ly = 1; ly <= item_sizes[1] && lx * ly <= kernel_wg; ly *= 2) {
+                if (t.global[0] % lx == 0 && t.global[1] % ly == 0) {
+                    shapes.push_back({lx, ly});
+                }
+            }
+        }
+        LwsTuningEntry best;
+        best.device = impl->device_key;
+        best.kernel = t.variant;
+        best.width = static_cast<int>(t.global[0]);
+        best.height = static_cast<int>(t.global[1]);
+        best.ns = -1.0;
+        for (const auto &shape : shapes) {
+            const size_t *local = (shape[0] > 0) ? shape.data() : nullptr;
+            double ns = 0.0;
+            std::string shape_error;
+            // Shapes the device rejects (resources, limits) are skipped, not fatal.
+            if (!impl->time_kernel(t.kernel, t.offset, t.global, local, reps, ns, shape_error)) {
+                continue;
+            }
+            if (best.ns < 0.0 || ns < best.ns) {
+                best.ns = ns;
+                best.lws_x = static_cast<int>(shape[0]);
+                best.lws_y = static_cast<int>(shape[1]);
+            }
+        }
+        if (best.ns < 0.0) {
+            error = "No work-group shape ran for " + t.variant;
+            return false;
+        }
+        db.put(best);
+        impl->tuned_lws[lws_key(best.kernel, t.global[0], t.global[1])] = {best.lws_x, best.lws_y};
+        out << t.variant << " " << t.global[0] << "x" << t.global[1] << ": lws=" << best.lws_x << "x" << best.lws_y
+            << " ns=" << best.ns << " (" << shapes.size() << " shapes)\n";
+    }
+    report = out.str();
+    return true;
+}
+
+std::string OpenCLRuntime::device_key() const {
+    return impl ? impl->device_key : std::string();
+}
+
 bool OpenCLRuntime::is_available() const {
     return impl && impl->context && impl->queue && impl->diffuse_kernel;
 }
@@ -1080,6 +2330,7 @@ bool OpenCLRuntime::print_devices(std::string &output, std::string &error) {
 OpenCLRuntime::OpenCLRuntime() : impl(nullptr) {}
 OpenCLRuntime::~OpenCLRuntime() {}
 bool OpenCLRuntime::init(int, int, std::string &error) { error = "OpenCL disabled at build time"; return false; }
+bool OpenCLRuntime::init_sub_device(int, int, int, int, std::string &error) { error = "OpenCL disabled at build time"; return false; }
 bool OpenCLRuntime::build_kernels(std::string &error) { error = "OpenCL disabled at build time"; return false; }
 void OpenCLRuntime::set_kernel_source(std::string) {}
 bool OpenCLRuntime::assemble_evolved_kernel(const int[4], int, int, std::string &error) { error = "OpenCL disabled at build time"; return false; }
@@ -1089,6 +2340,22 @@ bool OpenCLRuntime::init_fields(const GridField &, const GridField &, const Grid
 bool OpenCLRuntime::upload_fields(const GridField &, const GridField &, const GridField &, const GridField &, std::string &error) { error = "OpenCL disabled at build time"; return false; }
 bool OpenCLRuntime::step_diffuse(const FieldParams &, const FieldParams &, bool, GridField &, GridField &, GridField &, GridField &, std::string &error) { error = "OpenCL disabled at build time"; return false; }
 bool OpenCLRuntime::copyback(GridField &, GridField &, GridField &, GridField &, std::string &error) { error = "OpenCL disabled at build time"; return false; }
+bool OpenCLRuntime::reduce_fields(FieldReduction[4], std::string &error) { error = "OpenCL disabled at build time"; return false; }
+bool OpenCLRuntime::histogram_field(int, float, float, int, std::vector<int> &, std::string &error) { error = "OpenCL disabled at build time"; return false; }
+bool OpenCLRuntime::init_ecology(const MycelNetwork &, const Environment &, std::string &error) { error = "OpenCL disabled at build time"; return false; }
+bool OpenCLRuntime::upload_ecology(const MycelNetwork &, const Environment &, std::string &error) { error = "OpenCL disabled at build time"; return false; }
+bool OpenCLRuntime::step_ecology(const SimParams &, std::string &error) { error = "OpenCL disabled at build time"; return false; }
+bool OpenCLRuntime::copyback_ecology(MycelNetwork &, Environment &, std::string &error) { error = "OpenCL disabled at build time"; return false; }
+bool OpenCLRuntime::ecology_active() const { return false; }
+bool OpenCLRuntime::reduce_field(int, FieldReduction &, std::string &error) { error = "OpenCL disabled at build time"; return false; }
+bool OpenCLRuntime::read_field_rows(int, int, int, float *, std::string &error) { error = "OpenCL disabled at build time"; return false; }
+bool OpenCLRuntime::write_field_rows(int, int, int, const float *, std::string &error) { error = "OpenCL disabled at build time"; return false; }
+bool OpenCLRuntime::add_field_rect(int, int, int, int, int, float, std::string &error) { error = "OpenCL disabled at build time"; return false; }
+void OpenCLRuntime::set_lws_tuning(const LwsTuningDb &) {}
+bool OpenCLRuntime::autotune_lws(LwsTuningDb &, int, std::string &, std::string &error) { error = "OpenCL disabled at build time"; return false; }
+std::string OpenCLRuntime::device_key() const { return ""; }
+bool OpenCLRuntime::enable_image_backend(bool enable, std::string &error) { if (!enable) return true; error = "OpenCL disabled at build time"; return false; }
+std::string OpenCLRuntime::image_backend_status() const { return "off"; }
 bool OpenCLRuntime::is_available() const { return false; }
 float OpenCLRuntime::last_hardware_exhaustion_ns() const { return 0.0f; }
 void OpenCLRuntime::last_quadrant_exhaustion_ns(float out[4]) const {
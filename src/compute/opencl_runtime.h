@@ -3,7 +3,18 @@
 #include <string>
 #include <vector>
 
+#include "sim/environment.h"
 #include "sim/fields.h"
+#include "sim/mycel.h"
+#include "sim/params.h"
+
+class LwsTuningDb;
+
+struct FieldReduction {
+    double sum = 0.0;
+    float min = 0.0f;
+    float max = 0.0f;
+};
 
 class OpenCLRuntime {
 public:
@@ -11,11 +22,21 @@ public:
     ~OpenCLRuntime();
 
     bool init(int platform_index, int device_index, std::string &error);
+    // Splits the device into sub_count equal sub-devices (clCreateSubDevices) and binds sub_index.
+    bool init_sub_device(int platform_index, int device_index, int sub_count, int sub_index, std::string &error);
     bool build_kernels(std::string &error);
     void set_kernel_source(std::string source);
     bool assemble_evolved_kernel(const int codons[4], int toxic_stride, int toxic_iters, std::string &error);
     bool assemble_evolved_kernel_quadrant(int quadrant, const int codons[4], int toxic_stride, int toxic_iters, std::string &error);
     void set_quadrant_lws(const int lws[4][2]);
+    // Tuned LWS applies wherever no genome LWS is set (or it does not divide the global size).
+    void set_lws_tuning(const LwsTuningDb &db);
+    bool autotune_lws(LwsTuningDb &db, int reps, std::string &report, std::string &error);
+    std::string device_key() const;
+    // Plain diffusion reads fields through image2d_t with a clamp-to-edge sampler.
+    // Requires CL_DEVICE_IMAGE_SUPPORT; call after init(), before or after init_fields().
+    bool enable_image_backend(bool enable, std::string &error);
+    std::string image_backend_status() const;
     bool init_fields(const GridField &phero_food,
                      const GridField &phero_danger,
                      const GridField &phero_gamma,
@@ -35,6 +56,20 @@ public:
                       GridField &molecules,
                       std::string &error);
     bool copyback(GridField &phero_food, GridField &phero_danger, GridField &phero_gamma, GridField &molecules, std::string &error);
+    // Field order: 0=phero_food, 1=phero_danger, 2=phero_gamma, 3=molecules.
+    bool reduce_fields(FieldReduction out[4], std::string &error);
+    bool histogram_field(int field_index, float min_val, float max_val, int bins, std::vector<int> &hist, std::string &error);
+    // Device-resident mycel/resources: 4=mycel density, 5=mycel inhibitor, 6=resources.
+    bool init_ecology(const MycelNetwork &mycel, const Environment &env, std::string &error);
+    bool upload_ecology(const MycelNetwork &mycel, const Environment &env, std::string &error);
+    bool step_ecology(const SimParams &params, std::string &error);
+    bool copyback_ecology(MycelNetwork &mycel, Environment &env, std::string &error);
+    bool ecology_active() const;
+    bool reduce_field(int field_index, FieldReduction &out, std::string &error);
+    bool read_field_rows(int field_index, int y, int rows, float *dst, std::string &error);
+    bool write_field_rows(int field_index, int y, int rows, const float *src, std::string &error);
+    // Adds value to [x0,x1) x [y0,y1) of a resident field without a host round trip.
+    bool add_field_rect(int field_index, int x0, int y0, int x1, int y1, float value, std::string &error);
     bool is_available() const;
     float last_hardware_exhaustion_ns() const;
     void last_quadrant_exhaustion_ns(float out[4]) const;
@@ -0,0 +1,152 @@
+#include "opencl_tuning.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+std::string json_escape(const std::string &value) {
+    std::string out;
+    out.reserve(value.size() + 8);
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"': out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: out.push_back(c); break;
+        }
+    }
+    return out;
+}
+
+bool json_read_string(const std::string &s, size_t &i, std::string &out) {
+    if (i >= s.size() || s[i] != '"') return false;
+    ++i;
+    std::string result;
+    while (i < s.size()) {
+        char c = s[i++];
+        if (c == '"') {
+            out = result;
+            return true;
+        }
+        if (c == '\\' && i < s.size()) {
+            char esc = s[i++];
+            switch (esc) {
+                case 'n': result.push_back('\n'); break;
+                case 'r': result.push_back('\r'); break;
+                case 't': result.push_back('\t'); break;
+                default: result.push_back(esc); break;
+            }
+        } else {
+            result.push_back(c);
+        }
+    }
+    return false;
+}
+
+void skip_ws(const std::string &s, size_t &i) {
+    while (i < s.size() && std::isspace(static_cast<unsigned char>(s[i]))) ++i;
+}
+} // namespace
+
+bool LwsTuningDb::load(const std::string &path, std::string &error) {
+    items.clear();
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "Konnte Tuning-Datei nicht lesen: " + path;
+        return false;
+    }
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t i = 0;
+    while (i < content.size()) {
+        if (content[i] != '{') {
+            ++i;
+            continue;
+        }
+        ++i;
+        LwsTuningEntry entry;
+        bool has_device = false;
+        bool has_kernel = false;
+        while (i < content.size() && content[i] != '}') {
+            skip_ws(content, i);
+            std::string key;
+            if (!json_read_string(content, i, key)) {
+                ++i;
+                continue;
+            }
+            skip_ws(content, i);
+            if (i < content.size() && content[i] == ':') ++i;
+            skip_ws(content, i);
+            if (i < content.size() && content[i] == '"') {
+                std::string value;
+                if (!json_read_string(content, i, value)) break;
+                if (key == "device") {
+                    entry.device = value;
+                    has_device = true;
+                } else if (key == "kernel") {
+                    entry.kernel = value;
+                    has_kernel = true;
+                }
+            } else {
+                const char *start = content.c_str() + i;
+                char *end = nullptr;
+                double value = std::strtod(start, &end);
+                if (end == start) break;
+                i += static_cast<size_t>(end - start);
+                if (key == "width") entry.width = static_cast<int>(value);
+                else if (key == "height") entry.height = static_cast<int>(value);
+                else if (key == "lws_x") entry.lws_x = static_cast<int>(value);
+                else if (key == "lws_y") entry.lws_y = static_cast<int>(value);
+                else if (key == "ns") entry.ns = value;
+            }
+            skip_ws(content, i);
+            if (i < content.size() && content[i] == ',') ++i;
+        }
+        if (has_device && has_kernel && entry.width > 0 && entry.height > 0 && entry.lws_x >= 0 && entry.lws_y >= 0) {
+            put(entry);
+        }
+    }
+    return true;
+}
+
+bool LwsTuningDb::save(const std::string &path, std::string &error) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        error = "Konnte Tuning-Datei nicht schreiben: " + path;
+        return false;
+    }
+    out << "[\n";
+    for (size_t i = 0; i < items.size(); ++i) {
+        const LwsTuningEntry &e = items[i];
+        out << "  {\"device\":\"" << json_escape(e.device) << "\",\"kernel\":\"" << json_escape(e.kernel)
+            << "\",\"width\":" << e.width << ",\"height\":" << e.height
+            << ",\"lws_x\":" << e.lws_x << ",\"lws_y\":" << e.lws_y << ",\"ns\":" << e.ns << "}";
+        if (i + 1 < items.size()) out << ",";
+        out << "\n";
+    }
+    out << "]\n";
+    return static_cast<bool>(out);
+}
+
+const LwsTuningEntry *LwsTuningDb::find(const std::string &device, const std::string &kernel, int width, int height) const {
+    for (const auto &e : items) {
+        if (e.width == width && e.height == height && e.kernel == kernel && e.device == device) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+void LwsTuningDb::put(const LwsTuningEntry &entry) {
+    for (auto &e : items) {
+        if (e.width == entry.width && e.height == entry.height && e.kernel == entry.kernel && e.device == entry.device) {
+            e = entry;
+            return;
+        }
+    }
+    items.push_back(entry);
+}
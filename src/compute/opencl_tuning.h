@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct LwsTuningEntry {
+    std::string device;
+    std::string kernel;
+    int width = 0;
+    int height = 0;
+    int lws_x = 0;
+    int lws_y = 0;
+    double ns = 0.0;
+};
+
+// Best local work size per device, kernel variant and global size, stored as a JSON array.
+// lws_x/lws_y of 0 means the driver's choice won the sweep.
+class LwsTuningDb {
+public:
+    bool load(const std::string &path, std::string &error);
+    bool save(const std::string &path, std::string &error) const;
+    const LwsTuningEntry *find(const std::string &device, const std::string &kernel, int width, int height) const;
+    void put(const LwsTuningEntry &entry);
+    const std::vector<LwsTuningEntry> &entries() const { return items; }
+
+private:
+    std::vector<LwsTuningEntry> items;
+};
@@ -12,7 +12,12 @@
 #include <unordered_map>
 #include <chrono>
 #include <ctime>
+#include <atomic>
+#include <memory>
+#include <thread>
 
+#include "compute/opencl_bands.h"
+#include "compute/opencl_tuning.h"
 #include "compute/opencl_loader.h"
 #include "compute/opencl_runtime.h"
 #include "sim/agent.h"
@@ -56,6 +61,13 @@ struct CliOptions {
     int ocl_platform = 0;
     bool ocl_print_devices = false;
     bool ocl_no_copyback = false;
+    bool ocl_self_test = false;
+    std::vector<OpenCLDeviceSelector> ocl_devices;
+    int ocl_fission = 1;
+    bool ocl_autotune = false;
+    std::string ocl_tuning_file = "ocl_tuning.json";
+    bool ocl_images = false;
+    bool ocl_image_bench = false;
 
     bool stress_enable = false;
     int stress_at_step = 120;
@@ -96,6 +108,13 @@ struct CliOptions {
     int db_merge_steps = 2000;
     uint32_t db_merge_seed = 42;
     int db_merge_threshold = 0;
+    int db_merge_relayout = 25;
+    int db_bench_repeat = 5;
+    int db_stress_readers = 4;
+    int db_stress_writes = 1000;
+    int db_stress_publish = 1;
+    int db_threads = 0;
+    int db_wal = 0;
     std::string sql_output_format = "table";
 };
 
@@ -181,19 +200,26 @@ int pick_species(Rng &rng, const std::array<float, 4> &fracs) {
 
 void print_help() {
     std::cout << "micro_swarm Optionen:\n"
-              << "  --mode NAME     sim | db_ingest | db_query\n"
+              << "  --mode NAME     sim | db_ingest | db_query | db_shell | db_bench | db_stress | db_convert\n"
               << "  --input PATH    SQL-Input fuer db_ingest\n"
-              << "  --output PATH   MYCO-Output fuer db_ingest\n"
+              << "  --output PATH   MYCO-Output fuer db_ingest und db_convert\n"
               << "  --db-dump PATH  Cluster-PPM-Output fuer db_ingest\n"
               << "  --db-dump-scale N  Skalierung fuer PPM-Output (Default 4)\n"
               << "  --ingest-rules PATH  JSON-Regeln fuer Trait-Cluster beim Ingest\n"
               << "  --db PATH       MYCO-Input fuer db_query\n"
               << "  --query TEXT    Query fuer db_query (SQL-Light)\n"
               << "  --db-radius N   Radius fuer db_query (Default 5)\n"
+              << "  --db-bench-repeat N  Wiederholungen pro Query und Ladevorgang fuer db_bench (Default 5)\n"
+              << "  --db-stress-readers N  Lese-Threads fuer db_stress (Default 4)\n"
+              << "  --db-stress-writes N   Schreib-Statements fuer db_stress (Default 1000)\n"
+              << "  --db-stress-publish N  db_stress: Snapshot nach jeweils N Writes veroeffentlichen (Default 1)\n"
               << "  --db-merge-agents N   Agentenanzahl fuer Merge (Default 256)\n"
               << "  --db-merge-steps N    Schritte fuer Merge (Default 2000)\n"
               << "  --db-merge-seed N     Seed fuer Merge (Default 42)\n"
               << "  --db-merge-threshold N  Auto-Merge ab Delta-Size N (0=aus)\n"
+              << "  --db-merge-relayout N  Volles Re-Layout beim Merge ab N% geaenderter Payloads (Default 25, 0=immer)\n"
+              << "  --db-threads N  Worker-Threads fuer Ingest/Merge (0=automatisch)\n"
+              << "  --db-wal N      WAL <db>.wal fuer db_query/db_shell, fsync alle N Commits (0=aus)\n"
               << "  --sql-format F  Output-Format fuer SQL (table|csv|json)\n"
               << "  --width N        Rasterbreite\n"
               << "  --height N       Rasterhoehe\n"
@@ -232,6 +258,13 @@ void print_help() {
               << "  --ocl-platform N       OpenCL Platform Index\n"
               << "  --ocl-print-devices    OpenCL Platforms/Devices auflisten\n"
               << "  --ocl-no-copyback      Host-Backcopy nur bei Dump/Ende\n"
+              << "  --ocl-self-test        OpenCL CPU/GPU-Vergleich ausfuehren und beenden\n"
+              << "  --ocl-devices LIST     Mehrere Devices als Baender, z.B. 0:0,0:1\n"
+              << "  --ocl-fission N        Jedes Device in N Sub-Devices teilen (clCreateSubDevices)\n"
+              << "  --ocl-autotune         Work-Group-Groessen messen, in Tuning-Datei speichern und beenden\n"
+              << "  --ocl-tuning-file PATH Tuning-Datei fuer Work-Group-Groessen (default ocl_tuning.json)\n"
+              << "  --ocl-images           Felder als image2d_t lesen (Clamp-to-Edge-Sampler, braucht Image-Support)\n"
+              << "  --ocl-image-bench      Buffer- vs. image2d-Diffusion messen (--steps Schritte) und beenden\n"
               << "  --gpu N                Alias fuer OpenCL (0=aus, 1=an)\n"
               << "  --species-fracs f0 f1 f2 f3           Spezies-Anteile\n"
               << "  --species-profile S e f d df dd       Spezies-Profilwerte\n"
@@ -401,6 +434,34 @@ float distance_to_segment(float ax, float ay, float bx, float by, float px, floa
     return std::sqrt(dx * dx + dy * dy);
 }
 
+// One statement per line for db_bench/db_stress, optional "sql " prefix as in db_shell; # and -- are comments.
+bool read_sql_lines(const std::string &path, std::vector<std::string> &out) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) line.pop_back();
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos) continue;
+        line = line.substr(start);
+        if (line[0] == '#' || line.rfind("--", 0) == 0) continue;
+        if (line.size() > 4 && (line[0] == 's' || line[0] == 'S') && (line[1] == 'q' || line[1] == 'Q') &&
+            (line[2] == 'l' || line[2] == 'L') && line[3] == ' ') {
+            line = line.substr(4);
+        }
+        out.push_back(line);
+    }
+    return true;
+}
+
+bool is_read_statement(const std::string &sql) {
+    std::string lower = sql.substr(0, 6);
+    for (char &c : lower) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return lower.rfind("select", 0) == 0 || lower.rfind("with", 0) == 0;
+}
+
 bool export_dna_csv(const std::string &path,
                     const std::array<DNAMemory, 4> &dna_species,
                     const DNAMemory &dna_global) {
@@ -457,6 +518,26 @@ bool parse_cli(int argc, char **argv, CliOptions &opts) {
             opts.ocl_no_copyback = true;
             continue;
         }
+        if (arg == "--ocl-self-test") {
+            opts.ocl_self_test = true;
+            opts.ocl_enable = true;
+            continue;
+        }
+        if (arg == "--ocl-autotune") {
+            opts.ocl_autotune = true;
+            opts.ocl_enable = true;
+            continue;
+        }
+        if (arg == "--ocl-images") {
+            opts.ocl_images = true;
+            opts.ocl_enable = true;
+            continue;
+        }
+        if (arg == "--ocl-image-bench") {
+            opts.ocl_image_bench = true;
+            opts.ocl_enable = true;
+            continue;
+        }
         if (!arg.empty() && arg[0] != '-' && i == argc - 1) {
             if (!parse_string(arg.c_str(), opts.dump_subdir)) {
                 std::cerr << "Ungueltiger Wert fuer dump-subdir\n";
@@ -687,6 +768,26 @@ bool parse_cli(int argc, char **argv, CliOptions &opts) {
                 std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
                 return false;
             }
+        } else if (arg == "--db-bench-repeat") {
+            if (!parse_int(value, opts.db_bench_repeat)) {
+                std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
+                return false;
+            }
+        } else if (arg == "--db-stress-readers") {
+            if (!parse_int(value, opts.db_stress_readers)) {
+                std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
+                return false;
+            }
+        } else if (arg == "--db-stress-writes") {
+            if (!parse_int(value, opts.db_stress_writes)) {
+                std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
+                return false;
+            }
+        } else if (arg == "--db-stress-publish") {
+            if (!parse_int(value, opts.db_stress_publish)) {
+                std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
+                return false;
+            }
         } else if (arg == "--db-merge-agents") {
             if (!parse_int(value, opts.db_merge_agents)) {
                 std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
@@ -709,6 +810,21 @@ bool parse_cli(int argc, char **argv, CliOptions &opts) {
                 std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
                 return false;
             }
+        } else if (arg == "--db-merge-relayout") {
+            if (!parse_int(value, opts.db_merge_relayout)) {
+                std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
+                return false;
+            }
+        } else if (arg == "--db-threads") {
+            if (!parse_int(value, opts.db_threads)) {
+                std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
+                return false;
+            }
+        } else if (arg == "--db-wal") {
+            if (!parse_int(value, opts.db_wal) || opts.db_wal < 0) {
+                std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
+                return false;
+            }
         } else if (arg == "--sql-format") {
             if (!parse_string(value, opts.sql_output_format)) {
                 std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
@@ -874,6 +990,23 @@ bool parse_cli(int argc, char **argv, CliOptions &opts) {
                 std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
                 return false;
             }
+        } else if (arg == "--ocl-devices") {
+            if (!parse_ocl_device_list(value, opts.ocl_devices)) {
+                std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
+                return false;
+            }
+            opts.ocl_enable = true;
+        } else if (arg == "--ocl-fission") {
+            if (!parse_int(value, opts.ocl_fission) || opts.ocl_fission < 1) {
+                std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
+                return false;
+            }
+            opts.ocl_enable = true;
+        } else if (arg == "--ocl-tuning-file") {
+            if (!parse_string(value, opts.ocl_tuning_file)) {
+                std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
+                return false;
+            }
         } else if (arg == "--stress-at-step") {
             if (!parse_int(value, opts.stress_at_step)) {
                 std::cerr << "Ungueltiger Wert fuer " << arg << "\n";
@@ -1002,7 +1135,8 @@ int main(int argc, char **argv) {
         std::cout << output;
         return 0;
     }
-    if (opts.mode != "sim" && opts.mode != "db_ingest" && opts.mode != "db_query" && opts.mode != "db_shell") {
+    if (opts.mode != "sim" && opts.mode != "db_ingest" && opts.mode != "db_query" && opts.mode != "db_shell" &&
+        opts.mode != "db_bench" && opts.mode != "db_stress" && opts.mode != "db_convert") {
         std::cerr << "Unbekannter Modus: " << opts.mode << "\n";
         return 1;
     }
@@ -1024,6 +1158,7 @@ int main(int argc, char **argv) {
         cfg.steps = opts.params.steps;
         cfg.seed = opts.seed;
         cfg.rules_path = opts.ingest_rules_path;
+        cfg.threads = opts.db_threads;
         if (!db_run_ingest(world, cfg, error)) {
             std::cerr << "Ingest-Fehler: " << error << "\n";
             return 1;
@@ -1118,6 +1253,232 @@ int main(int argc, char **argv) {
             std::cout << "\n";
         }
     };
+    if (opts.mode == "db_convert") {
+        if (opts.db_path.empty() || opts.db_output.empty()) {
+            std::cerr << "db_convert benoetigt --db und --output\n";
+            return 1;
+        }
+        DbWorld world;
+        std::string error;
+        if (!db_load_myco(opts.db_path, world, error) || !db_save_myco(opts.db_output, world, error)) {
+            std::cerr << "MYCO-Fehler: " << error << "\n";
+            return 1;
+        }
+        std::cout << "MYCO" << db_myco_version(opts.db_path) << " -> MYCO" << db_myco_version(opts.db_output)
+                  << " payloads=" << world.payloads.size() << " output=" << opts.db_output << "\n";
+        return 0;
+    }
+    if (opts.mode == "db_bench") {
+        if (opts.db_path.empty()) {
+            std::cerr << "db_bench benoetigt --db (und optional --input mit Queries)\n";
+            return 1;
+        }
+        int repeat = std::max(1, opts.db_bench_repeat);
+        std::cout << std::fixed << std::setprecision(3);
+        // Load time first; the last loaded world serves the queries.
+        DbWorld world;
+        std::string error;
+        double load_best_ms = 0.0;
+        double load_sum_ms = 0.0;
+        for (int r = 0; r < repeat; ++r) {
+            DbWorld loaded;
+            auto t0 = std::chrono::steady_clock::now();
+            bool ok = db_load_myco(opts.db_path, loaded, error);
+            auto t1 = std::chrono::steady_clock::now();
+            if (!ok) {
+                std::cerr << "MYCO-Fehler: " << error << "\n";
+                return 1;
+            }
+            double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+            load_best_ms = (r == 0) ? ms : std::min(load_best_ms, ms);
+            load_sum_ms += ms;
+            if (r == repeat - 1) {
+                world = std::move(loaded);
+            }
+        }
+        std::cout << "bench load format=MYCO" << db_myco_version(opts.db_path) << " payloads=" << world.payloads.size()
+                  << " best_ms=" << load_best_ms << " avg_ms=" << (load_sum_ms / repeat) << "\n";
+        if (opts.db_input.empty()) {
+            return 0;
+        }
+        std::vector<std::string> queries;
+        if (!read_sql_lines(opts.db_input, queries)) {
+            std::cerr << "Query-Datei nicht lesbar: " << opts.db_input << "\n";
+            return 1;
+        }
+        for (const auto &query : queries) {
+            if (!is_read_statement(query)) {
+                std::cerr << "db_bench: nur SELECT/WITH erlaubt: " << query << "\n";
+                return 1;
+            }
+        }
+        if (queries.empty()) {
+            std::cerr << "db_bench: keine Queries in " << opts.db_input << "\n";
+            return 1;
+        }
+        double total_ms = 0.0;
+        for (size_t qi = 0; qi < queries.size(); ++qi) {
+            double best_ms = 0.0;
+            double sum_ms = 0.0;
+            size_t rows = 0;
+            for (int r = 0; r < repeat; ++r) {
+                DbSqlResult result;
+                auto t0 = std::chrono::steady_clock::now();
+                bool ok = db_execute_sql(world, queries[qi], false, 0, 0, opts.db_radius, result, error);
+                auto t1 = std::chrono::steady_clock::now();
+                if (!ok) {
+                    std::cerr << "SQL-Fehler in Query " << (qi + 1) << ": " << error << "\n";
+                    return 1;
+                }
+                double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+                best_ms = (r == 0) ? ms : std::min(best_ms, ms);
+                sum_ms += ms;
+                rows = result.rows.size();
+            }
+            total_ms += sum_ms / repeat;
+            std::cout << "bench q" << (qi + 1) << " rows=" << rows << " best_ms=" << best_ms
+                      << " avg_ms=" << (sum_ms / repeat) << " sql=" << queries[qi] << "\n";
+        }
+        std::cout << "db_bench queries=" << queries.size() << " repeat=" << repeat << " total_avg_ms=" << total_ms << "\n";
+        return 0;
+    }
+    if (opts.mode == "db_stress") {
+        if (opts.db_path.empty() || opts.db_input.empty()) {
+            std::cerr << "db_stress benoetigt --db und --input mit SELECT- und Schreib-Statements\n";
+            return 1;
+        }
+        DbWorld world;
+        std::string error;
+        if (!db_load_myco(opts.db_path, world, error)) {
+            std::cerr << "MYCO-Fehler: " << error << "\n";
+            return 1;
+        }
+        std::vector<std::string> lines;
+        if (!read_sql_lines(opts.db_input, lines)) {
+            std::cerr << "Query-Datei nicht lesbar: " << opts.db_input << "\n";
+            return 1;
+        }
+        // SELECT/WITH lines go round-robin to the readers, all other lines form the writer's script.
+        std::vector<std::string> queries;
+        std::vector<std::string> writes;
+        for (auto &line : lines) {
+            (is_read_statement(line) ? queries : writes).push_back(line);
+        }
+        if (queries.empty() || writes.empty()) {
+            std::cerr << "db_stress: braucht mindestens ein SELECT und ein Schreib-Statement in " << opts.db_input << "\n";
+            return 1;
+        }
+        int reader_count = std::max(1, opts.db_stress_readers);
+        int write_count = std::max(1, opts.db_stress_writes);
+        int publish_every = std::max(1, opts.db_stress_publish);
+        std::cout << std::fixed << std::setprecision(3);
+
+        DbSnapshotStore store;
+        if (!db_publish_snapshot(store, world, error)) {
+            std::cerr << "Snapshot-Fehler: " << error << "\n";
+            return 1;
+        }
+        struct ReaderStats {
+            size_t queries = 0;
+            double total_ms = 0.0;
+            double max_ms = 0.0;
+            uint64_t first_version = 0;
+            uint64_t last_version = 0;
+            std::string error;
+        };
+        std::atomic<bool> writer_done{false};
+        std::atomic<bool> failed{false};
+        std::vector<ReaderStats> stats(static_cast<size_t>(reader_count));
+        std::vector<std::thread> readers;
+        auto t_start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reader_count; ++r) {
+            readers.emplace_back([&, r]() {
+                ReaderStats &st = stats[static_cast<size_t>(r)];
+                size_t next = static_cast<size_t>(r);
+                while (!failed.load()) {
+                    bool last_round = writer_done.load();
+                    std::shared_ptr<const DbWorldSnapshot> snapshot = db_acquire_snapshot(store);
+                    if (snapshot->version < st.last_version) {
+                        st.error = "Snapshot-Version rueckwaerts: " + std::to_string(snapshot->version);
+                        failed = true;
+                        return;
+                    }
+                    if (st.first_version == 0) st.first_version = snapshot->version;
+                    st.last_version = snapshot->version;
+                    DbSqlResult result;
+                    const std::string &sql = queries[next++ % queries.size()];
+                    auto t0 = std::chrono::steady_clock::now();
+                    if (!db_execute_snapshot_sql(*snapshot, sql, false, 0, 0, opts.db_radius, result, st.error)) {
+                        st.error = sql + ": " + st.error;
+                        failed = true;
+                        return;
+                    }
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                    ++st.queries;
+                    st.total_ms += ms;
+                    st.max_ms = std::max(st.max_ms, ms);
+                    if (last_round) return;
+                }
+            });
+        }
+        double write_ms = 0.0;
+        double publish_ms = 0.0;
+        double publish_max_ms = 0.0;
+        int publishes = 0;
+        for (int i = 0; i < write_count && !failed.load(); ++i) {
+            const std::string &sql = writes[static_cast<size_t>(i) % writes.size()];
+            DbSqlResult result;
+            auto t0 = std::chrono::steady_clock::now();
+            bool ok = db_execute_sql(world, sql, false, 0, 0, opts.db_radius, result, error);
+            auto t1 = std::chrono::steady_clock::now();
+            write_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+            if (!ok) {
+                error = sql + ": " + error;
+                failed = true;
+                break;
+            }
+            if ((i + 1) % publish_every == 0 || i + 1 == write_count) {
+                if (!db_publish_snapshot(store, world, error)) {
+                    failed = true;
+                    break;
+                }
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t1).count();
+                publish_ms += ms;
+                publish_max_ms = std::max(publish_max_ms, ms);
+                ++publishes;
+            }
+        }
+        writer_done = true;
+        for (auto &t : readers) t.join();
+        double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_start).count();
+        if (failed.load()) {
+            if (!error.empty()) std::cerr << "db_stress Writer: " << error << "\n";
+            for (const auto &st : stats) {
+                if (!st.error.empty()) std::cerr << "db_stress Reader: " << st.error << "\n";
+            }
+            return 1;
+        }
+        size_t total_queries = 0;
+        double total_query_ms = 0.0;
+        double max_query_ms = 0.0;
+        for (const auto &st : stats) {
+            total_queries += st.queries;
+            total_query_ms += st.total_ms;
+            max_query_ms = std::max(max_query_ms, st.max_ms);
+        }
+        std::cout << "stress writer writes=" << write_count << " publishes=" << publishes
+                  << " write_avg_ms=" << (write_ms / write_count) << " publish_avg_ms=" << (publish_ms / std::max(1, publishes))
+                  << " publish_max_ms=" << publish_max_ms << "\n";
+        for (size_t r = 0; r < stats.size(); ++r) {
+            std::cout << "stress reader" << (r + 1) << " queries=" << stats[r].queries
+                      << " versions=" << stats[r].first_version << ".." << stats[r].last_version << "\n";
+        }
+        std::cout << "db_stress readers=" << reader_count << " queries=" << total_queries
+                  << " avg_query_ms=" << (total_queries ? total_query_ms / total_queries : 0.0) << " max_query_ms=" << max_query_ms
+                  << " wall_ms=" << wall_ms << " writes_per_s=" << (write_count * 1000.0 / wall_ms)
+                  << " queries_per_s=" << (total_queries * 1000.0 / wall_ms) << "\n";
+        return 0;
+    }
     if (opts.mode == "db_query") {
         if (opts.db_path.empty() || opts.db_query.empty()) {
             std::cerr << "db_query benoetigt --db und --query\n";
@@ -1129,6 +1490,10 @@ int main(int argc, char **argv) {
             std::cerr << "MYCO-Fehler: " << error << "\n";
             return 1;
         }
+        if (opts.db_wal > 0 && !db_wal_open(world, opts.db_path, opts.db_wal, error)) {
+            std::cerr << "WAL-Fehler: " << error << "\n";
+            return 1;
+        }
         std::string qtrim = opts.db_query;
         auto lower_copy = [](std::string s) {
             for (char &c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
@@ -1172,11 +1537,17 @@ int main(int argc, char **argv) {
             std::cerr << "MYCO-Fehler: " << error << "\n";
             return 1;
         }
+        if (opts.db_wal > 0 && !db_wal_open(world, opts.db_path, opts.db_wal, error)) {
+            std::cerr << "WAL-Fehler: " << error << "\n";
+            return 1;
+        }
         DbIngestConfig merge_cfg;
         merge_cfg.agent_count = opts.db_merge_agents;
         merge_cfg.steps = opts.db_merge_steps;
         merge_cfg.seed = opts.db_merge_seed;
         merge_cfg.rules_path = opts.ingest_rules_path;
+        merge_cfg.threads = opts.db_threads;
+        merge_cfg.relayout_percent = opts.db_merge_relayout;
         bool focus_set = false;
         int focus_x = 0;
         int focus_y = 0;
@@ -1533,10 +1904,13 @@ int main(int argc, char **argv) {
                 std::cout << "  tables                  -> Tabellenliste\n";
                 std::cout << "  stats                   -> Payload-Counts pro Tabelle\n";
                 std::cout << "  delta                   -> Delta-Status\n";
-                std::cout << "  merge                   -> Delta in Cluster mergen\n";
+                std::cout << "  merge                   -> Delta in Cluster mergen (inkrementell)\n";
+                std::cout << "  merge full              -> Delta mergen mit komplettem Re-Layout\n";
                 std::cout << "  merge auto <n>           -> Auto-Merge ab Delta-Size N\n";
                 std::cout << "  delta show              -> Delta-Details\n";
                 std::cout << "  undo                    -> Letztes Delta rueckgaengig\n";
+                std::cout << "  checkpoint              -> Delta mergen, .myco neu schreiben, WAL leeren (--db-wal)\n";
+                std::cout << "  sql BEGIN | COMMIT | ROLLBACK [TO name] | SAVEPOINT name -> Transaktionen\n";
                 std::cout << "  schema <table>           -> Spaltenliste\n";
                 std::cout << "  ingest <sql> [rules]     -> SQL-Dump ingestieren (ersetzen)\n";
                 std::cout << "  history                 -> Historie anzeigen\n";
@@ -1635,11 +2009,10 @@ int main(int argc, char **argv) {
                     cols = world.table_columns[static_cast<size_t>(table_id)];
                 }
                 if (cols.empty()) {
-                    for (const auto &p : world.payloads) {
+                    for (int idx : db_table_payloads(world, table_id)) {
+                        const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
                         if (p.table_id == table_id) {
-                            int64_t key = db_payload_key(p.table_id, p.id);
-                            if (world.tombstones.find(key) != world.tombstones.end()) continue;
-                            if (!p.is_delta && world.delta_index_by_key.find(key) != world.delta_index_by_key.end()) continue;
+                            if (db_payload_hidden(world, idx)) continue;
                             for (const auto &f : p.fields) {
                                 cols.push_back(f.name);
                             }
@@ -1671,11 +2044,9 @@ int main(int argc, char **argv) {
                     std::cout << "\n";
                 }
                 bool printed = false;
-                for (const auto &p : world.payloads) {
-                    if (p.table_id != table_id) continue;
-                    int64_t key = db_payload_key(p.table_id, p.id);
-                    if (world.tombstones.find(key) != world.tombstones.end()) continue;
-                    if (!p.is_delta && world.delta_index_by_key.find(key) != world.delta_index_by_key.end()) continue;
+                for (int idx : db_table_payloads(world, table_id)) {
+                    const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
+                    if (db_payload_hidden(world, idx)) continue;
                     if (p.fields.empty()) continue;
                     std::cout << "example: " << p.raw_data << "\n";
                     printed = true;
@@ -1696,10 +2067,9 @@ int main(int argc, char **argv) {
                     continue;
                 }
                 bool found = false;
-                for (const auto &p : world.payloads) {
-                    int64_t key = db_payload_key(p.table_id, p.id);
-                    if (world.tombstones.find(key) != world.tombstones.end()) continue;
-                    if (!p.is_delta && world.delta_index_by_key.find(key) != world.delta_index_by_key.end()) continue;
+                for (size_t i = 0; i < world.payloads.size(); ++i) {
+                    const DbPayload &p = world.payloads[i];
+                    if (db_payload_hidden(world, static_cast<int>(i))) continue;
                     if (p.id == payload_id && p.placed) {
                         focus_x = p.x;
                         focus_y = p.y;
@@ -1881,11 +2251,10 @@ int main(int argc, char **argv) {
             }
             if (line == "stats") {
                 std::vector<int> counts(world.table_names.size(), 0);
-                for (const auto &p : world.payloads) {
+                for (size_t i = 0; i < world.payloads.size(); ++i) {
+                    const DbPayload &p = world.payloads[i];
                     if (p.table_id >= 0 && p.table_id < static_cast<int>(counts.size())) {
-                        int64_t key = db_payload_key(p.table_id, p.id);
-                        if (world.tombstones.find(key) != world.tombstones.end()) continue;
-                        if (!p.is_delta && world.delta_index_by_key.find(key) != world.delta_index_by_key.end()) continue;
+                        if (db_payload_hidden(world, static_cast<int>(i))) continue;
                         counts[static_cast<size_t>(p.table_id)]++;
                     }
                 }
@@ -1920,9 +2289,13 @@ int main(int argc, char **argv) {
                 }
                 continue;
             }
-            if (line == "merge") {
+            if (line == "merge" || line == "merge full") {
+                DbIngestConfig cfg = merge_cfg;
+                if (line == "merge full") {
+                    cfg.relayout_percent = 0;
+                }
                 std::string merge_error;
-                if (!db_merge_delta(world, merge_cfg, merge_error)) {
+                if (!db_merge_delta(world, cfg, merge_error)) {
                     std::cout << "merge_error: " << merge_error << "\n";
                 } else {
                     std::cout << "merge_ok\n";
@@ -1941,6 +2314,15 @@ int main(int argc, char **argv) {
                 std::cout << "merge_auto=" << auto_merge_threshold << "\n";
                 continue;
             }
+            if (line == "checkpoint") {
+                std::string checkpoint_error;
+                if (!db_checkpoint(world, merge_cfg, checkpoint_error)) {
+                    std::cout << "checkpoint_error: " << checkpoint_error << "\n";
+                } else {
+                    std::cout << "checkpoint_ok\n";
+                }
+                continue;
+            }
             if (line == "undo") {
                 std::string undo_error;
                 if (!db_undo_last_delta(world, undo_error)) {
@@ -2052,11 +2434,10 @@ int main(int argc, char **argv) {
                     cols = world.table_columns[static_cast<size_t>(table_id)];
                 }
                 if (cols.empty()) {
-                    for (const auto &p : world.payloads) {
+                    for (int idx : db_table_payloads(world, table_id)) {
+                        const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
                         if (p.table_id == table_id) {
-                            int64_t key = db_payload_key(p.table_id, p.id);
-                            if (world.tombstones.find(key) != world.tombstones.end()) continue;
-                            if (!p.is_delta && world.delta_index_by_key.find(key) != world.delta_index_by_key.end()) continue;
+                            if (db_payload_hidden(world, idx)) continue;
                             for (const auto &f : p.fields) {
                                 cols.push_back(f.name);
                             }
@@ -2139,7 +2520,7 @@ int main(int argc, char **argv) {
                     last_query.local = focus_set;
                     last_query.fallback_global = false;
                     last_query.hits = static_cast<int>(result.rows.size());
-                    if (auto_merge_threshold > 0) {
+                    if (auto_merge_threshold > 0 && !world.txn_active) {
                         std::string lower_sql = statements[si];
                         for (char &c : lower_sql) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
                         if (lower_sql.rfind("insert", 0) == 0 || lower_sql.rfind("update", 0) == 0 ||
@@ -2738,7 +3119,23 @@ int main(int argc, char **argv) {
 
     OpenCLRuntime ocl_runtime;
     bool ocl_active = false;
-    if (opts.ocl_enable) {
+    if (opts.ocl_devices.empty()) {
+        opts.ocl_devices.push_back(OpenCLDeviceSelector{opts.ocl_platform, opts.ocl_device});
+    }
+    bool ocl_multi = opts.ocl_enable && opts.ocl_devices.size() * static_cast<size_t>(opts.ocl_fission) > 1;
+    OpenCLBandRuntime ocl_bands;
+    bool ocl_bands_active = false;
+    if (ocl_multi) {
+        std::string ocl_error;
+        if (!ocl_bands.init(opts.ocl_devices, opts.ocl_fission, ocl_error)) {
+            std::cerr << "[OpenCL] multi-device init failed, fallback to CPU: " << ocl_error << "\n";
+        } else if (!ocl_bands.init_fields(phero_food, phero_danger, phero_gamma, molecules, ocl_error)) {
+            std::cerr << "[OpenCL] multi-device buffer init failed, fallback to CPU: " << ocl_error << "\n";
+        } else {
+            std::cout << "[OpenCL] " << ocl_bands.band_count() << " bands: " << ocl_bands.device_info() << "\n";
+            ocl_bands_active = true;
+        }
+    } else if (opts.ocl_enable) {
         std::string ocl_error;
         if (!ocl_runtime.init(opts.ocl_platform, opts.ocl_device, ocl_error)) {
             std::cerr << "[OpenCL] init failed, fallback to CPU: " << ocl_error << "\n";
@@ -2750,9 +3147,13 @@ int main(int argc, char **argv) {
             std::cout << "[OpenCL] platform/device: " << ocl_runtime.device_info() << "\n";
             std::cout << "[OpenCL] kernels built\n";
             ocl_active = true;
+            if (opts.ocl_images && !ocl_runtime.enable_image_backend(true, ocl_error)) {
+                std::cerr << "[OpenCL] image2d backend unavailable, using buffers: " << ocl_error << "\n";
+            }
         }
     }
 
+    bool ocl_ecology_ok = true;
     auto run_ocl_self_test = [&](OpenCLRuntime &runtime) -> bool {
         GridField pf(16, 16, 0.0f);
         GridField pd(16, 16, 0.0f);
@@ -2805,9 +3206,143 @@ int main(int argc, char **argv) {
             std::cerr << "[OpenCL] self-test too large diff, fallback to CPU\n";
             return false;
         }
+        FieldReduction reduction[4];
+        if (!runtime.reduce_fields(reduction, error)) {
+            std::cerr << "[OpenCL] self-test reduction unavailable: " << error << "\n";
+            return true;
+        }
+        const GridField *host_fields[4] = {&pf, &pd, &pg, &m};
+        double reduce_diff = 0.0;
+        for (int f = 0; f < 4; ++f) {
+            double host_sum = 0.0;
+            float host_min = host_fields[f]->data.front();
+            float host_max = host_fields[f]->data.front();
+            for (float v : host_fields[f]->data) {
+                host_sum += static_cast<double>(v);
+                host_min = std::min(host_min, v);
+                host_max = std::max(host_max, v);
+            }
+            reduce_diff = std::max(reduce_diff, std::abs(reduction[f].sum - host_sum) / std::max(1.0, std::abs(host_sum)));
+            reduce_diff = std::max(reduce_diff, static_cast<double>(std::abs(reduction[f].min - host_min)));
+            reduce_diff = std::max(reduce_diff, static_cast<double>(std::abs(reduction[f].max - host_max)));
+        }
+        std::cout << "[OpenCL] self-test reduce_diff=" << reduce_diff << "\n";
+        if (reduce_diff > 1e-3) {
+            std::cerr << "[OpenCL] self-test reduction mismatch, fallback to CPU\n";
+            return false;
+        }
+
+        // Mycel/resource kernels against MycelNetwork::update and Environment::regenerate.
+        MycelNetwork test_mycel(pf.width, pf.height);
+        Environment test_env(pf.width, pf.height);
+        for (size_t i = 0; i < pf.data.size(); ++i) {
+            test_mycel.density.data[i] = rng.uniform(0.0f, 1.0f);
+            test_mycel.inhibitor.data[i] = rng.uniform(0.0f, 0.5f);
+            test_env.resources.data[i] = rng.uniform(0.0f, 1.0f);
+        }
+        test_env.apply_block_rect(2, 2, 3, 3);
+        MycelNetwork cpu_mycel = test_mycel;
+        Environment cpu_env = test_env;
+        if (!runtime.init_ecology(test_mycel, test_env, error)) {
+            std::cerr << "[OpenCL] self-test ecology unavailable: " << error << "\n";
+            ocl_ecology_ok = false;
+            return true;
+        }
+        for (int i = 0; i < 5; ++i) {
+            cpu_mycel.update(params, pf, cpu_env.resources);
+            cpu_env.regenerate(params);
+            if (!runtime.step_ecology(params, error)) {
+                std::cerr << "[OpenCL] self-test ecology step failed: " << error << "\n";
+                ocl_ecology_ok = false;
+                return true;
+            }
+        }
+        if (!runtime.copyback_ecology(test_mycel, test_env, error)) {
+            std::cerr << "[OpenCL] self-test ecology copyback failed: " << error << "\n";
+            ocl_ecology_ok = false;
+            return true;
+        }
+        double ecology_diff = 0.0;
+        for (size_t i = 0; i < pf.data.size(); ++i) {
+            ecology_diff = std::max(ecology_diff, static_cast<double>(std::abs(test_mycel.density.data[i] - cpu_mycel.density.data[i])));
+            ecology_diff = std::max(ecology_diff, static_cast<double>(std::abs(test_mycel.inhibitor.data[i] - cpu_mycel.inhibitor.data[i])));
+            ecology_diff = std::max(ecology_diff, static_cast<double>(std::abs(test_env.resources.data[i] - cpu_env.resources.data[i])));
+        }
+        std::cout << "[OpenCL] self-test ecology_diff=" << ecology_diff << "\n";
+        if (ecology_diff > 1e-4) {
+            std::cerr << "[OpenCL] self-test ecology mismatch, mycel/resources stay on CPU\n";
+            ocl_ecology_ok = false;
+        }
+        return true;
+    };
+
+    // Several steps without host upload, so the halo exchange carries the band edges.
+    auto run_band_self_test = [&](OpenCLBandRuntime &runtime) -> bool {
+        int w = 16;
+        int h = std::max(16, runtime.band_count() * 4);
+        GridField pf(w, h, 0.0f);
+        GridField pd(w, h, 0.0f);
+        GridField pg(w, h, 0.0f);
+        GridField m(w, h, 0.0f);
+        for (size_t i = 0; i < pf.data.size(); ++i) {
+            float v = rng.uniform(0.0f, 1.0f);
+            pf.data[i] = v;
+            pd.data[i] = 1.0f - v;
+            pg.data[i] = v * 0.5f;
+            m.data[i] = 1.0f - v;
+        }
+        GridField cpu_pf = pf;
+        GridField cpu_pd = pd;
+        GridField cpu_pg = pg;
+        GridField cpu_m = m;
+        FieldParams fp{0.02f, 0.15f};
+        FieldParams fm{0.35f, 0.25f};
+        std::string error;
+        if (!runtime.init_fields(pf, pd, pg, m, error)) {
+            std::cerr << "[OpenCL] band self-test init failed: " << error << "\n";
+            return false;
+        }
+        for (int i = 0; i < 5; ++i) {
+            diffuse_and_evaporate(cpu_pf, fp);
+            diffuse_and_evaporate(cpu_pd, fp);
+            diffuse_and_evaporate(cpu_pg, fp);
+            diffuse_and_evaporate(cpu_m, fm);
+            if (!runtime.step_diffuse(fp, fm, false, pf, pd, pg, m, error)) {
+                std::cerr << "[OpenCL] band self-test step failed: " << error << "\n";
+                return false;
+            }
+        }
+        if (!runtime.copyback(pf, pd, pg, m, error)) {
+            std::cerr << "[OpenCL] band self-test copyback failed: " << error << "\n";
+            return false;
+        }
+        double max_abs = 0.0;
+        const GridField *dev[4] = {&pf, &pd, &pg, &m};
+        const GridField *cpu[4] = {&cpu_pf, &cpu_pd, &cpu_pg, &cpu_m};
+        for (int f = 0; f < 4; ++f) {
+            for (size_t i = 0; i < dev[f]->data.size(); ++i) {
+                max_abs = std::max(max_abs, std::abs(static_cast<double>(dev[f]->data[i]) - cpu[f]->data[i]));
+            }
+        }
+        std::cout << "[OpenCL] band self-test bands=" << runtime.band_count() << " max_abs=" << max_abs << "\n";
+        if (max_abs > 1e-3) {
+            std::cerr << "[OpenCL] band self-test too large diff, fallback to CPU\n";
+            return false;
+        }
         return true;
     };
 
+    if (opts.ocl_self_test) {
+        if (ocl_multi) {
+            bool passed = ocl_bands_active && run_band_self_test(ocl_bands);
+            std::cout << "[OpenCL] self-test " << (passed ? "passed" : "failed") << "\n";
+            return passed ? 0 : 1;
+        }
+        bool passed = ocl_active && run_ocl_self_test(ocl_runtime) && ocl_ecology_ok;
+        std::cout << "[OpenCL] self-test " << (passed ? "passed" : "failed") << "\n";
+        return passed ? 0 : 1;
+    }
+
     if (ocl_active) {
         if (!run_ocl_self_test(ocl_runtime)) {
             ocl_active = false;
@@ -2818,6 +3353,15 @@ int main(int argc, char **argv) {
                 ocl_active = false;
             } else {
                 std::cout << "[OpenCL] using GPU diffusion\n";
+                if (opts.ocl_images) {
+                    std::cout << "[OpenCL] field reads: " << ocl_runtime.image_backend_status() << "\n";
+                }
+                LwsTuningDb tuning;
+                std::string tuning_error;
+                if (!opts.ocl_autotune && tuning.load(opts.ocl_tuning_file, tuning_error)) {
+                    ocl_runtime.set_lws_tuning(tuning);
+                    std::cout << "[OpenCL] LWS tuning loaded: " << opts.ocl_tuning_file << "\n";
+                }
                 if (opts.ocl_no_copyback) {
                     std::cout << "[OpenCL] no-copyback enabled\n";
                 }
@@ -2825,6 +3369,169 @@ int main(int argc, char **argv) {
         }
     }
 
+    if (opts.ocl_image_bench) {
+        if (ocl_multi || !ocl_active) {
+            std::cerr << "[OpenCL] image bench braucht ein aktives Einzel-Device\n";
+            return 1;
+        }
+        GridField seed(params.width, params.height, 0.0f);
+        for (int y = 0; y < seed.height; ++y) {
+            for (int x = 0; x < seed.width; ++x) {
+                seed.at(x, y) = 0.5f + 0.5f * std::sin(0.11f * static_cast<float>(x)) * std::cos(0.07f * static_cast<float>(y));
+            }
+        }
+        int bench_steps = std::max(1, params.steps);
+        // Returns ms per step; the final copyback is inside the timed region so queued work is included.
+        auto bench_path = [&](bool images, GridField out[4], double &ms_per_step, std::string &error) -> bool {
+            if (!ocl_runtime.enable_image_backend(images, error)) {
+                return false;
+            }
+            for (int f = 0; f < 4; ++f) {
+                out[f] = seed;
+            }
+            if (!ocl_runtime.init_fields(out[0], out[1], out[2], out[3], error)) {
+                return false;
+            }
+            if (images && ocl_runtime.image_backend_status().rfind("image2d", 0) != 0) {
+                error = ocl_runtime.image_backend_status();
+                return false;
+            }
+            for (int i = 0; i < 3; ++i) {
+                if (!ocl_runtime.step_diffuse(pheromone_params, molecule_params, false, out[0], out[1], out[2], out[3], error)) {
+                    return false;
+                }
+            }
+            if (!ocl_runtime.upload_fields(seed, seed, seed, seed, error)) {
+                return false;
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < bench_steps; ++i) {
+                if (!ocl_runtime.step_diffuse(pheromone_params, molecule_params, false, out[0], out[1], out[2], out[3], error)) {
+                    return false;
+                }
+            }
+            if (!ocl_runtime.copyback(out[0], out[1], out[2], out[3], error)) {
+                return false;
+            }
+            auto t1 = std::chrono::steady_clock::now();
+            ms_per_step = std::chrono::duration<double, std::milli>(t1 - t0).count() / bench_steps;
+            return true;
+        };
+        GridField buf_out[4];
+        GridField img_out[4];
+        double buf_ms = 0.0;
+        double img_ms = 0.0;
+        std::string bench_error;
+        if (!bench_path(false, buf_out, buf_ms, bench_error)) {
+            std::cerr << "[OpenCL] image bench (buffers) failed: " << bench_error << "\n";
+            return 1;
+        }
+        if (!bench_path(true, img_out, img_ms, bench_error)) {
+            std::cerr << "[OpenCL] image bench (image2d) failed: " << bench_error << "\n";
+            return 1;
+        }
+        float max_abs = 0.0f;
+        for (int f = 0; f < 4; ++f) {
+            for (size_t i = 0; i < buf_out[f].data.size(); ++i) {
+                max_abs = std::max(max_abs, std::fabs(buf_out[f].data[i] - img_out[f].data[i]));
+            }
+        }
+        std::cout << "[OpenCL] image bench " << params.width << "x" << params.height << " steps=" << bench_steps
+                  << " buffers=" << buf_ms << " ms/step image2d=" << img_ms << " ms/step ("
+                  << ocl_runtime.image_backend_status() << ") speedup=" << (img_ms > 0.0 ? buf_ms / img_ms : 0.0)
+                  << " max_abs=" << max_abs << "\n";
+        return 0;
+    }
+
+    if (opts.ocl_autotune) {
+        if (ocl_multi) {
+            std::cerr << "[OpenCL] autotune laeuft nur mit einem Device (ohne --ocl-devices/--ocl-fission)\n";
+            return 1;
+        }
+        if (!ocl_active) {
+            std::cerr << "[OpenCL] autotune failed: kein OpenCL-Device aktiv\n";
+            return 1;
+        }
+        LwsTuningDb tuning;
+        std::string tuning_error;
+        tuning.load(opts.ocl_tuning_file, tuning_error);
+        std::string report;
+        if (!ocl_runtime.autotune_lws(tuning, 5, report, tuning_error) ||
+            !tuning.save(opts.ocl_tuning_file, tuning_error)) {
+            std::cerr << "[OpenCL] autotune failed: " << tuning_error << "\n";
+            return 1;
+        }
+        std::cout << "[OpenCL] autotune " << ocl_runtime.device_key() << "\n" << report;
+        std::cout << "[OpenCL] tuning saved: " << opts.ocl_tuning_file << "\n";
+        return 0;
+    }
+
+    if (ocl_bands_active) {
+        std::string ocl_error;
+        if (!run_band_self_test(ocl_bands)) {
+            ocl_bands_active = false;
+        } else if (!ocl_bands.init_fields(phero_food, phero_danger, phero_gamma, molecules, ocl_error)) {
+            std::cerr << "[OpenCL] multi-device buffer init failed, fallback to CPU: " << ocl_error << "\n";
+            ocl_bands_active = false;
+        } else {
+            std::cout << "[OpenCL] using multi-device diffusion\n";
+            if (opts.ocl_no_copyback) {
+                std::cout << "[OpenCL] no-copyback: Baender bleiben auf den Devices, pro Schritt wird nur phero_food fuer das Mycel gelesen.\n";
+            }
+        }
+    }
+
+    // With no-copyback and without logic probes nothing on the host reads mycel/resources
+    // between dumps, so they stay resident on the device.
+    bool ocl_ecology = false;
+    if (ocl_active && opts.ocl_no_copyback && params.logic_mode == 0 && ocl_ecology_ok) {
+        std::string ocl_error;
+        if (!ocl_runtime.init_ecology(mycel, env, ocl_error)) {
+            std::cerr << "[OpenCL] ecology init failed, mycel/resources stay on CPU: " << ocl_error << "\n";
+        } else {
+            ocl_ecology = true;
+            std::cout << "[OpenCL] mycel/resources resident on device\n";
+        }
+    }
+    // Without resident ecology mycel.update reads phero_food on the host every step.
+    if (ocl_active && opts.ocl_no_copyback && !ocl_ecology) {
+        std::cerr << "[OpenCL] ocl-no-copyback braucht Mycel/Ressourcen auf dem Device, erzwungenes Copyback.\n";
+        opts.ocl_no_copyback = false;
+    }
+    // Set when the host copies of the diffusion fields are newer than the resident buffers.
+    bool ocl_fields_dirty = false;
+    auto drop_ecology = [&]() {
+        if (!ocl_ecology) return;
+        std::string ocl_error;
+        if (!ocl_runtime.copyback_ecology(mycel, env, ocl_error)) {
+            std::cerr << "[OpenCL] ecology copyback failed, host mycel/resources may be stale: " << ocl_error << "\n";
+        }
+        ocl_ecology = false;
+        if (ocl_active && opts.ocl_no_copyback) {
+            if (!ocl_fields_dirty && !ocl_runtime.copyback(phero_food, phero_danger, phero_gamma, molecules, ocl_error)) {
+                std::cerr << "[OpenCL] copyback failed, fallback to CPU: " << ocl_error << "\n";
+                ocl_active = false;
+            }
+            std::cerr << "[OpenCL] ocl-no-copyback ohne Mycel/Ressourcen auf dem Device, erzwungenes Copyback.\n";
+            opts.ocl_no_copyback = false;
+        }
+    };
+    // Brings the host copies of resident diffusion fields up to date; a failure drops the device path.
+    auto copyback_resident = [&]() -> bool {
+        std::string ocl_error;
+        bool ok = ocl_bands_active ? ocl_bands.copyback(phero_food, phero_danger, phero_gamma, molecules, ocl_error)
+                                   : ocl_runtime.copyback(phero_food, phero_danger, phero_gamma, molecules, ocl_error);
+        if (ok) return true;
+        std::cerr << "[OpenCL] copyback failed, fallback to CPU: " << ocl_error << "\n";
+        if (ocl_bands_active) {
+            ocl_bands_active = false;
+        } else {
+            ocl_active = false;
+            drop_ecology();
+        }
+        return false;
+    };
+
     if (opts.dump_every > 0) {
         std::error_code ec;
         std::filesystem::create_directories(opts.dump_dir, ec);
@@ -2865,6 +3572,7 @@ int main(int argc, char **argv) {
     std::vector<SystemMetrics> system_metrics;
     system_metrics.reserve(static_cast<size_t>(params.steps));
     bool last_physics_valid = true;
+    bool ocl_reduce_ok = true;
     auto field_sum = [](const GridField &field) -> double {
         double sum = 0.0;
         for (float v : field.data) {
@@ -2885,11 +3593,29 @@ int main(int argc, char **argv) {
         }
         return calculate_genetic_stagnation(merged);
     };
+    // Resident fields take the injection on the device; uploading the host copy would
+    // overwrite the diffused state with stale data.
+    auto add_field_rect = [&](GridField &field, int field_index, int x0, int y0, int x1, int y1, float value) {
+        if ((ocl_active || ocl_bands_active) && opts.ocl_no_copyback && !ocl_fields_dirty) {
+            std::string ocl_error;
+            bool added = ocl_bands_active ? ocl_bands.add_field_rect(field_index, x0, y0, x1, y1, value, ocl_error)
+                                          : ocl_runtime.add_field_rect(field_index, x0, y0, x1, y1, value, ocl_error);
+            if (added) {
+                return;
+            }
+            std::cerr << "[OpenCL] field inject failed, using host copy: " << ocl_error << "\n";
+            copyback_resident();
+            ocl_fields_dirty = true;
+        }
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                field.at(x, y) += value;
+            }
+        }
+    };
     auto inject_gamma = [&](float base, const float quad_ns[4]) {
         if (base > 0.0f) {
-            for (float &v : phero_gamma.data) {
-                v += base;
-            }
+            add_field_rect(phero_gamma, 2, 0, 0, params.width, params.height, base);
         }
         int mid_x = params.width / 2;
         int mid_y = params.height / 2;
@@ -2911,11 +3637,7 @@ int main(int argc, char **argv) {
             if (v <= 0.0f) {
                 continue;
             }
-            for (int y = quads[q].y0; y < quads[q].y1; ++y) {
-                for (int x = quads[q].x0; x < quads[q].x1; ++x) {
-                    phero_gamma.at(x, y) += v;
-                }
-            }
+            add_field_rect(phero_gamma, 2, quads[q].x0, quads[q].y0, quads[q].x1, quads[q].y1, v);
         }
     };
     int logic_case = 0;
@@ -2951,27 +3673,43 @@ int main(int argc, char **argv) {
             int a = (logic_active_case >> 0) & 1;
             int b = (logic_active_case >> 1) & 1;
             if (a) {
-                phero_food.at(params.logic_input_ax, params.logic_input_ay) += params.logic_pulse_strength;
+                add_field_rect(phero_food, 0, params.logic_input_ax, params.logic_input_ay,
+                               params.logic_input_ax + 1, params.logic_input_ay + 1, params.logic_pulse_strength);
             }
             if (b) {
-                phero_food.at(params.logic_input_bx, params.logic_input_by) += params.logic_pulse_strength;
+                add_field_rect(phero_food, 0, params.logic_input_bx, params.logic_input_by,
+                               params.logic_input_bx + 1, params.logic_input_by + 1, params.logic_pulse_strength);
             }
             logic_case = (logic_case + 1) & 3;
         }
-        if (ocl_active && opts.ocl_no_copyback && dump_step) {
+        if ((ocl_active || ocl_bands_active) && opts.ocl_no_copyback && !ocl_fields_dirty && dump_step) {
             std::string ocl_error;
-            if (!ocl_runtime.copyback(phero_food, phero_danger, phero_gamma, molecules, ocl_error)) {
-                std::cerr << "[OpenCL] copyback failed, fallback to CPU: " << ocl_error << "\n";
-                ocl_active = false;
+            if (copyback_resident() && ocl_ecology && !ocl_runtime.copyback_ecology(mycel, env, ocl_error)) {
+                std::cerr << "[OpenCL] ecology copyback failed, fallback to CPU: " << ocl_error << "\n";
+                ocl_ecology = false;
             }
         }
         if (opts.stress_enable && !stress_applied && step >= opts.stress_at_step) {
+            if (ocl_ecology && !dump_step) {
+                std::string ocl_error;
+                if (!ocl_runtime.copyback_ecology(mycel, env, ocl_error)) {
+                    std::cerr << "[OpenCL] ecology copyback failed, fallback to CPU: " << ocl_error << "\n";
+                    ocl_ecology = false;
+                }
+            }
             if (opts.stress_block_rect_set) {
                 env.apply_block_rect(opts.stress_block_x, opts.stress_block_y, opts.stress_block_w, opts.stress_block_h);
             }
             if (opts.stress_shift_set) {
                 env.shift_hotspots(opts.stress_shift_dx, opts.stress_shift_dy);
             }
+            if (ocl_ecology) {
+                std::string ocl_error;
+                if (!ocl_runtime.upload_ecology(mycel, env, ocl_error)) {
+                    std::cerr << "[OpenCL] ecology upload failed, fallback to CPU: " << ocl_error << "\n";
+                    ocl_ecology = false;
+                }
+            }
             stress_applied = true;
             std::cout << "[stress] applied at step=" << step << "\n";
         }
@@ -3167,16 +3905,101 @@ int main(int argc, char **argv) {
             }
         }
         bool cpu_diffused = false;
+        bool band_diffused = false;
+        auto valid_sum = [](double pre, double post, float evap) -> bool {
+            if (!std::isfinite(pre) || !std::isfinite(post)) return false;
+            double expected = pre * (1.0 - static_cast<double>(evap));
+            if (expected < 1e-6) {
+                return post >= -1e-3;
+            }
+            double min_allowed = expected * 0.5;
+            double max_allowed = pre * 1.1;
+            return post >= min_allowed && post <= max_allowed;
+        };
+        if (ocl_bands_active) {
+            bool do_copyback = (!opts.ocl_no_copyback) || dump_step;
+            double pre_food_sum = 0.0;
+            double pre_danger_sum = 0.0;
+            double pre_mol_sum = 0.0;
+            if (do_copyback) {
+                pre_food_sum = field_sum(phero_food);
+                pre_danger_sum = field_sum(phero_danger);
+                pre_mol_sum = field_sum(molecules);
+            }
+            std::string ocl_error;
+            bool band_ok = true;
+            if (!opts.ocl_no_copyback || ocl_fields_dirty) {
+                band_ok = ocl_bands.upload_fields(phero_food, phero_danger, phero_gamma, molecules, ocl_error);
+                ocl_fields_dirty = !band_ok;
+            }
+            FieldReduction pre_reduction[4];
+            bool device_check = false;
+            if (band_ok && !do_copyback && ocl_reduce_ok) {
+                device_check = ocl_bands.reduce_fields(pre_reduction, ocl_error);
+                if (!device_check) {
+                    std::cerr << "[OpenCL] reduction failed, physics check disabled: " << ocl_error << "\n";
+                    ocl_reduce_ok = false;
+                }
+            }
+            band_ok = band_ok &&
+                      ocl_bands.step_diffuse(pheromone_params, molecule_params, do_copyback, phero_food, phero_danger, phero_gamma, molecules, ocl_error);
+            // mycel.update reads phero_food on the host; the other fields stay on the devices.
+            if (band_ok && !do_copyback) {
+                band_ok = ocl_bands.copyback_field(0, phero_food, ocl_error);
+            }
+            if (!band_ok) {
+                std::cerr << "[OpenCL] multi-device diffuse failed, fallback to CPU: " << ocl_error << "\n";
+                ocl_bands_active = false;
+            } else {
+                band_diffused = true;
+                if (do_copyback) {
+                    bool ok_food = valid_sum(pre_food_sum, field_sum(phero_food), pheromone_params.evaporation);
+                    bool ok_danger = valid_sum(pre_danger_sum, field_sum(phero_danger), pheromone_params.evaporation);
+                    bool ok_mol = valid_sum(pre_mol_sum, field_sum(molecules), molecule_params.evaporation);
+                    last_physics_valid = ok_food && ok_danger && ok_mol;
+                } else if (device_check) {
+                    FieldReduction post_reduction[4];
+                    if (!ocl_bands.reduce_fields(post_reduction, ocl_error)) {
+                        std::cerr << "[OpenCL] reduction failed, physics check disabled: " << ocl_error << "\n";
+                        ocl_reduce_ok = false;
+                    } else {
+                        bool ok_food = valid_sum(pre_reduction[0].sum, post_reduction[0].sum, pheromone_params.evaporation);
+                        bool ok_danger = valid_sum(pre_reduction[1].sum, post_reduction[1].sum, pheromone_params.evaporation);
+                        bool ok_mol = valid_sum(pre_reduction[3].sum, post_reduction[3].sum, molecule_params.evaporation);
+                        last_physics_valid = ok_food && ok_danger && ok_mol;
+                    }
+                }
+            }
+        }
         if (ocl_active) {
-            double pre_food_sum = field_sum(phero_food);
-            double pre_danger_sum = field_sum(phero_danger);
-            double pre_mol_sum = field_sum(molecules);
+            bool do_copyback = (!opts.ocl_no_copyback) || dump_step;
+            double pre_food_sum = 0.0;
+            double pre_danger_sum = 0.0;
+            double pre_mol_sum = 0.0;
+            if (do_copyback) {
+                pre_food_sum = field_sum(phero_food);
+                pre_danger_sum = field_sum(phero_danger);
+                pre_mol_sum = field_sum(molecules);
+            }
             std::string ocl_error;
-            if (!ocl_runtime.upload_fields(phero_food, phero_danger, phero_gamma, molecules, ocl_error)) {
+            bool upload_ok = true;
+            if (!opts.ocl_no_copyback || ocl_fields_dirty) {
+                upload_ok = ocl_runtime.upload_fields(phero_food, phero_danger, phero_gamma, molecules, ocl_error);
+                ocl_fields_dirty = !upload_ok;
+            }
+            if (!upload_ok) {
                 std::cerr << "[OpenCL] upload failed, fallback to CPU: " << ocl_error << "\n";
                 ocl_active = false;
             } else {
-                bool do_copyback = (!opts.ocl_no_copyback) || dump_step;
+                FieldReduction pre_reduction[4];
+                bool device_check = false;
+                if (!do_copyback && ocl_reduce_ok) {
+                    device_check = ocl_runtime.reduce_fields(pre_reduction, ocl_error);
+                    if (!device_check) {
+                        std::cerr << "[OpenCL] reduction failed, physics check disabled: " << ocl_error << "\n";
+                        ocl_reduce_ok = false;
+                    }
+                }
                 if (!ocl_runtime.step_diffuse(pheromone_params, molecule_params, do_copyback, phero_food, phero_danger, phero_gamma, molecules, ocl_error)) {
                     std::cerr << "[OpenCL] diffuse failed, fallback to CPU: " << ocl_error << "\n";
                     ocl_active = false;
@@ -3186,16 +4009,6 @@ int main(int argc, char **argv) {
                     diffuse_and_evaporate(molecules, molecule_params);
                     cpu_diffused = true;
                 } else if (do_copyback) {
-                    auto valid_sum = [](double pre, double post, float evap) -> bool {
-                        if (!std::isfinite(pre) || !std::isfinite(post)) return false;
-                        double expected = pre * (1.0 - static_cast<double>(evap));
-                        if (expected < 1e-6) {
-                            return post >= -1e-3;
-                        }
-                        double min_allowed = expected * 0.5;
-                        double max_allowed = pre * 1.1;
-                        return post >= min_allowed && post <= max_allowed;
-                    };
                     double post_food_sum = field_sum(phero_food);
                     double post_danger_sum = field_sum(phero_danger);
                     double post_mol_sum = field_sum(molecules);
@@ -3203,10 +4016,21 @@ int main(int argc, char **argv) {
                     bool ok_danger = valid_sum(pre_danger_sum, post_danger_sum, pheromone_params.evaporation);
                     bool ok_mol = valid_sum(pre_mol_sum, post_mol_sum, molecule_params.evaporation);
                     last_physics_valid = ok_food && ok_danger && ok_mol;
+                } else if (device_check) {
+                    FieldReduction post_reduction[4];
+                    if (!ocl_runtime.reduce_fields(post_reduction, ocl_error)) {
+                        std::cerr << "[OpenCL] reduction failed, physics check disabled: " << ocl_error << "\n";
+                        ocl_reduce_ok = false;
+                    } else {
+                        bool ok_food = valid_sum(pre_reduction[0].sum, post_reduction[0].sum, pheromone_params.evaporation);
+                        bool ok_danger = valid_sum(pre_reduction[1].sum, post_reduction[1].sum, pheromone_params.evaporation);
+                        bool ok_mol = valid_sum(pre_reduction[3].sum, post_reduction[3].sum, molecule_params.evaporation);
+                        last_physics_valid = ok_food && ok_danger && ok_mol;
+                    }
                 }
             }
         }
-        if (!ocl_active && !cpu_diffused) {
+        if (!ocl_active && !cpu_diffused && !band_diffused) {
             diffuse_and_evaporate(phero_food, pheromone_params);
             diffuse_and_evaporate(phero_danger, pheromone_params);
             diffuse_and_evaporate(phero_gamma, pheromone_params);
@@ -3215,6 +4039,10 @@ int main(int argc, char **argv) {
         }
 
         if (opts.stress_enable && stress_applied && opts.stress_pheromone_noise > 0.0f) {
+            // The noise comes from the host RNG, so resident fields take a round trip.
+            if ((ocl_active || ocl_bands_active) && opts.ocl_no_copyback && !ocl_fields_dirty && copyback_resident()) {
+                ocl_fields_dirty = true;
+            }
             for (float &v : phero_food.data) {
                 v += stress_rng.uniform(0.0f, opts.stress_pheromone_noise);
                 if (v < 0.0f) v = 0.0f;
@@ -3225,14 +4053,30 @@ int main(int argc, char **argv) {
             }
         }
 
-        mycel.update(params, phero_food, env.resources);
+        bool ecology_stepped = false;
+        if (ocl_ecology && !ocl_active) {
+            drop_ecology();
+        } else if (ocl_ecology) {
+            std::string ocl_error;
+            if (ocl_runtime.step_ecology(params, ocl_error)) {
+                ecology_stepped = true;
+            } else {
+                std::cerr << "[OpenCL] ecology step failed, fallback to CPU: " << ocl_error << "\n";
+                drop_ecology();
+            }
+        }
+        if (!ecology_stepped) {
+            mycel.update(params, phero_food, env.resources);
+        }
         if (params.logic_mode != 0) {
             float measured = sample_output(mycel.density);
             int target = logic_target_for_case(params.logic_mode, logic_active_case);
             float score = 1.0f - std::abs(static_cast<float>(target) - clamp01(measured));
             logic_last_score = clamp01(score);
         }
-        env.regenerate(params);
+        if (!ecology_stepped) {
+            env.regenerate(params);
+        }
         for (auto &pool : dna_species) {
             pool.decay(evo);
         }
@@ -3295,8 +4139,18 @@ int main(int argc, char **argv) {
 
         if (step % 10 == 0) {
             float mycel_sum = 0.0f;
-            for (float v : mycel.density.data) {
-                mycel_sum += v;
+            FieldReduction mycel_reduction;
+            std::string ocl_error;
+            if (ocl_ecology && ocl_runtime.reduce_field(4, mycel_reduction, ocl_error)) {
+                mycel_sum = static_cast<float>(mycel_reduction.sum);
+            } else {
+                if (ocl_ecology) {
+                    std::cerr << "[OpenCL] mycel reduction failed, fallback to CPU: " << ocl_error << "\n";
+                    drop_ecology();
+                }
+                for (float v : mycel.density.data) {
+                    mycel_sum += v;
+                }
             }
             float mycel_avg = mycel_sum / static_cast<float>(mycel.density.data.size());
 
@@ -3308,13 +4162,22 @@ int main(int argc, char **argv) {
         }
     }
 
-    if (ocl_active && opts.ocl_no_copyback) {
+    if ((ocl_active || ocl_bands_active) && opts.ocl_no_copyback && !ocl_fields_dirty) {
         std::string ocl_error;
-        if (!ocl_runtime.copyback(phero_food, phero_danger, phero_gamma, molecules, ocl_error)) {
+        bool copied = ocl_bands_active ? ocl_bands.copyback(phero_food, phero_danger, phero_gamma, molecules, ocl_error)
+                                       : ocl_runtime.copyback(phero_food, phero_danger, phero_gamma, molecules, ocl_error);
+        if (!copied) {
             std::cerr << "[OpenCL] final copyback failed: " << ocl_error << "\n";
             return 1;
         }
     }
+    if (ocl_ecology) {
+        std::string ocl_error;
+        if (!ocl_runtime.copyback_ecology(mycel, env, ocl_error)) {
+            std::cerr << "[OpenCL] final ecology copyback failed: " << ocl_error << "\n";
+            return 1;
+        }
+    }
 
     if (opts.dump_every > 0) {
         ReportOptions report_opts;
@@ -3,11 +3,13 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <cstring>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "compute/opencl_runtime.h"
@@ -50,9 +52,14 @@ struct MicroSwarmContext {
     OpenCLRuntime ocl;
     bool ocl_active = false;
     bool ocl_no_copyback = false;
+    // Host copies of the diffusion fields are newer than the device buffers.
+    bool ocl_fields_dirty = false;
     int ocl_platform = 0;
     int ocl_device = 0;
     bool last_physics_valid = true;
+    bool ocl_reduce_ok = true;
+    bool ocl_ecology = false;
+    bool ocl_ecology_ok = true;
     int logic_case = 0;
     int logic_active_case = 0;
     float logic_last_score = 0.5f;
@@ -69,12 +76,21 @@ struct MicroSwarmContext {
           mycel(0, 0) {}
 };
 
+struct MicroSwarmDbCursor {
+    DbSqlCursor cursor;
+    DbSqlResult batch;
+};
+
 struct MicroSwarmDbContext {
     DbWorld world;
     std::vector<int> last_results;
     std::string last_error;
     DbSqlResult last_sql_result;
     bool last_sql_valid = false;
+    std::unordered_map<int, DbPreparedSql> prepared;
+    int next_prepared_id = 1;
+    std::unordered_map<int, MicroSwarmDbCursor> cursors;
+    int next_cursor_id = 1;
     std::vector<std::string> delta_entries;
     std::vector<std::string> tombstone_entries;
     bool delta_cache_valid = false;
@@ -308,6 +324,17 @@ struct FieldStatsLocal {
     float norm_entropy = 0.0f;
 };
 
+void apply_histogram_entropy(const std::vector<int> &hist, double total, int bins, FieldStatsLocal &stats) {
+    double ent = 0.0;
+    for (int c : hist) {
+        if (c <= 0) continue;
+        double p = static_cast<double>(c) / total;
+        ent -= p * std::log(p);
+    }
+    stats.entropy = static_cast<float>(ent);
+    stats.norm_entropy = static_cast<float>(ent / std::log(static_cast<double>(bins)));
+}
+
 FieldStatsLocal compute_entropy_stats(const std::vector<float> &values, int bins) {
     FieldStatsLocal stats;
     if (values.empty()) {
@@ -339,18 +366,47 @@ FieldStatsLocal compute_entropy_stats(const std::vector<float> &values, int bins
         if (bin >= bins) bin = bins - 1;
         hist[static_cast<size_t>(bin)]++;
     }
-    double ent = 0.0;
-    double denom = static_cast<double>(values.size());
-    for (int c : hist) {
-        if (c <= 0) continue;
-        double p = static_cast<double>(c) / denom;
-        ent -= p * std::log(p);
-    }
-    stats.entropy = static_cast<float>(ent);
-    stats.norm_entropy = static_cast<float>(ent / std::log(static_cast<double>(bins)));
+    apply_histogram_entropy(hist, static_cast<double>(values.size()), bins, stats);
     return stats;
 }
 
+// Device-side variant: min/max/sum and the histogram come from reduction kernels,
+// p95 is interpolated inside the histogram bin instead of an exact nth_element.
+bool compute_entropy_stats_device(MicroSwarmContext *ctx, int field_index, const FieldReduction &r, int bins, FieldStatsLocal &stats) {
+    std::string error;
+    double count = static_cast<double>(ctx->params.width) * static_cast<double>(ctx->params.height);
+    if (count <= 0.0) {
+        return false;
+    }
+    stats = FieldStatsLocal{};
+    stats.min = r.min;
+    stats.max = r.max;
+    stats.mean = static_cast<float>(r.sum / count);
+    stats.p95 = r.max;
+    if (bins <= 1 || r.max <= r.min) {
+        stats.p95 = r.min;
+        return true;
+    }
+    std::vector<int> hist;
+    if (!ctx->ocl.histogram_field(field_index, r.min, r.max, bins, hist, error)) {
+        return false;
+    }
+    double target = 0.95 * (count - 1.0);
+    double cumulative = 0.0;
+    double bin_width = static_cast<double>(r.max - r.min) / static_cast<double>(bins);
+    for (int b = 0; b < bins; ++b) {
+        double c = static_cast<double>(hist[static_cast<size_t>(b)]);
+        if (c > 0.0 && cumulative + c > target) {
+            double frac = (target - cumulative) / c;
+            stats.p95 = static_cast<float>(r.min + (static_cast<double>(b) + frac) * bin_width);
+            break;
+        }
+        cumulative += c;
+    }
+    apply_histogram_entropy(hist, count, bins, stats);
+    return true;
+}
+
 GridField *select_field(MicroSwarmContext *ctx, ms_field_kind kind) {
     switch (kind) {
         case MS_FIELD_RESOURCES: return &ctx->env.resources;
@@ -483,6 +539,9 @@ void init_fields(MicroSwarmContext *ctx) {
     ctx->phero_gamma = GridField(ctx->params.width, ctx->params.height, 0.0f);
     ctx->molecules = GridField(ctx->params.width, ctx->params.height, 0.0f);
     ctx->mycel = MycelNetwork(ctx->params.width, ctx->params.height);
+    // Device copies are stale now; step_once uploads the fresh fields again.
+    ctx->ocl_ecology = false;
+    ctx->ocl_fields_dirty = true;
     if (ctx->params.logic_input_ax < 0 || ctx->params.logic_input_ay < 0 ||
         ctx->params.logic_input_bx < 0 || ctx->params.logic_input_by < 0) {
         ctx->params.logic_input_ax = ctx->params.width / 4;
@@ -501,14 +560,39 @@ void init_fields(MicroSwarmContext *ctx) {
 }
 
 bool ensure_host_fields(MicroSwarmContext *ctx) {
-    if (ctx->ocl_active && ctx->ocl_no_copyback) {
+    if (ctx->ocl_active && ctx->ocl_no_copyback && !ctx->ocl_fields_dirty) {
         std::string error;
         if (!ctx->ocl.copyback(ctx->phero_food, ctx->phero_danger, ctx->phero_gamma, ctx->molecules, error)) {
             return false;
         }
     }
+    if (ctx->ocl_ecology) {
+        std::string error;
+        if (!ctx->ocl.copyback_ecology(ctx->mycel, ctx->env, error)) {
+            return false;
+        }
+    }
     return true;
 }
+
+// Pushes host field edits to the device; a failed upload is retried by step_once.
+void upload_host_fields(MicroSwarmContext *ctx) {
+    if (!ctx->ocl_active) return;
+    std::string error;
+    ctx->ocl_fields_dirty = !ctx->ocl.upload_fields(ctx->phero_food, ctx->phero_danger, ctx->phero_gamma, ctx->molecules, error);
+}
+
+// Moves mycel/resources back to the host and stops stepping them on the device.
+void drop_ecology(MicroSwarmContext *ctx) {
+    if (!ctx->ocl_ecology) return;
+    std::string error;
+    ctx->ocl.copyback_ecology(ctx->mycel, ctx->env, error);
+    ctx->ocl_ecology = false;
+}
+
+bool is_ecology_field(ms_field_kind kind) {
+    return kind == MS_FIELD_RESOURCES || kind == MS_FIELD_MYCEL;
+}
 void step_once(MicroSwarmContext *ctx) {
     if (ctx->paused) {
         return;
@@ -535,11 +619,28 @@ void step_once(MicroSwarmContext *ctx) {
         }
         return calculate_genetic_stagnation(merged);
     };
+    // Resident fields take the injection on the device; uploading the host copy would
+    // overwrite the diffused state with stale data.
+    auto add_field_rect = [&](GridField &field, int field_index, int x0, int y0, int x1, int y1, float value) {
+        if (ctx->ocl_active && ctx->ocl_no_copyback && !ctx->ocl_fields_dirty) {
+            std::string error;
+            if (ctx->ocl.add_field_rect(field_index, x0, y0, x1, y1, value, error)) {
+                return;
+            }
+            if (!ensure_host_fields(ctx)) {
+                ctx->ocl_active = false;
+            }
+            ctx->ocl_fields_dirty = true;
+        }
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                field.at(x, y) += value;
+            }
+        }
+    };
     auto inject_gamma = [&](float base, const float quad_ns[4]) {
         if (base > 0.0f) {
-            for (float &v : ctx->phero_gamma.data) {
-                v += base;
-            }
+            add_field_rect(ctx->phero_gamma, 2, 0, 0, ctx->params.width, ctx->params.height, base);
         }
         int mid_x = ctx->params.width / 2;
         int mid_y = ctx->params.height / 2;
@@ -561,11 +662,7 @@ void step_once(MicroSwarmContext *ctx) {
             if (v <= 0.0f) {
                 continue;
             }
-            for (int y = quads[q].y0; y < quads[q].y1; ++y) {
-                for (int x = quads[q].x0; x < quads[q].x1; ++x) {
-                    ctx->phero_gamma.at(x, y) += v;
-                }
-            }
+            add_field_rect(ctx->phero_gamma, 2, quads[q].x0, quads[q].y0, quads[q].x1, quads[q].y1, v);
         }
     };
     const int codon_max = 7;
@@ -688,10 +785,12 @@ void step_once(MicroSwarmContext *ctx) {
         int a = (ctx->logic_active_case >> 0) & 1;
         int b = (ctx->logic_active_case >> 1) & 1;
         if (a) {
-            ctx->phero_food.at(ctx->params.logic_input_ax, ctx->params.logic_input_ay) += ctx->params.logic_pulse_strength;
+            add_field_rect(ctx->phero_food, 0, ctx->params.logic_input_ax, ctx->params.logic_input_ay,
+                           ctx->params.logic_input_ax + 1, ctx->params.logic_input_ay + 1, ctx->params.logic_pulse_strength);
         }
         if (b) {
-            ctx->phero_food.at(ctx->params.logic_input_bx, ctx->params.logic_input_by) += ctx->params.logic_pulse_strength;
+            add_field_rect(ctx->phero_food, 0, ctx->params.logic_input_bx, ctx->params.logic_input_by,
+                           ctx->params.logic_input_bx + 1, ctx->params.logic_input_by + 1, ctx->params.logic_pulse_strength);
         }
         ctx->logic_case = (ctx->logic_case + 1) & 3;
     }
@@ -849,15 +948,40 @@ void step_once(MicroSwarmContext *ctx) {
 
     bool cpu_diffused = false;
     if (ctx->ocl_active) {
-        double pre_food_sum = field_sum(ctx->phero_food);
-        double pre_danger_sum = field_sum(ctx->phero_danger);
-        double pre_mol_sum = field_sum(ctx->molecules);
+        auto valid_sum = [](double pre, double post, float evap) -> bool {
+            if (!std::isfinite(pre) || !std::isfinite(post)) return false;
+            double expected = pre * (1.0 - static_cast<double>(evap));
+            if (expected < 1e-6) {
+                return post >= -1e-3;
+            }
+            double min_allowed = expected * 0.5;
+            double max_allowed = pre * 1.1;
+            return post >= min_allowed && post <= max_allowed;
+        };
+        bool do_copyback = !ctx->ocl_no_copyback;
+        double pre_food_sum = 0.0;
+        double pre_danger_sum = 0.0;
+        double pre_mol_sum = 0.0;
+        if (do_copyback) {
+            pre_food_sum = field_sum(ctx->phero_food);
+            pre_danger_sum = field_sum(ctx->phero_danger);
+            pre_mol_sum = field_sum(ctx->molecules);
+        }
         std::string error;
-        if (!ctx->ocl.upload_fields(ctx->phero_food, ctx->phero_danger, ctx->phero_gamma, ctx->molecules, error)) {
-            ctx->ocl_active = false;
+        if (!ctx->ocl_no_copyback || ctx->ocl_fields_dirty) {
+            if (ctx->ocl.upload_fields(ctx->phero_food, ctx->phero_danger, ctx->phero_gamma, ctx->molecules, error)) {
+                ctx->ocl_fields_dirty = false;
+            } else {
+                ctx->ocl_active = false;
+            }
         }
         if (ctx->ocl_active) {
-            bool do_copyback = !ctx->ocl_no_copyback;
+            FieldReduction pre_reduction[4];
+            bool device_check = false;
+            if (!do_copyback && ctx->ocl_reduce_ok) {
+                device_check = ctx->ocl.reduce_fields(pre_reduction, error);
+                ctx->ocl_reduce_ok = device_check;
+            }
             if (!ctx->ocl.step_diffuse(pheromone_params, molecule_params, do_copyback, ctx->phero_food, ctx->phero_danger, ctx->phero_gamma, ctx->molecules, error)) {
                 ctx->ocl_active = false;
                 diffuse_and_evaporate(ctx->phero_food, pheromone_params);
@@ -865,17 +989,17 @@ void step_once(MicroSwarmContext *ctx) {
                 diffuse_and_evaporate(ctx->phero_gamma, pheromone_params);
                 diffuse_and_evaporate(ctx->molecules, molecule_params);
                 cpu_diffused = true;
+            } else if (device_check) {
+                FieldReduction post_reduction[4];
+                if (!ctx->ocl.reduce_fields(post_reduction, error)) {
+                    ctx->ocl_reduce_ok = false;
+                } else {
+                    bool ok_food = valid_sum(pre_reduction[0].sum, post_reduction[0].sum, pheromone_params.evaporation);
+                    bool ok_danger = valid_sum(pre_reduction[1].sum, post_reduction[1].sum, pheromone_params.evaporation);
+                    bool ok_mol = valid_sum(pre_reduction[3].sum, post_reduction[3].sum, molecule_params.evaporation);
+                    ctx->last_physics_valid = ok_food && ok_danger && ok_mol;
+                }
             } else if (do_copyback) {
-                auto valid_sum = [](double pre, double post, float evap) -> bool {
-                    if (!std::isfinite(pre) || !std::isfinite(post)) return false;
-                    double expected = pre * (1.0 - static_cast<double>(evap));
-                    if (expected < 1e-6) {
-                        return post >= -1e-3;
-                    }
-                    double min_allowed = expected * 0.5;
-                    double max_allowed = pre * 1.1;
-                    return post >= min_allowed && post <= max_allowed;
-                };
                 double post_food_sum = field_sum(ctx->phero_food);
                 double post_danger_sum = field_sum(ctx->phero_danger);
                 double post_mol_sum = field_sum(ctx->molecules);
@@ -894,14 +1018,39 @@ void step_once(MicroSwarmContext *ctx) {
         ctx->last_physics_valid = true;
     }
 
-    ctx->mycel.update(ctx->params, ctx->phero_food, ctx->env.resources);
+    bool ecology_stepped = false;
+    if (ctx->ocl_active && ctx->ocl_no_copyback && ctx->params.logic_mode == 0 && ctx->ocl_ecology_ok) {
+        std::string error;
+        if (!ctx->ocl_ecology) {
+            ctx->ocl_ecology = ctx->ocl.init_ecology(ctx->mycel, ctx->env, error);
+            ctx->ocl_ecology_ok = ctx->ocl_ecology;
+        }
+        if (ctx->ocl_ecology) {
+            ecology_stepped = ctx->ocl.step_ecology(ctx->params, error);
+            if (!ecology_stepped) {
+                drop_ecology(ctx);
+                ctx->ocl_ecology_ok = false;
+            }
+        }
+    } else {
+        drop_ecology(ctx);
+    }
+    if (!ecology_stepped) {
+        // mycel.update reads phero_food on the host.
+        if (!ensure_host_fields(ctx)) {
+            ctx->ocl_active = false;
+        }
+        ctx->mycel.update(ctx->params, ctx->phero_food, ctx->env.resources);
+    }
     if (ctx->params.logic_mode != 0) {
         float measured = sample_output(ctx->mycel.density);
         int target = logic_target_for_case(ctx->params.logic_mode, ctx->logic_active_case);
         float score = 1.0f - std::abs(static_cast<float>(target) - clamp01(measured));
         ctx->logic_last_score = clamp01(score);
     }
-    ctx->env.regenerate(ctx->params);
+    if (!ecology_stepped) {
+        ctx->env.regenerate(ctx->params);
+    }
     for (auto &pool : ctx->dna_species) {
         pool.decay(ctx->evo);
     }
@@ -1263,11 +1412,10 @@ int ms_copy_field_in(ms_handle_t *h, ms_field_kind kind, const float *src, int s
     if (!field) return 0;
     int count = field->width * field->height;
     if (src_count < count) return 0;
+    if (is_ecology_field(kind)) drop_ecology(ctx);
+    if (!ensure_host_fields(ctx)) return 0;
     std::copy(src, src + count, field->data.begin());
-    if (ctx->ocl_active) {
-        std::string error;
-        ctx->ocl.upload_fields(ctx->phero_food, ctx->phero_danger, ctx->phero_gamma, ctx->molecules, error);
-    }
+    upload_host_fields(ctx);
     return count;
 }
 
@@ -1276,11 +1424,10 @@ void ms_clear_field(ms_handle_t *h, ms_field_kind kind, float value) {
     auto *ctx = reinterpret_cast<MicroSwarmContext *>(h);
     GridField *field = select_field(ctx, kind);
     if (!field) return;
+    if (is_ecology_field(kind)) drop_ecology(ctx);
+    if (!ensure_host_fields(ctx)) return;
     field->fill(value);
-    if (ctx->ocl_active) {
-        std::string error;
-        ctx->ocl.upload_fields(ctx->phero_food, ctx->phero_danger, ctx->phero_gamma, ctx->molecules, error);
-    }
+    upload_host_fields(ctx);
 }
 
 int ms_load_field_csv(ms_handle_t *h, ms_field_kind kind, const char *path) {
@@ -1296,10 +1443,10 @@ int ms_load_field_csv(ms_handle_t *h, ms_field_kind kind, const char *path) {
     if (data.width != field->width || data.height != field->height) {
         return 0;
     }
+    if (is_ecology_field(kind)) drop_ecology(ctx);
+    if (!ensure_host_fields(ctx)) return 0;
     field->data = data.values;
-    if (ctx->ocl_active) {
-        ctx->ocl.upload_fields(ctx->phero_food, ctx->phero_danger, ctx->phero_gamma, ctx->molecules, error);
-    }
+    upload_host_fields(ctx);
     return 1;
 }
 
@@ -1603,7 +1750,6 @@ void ms_get_energy_by_species(ms_handle_t *h, float out[4]) {
 void ms_get_entropy_metrics(ms_handle_t *h, ms_entropy_t *out) {
     if (!h || !out) return;
     auto *ctx = reinterpret_cast<MicroSwarmContext *>(h);
-    if (!ensure_host_fields(ctx)) return;
     const int bins = 64;
     std::array<GridField *, 5> fields = {
         &ctx->env.resources,
@@ -1612,8 +1758,41 @@ void ms_get_entropy_metrics(ms_handle_t *h, ms_entropy_t *out) {
         &ctx->molecules,
         &ctx->mycel.density
     };
+    // Device field index per entry, -1 for host-only fields.
+    int device_index[5] = {-1, 0, 1, 3, -1};
+    if (ctx->ocl_ecology) {
+        device_index[0] = 6;
+        device_index[4] = 4;
+    }
+    FieldReduction reduction[7];
+    bool use_device = ctx->ocl_active && ctx->ocl_no_copyback && !ctx->ocl_fields_dirty && ctx->ocl_reduce_ok;
+    if (use_device) {
+        std::string error;
+        use_device = ctx->ocl.reduce_fields(reduction, error);
+        if (use_device && ctx->ocl_ecology) {
+            use_device = ctx->ocl.reduce_field(4, reduction[4], error) &&
+                         ctx->ocl.reduce_field(6, reduction[6], error);
+        }
+        ctx->ocl_reduce_ok = use_device;
+    }
+    bool host_synced = false;
     for (int i = 0; i < 5; ++i) {
-        FieldStatsLocal stats = compute_entropy_stats(fields[i]->data, bins);
+        FieldStatsLocal stats;
+        bool done = false;
+        if (use_device && device_index[i] >= 0) {
+            done = compute_entropy_stats_device(ctx, device_index[i], reduction[device_index[i]], bins, stats);
+            if (!done) {
+                ctx->ocl_reduce_ok = false;
+                use_device = false;
+            }
+        }
+        if (!done) {
+            if (device_index[i] >= 0 && !host_synced) {
+                if (!ensure_host_fields(ctx)) return;
+                host_synced = true;
+            }
+            stats = compute_entropy_stats(fields[i]->data, bins);
+        }
         out->entropy[i] = stats.entropy;
         out->norm_entropy[i] = stats.norm_entropy;
         out->p95[i] = stats.p95;
@@ -1623,6 +1802,17 @@ void ms_get_entropy_metrics(ms_handle_t *h, ms_entropy_t *out) {
 void ms_get_mycel_stats(ms_handle_t *h, ms_mycel_stats_t *out) {
     if (!h || !out) return;
     auto *ctx = reinterpret_cast<MicroSwarmContext *>(h);
+    if (ctx->ocl_ecology) {
+        FieldReduction r;
+        std::string error;
+        if (ctx->ocl.reduce_field(4, r, error) && !ctx->mycel.density.data.empty()) {
+            out->min_val = r.min;
+            out->max_val = r.max;
+            out->mean = static_cast<float>(r.sum / static_cast<double>(ctx->mycel.density.data.size()));
+            return;
+        }
+        if (!ensure_host_fields(ctx)) return;
+    }
     const auto &values = ctx->mycel.density.data;
     if (values.empty()) {
         out->min_val = 0.0f;
@@ -1646,10 +1836,15 @@ void ms_get_mycel_stats(ms_handle_t *h, ms_mycel_stats_t *out) {
 void ms_ocl_enable(ms_handle_t *h, int enable) {
     if (!h) return;
     auto *ctx = reinterpret_cast<MicroSwarmContext *>(h);
+    // Resident fields are the newer copy; sync them before the device goes away or is reset.
+    ensure_host_fields(ctx);
     if (!enable) {
+        drop_ecology(ctx);
         ctx->ocl_active = false;
         return;
     }
+    drop_ecology(ctx);
+    ctx->ocl_ecology_ok = true;
     std::string error;
     if (!ctx->ocl.init(ctx->ocl_platform, ctx->ocl_device, error)) {
         ctx->ocl_active = false;
@@ -1663,6 +1858,7 @@ void ms_ocl_enable(ms_handle_t *h, int enable) {
         ctx->ocl_active = false;
         return;
     }
+    ctx->ocl_fields_dirty = false;
     ctx->ocl_active = true;
 }
 
@@ -1686,6 +1882,8 @@ void ms_ocl_print_devices(void) {
 void ms_ocl_set_no_copyback(ms_handle_t *h, int enable) {
     if (!h) return;
     auto *ctx = reinterpret_cast<MicroSwarmContext *>(h);
+    ensure_host_fields(ctx);
+    drop_ecology(ctx);
     if (enable && ctx->params.agent_count > 0) {
         ctx->ocl_no_copyback = false;
     } else {
@@ -1852,6 +2050,207 @@ int ms_db_sql_get_cell(ms_db_handle_t *h, int row, int col, char *dst, int dst_s
     return copy_string(dst, dst_size, r[static_cast<size_t>(col)]);
 }
 
+int ms_db_prepare(ms_db_handle_t *h, const char *query) {
+    if (!h || !query) return 0;
+    auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
+    ctx->last_error.clear();
+    DbPreparedSql stmt;
+    std::string error;
+    if (!db_prepare_sql(query, stmt, error)) {
+        ctx->last_error = error;
+        return 0;
+    }
+    int id = ctx->next_prepared_id++;
+    ctx->prepared[id] = std::move(stmt);
+    return id;
+}
+
+namespace {
+
+int bind_prepared(ms_db_handle_t *h, int stmt, int index, const DbSqlParam &value) {
+    if (!h) return 0;
+    auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
+    ctx->last_error.clear();
+    auto it = ctx->prepared.find(stmt);
+    if (it == ctx->prepared.end()) {
+        ctx->last_error = "Unbekanntes Statement.";
+        return 0;
+    }
+    std::string error;
+    if (!db_bind_sql_param(it->second, index, value, error)) {
+        ctx->last_error = error;
+        return 0;
+    }
+    return 1;
+}
+
+} // namespace
+
+int ms_db_bind_int(ms_db_handle_t *h, int stmt, int index, int64_t value) {
+    DbSqlParam param;
+    param.kind = DbSqlParam::INT;
+    param.int_value = value;
+    return bind_prepared(h, stmt, index, param);
+}
+
+int ms_db_bind_double(ms_db_handle_t *h, int stmt, int index, double value) {
+    DbSqlParam param;
+    param.kind = DbSqlParam::DOUBLE;
+    param.double_value = value;
+    return bind_prepared(h, stmt, index, param);
+}
+
+int ms_db_bind_text(ms_db_handle_t *h, int stmt, int index, const char *value) {
+    DbSqlParam param;
+    if (value) {
+        param.kind = DbSqlParam::TEXT;
+        param.text = value;
+    }
+    return bind_prepared(h, stmt, index, param);
+}
+
+int ms_db_bind_null(ms_db_handle_t *h, int stmt, int index) {
+    return bind_prepared(h, stmt, index, DbSqlParam{});
+}
+
+int ms_db_execute_prepared(ms_db_handle_t *h, int stmt, int use_focus, int focus_x, int focus_y, int radius) {
+    if (!h) return 0;
+    auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
+    ctx->last_error.clear();
+    auto it = ctx->prepared.find(stmt);
+    if (it == ctx->prepared.end()) {
+        ctx->last_error = "Unbekanntes Statement.";
+        return 0;
+    }
+    DbSqlResult result;
+    std::string error;
+    if (!db_execute_prepared(ctx->world, it->second, use_focus != 0, focus_x, focus_y, radius, result, error)) {
+        ctx->last_error = error;
+        ctx->last_sql_valid = false;
+        ctx->last_sql_result = DbSqlResult{};
+        return 0;
+    }
+    ctx->last_sql_result = std::move(result);
+    ctx->last_sql_valid = true;
+    invalidate_delta_cache(ctx);
+    return static_cast<int>(ctx->last_sql_result.rows.size());
+}
+
+int ms_db_finalize(ms_db_handle_t *h, int stmt) {
+    if (!h) return 0;
+    auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
+    return ctx->prepared.erase(stmt) > 0 ? 1 : 0;
+}
+
+int ms_db_cursor_open(ms_db_handle_t *h, const char *query, int use_focus, int focus_x, int focus_y, int radius) {
+    if (!h || !query) return 0;
+    auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
+    ctx->last_error.clear();
+    MicroSwarmDbCursor entry;
+    std::string error;
+    if (!db_cursor_open(ctx->world, query, use_focus != 0, focus_x, focus_y, radius, entry.cursor, error)) {
+        ctx->last_error = error;
+        return 0;
+    }
+    entry.batch.columns = entry.cursor.columns;
+    int id = ctx->next_cursor_id++;
+    ctx->cursors[id] = std::move(entry);
+    return id;
+}
+
+namespace {
+
+MicroSwarmDbCursor *find_cursor(ms_db_handle_t *h, int cursor) {
+    if (!h) return nullptr;
+    auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
+    auto it = ctx->cursors.find(cursor);
+    if (it == ctx->cursors.end()) {
+        ctx->last_error = "Unbekannter Cursor.";
+        return nullptr;
+    }
+    return &it->second;
+}
+
+bool batch_column_valid(const MicroSwarmDbCursor *entry, int col) {
+    return entry && col >= 0 && col < static_cast<int>(entry->batch.columns.size());
+}
+
+} // namespace
+
+int ms_db_cursor_next_batch(ms_db_handle_t *h, int cursor, int max_rows) {
+    MicroSwarmDbCursor *entry = find_cursor(h, cursor);
+    if (!entry) return 0;
+    auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
+    ctx->last_error.clear();
+    std::string error;
+    size_t limit = max_rows > 0 ? static_cast<size_t>(max_rows) : 0;
+    if (!db_cursor_next(entry->cursor, limit, entry->batch, error)) {
+        ctx->last_error = error;
+        entry->batch.rows.clear();
+        return 0;
+    }
+    return static_cast<int>(entry->batch.rows.size());
+}
+
+int ms_db_cursor_get_column_count(ms_db_handle_t *h, int cursor) {
+    MicroSwarmDbCursor *entry = find_cursor(h, cursor);
+    if (!entry) return 0;
+    return static_cast<int>(entry->batch.columns.size());
+}
+
+int ms_db_cursor_get_column_name(ms_db_handle_t *h, int cursor, int index, char *dst, int dst_size) {
+    MicroSwarmDbCursor *entry = find_cursor(h, cursor);
+    if (!batch_column_valid(entry, index)) return 0;
+    return copy_string(dst, dst_size, entry->batch.columns[static_cast<size_t>(index)]);
+}
+
+int ms_db_cursor_get_cell(ms_db_handle_t *h, int cursor, int row, int col, char *dst, int dst_size) {
+    MicroSwarmDbCursor *entry = find_cursor(h, cursor);
+    if (!entry) return 0;
+    if (row < 0 || row >= static_cast<int>(entry->batch.rows.size())) return 0;
+    const auto &r = entry->batch.rows[static_cast<size_t>(row)];
+    if (col < 0 || col >= static_cast<int>(r.size())) {
+        return copy_string(dst, dst_size, "");
+    }
+    return copy_string(dst, dst_size, r[static_cast<size_t>(col)]);
+}
+
+int ms_db_cursor_fetch_double(ms_db_handle_t *h, int cursor, int col, double *out, uint8_t *valid, int max_rows) {
+    MicroSwarmDbCursor *entry = find_cursor(h, cursor);
+    if (!batch_column_valid(entry, col) || !out || max_rows <= 0) return 0;
+    int count = std::min(max_rows, static_cast<int>(entry->batch.rows.size()));
+    for (int i = 0; i < count; ++i) {
+        const std::string &text = entry->batch.rows[static_cast<size_t>(i)][static_cast<size_t>(col)];
+        char *end = nullptr;
+        double v = text.empty() ? 0.0 : std::strtod(text.c_str(), &end);
+        bool ok = !text.empty() && end && *end == '\0';
+        out[i] = ok ? v : 0.0;
+        if (valid) valid[i] = ok ? 1 : 0;
+    }
+    return count;
+}
+
+int ms_db_cursor_fetch_int64(ms_db_handle_t *h, int cursor, int col, int64_t *out, uint8_t *valid, int max_rows) {
+    MicroSwarmDbCursor *entry = find_cursor(h, cursor);
+    if (!batch_column_valid(entry, col) || !out || max_rows <= 0) return 0;
+    int count = std::min(max_rows, static_cast<int>(entry->batch.rows.size()));
+    for (int i = 0; i < count; ++i) {
+        const std::string &text = entry->batch.rows[static_cast<size_t>(i)][static_cast<size_t>(col)];
+        char *end = nullptr;
+        long long v = text.empty() ? 0 : std::strtoll(text.c_str(), &end, 10);
+        bool ok = !text.empty() && end && *end == '\0';
+        out[i] = ok ? static_cast<int64_t>(v) : 0;
+        if (valid) valid[i] = ok ? 1 : 0;
+    }
+    return count;
+}
+
+int ms_db_cursor_close(ms_db_handle_t *h, int cursor) {
+    if (!h) return 0;
+    auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
+    return ctx->cursors.erase(cursor) > 0 ? 1 : 0;
+}
+
 int ms_db_merge_delta(ms_db_handle_t *h, int agents, int steps, uint32_t seed) {
     if (!h) return 0;
     auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
@@ -1882,6 +2281,82 @@ int ms_db_undo_last_delta(ms_db_handle_t *h) {
     return 1;
 }
 
+int ms_db_bulk_insert(ms_db_handle_t *h, const char *table, const char *const *columns, int column_count, const char *const *values, int row_count) {
+    if (!h) return 0;
+    auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
+    ctx->last_error.clear();
+    if (!table || !columns || !values || column_count <= 0 || row_count < 0) {
+        ctx->last_error = "Bulk-Insert: ungueltige Argumente.";
+        return 0;
+    }
+    std::vector<std::string> cols;
+    cols.reserve(static_cast<size_t>(column_count));
+    for (int c = 0; c < column_count; ++c) {
+        cols.emplace_back(columns[c] ? columns[c] : "");
+    }
+    // values is column-major: column c holds values[c * row_count .. c * row_count + row_count - 1].
+    // A NULL pointer is a NULL cell; it goes to the engine as a mask entry, not as text.
+    std::vector<std::vector<std::string>> rows(static_cast<size_t>(row_count));
+    std::vector<uint8_t> nulls;
+    for (int r = 0; r < row_count; ++r) {
+        auto &row = rows[static_cast<size_t>(r)];
+        row.resize(cols.size());
+        for (int c = 0; c < column_count; ++c) {
+            const char *v = values[static_cast<size_t>(c) * static_cast<size_t>(row_count) + static_cast<size_t>(r)];
+            if (v) {
+                row[static_cast<size_t>(c)] = v;
+                continue;
+            }
+            if (nulls.empty()) nulls.assign(rows.size() * cols.size(), 0);
+            nulls[static_cast<size_t>(r) * cols.size() + static_cast<size_t>(c)] = 1;
+        }
+    }
+    int inserted = 0;
+    if (!db_bulk_insert(ctx->world, table, cols, rows, nulls, inserted, ctx->last_error)) {
+        return 0;
+    }
+    invalidate_delta_cache(ctx);
+    return inserted;
+}
+
+int ms_db_wal_open(ms_db_handle_t *h, const char *myco_path, int sync_every) {
+    if (!h || !myco_path) return 0;
+    auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
+    ctx->last_error.clear();
+    if (!db_wal_open(ctx->world, myco_path, sync_every, ctx->last_error)) {
+        return 0;
+    }
+    return 1;
+}
+
+int ms_db_wal_close(ms_db_handle_t *h) {
+    if (!h) return 0;
+    auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
+    ctx->last_error.clear();
+    if (!db_wal_sync(ctx->world, ctx->last_error)) {
+        return 0;
+    }
+    db_wal_close(ctx->world);
+    return 1;
+}
+
+int ms_db_checkpoint(ms_db_handle_t *h, int agents, int steps, uint32_t seed) {
+    if (!h) return 0;
+    auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
+    ctx->last_error.clear();
+    DbIngestConfig cfg;
+    cfg.agent_count = agents;
+    cfg.steps = steps;
+    cfg.seed = seed;
+    std::string error;
+    if (!db_checkpoint(ctx->world, cfg, error)) {
+        ctx->last_error = error;
+        return 0;
+    }
+    invalidate_delta_cache(ctx);
+    return 1;
+}
+
 int ms_db_get_delta_count(ms_db_handle_t *h) {
     if (!h) return 0;
     auto *ctx = reinterpret_cast<MicroSwarmDbContext *>(h);
@@ -1997,17 +2472,14 @@ int ms_db_find_payload_by_id(ms_db_handle_t *h, int payload_id) {
         int idx = pair.second;
         if (idx < 0 || idx >= static_cast<int>(ctx->world.payloads.size())) continue;
         const DbPayload &p = ctx->world.payloads[static_cast<size_t>(idx)];
-        int64_t key = db_payload_key(p.table_id, p.id);
-        if (ctx->world.tombstones.find(key) != ctx->world.tombstones.end()) continue;
+        if (db_payload_hidden(ctx->world, idx)) continue;
         if (p.id == payload_id) {
             return idx;
         }
     }
     for (size_t i = 0; i < ctx->world.payloads.size(); ++i) {
         const DbPayload &p = ctx->world.payloads[i];
-        int64_t key = db_payload_key(p.table_id, p.id);
-        if (ctx->world.tombstones.find(key) != ctx->world.tombstones.end()) continue;
-        if (!p.is_delta && ctx->world.delta_index_by_key.find(key) != ctx->world.delta_index_by_key.end()) continue;
+        if (db_payload_hidden(ctx->world, static_cast<int>(i))) continue;
         if (p.id == payload_id) {
             return static_cast<int>(i);
         }
@@ -17,7 +17,7 @@ extern "C" {
 #endif
 
 #define MS_API_VERSION_MAJOR 1
-#define MS_API_VERSION_MINOR 5
+#define MS_API_VERSION_MINOR 9
 #define MS_API_VERSION_PATCH 0
 
 typedef struct ms_handle_t ms_handle_t;
@@ -241,8 +241,27 @@ MICRO_SWARM_API int ms_db_sql_get_column_count(ms_db_handle_t *h);
 MICRO_SWARM_API int ms_db_sql_get_column_name(ms_db_handle_t *h, int index, char *dst, int dst_size);
 MICRO_SWARM_API int ms_db_sql_get_row_count(ms_db_handle_t *h);
 MICRO_SWARM_API int ms_db_sql_get_cell(ms_db_handle_t *h, int row, int col, char *dst, int dst_size);
+MICRO_SWARM_API int ms_db_prepare(ms_db_handle_t *h, const char *query);
+MICRO_SWARM_API int ms_db_bind_int(ms_db_handle_t *h, int stmt, int index, int64_t value);
+MICRO_SWARM_API int ms_db_bind_double(ms_db_handle_t *h, int stmt, int index, double value);
+MICRO_SWARM_API int ms_db_bind_text(ms_db_handle_t *h, int stmt, int index, const char *value);
+MICRO_SWARM_API int ms_db_bind_null(ms_db_handle_t *h, int stmt, int index);
+MICRO_SWARM_API int ms_db_execute_prepared(ms_db_handle_t *h, int stmt, int use_focus, int focus_x, int focus_y, int radius);
+MICRO_SWARM_API int ms_db_finalize(ms_db_handle_t *h, int stmt);
+MICRO_SWARM_API int ms_db_cursor_open(ms_db_handle_t *h, const char *query, int use_focus, int focus_x, int focus_y, int radius);
+MICRO_SWARM_API int ms_db_cursor_next_batch(ms_db_handle_t *h, int cursor, int max_rows);
+MICRO_SWARM_API int ms_db_cursor_get_column_count(ms_db_handle_t *h, int cursor);
+MICRO_SWARM_API int ms_db_cursor_get_column_name(ms_db_handle_t *h, int cursor, int index, char *dst, int dst_size);
+MICRO_SWARM_API int ms_db_cursor_get_cell(ms_db_handle_t *h, int cursor, int row, int col, char *dst, int dst_size);
+MICRO_SWARM_API int ms_db_cursor_fetch_double(ms_db_handle_t *h, int cursor, int col, double *out, uint8_t *valid, int max_rows);
+MICRO_SWARM_API int ms_db_cursor_fetch_int64(ms_db_handle_t *h, int cursor, int col, int64_t *out, uint8_t *valid, int max_rows);
+MICRO_SWARM_API int ms_db_cursor_close(ms_db_handle_t *h, int cursor);
 MICRO_SWARM_API int ms_db_merge_delta(ms_db_handle_t *h, int agents, int steps, uint32_t seed);
 MICRO_SWARM_API int ms_db_undo_last_delta(ms_db_handle_t *h);
+MICRO_SWARM_API int ms_db_bulk_insert(ms_db_handle_t *h, const char *table, const char *const *columns, int column_count, const char *const *values, int row_count);
+MICRO_SWARM_API int ms_db_wal_open(ms_db_handle_t *h, const char *myco_path, int sync_every);
+MICRO_SWARM_API int ms_db_wal_close(ms_db_handle_t *h);
+MICRO_SWARM_API int ms_db_checkpoint(ms_db_handle_t *h, int agents, int steps, uint32_t seed);
 MICRO_SWARM_API int ms_db_get_delta_count(ms_db_handle_t *h);
 MICRO_SWARM_API int ms_db_get_tombstone_count(ms_db_handle_t *h);
 MICRO_SWARM_API int ms_db_get_delta_entry(ms_db_handle_t *h, int index, char *dst, int dst_size);
@@ -3,14 +3,24 @@
 #include "params.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <cerrno>
+#include <climits>
 #include <cmath>
+#include <condition_variable>
+#include <cstdio>
 #include <cstring>
 #include <cstdlib>
 #include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <regex>
 #include <sstream>
 #include <string>
+#include <thread>
 
 namespace {
 std::string to_lower(std::string s) {
@@ -30,18 +40,18 @@ std::string trim(const std::string &s) {
     return s.substr(start, end - start);
 }
 
+// Verhalten wie std::stoi (Leerzeichen/Vorzeichen, Rest wird ignoriert), aber ohne
+// Exceptions: beim Laden scheitert die ID-Erkennung oft an Textspalten.
 bool parse_int_value(const std::string &s, int &out) {
-    try {
-        size_t idx = 0;
-        int v = std::stoi(s, &idx);
-        if (idx == 0) {
-            return false;
-        }
-        out = v;
-        return true;
-    } catch (...) {
+    const char *begin = s.c_str();
+    char *end = nullptr;
+    errno = 0;
+    long v = std::strtol(begin, &end, 10);
+    if (end == begin || errno == ERANGE || v < INT_MIN || v > INT_MAX) {
         return false;
     }
+    out = static_cast<int>(v);
+    return true;
 }
 
 std::string strip_quotes(const std::string &s) {
@@ -65,6 +75,18 @@ bool ieq_prefix(const std::string &s, const std::string &prefix) {
     return true;
 }
 
+// Wie ieq_prefix, aber ab Position pos und ohne Teilstring-Kopie.
+bool ieq_at(const std::string &s, size_t pos, const char *prefix) {
+    size_t len = std::strlen(prefix);
+    if (pos > s.size() || s.size() - pos < len) return false;
+    for (size_t i = 0; i < len; ++i) {
+        if (std::tolower(static_cast<unsigned char>(s[pos + i])) != std::tolower(static_cast<unsigned char>(prefix[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool ieq(const std::string &a, const std::string &b) {
     if (a.size() != b.size()) return false;
     for (size_t i = 0; i < a.size(); ++i) {
@@ -299,27 +321,31 @@ bool parse_columns_list(const std::string &s, size_t &i, std::vector<std::string
 bool parse_value(const std::string &s, size_t &i, std::string &out) {
     while (i < s.size() && std::isspace(static_cast<unsigned char>(s[i]))) i++;
     if (i >= s.size()) return false;
+    out.clear();
     if (s[i] == '\'' || s[i] == '"') {
         char quote = s[i++];
-        std::string val;
         while (i < s.size()) {
+            // Unmaskierte Abschnitte am Stueck uebernehmen.
+            size_t run = i;
+            while (run < s.size() && s[run] != quote && s[run] != '\\') run++;
+            out.append(s, i, run - i);
+            i = run;
+            if (i >= s.size()) break;
             char c = s[i++];
             if (c == '\\' && i < s.size()) {
-                char n = s[i++];
-                val.push_back(n);
+                out.push_back(s[i++]);
                 continue;
             }
             if (c == quote) {
                 if (i < s.size() && s[i] == quote) {
-                    val.push_back(quote);
+                    out.push_back(quote);
                     i++;
                     continue;
                 }
                 break;
             }
-            val.push_back(c);
+            out.push_back(c);
         }
-        out = val;
         return true;
     }
     size_t start = i;
@@ -328,7 +354,10 @@ bool parse_value(const std::string &s, size_t &i, std::string &out) {
         if (c == ',' || c == ')') break;
         i++;
     }
-    out = trim(s.substr(start, i - start));
+    size_t end = i;
+    while (start < end && std::isspace(static_cast<unsigned char>(s[start]))) start++;
+    while (end > start && std::isspace(static_cast<unsigned char>(s[end - 1]))) end--;
+    out.assign(s, start, end - start);
     return true;
 }
 
@@ -344,10 +373,11 @@ bool parse_values_list(const std::string &s, size_t &i, std::vector<std::vector<
         }
         i++;
         std::vector<std::string> row;
+        if (!rows.empty()) row.reserve(rows.front().size());
         while (i < s.size()) {
             std::string value;
             if (!parse_value(s, i, value)) return false;
-            row.push_back(value);
+            row.push_back(std::move(value));
             while (i < s.size() && std::isspace(static_cast<unsigned char>(s[i]))) i++;
             if (i < s.size() && s[i] == ',') {
                 i++;
@@ -379,7 +409,7 @@ bool parse_values_list(const std::string &s, size_t &i, std::vector<std::vector<
 bool parse_insert_statement(const std::string &stmt, SqlInsert &out) {
     size_t i = 0;
     while (i < stmt.size() && std::isspace(static_cast<unsigned char>(stmt[i]))) i++;
-    if (!ieq_prefix(stmt.substr(i), "insert into")) {
+    if (!ieq_at(stmt, i, "insert into")) {
         return false;
     }
     i += 11;
@@ -394,7 +424,7 @@ bool parse_insert_statement(const std::string &stmt, SqlInsert &out) {
         i = save;
     }
     while (i < stmt.size() && std::isspace(static_cast<unsigned char>(stmt[i]))) i++;
-    if (!ieq_prefix(stmt.substr(i), "values")) {
+    if (!ieq_at(stmt, i, "values")) {
         return false;
     }
     i += 6;
@@ -463,15 +493,14 @@ bool parse_insert_statement_lenient(const std::string &stmt, SqlInsert &out) {
 bool parse_create_table_statement(const std::string &stmt, std::string &table, std::vector<std::string> &columns) {
     size_t i = 0;
     while (i < stmt.size() && std::isspace(static_cast<unsigned char>(stmt[i]))) i++;
-    if (!ieq_prefix(stmt.substr(i), "create table")) {
+    if (!ieq_at(stmt, i, "create table")) {
         return false;
     }
     i += 12;
     {
         size_t tmp = i;
         while (tmp < stmt.size() && std::isspace(static_cast<unsigned char>(stmt[tmp]))) tmp++;
-        std::string rest = to_lower(stmt.substr(tmp));
-        if (ieq_prefix(rest, "if not exists")) {
+        if (ieq_at(stmt, tmp, "if not exists")) {
             tmp += 13;
             i = tmp;
         }
@@ -540,12 +569,17 @@ int64_t make_payload_key(int table_id, int id) {
 }
 
 std::string build_raw_data(const std::vector<DbField> &fields) {
-    std::ostringstream ss;
+    size_t total = 0;
+    for (const auto &f : fields) total += f.name.size() + f.value.size() + 3;
+    std::string out;
+    out.reserve(total);
     for (size_t i = 0; i < fields.size(); ++i) {
-        if (i > 0) ss << ", ";
-        ss << fields[i].name << "=" << fields[i].value;
+        if (i > 0) out += ", ";
+        out += fields[i].name;
+        out.push_back('=');
+        out += fields[i].value;
     }
-    return ss.str();
+    return out;
 }
 
 struct IngestRule {
@@ -836,11 +870,117 @@ bool load_ingest_rules(const std::string &path, IngestRules &rules, std::string
     return true;
 }
 
+unsigned worker_thread_count(int requested) {
+    if (requested > 0) return static_cast<unsigned>(requested);
+    unsigned hw = std::thread::hardware_concurrency();
+    return std::max(1u, std::min(hw, 16u));
+}
+
+// Feste Worker-Threads fuer wiederholte parallele Schleifen (SQL-Bloecke, Ingest-Schritte).
+// run() verteilt die Indizes dynamisch, der aufrufende Thread arbeitet mit.
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned threads) {
+        for (unsigned t = 1; t < threads; ++t) {
+            workers_.emplace_back([this]() { worker_loop(); });
+        }
+    }
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &w : workers_) {
+            w.join();
+        }
+    }
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    template <typename Fn>
+    void run(size_t count, Fn &&fn) {
+        if (workers_.empty() || count < 2) {
+            for (size_t i = 0; i < count; ++i) fn(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = [&fn](size_t i) { fn(i); };
+            count_ = count;
+            next_.store(0);
+            busy_ = workers_.size();
+            generation_++;
+        }
+        wake_.notify_all();
+        drain();
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return busy_ == 0; });
+        task_ = nullptr;
+    }
+
+private:
+    void drain() {
+        for (size_t i = next_.fetch_add(1); i < count_; i = next_.fetch_add(1)) {
+            task_(i);
+        }
+    }
+    void worker_loop() {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+            }
+            drain();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                busy_--;
+            }
+            done_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::function<void(size_t)> task_;
+    size_t count_ = 0;
+    std::atomic<size_t> next_{0};
+    size_t busy_ = 0;
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+};
+
+// Ingest-Regel, die fuer ein Payload greift; FK-Ziele und Trait-Schluessel werden
+// beim Aufnehmen einmal aufgeloest statt in jedem Schritt.
+struct IngestHit {
+    const IngestRule *rule = nullptr;
+    bool foreign_key = false;
+    int64_t fk_key = 0;
+    int trait = -1;
+};
+
 struct DbCarrierAgent {
     float x = 0.0f;
     float y = 0.0f;
     int payload_index = -1;
+    std::vector<int64_t> fk_keys;
+    std::vector<IngestHit> hits;
+    // Ergebnis der Bewegungsphase eines Schritts.
+    bool want_place = false;
+    int cell_x = 0;
+    int cell_y = 0;
+    int place_x = -1;
+    int place_y = -1;
 };
+
+// Zeilenbaender fuer die Platzierung: find_empty_near (Radius 2) eines Bandes
+// beruehrt nie das uebernaechste, daher laufen gerade und ungerade Baender je parallel.
+constexpr int kIngestBandRows = 8;
 
 bool find_empty_near(const DbWorld &world, int cx, int cy, int radius, int &out_x, int &out_y) {
     int x0 = std::max(0, cx - radius);
@@ -849,7 +989,7 @@ bool find_empty_near(const DbWorld &world, int cx, int cy, int radius, int &out_
     int y1 = std::min(world.height - 1, cy + radius);
     for (int y = y0; y <= y1; ++y) {
         for (int x = x0; x <= x1; ++x) {
-            if (world.cell_payload[static_cast<size_t>(y) * world.width + x] < 0) {
+            if ((*world.cell_payload)[static_cast<size_t>(y) * world.width + x] < 0) {
                 out_x = x;
                 out_y = y;
                 return true;
@@ -876,14 +1016,191 @@ bool base_overridden(const DbWorld &world, int64_t key) {
     return world.delta_index_by_key.find(key) != world.delta_index_by_key.end();
 }
 
+int base_payload_index(const DbWorld &world, int64_t key) {
+    auto it = world.base_index_by_key->find(key);
+    return it == world.base_index_by_key->end() ? -1 : it->second;
+}
+
+// Recomputes the status bits of the base and delta payload of one key after its delta state changed.
+void refresh_key_status(DbWorld &world, int64_t key) {
+    if (world.payload_status.size() < world.payloads.size()) {
+        world.payload_status.resize(world.payloads.size(), 0);
+    }
+    uint8_t tombstoned = payload_tombstoned(world, key) ? kDbPayloadTombstoned : 0;
+    auto dit = world.delta_index_by_key.find(key);
+    bool has_delta = dit != world.delta_index_by_key.end();
+    if (has_delta) {
+        world.payload_status[static_cast<size_t>(dit->second)] = kDbPayloadDelta | tombstoned;
+    }
+    uint8_t base_bits = tombstoned | (has_delta ? kDbPayloadOverridden : 0);
+    for (int base = base_payload_index(world, key); base >= 0; base = (*world.base_key_next)[static_cast<size_t>(base)]) {
+        world.payload_status[static_cast<size_t>(base)] = base_bits;
+    }
+}
+
+void rebuild_payload_status(DbWorld &world) {
+    // Fresh maps instead of edit(): published snapshots keep the old ones.
+    std::unordered_map<int64_t, int> base_index_by_key;
+    std::vector<int> base_key_next(world.payloads.size(), -1);
+    base_index_by_key.reserve(world.payloads.size());
+    world.payload_status.assign(world.payloads.size(), 0);
+    // Backwards, so each key maps to its first base row and the chain runs in payload order.
+    for (size_t i = world.payloads.size(); i-- > 0;) {
+        const DbPayload &p = world.payloads[i];
+        if (p.table_id < 0) {
+            world.payload_status[i] = kDbPayloadTombstoned;
+            continue;
+        }
+        int64_t key = make_payload_key(p.table_id, p.id);
+        uint8_t bits = payload_tombstoned(world, key) ? kDbPayloadTombstoned : 0;
+        if (p.is_delta) {
+            bits |= kDbPayloadDelta;
+        } else {
+            auto inserted = base_index_by_key.emplace(key, static_cast<int>(i));
+            if (!inserted.second) {
+                base_key_next[i] = inserted.first->second;
+                inserted.first->second = static_cast<int>(i);
+            }
+            if (base_overridden(world, key)) bits |= kDbPayloadOverridden;
+        }
+        world.payload_status[i] = bits;
+    }
+    world.base_index_by_key = DbCow<std::unordered_map<int64_t, int>>(std::move(base_index_by_key));
+    world.base_key_next = DbCow<std::vector<int>>(std::move(base_key_next));
+}
+
 int next_payload_id(const DbWorld &world, int table_id) {
-    int max_id = 0;
-    for (const auto &p : world.payloads) {
-        if (p.table_id == table_id) {
-            if (p.id > max_id) max_id = p.id;
+    if (table_id < 0 || table_id >= static_cast<int>(world.table_max_id.size())) {
+        return 1;
+    }
+    return world.table_max_id[static_cast<size_t>(table_id)] + 1;
+}
+
+void mark_columns_dirty(DbWorld &world, int table_id) {
+    if (table_id >= 0 && table_id < static_cast<int>(world.table_store.size())) {
+        world.table_store[static_cast<size_t>(table_id)].reset();
+    }
+}
+
+void track_payload(DbWorld &world, int payload_index) {
+    const DbPayload &p = world.payloads[static_cast<size_t>(payload_index)];
+    if (p.table_id < 0) return;
+    size_t table = static_cast<size_t>(p.table_id);
+    if (world.table_payloads.size() <= table) {
+        world.table_payloads.resize(table + 1);
+        world.table_max_id.resize(table + 1, 0);
+    }
+    mark_columns_dirty(world, p.table_id);
+    world.table_payloads[table].push_back(payload_index);
+    world.table_max_id[table] = std::max(world.table_max_id[table], p.id);
+}
+
+void untrack_payload(DbWorld &world, int payload_index) {
+    const DbPayload &p = world.payloads[static_cast<size_t>(payload_index)];
+    if (p.table_id < 0 || p.table_id >= static_cast<int>(world.table_payloads.size())) return;
+    mark_columns_dirty(world, p.table_id);
+    auto &list = world.table_payloads[static_cast<size_t>(p.table_id)];
+    if (!list.empty() && list.back() == payload_index) {
+        list.pop_back();
+        return;
+    }
+    auto it = std::lower_bound(list.begin(), list.end(), payload_index);
+    if (it != list.end() && *it == payload_index) {
+        list.erase(it);
+    }
+}
+
+// Same rule as the SQL executor: a number if stod consumes a prefix.
+bool column_number(const std::string &text, double &out) {
+    try {
+        size_t used = 0;
+        out = std::stod(text, &used);
+        return used > 0;
+    } catch (...) {
+        return false;
+    }
+}
+
+// Only plain integers whose text round-trips, so the text never has to be stored.
+bool column_int(const std::string &text, int64_t &out) {
+    if (text.empty() || text.size() > 20) return false;
+    char *end = nullptr;
+    errno = 0;
+    long long v = std::strtoll(text.c_str(), &end, 10);
+    if (errno != 0 || end != text.c_str() + text.size()) return false;
+    if (std::to_string(v) != text) return false;
+    out = static_cast<int64_t>(v);
+    return true;
+}
+
+void finish_column(DbColumn &col, const std::vector<const std::string *> &values) {
+    size_t rows = values.size();
+    col.present.assign(rows, 0);
+    col.ints.assign(rows, 0);
+    bool all_int = true;
+    for (size_t r = 0; r < rows; ++r) {
+        if (!values[r]) continue;
+        col.present[r] = 1;
+        if (all_int && !column_int(*values[r], col.ints[r])) {
+            all_int = false;
+        }
+    }
+    if (all_int) {
+        col.kind = DbColumn::INT64;
+        return;
+    }
+    col.ints.clear();
+    col.ints.shrink_to_fit();
+    col.codes.assign(rows, 0);
+    std::unordered_map<std::string, uint32_t> lookup;
+    bool all_numeric = true;
+    for (size_t r = 0; r < rows; ++r) {
+        if (!values[r]) continue;
+        auto res = lookup.emplace(*values[r], static_cast<uint32_t>(col.dictionary.size()));
+        if (res.second) {
+            double num = 0.0;
+            bool numeric = column_number(*values[r], num);
+            col.dictionary.push_back(*values[r]);
+            col.dictionary_numbers.push_back(numeric ? num : 0.0);
+            col.dictionary_numeric.push_back(numeric ? 1 : 0);
+            all_numeric = all_numeric && numeric;
+        }
+        col.codes[r] = res.first->second;
+    }
+    col.kind = all_numeric ? DbColumn::DOUBLE : DbColumn::TEXT;
+}
+
+void build_column_table(const DbWorld &world, int table_id, DbColumnTable &store) {
+    const std::vector<int> &rows = db_table_payloads(world, table_id);
+    store.payload_index = rows;
+    store.x.assign(rows.size(), -1);
+    store.y.assign(rows.size(), -1);
+    store.delta.assign(rows.size(), 0);
+    store.columns.clear();
+    store.column_lookup.clear();
+    std::vector<std::vector<const std::string *>> values;
+    for (size_t r = 0; r < rows.size(); ++r) {
+        const DbPayload &p = world.payloads[static_cast<size_t>(rows[r])];
+        if (p.placed) {
+            store.x[r] = p.x;
+            store.y[r] = p.y;
+        }
+        store.delta[r] = p.is_delta ? 1 : 0;
+        for (const auto &f : p.fields) {
+            std::string key = to_lower(f.name);
+            auto it = store.column_lookup.find(key);
+            if (it == store.column_lookup.end()) {
+                it = store.column_lookup.emplace(key, static_cast<int>(store.columns.size())).first;
+                store.columns.emplace_back();
+                store.columns.back().name = key;
+                values.emplace_back(rows.size(), nullptr);
+            }
+            values[static_cast<size_t>(it->second)][r] = &f.value;
         }
     }
-    return max_id + 1;
+    for (size_t c = 0; c < store.columns.size(); ++c) {
+        finish_column(store.columns[c], values[c]);
+    }
 }
 
 void ensure_column(DbWorld &world, int table_id, const std::string &col) {
@@ -926,6 +1243,12 @@ void deactivate_payload(DbPayload &payload) {
     payload.is_delta = false;
 }
 
+// Marks a delta slot that undo took out of the key maps; it stays in payloads until the next merge.
+void release_delta_slot(DbWorld &world, int payload_index) {
+    deactivate_payload(world.payloads.mut(static_cast<size_t>(payload_index)));
+    world.payload_status[static_cast<size_t>(payload_index)] = kDbPayloadTombstoned;
+}
+
 bool apply_set_fields(DbWorld &world,
                       DbPayload &payload,
                       const std::vector<std::pair<std::string, std::string>> &sets,
@@ -1074,293 +1397,895 @@ bool parse_delete_statement(const std::string &stmt,
     where_val = p.consume();
     return !where_val.empty();
 }
-} // namespace
-
-int db_add_table(DbWorld &world, const std::string &name) {
-    std::string key = to_lower(name);
-    auto it = world.table_lookup.find(key);
-    if (it != world.table_lookup.end()) {
-        return it->second;
-    }
-    int id = static_cast<int>(world.table_names.size());
-    world.table_lookup[key] = id;
-    world.table_names.push_back(name);
-    world.table_columns.emplace_back();
-    if (world.width > 0 && world.height > 0) {
-        world.table_pheromones.emplace_back(world.width, world.height, 0.0f);
+
+bool match_word(const std::string &s, size_t &i, const char *word) {
+    while (i < s.size() && std::isspace(static_cast<unsigned char>(s[i]))) i++;
+    size_t len = std::strlen(word);
+    if (!ieq_at(s, i, word)) return false;
+    if (i + len < s.size()) {
+        char n = s[i + len];
+        if (std::isalnum(static_cast<unsigned char>(n)) || n == '_') return false;
     }
-    return id;
+    i += len;
+    return true;
 }
 
-int64_t db_payload_key(int table_id, int id) {
-    return make_payload_key(table_id, id);
+bool parse_create_index_statement(const std::string &stmt, DbIndex &out, bool &if_not_exists) {
+    size_t i = 0;
+    out = DbIndex{};
+    if_not_exists = false;
+    if (!match_word(stmt, i, "create")) return false;
+    out.unique = match_word(stmt, i, "unique");
+    if (!match_word(stmt, i, "index")) return false;
+    if (match_word(stmt, i, "if")) {
+        if (!match_word(stmt, i, "not") || !match_word(stmt, i, "exists")) return false;
+        if_not_exists = true;
+    }
+    if (!parse_identifier(stmt, i, out.name)) return false;
+    if (!match_word(stmt, i, "on")) return false;
+    if (!parse_identifier(stmt, i, out.table)) return false;
+    if (match_word(stmt, i, "using")) {
+        std::string method;
+        if (!parse_identifier(stmt, i, method)) return false;
+    }
+    while (i < stmt.size() && std::isspace(static_cast<unsigned char>(stmt[i]))) i++;
+    if (i >= stmt.size() || stmt[i] != '(') return false;
+    i++;
+    while (i < stmt.size()) {
+        std::string col;
+        if (!parse_identifier(stmt, i, col)) return false;
+        out.columns.push_back(col);
+        // Skip prefix lengths, ASC/DESC and COLLATE up to the next column.
+        int depth = 0;
+        while (i < stmt.size()) {
+            char c = stmt[i];
+            if (c == '(') depth++;
+            if (c == ')') {
+                if (depth == 0) break;
+                depth--;
+            }
+            if (c == ',' && depth == 0) break;
+            i++;
+        }
+        if (i >= stmt.size()) return false;
+        if (stmt[i++] == ')') return true;
+    }
+    return false;
 }
 
-size_t db_delta_count(const DbWorld &world) {
-    size_t count = 0;
-    for (const auto &pair : world.delta_index_by_key) {
-        if (world.tombstones.find(pair.first) == world.tombstones.end()) {
-            count++;
-        }
+bool parse_drop_index_statement(const std::string &stmt, std::string &name, bool &if_exists) {
+    size_t i = 0;
+    if_exists = false;
+    if (!match_word(stmt, i, "drop") || !match_word(stmt, i, "index")) return false;
+    if (match_word(stmt, i, "if")) {
+        if (!match_word(stmt, i, "exists")) return false;
+        if_exists = true;
     }
-    return count;
+    if (!parse_identifier(stmt, i, name)) return false;
+    if (!name.empty() && name.back() == ';') name.pop_back();
+    return !name.empty();
 }
 
-bool db_has_pending_delta(const DbWorld &world) {
-    return !world.tombstones.empty() || !world.delta_index_by_key.empty();
+// Numeric parse as in the SQL executor (leading number); NaN is indexed as text.
+bool index_number(const std::string &value, double &out) {
+    try {
+        size_t idx = 0;
+        double v = std::stod(value, &idx);
+        if (idx == 0 || std::isnan(v)) return false;
+        out = v;
+        return true;
+    } catch (...) {
+        return false;
+    }
 }
-
-int db_find_table(const DbWorld &world, const std::string &name) {
-    std::string key = to_lower(name);
-    auto it = world.table_lookup.find(key);
-    if (it != world.table_lookup.end()) {
-        return it->second;
-    }
-    return -1;
-}
-
-void db_init_world(DbWorld &world, int width, int height) {
-    world.width = width;
-    world.height = height;
-    world.cell_payload.assign(static_cast<size_t>(width) * height, -1);
-    world.table_pheromones.clear();
-    world.table_pheromones.reserve(world.table_names.size());
-    for (size_t i = 0; i < world.table_names.size(); ++i) {
-        world.table_pheromones.emplace_back(width, height, 0.0f);
-    }
-    world.data_density = GridField(width, height, 0.0f);
-    world.mycel = MycelNetwork(width, height);
-    world.payload_positions.clear();
-}
-
-bool db_place_payload(DbWorld &world, int payload_index, int x, int y) {
-    if (payload_index < 0 || payload_index >= static_cast<int>(world.payloads.size())) {
-        return false;
-    }
-    if (x < 0 || y < 0 || x >= world.width || y >= world.height) {
-        return false;
-    }
-    size_t idx = static_cast<size_t>(y) * world.width + x;
-    if (world.cell_payload[idx] >= 0) {
-        return false;
-    }
-    DbPayload &payload = world.payloads[static_cast<size_t>(payload_index)];
-    payload.x = x;
-    payload.y = y;
-    payload.placed = true;
-    world.cell_payload[idx] = payload_index;
-    world.data_density.at(x, y) = 1.0f;
-    if (payload.table_id >= 0 && payload.table_id < static_cast<int>(world.table_pheromones.size())) {
-        world.table_pheromones[static_cast<size_t>(payload.table_id)].at(x, y) += 1.0f;
-    }
-    world.payload_positions[make_payload_key(payload.table_id, payload.id)] = {x, y};
-    return true;
-}
-
-bool db_load_sql(const std::string &path, DbWorld &world, std::string &error) {
-    std::ifstream in(path, std::ios::binary);
-    if (!in.is_open()) {
-        error = "SQL-Datei konnte nicht geoeffnet werden: " + path;
-        return false;
-    }
-    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
-    if (content.empty()) {
-        error = "SQL-Datei ist leer.";
-        return false;
-    }
-
-    std::string stmt;
-    bool in_string = false;
-    char string_quote = 0;
-    bool in_line_comment = false;
-    bool in_block_comment = false;
-    for (size_t i = 0; i < content.size(); ++i) {
-        char c = content[i];
-        char n = (i + 1 < content.size()) ? content[i + 1] : '\0';
-        if (!in_string && !in_block_comment && c == '-' && n == '-') {
-            in_line_comment = true;
-            i++;
-            continue;
-        }
-        if (!in_string && !in_line_comment && c == '/' && n == '*') {
-            in_block_comment = true;
-            i++;
-            continue;
-        }
-        if (in_line_comment) {
-            if (c == '\n' || c == '\r') {
-                in_line_comment = false;
-            }
-            continue;
-        }
-        if (in_block_comment) {
-            if (c == '*' && n == '/') {
-                in_block_comment = false;
-                i++;
-            }
-            continue;
-        }
-
-        if (in_string && c == '\\') {
-            stmt.push_back(c);
-            if (n != '\0') {
-                stmt.push_back(n);
-                i++;
+
+DbIndexKey make_index_key(const std::string &value) {
+    DbIndexKey key;
+    key.numeric = index_number(value, key.number);
+    if (!key.numeric) {
+        key.text = value;
+    }
+    return key;
+}
+
+std::string index_hash_part(const std::string &value) {
+    double num = 0.0;
+    if (index_number(value, num)) {
+        if (num == 0.0) num = 0.0;
+        char buf[40];
+        std::snprintf(buf, sizeof(buf), "n%.17g", num);
+        return buf;
+    }
+    return "s" + to_lower(value);
+}
+
+bool index_keys(const DbIndex &index, const DbPayload &p, std::string &hash_key, DbIndexKey &leading) {
+    hash_key.clear();
+    for (size_t c = 0; c < index.columns.size(); ++c) {
+        const DbField *field = nullptr;
+        for (const auto &f : p.fields) {
+            if (ieq(f.name, index.columns[c])) {
+                field = &f;
+                break;
             }
-            continue;
         }
-        if (c == '\'' || c == '"') {
-            if (!in_string) {
-                in_string = true;
-                string_quote = c;
-            } else if (c == string_quote) {
-                if (n == string_quote) {
-                    stmt.push_back(c);
-                    stmt.push_back(n);
-                    i++;
-                    continue;
-                }
-                in_string = false;
-            }
-        }
-        stmt.push_back(c);
-        if (!in_string && c == ';') {
-            std::string stmt_trim = trim(stmt);
-            std::string table_name;
-            std::vector<std::string> schema_cols;
-            if (parse_create_table_statement(stmt_trim, table_name, schema_cols)) {
-                int table_id = db_add_table(world, table_name);
-                if (!schema_cols.empty()) {
-                    world.table_columns[static_cast<size_t>(table_id)] = schema_cols;
-                }
-                stmt.clear();
-                continue;
-            }
-            SqlInsert insert;
-            if (parse_insert_statement(stmt, insert) || parse_insert_statement_lenient(stmt, insert)) {
-                int table_id = db_add_table(world, insert.table);
-                if (!insert.columns.empty() && world.table_columns[static_cast<size_t>(table_id)].empty()) {
-                    world.table_columns[static_cast<size_t>(table_id)] = insert.columns;
-                }
-                for (const auto &row : insert.rows) {
-                    DbPayload payload;
-                    payload.table_id = table_id;
-                    payload.fields.clear();
-                    if (!insert.columns.empty()) {
-                        if (row.size() != insert.columns.size()) {
-                            continue;
-                        }
-                        for (size_t ci = 0; ci < insert.columns.size(); ++ci) {
-                            DbField field;
-                            field.name = insert.columns[ci];
-                            field.value = strip_quotes(row[ci]);
-                            payload.fields.push_back(field);
-                        }
-                    } else {
-                        const auto &schema = world.table_columns[static_cast<size_t>(table_id)];
-                        for (size_t ci = 0; ci < row.size(); ++ci) {
-                            DbField field;
-                            if (ci < schema.size()) {
-                                field.name = schema[ci];
-                            } else {
-                                field.name = "col" + std::to_string(ci);
-                            }
-                            field.value = strip_quotes(row[ci]);
-                            payload.fields.push_back(field);
-                        }
-                    }
-                    int id_value = 0;
-                    bool found_id = false;
-                    for (const auto &f : payload.fields) {
-                        if (ieq(f.name, "id")) {
-                            if (parse_int_value(f.value, id_value)) {
-                                found_id = true;
-                            }
-                            break;
-                        }
-                    }
-                    if (!found_id) {
-                        if (!payload.fields.empty()) {
-                            found_id = parse_int_value(payload.fields.front().value, id_value);
-                        }
-                    }
-                    if (!found_id) {
-                        id_value = static_cast<int>(world.payloads.size()) + 1;
-                    }
-                    payload.id = id_value;
-                    for (const auto &f : payload.fields) {
-                        if (!ends_with_id(f.name)) continue;
-                        int fk_id = 0;
-                        if (!parse_int_value(f.value, fk_id)) continue;
-                        std::string fk_table = fk_table_from_column(f.name);
-                        int fk_table_id = db_find_table(world, fk_table);
-                        if (fk_table_id >= 0) { // <--- WICHTIGE PRÜFUNG HINZUFÜGEN
-                            DbForeignKey fk;
-                            fk.table_id = fk_table_id;
-                            fk.id = fk_id;
-                            fk.column = f.name;
-                            payload.foreign_keys.push_back(fk);
-                        }
-                    }
-                    payload.raw_data = build_raw_data(payload.fields);
-                    world.payloads.push_back(std::move(payload));
-                }
-            }
-            stmt.clear();
-        }
-    }
-    if (world.payloads.empty()) {
-        error = "Keine INSERT-Statements gefunden.";
-        return false;
-    }
-    return true;
-}
-
-bool db_run_ingest(DbWorld &world, const DbIngestConfig &cfg, std::string &error) {
-    if (world.width <= 0 || world.height <= 0) {
-        error = "Ungueltige Rastergroesse.";
-        return false;
+        if (!field) return false;
+        if (c > 0) hash_key.push_back('\x1f');
+        hash_key += index_hash_part(field->value);
+        if (c == 0) leading = make_index_key(field->value);
     }
-    if (world.payloads.empty()) {
-        error = "Keine Payloads vorhanden.";
-        return false;
+    return !index.columns.empty();
+}
+
+void index_insert(DbIndex &index, const DbPayload &p, int payload_index) {
+    std::string hash_key;
+    DbIndexKey leading;
+    if (!index_keys(index, p, hash_key, leading)) return;
+    index.hash[hash_key].push_back(payload_index);
+    index.ordered.emplace(std::move(leading), payload_index);
+}
+
+void index_erase(DbIndex &index, const DbPayload &p, int payload_index) {
+    std::string hash_key;
+    DbIndexKey leading;
+    if (!index_keys(index, p, hash_key, leading)) return;
+    auto it = index.hash.find(hash_key);
+    if (it != index.hash.end()) {
+        auto &bucket = it->second;
+        bucket.erase(std::remove(bucket.begin(), bucket.end(), payload_index), bucket.end());
+        if (bucket.empty()) index.hash.erase(it);
     }
-    IngestRules ingest_rules;
-    if (!cfg.rules_path.empty()) {
-        std::string rules_error;
-        if (!load_ingest_rules(cfg.rules_path, ingest_rules, rules_error)) {
-            error = "Ingest-Regeln: " + rules_error;
-            return false;
+    auto range = index.ordered.equal_range(leading);
+    for (auto oit = range.first; oit != range.second; ++oit) {
+        if (oit->second == payload_index) {
+            index.ordered.erase(oit);
+            break;
         }
     }
-    if (ingest_rules.default_rules.empty()) {
-        IngestRule rule;
-        rule.pattern = ".*_id$";
-        rule.pattern_rule = true;
-        rule.weight = 1.0;
-        rule.type = "foreign_key";
-        rule.pattern_re = std::regex(rule.pattern, std::regex::icase);
-        ingest_rules.default_rules.push_back(std::move(rule));
-    }
-    db_init_world(world, world.width, world.height);
-    Rng rng(cfg.seed);
-    int spawn_x = cfg.spawn_x >= 0 ? cfg.spawn_x : world.width / 2;
-    int spawn_y = cfg.spawn_y >= 0 ? cfg.spawn_y : world.height / 2;
+}
 
-    std::vector<int> pending;
-    pending.reserve(world.payloads.size());
+// Adds or removes one payload in every index of its table; call around in-place payload changes.
+void index_payload(DbWorld &world, int payload_index, bool add) {
+    const DbPayload &p = world.payloads[static_cast<size_t>(payload_index)];
+    mark_columns_dirty(world, p.table_id);
+    if (p.table_id < 0 || world.indexes.empty()) return;
+    for (auto &pair : world.indexes) {
+        if (db_find_table(world, pair.second->table) != p.table_id) continue;
+        DbIndex &index = pair.second.edit();
+        if (add) {
+            index_insert(index, p, payload_index);
+        } else {
+            index_erase(index, p, payload_index);
+        }
+    }
+}
+
+bool payload_live(const DbWorld &world, int payload_index) {
+    return world.payloads[static_cast<size_t>(payload_index)].table_id >= 0 && !db_payload_hidden(world, payload_index);
+}
+
+bool unique_conflict(const DbWorld &world, const DbPayload &p, std::string &error) {
+    int64_t self_key = make_payload_key(p.table_id, p.id);
+    for (const auto &pair : world.indexes) {
+        const DbIndex &index = *pair.second;
+        if (!index.unique || db_find_table(world, index.table) != p.table_id) continue;
+        std::string hash_key;
+        DbIndexKey leading;
+        if (!index_keys(index, p, hash_key, leading)) continue;
+        auto it = index.hash.find(hash_key);
+        if (it == index.hash.end()) continue;
+        for (int idx : it->second) {
+            const DbPayload &other = world.payloads[static_cast<size_t>(idx)];
+            if (!payload_live(world, idx)) continue;
+            if (make_payload_key(other.table_id, other.id) == self_key) continue;
+            error = "UNIQUE-Index verletzt: " + index.name;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Leseblock und Statement-Block fuer db_load_sql; begrenzen den Speicherbedarf beim Laden.
+constexpr size_t kSqlLoadChunkBytes = 4u << 20;
+constexpr size_t kSqlLoadBatchBytes = 32u << 20;
+
+enum SqlScanClass : unsigned char {
+    SCAN_NORMAL = 1, // Sonderzeichen ausserhalb von Strings/Kommentaren
+    SCAN_BLOCK = 2   // Sonderzeichen im Blockkommentar
+};
+
+const unsigned char *sql_scan_table() {
+    static const std::vector<unsigned char> table = [] {
+        std::vector<unsigned char> t(256, 0);
+        for (unsigned char c : {'-', '/', '\'', '"', ';'}) t[c] |= SCAN_NORMAL;
+        for (unsigned char c : {'*', '/'}) t[c] |= SCAN_BLOCK;
+        return t;
+    }();
+    return table.data();
+}
+
+// Zerlegt einen SQL-Dump blockweise in Statements. Kommentare werden entfernt,
+// Strings (inkl. Backslash-Escapes und verdoppelter Quotes) bleiben unveraendert.
+class SqlStatementSplitter {
+public:
+    // Verarbeitet data[0, size) und liefert die Anzahl verbrauchter Bytes. Ohne last
+    // bleibt das letzte Byte stehen, weil jede Entscheidung das Folgezeichen braucht.
+    size_t feed(const char *data, size_t size, bool last, std::vector<std::string> &out) {
+        const unsigned char *table = sql_scan_table();
+        const size_t limit = last ? size : (size > 0 ? size - 1 : 0);
+        size_t i = 0;
+        while (i < limit) {
+            // Laeufe ohne Sonderzeichen am Stueck ueberspringen bzw. uebernehmen.
+            size_t run = i;
+            if (in_line_comment_) {
+                while (run < limit && data[run] != '\n' && data[run] != '\r') run++;
+            } else if (in_block_comment_) {
+                while (run < limit && !(table[static_cast<unsigned char>(data[run])] & SCAN_BLOCK)) run++;
+            } else if (in_string_) {
+                while (run < limit && data[run] != string_quote_ && data[run] != '\\') run++;
+                stmt_.append(data + i, run - i);
+            } else {
+                while (run < limit && !(table[static_cast<unsigned char>(data[run])] & SCAN_NORMAL)) run++;
+                stmt_.append(data + i, run - i);
+            }
+            i = run;
+            if (i >= limit) break;
+
+            char c = data[i];
+            char n = (i + 1 < size) ? data[i + 1] : '\0';
+            if (!in_string_ && !in_block_comment_ && c == '-' && n == '-') {
+                in_line_comment_ = true;
+                i += 2;
+                continue;
+            }
+            if (!in_string_ && !in_line_comment_ && c == '/' && n == '*') {
+                in_block_comment_ = true;
+                i += 2;
+                continue;
+            }
+            if (in_line_comment_) {
+                if (c == '\n' || c == '\r') {
+                    in_line_comment_ = false;
+                }
+                i++;
+                continue;
+            }
+            if (in_block_comment_) {
+                if (c == '*' && n == '/') {
+                    in_block_comment_ = false;
+                    i++;
+                }
+                i++;
+                continue;
+            }
+            if (in_string_ && c == '\\') {
+                stmt_.push_back(c);
+                if (n != '\0') {
+                    stmt_.push_back(n);
+                    i++;
+                }
+                i++;
+                continue;
+            }
+            if (c == '\'' || c == '"') {
+                if (!in_string_) {
+                    in_string_ = true;
+                    string_quote_ = c;
+                } else if (c == string_quote_) {
+                    if (n == string_quote_) {
+                        stmt_.push_back(c);
+                        stmt_.push_back(n);
+                        i += 2;
+                        continue;
+                    }
+                    in_string_ = false;
+                }
+            }
+            stmt_.push_back(c);
+            i++;
+            if (!in_string_ && c == ';') {
+                out.push_back(std::move(stmt_));
+                stmt_.clear();
+            }
+        }
+        return i;
+    }
+
+private:
+    std::string stmt_;
+    bool in_string_ = false;
+    char string_quote_ = 0;
+    bool in_line_comment_ = false;
+    bool in_block_comment_ = false;
+};
+
+struct SqlDumpStatement {
+    enum Kind { NONE, CREATE_TABLE, CREATE_INDEX, INSERT } kind = NONE;
+    std::string table;
+    std::vector<std::string> columns;
+    DbIndex index;
+    SqlInsert insert;
+    // Vom sequentiellen Schritt gesetzt: Zieltabelle, Feldnamen je Position und
+    // die Anzahl Tabellen, die zu diesem Zeitpunkt fuer FKs sichtbar sind.
+    int table_id = -1;
+    size_t visible_tables = 0;
+    std::vector<std::string> names;
+    std::vector<DbPayload> payloads;
+    std::vector<size_t> fallback_ids;
+};
+
+void strip_quotes_inplace(std::string &s) {
+    if (s.size() >= 2) {
+        char a = s.front();
+        char b = s.back();
+        if ((a == '\'' && b == '\'') || (a == '"' && b == '"')) {
+            s.pop_back();
+            s.erase(0, 1);
+        }
+    }
+}
+
+void parse_dump_statement(const std::string &stmt, SqlDumpStatement &out) {
+    size_t start = 0;
+    while (start < stmt.size() && std::isspace(static_cast<unsigned char>(stmt[start]))) start++;
+    if (ieq_at(stmt, start, "create")) {
+        std::string stmt_trim = trim(stmt);
+        if (parse_create_table_statement(stmt_trim, out.table, out.columns)) {
+            out.kind = SqlDumpStatement::CREATE_TABLE;
+            return;
+        }
+        bool if_not_exists = false;
+        if (parse_create_index_statement(stmt_trim, out.index, if_not_exists)) {
+            out.kind = SqlDumpStatement::CREATE_INDEX;
+            return;
+        }
+    }
+    if (parse_insert_statement(stmt, out.insert) || parse_insert_statement_lenient(stmt, out.insert)) {
+        out.kind = SqlDumpStatement::INSERT;
+    }
+}
+
+void build_dump_payloads(const DbWorld &world, SqlDumpStatement &st) {
+    const bool explicit_columns = !st.insert.columns.empty();
+    int id_column = -1;
+    std::vector<std::pair<size_t, int>> fk_columns;
+    for (size_t ci = 0; ci < st.names.size(); ++ci) {
+        const std::string &name = st.names[ci];
+        if (id_column < 0 && ieq(name, "id")) {
+            id_column = static_cast<int>(ci);
+        }
+        if (!ends_with_id(name)) continue;
+        int fk_table_id = db_find_table(world, fk_table_from_column(name));
+        if (fk_table_id >= 0 && static_cast<size_t>(fk_table_id) < st.visible_tables) {
+            fk_columns.emplace_back(ci, fk_table_id);
+        }
+    }
+    st.payloads.reserve(st.insert.rows.size());
+    for (auto &row : st.insert.rows) {
+        if (explicit_columns && row.size() != st.names.size()) {
+            continue;
+        }
+        DbPayload payload;
+        payload.table_id = st.table_id;
+        payload.fields.reserve(row.size());
+        for (size_t ci = 0; ci < row.size(); ++ci) {
+            DbField field;
+            field.name = st.names[ci];
+            field.value = std::move(row[ci]);
+            strip_quotes_inplace(field.value);
+            payload.fields.push_back(std::move(field));
+        }
+        int id_value = 0;
+        bool found_id = false;
+        if (id_column >= 0 && static_cast<size_t>(id_column) < payload.fields.size()) {
+            found_id = parse_int_value(payload.fields[static_cast<size_t>(id_column)].value, id_value);
+        }
+        if (!found_id && !payload.fields.empty()) {
+            found_id = parse_int_value(payload.fields.front().value, id_value);
+        }
+        if (!found_id) {
+            st.fallback_ids.push_back(st.payloads.size());
+        }
+        payload.id = id_value;
+        for (const auto &fk_col : fk_columns) {
+            if (fk_col.first >= payload.fields.size()) break;
+            const DbField &f = payload.fields[fk_col.first];
+            int fk_id = 0;
+            if (!parse_int_value(f.value, fk_id)) continue;
+            DbForeignKey fk;
+            fk.table_id = fk_col.second;
+            fk.id = fk_id;
+            fk.column = f.name;
+            payload.foreign_keys.push_back(fk);
+        }
+        payload.raw_data = build_raw_data(payload.fields);
+        st.payloads.push_back(std::move(payload));
+    }
+    st.insert.rows.clear();
+    st.insert.rows.shrink_to_fit();
+}
+
+// Ein Statement-Block: parallel parsen, Schema und Tabellen in Dateireihenfolge
+// anwenden, Payloads parallel aufbauen und in Reihenfolge anhaengen.
+void load_sql_batch(DbWorld &world, std::vector<std::string> &batch, WorkerPool &pool) {
+    std::vector<SqlDumpStatement> parsed(batch.size());
+    pool.run(batch.size(), [&](size_t i) {
+        parse_dump_statement(batch[i], parsed[i]);
+        std::string().swap(batch[i]);
+    });
+
+    std::vector<size_t> inserts;
+    for (size_t i = 0; i < parsed.size(); ++i) {
+        SqlDumpStatement &st = parsed[i];
+        if (st.kind == SqlDumpStatement::CREATE_TABLE) {
+            int table_id = db_add_table(world, st.table);
+            if (!st.columns.empty()) {
+                world.table_columns[static_cast<size_t>(table_id)] = st.columns;
+            }
+        } else if (st.kind == SqlDumpStatement::CREATE_INDEX) {
+            int table_id = db_add_table(world, st.index.table);
+            st.index.table = world.table_names[static_cast<size_t>(table_id)];
+            std::string key = to_lower(st.index.name);
+            world.indexes[key] = DbCow<DbIndex>(std::move(st.index));
+        } else if (st.kind == SqlDumpStatement::INSERT) {
+            st.table_id = db_add_table(world, st.insert.table);
+            auto &schema = world.table_columns[static_cast<size_t>(st.table_id)];
+            if (!st.insert.columns.empty()) {
+                if (schema.empty()) {
+                    schema = st.insert.columns;
+                }
+                st.names = st.insert.columns;
+            } else {
+                size_t width = 0;
+                for (const auto &row : st.insert.rows) width = std::max(width, row.size());
+                st.names.reserve(width);
+                for (size_t ci = 0; ci < width; ++ci) {
+                    st.names.push_back(ci < schema.size() ? schema[ci] : "col" + std::to_string(ci));
+                }
+            }
+            st.visible_tables = world.table_names.size();
+            inserts.push_back(i);
+        }
+    }
+
+    pool.run(inserts.size(), [&](size_t k) {
+        build_dump_payloads(world, parsed[inserts[k]]);
+    });
+
+    for (size_t k : inserts) {
+        SqlDumpStatement &st = parsed[k];
+        size_t base = world.payloads.size();
+        for (size_t local : st.fallback_ids) {
+            st.payloads[local].id = static_cast<int>(base + local) + 1;
+        }
+        for (auto &payload : st.payloads) {
+            world.payloads.push_back(std::move(payload));
+        }
+    }
+}
+// Platzierung ohne Pruefungen; der Aufrufer stellt sicher, dass die Zelle frei bzw.
+// bereits fuer dieses Payload reserviert ist.
+void commit_placement(DbWorld &world, int payload_index, int x, int y) {
+    size_t idx = static_cast<size_t>(y) * world.width + x;
+    DbPayload &payload = world.payloads.mut(static_cast<size_t>(payload_index));
+    payload.x = x;
+    payload.y = y;
+    payload.placed = true;
+    mark_columns_dirty(world, payload.table_id);
+    world.tile_index.reset();
+    world.cell_payload.edit()[idx] = payload_index;
+    world.data_density.at(x, y) = 1.0f;
+    if (payload.table_id >= 0 && payload.table_id < static_cast<int>(world.table_pheromones.size())) {
+        world.table_pheromones[static_cast<size_t>(payload.table_id)].at(x, y) += 1.0f;
+    }
+    world.payload_positions[make_payload_key(payload.table_id, payload.id)] = {x, y};
+}
+
+void build_tile_index(DbWorld &world) {
+    auto built = std::make_shared<DbTileIndex>();
+    DbTileIndex &tiles = *built;
+    const std::vector<int> &cells = *world.cell_payload;
+    tiles.tiles_x = (std::max(0, world.width) + kDbTileSize - 1) / kDbTileSize;
+    tiles.tiles_y = (std::max(0, world.height) + kDbTileSize - 1) / kDbTileSize;
+    tiles.table_words = (world.table_names.size() + 63) / 64;
+    tiles.table_bits.assign(static_cast<size_t>(tiles.tiles_x) * tiles.tiles_y * tiles.table_words, 0);
+    if (cells.size() == static_cast<size_t>(std::max(0, world.width)) * std::max(0, world.height)) {
+        for (int y = 0; y < world.height; ++y) {
+            size_t tile_row = static_cast<size_t>(y / kDbTileSize) * tiles.tiles_x;
+            for (int x = 0; x < world.width; ++x) {
+                int idx = cells[static_cast<size_t>(y) * world.width + x];
+                if (idx < 0 || idx >= static_cast<int>(world.payloads.size())) continue;
+                int table_id = world.payloads[static_cast<size_t>(idx)].table_id;
+                if (table_id < 0 || static_cast<size_t>(table_id) >= tiles.table_words * 64) continue;
+                size_t tile = tile_row + static_cast<size_t>(x / kDbTileSize);
+                tiles.table_bits[tile * tiles.table_words + static_cast<size_t>(table_id) / 64] |=
+                    uint64_t(1) << (table_id % 64);
+            }
+        }
+    }
+    world.tile_index = std::move(built);
+}
+
+// Calls fn(payload_index, x, y) for every occupied cell of the box in row-major order. With a
+// current tile index, tiles without a payload of `table_id` are skipped.
+template <typename Fn>
+void scan_table_cells(const DbWorld &world, int table_id, int x0, int y0, int x1, int y1, Fn &&fn) {
+    x0 = std::max(0, x0);
+    y0 = std::max(0, y0);
+    x1 = std::min(world.width - 1, x1);
+    y1 = std::min(world.height - 1, y1);
+    if (x0 > x1 || y0 > y1) return;
+    static const DbTileIndex no_tiles;
+    const DbTileIndex &tiles = world.tile_index ? *world.tile_index : no_tiles;
+    const std::vector<int> &cells = *world.cell_payload;
+    bool use_tiles = world.tile_index && table_id >= 0;
+    size_t word = static_cast<size_t>(std::max(0, table_id)) / 64;
+    uint64_t bit = uint64_t(1) << (std::max(0, table_id) % 64);
+    if (use_tiles && word >= tiles.table_words) return;
+    for (int y = y0; y <= y1; ++y) {
+        size_t tile_row = static_cast<size_t>(y / kDbTileSize) * tiles.tiles_x;
+        for (int tx = x0 / kDbTileSize; tx <= x1 / kDbTileSize; ++tx) {
+            if (use_tiles && !(tiles.table_bits[(tile_row + tx) * tiles.table_words + word] & bit)) continue;
+            int xa = std::max(x0, tx * kDbTileSize);
+            int xb = std::min(x1, tx * kDbTileSize + kDbTileSize - 1);
+            for (int x = xa; x <= xb; ++x) {
+                int idx = cells[static_cast<size_t>(y) * world.width + x];
+                if (idx >= 0 && idx < static_cast<int>(world.payloads.size())) fn(idx, x, y);
+            }
+        }
+    }
+}
+} // namespace
+
+DbPayload &DbPayloadList::mut(size_t i) {
+    if (i >= base_size_) return own_[i - base_size_];
+    if (base_.use_count() > 1) base_ = std::make_shared<std::vector<DbPayload>>(*base_);
+    return (*base_)[i];
+}
+
+void DbPayloadList::resize(size_t count) {
+    if (count >= base_size_) {
+        own_.resize(count - base_size_);
+        return;
+    }
+    std::vector<DbPayload> rows = release();
+    rows.resize(count);
+    own_ = std::move(rows);
+}
+
+void DbPayloadList::clear() {
+    base_.reset();
+    base_size_ = 0;
+    own_.clear();
+}
+
+void DbPayloadList::assign(std::vector<DbPayload> rows) {
+    clear();
+    own_ = std::move(rows);
+}
+
+std::vector<DbPayload> DbPayloadList::release() {
+    std::vector<DbPayload> rows;
+    if (base_) {
+        if (base_.use_count() == 1) {
+            rows = std::move(*base_);
+        } else {
+            rows = *base_;
+        }
+    }
+    rows.reserve(rows.size() + own_.size());
+    std::move(own_.begin(), own_.end(), std::back_inserter(rows));
+    clear();
+    return rows;
+}
+
+void DbPayloadList::share_base(size_t count) {
+    count = std::min(count, size());
+    if (count <= base_size_) return;
+    std::shared_ptr<std::vector<DbPayload>> block;
+    if (base_ && base_.use_count() == 1) {
+        block = std::move(base_);
+    } else {
+        block = std::make_shared<std::vector<DbPayload>>();
+        if (base_) *block = *base_;
+    }
+    size_t take = count - base_size_;
+    block->reserve(count);
+    std::move(own_.begin(), own_.begin() + static_cast<std::ptrdiff_t>(take), std::back_inserter(*block));
+    own_.erase(own_.begin(), own_.begin() + static_cast<std::ptrdiff_t>(take));
+    base_ = std::move(block);
+    base_size_ = count;
+}
+
+int db_add_table(DbWorld &world, const std::string &name) {
+    std::string key = to_lower(name);
+    auto it = world.table_lookup.find(key);
+    if (it != world.table_lookup.end()) {
+        return it->second;
+    }
+    int id = static_cast<int>(world.table_names.size());
+    world.table_lookup[key] = id;
+    world.table_names.push_back(name);
+    world.table_columns.emplace_back();
+    world.table_payloads.resize(world.table_names.size());
+    world.table_max_id.resize(world.table_names.size(), 0);
+    world.table_store.resize(world.table_names.size());
+    if (world.width > 0 && world.height > 0) {
+        world.table_pheromones.emplace_back(world.width, world.height, 0.0f);
+    }
+    return id;
+}
+
+int64_t db_payload_key(int table_id, int id) {
+    return make_payload_key(table_id, id);
+}
+
+int db_find_payload(const DbWorld &world, int table_id, int id) {
+    int64_t key = make_payload_key(table_id, id);
+    if (payload_tombstoned(world, key)) return -1;
+    auto dit = world.delta_index_by_key.find(key);
+    if (dit != world.delta_index_by_key.end()) return dit->second;
+    return base_payload_index(world, key);
+}
+
+size_t db_delta_count(const DbWorld &world) {
+    size_t count = 0;
+    for (const auto &pair : world.delta_index_by_key) {
+        if (world.tombstones.find(pair.first) == world.tombstones.end()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool db_has_pending_delta(const DbWorld &world) {
+    return !world.tombstones.empty() || !world.delta_index_by_key.empty();
+}
+
+int db_find_table(const DbWorld &world, const std::string &name) {
+    std::string key = to_lower(name);
+    auto it = world.table_lookup.find(key);
+    if (it != world.table_lookup.end()) {
+        return it->second;
+    }
+    return -1;
+}
+
+const std::vector<int> &db_table_payloads(const DbWorld &world, int table_id) {
+    static const std::vector<int> empty;
+    if (table_id < 0 || table_id >= static_cast<int>(world.table_payloads.size())) {
+        return empty;
+    }
+    return world.table_payloads[static_cast<size_t>(table_id)];
+}
+
+void db_rebuild_table_payloads(DbWorld &world) {
+    world.table_payloads.assign(world.table_names.size(), std::vector<int>{});
+    world.table_max_id.assign(world.table_names.size(), 0);
+    world.table_store.assign(world.table_names.size(), nullptr);
     for (size_t i = 0; i < world.payloads.size(); ++i) {
-        pending.push_back(static_cast<int>(i));
+        track_payload(world, static_cast<int>(i));
+    }
+    rebuild_payload_status(world);
+}
+
+void db_refresh_column_store(DbWorld &world) {
+    if (world.table_store.size() < world.table_names.size()) {
+        world.table_store.resize(world.table_names.size());
+    }
+    for (size_t t = 0; t < world.table_store.size(); ++t) {
+        if (!world.table_store[t]) {
+            auto store = std::make_shared<DbColumnTable>();
+            build_column_table(world, static_cast<int>(t), *store);
+            world.table_store[t] = std::move(store);
+        }
+    }
+    if (!world.tile_index) {
+        build_tile_index(world);
+    }
+}
+
+const DbColumnTable *db_column_table(const DbWorld &world, int table_id) {
+    if (table_id < 0 || table_id >= static_cast<int>(world.table_store.size())) {
+        return nullptr;
+    }
+    return world.table_store[static_cast<size_t>(table_id)].get();
+}
+
+void db_parallel_for(size_t count, int threads, const std::function<void(size_t)> &fn) {
+    unsigned workers = worker_thread_count(threads);
+    if (count < 2 || workers < 2) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    WorkerPool pool(static_cast<unsigned>(std::min<size_t>(workers, count)));
+    pool.run(count, fn);
+}
+
+bool db_focus_payloads(const DbWorld &world, int table_id, int cx, int cy, int radius, std::vector<int> &out) {
+    if (!world.tile_index || table_id < 0 || table_id >= static_cast<int>(world.table_payloads.size())) {
+        return false;
+    }
+    int reach = std::abs(radius);
+    int64_t side_x = std::max(0, std::min(world.width - 1, cx + reach) - std::max(0, cx - reach) + 1);
+    int64_t side_y = std::max(0, std::min(world.height - 1, cy + reach) - std::max(0, cy - reach) + 1);
+    if (side_x * side_y > static_cast<int64_t>(world.table_payloads[static_cast<size_t>(table_id)].size())) {
+        return false;
+    }
+    out.clear();
+    int64_t r2 = static_cast<int64_t>(radius) * radius;
+    scan_table_cells(world, table_id, cx - reach, cy - reach, cx + reach, cy + reach, [&](int idx, int, int) {
+        const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
+        if (p.table_id != table_id || p.is_delta || !p.placed) return;
+        int64_t dx = p.x - cx;
+        int64_t dy = p.y - cy;
+        if (dx * dx + dy * dy > r2) return;
+        if (db_payload_hidden(world, idx)) return;
+        out.push_back(idx);
+    });
+    // Deltas are not placed and stay visible regardless of the focus.
+    for (const auto &entry : world.delta_index_by_key) {
+        const DbPayload &p = world.payloads[static_cast<size_t>(entry.second)];
+        if (p.table_id != table_id || db_payload_hidden(world, entry.second)) continue;
+        out.push_back(entry.second);
+    }
+    std::sort(out.begin(), out.end());
+    return true;
+}
+
+void db_init_world(DbWorld &world, int width, int height) {
+    world.width = width;
+    world.height = height;
+    world.cell_payload = DbCow<std::vector<int>>(std::vector<int>(static_cast<size_t>(width) * height, -1));
+    world.tile_index.reset();
+    world.table_pheromones.clear();
+    world.table_pheromones.reserve(world.table_names.size());
+    for (size_t i = 0; i < world.table_names.size(); ++i) {
+        world.table_pheromones.emplace_back(width, height, 0.0f);
+    }
+    world.data_density = GridField(width, height, 0.0f);
+    world.mycel = MycelNetwork(width, height);
+    world.payload_positions.clear();
+}
+
+bool db_place_payload(DbWorld &world, int payload_index, int x, int y) {
+    if (payload_index < 0 || payload_index >= static_cast<int>(world.payloads.size())) {
+        return false;
+    }
+    if (x < 0 || y < 0 || x >= world.width || y >= world.height) {
+        return false;
+    }
+    size_t idx = static_cast<size_t>(y) * world.width + x;
+    if ((*world.cell_payload)[idx] >= 0) {
+        return false;
+    }
+    commit_placement(world, payload_index, x, y);
+    return true;
+}
+
+bool db_load_sql(const std::string &path, DbWorld &world, std::string &error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        error = "SQL-Datei konnte nicht geoeffnet werden: " + path;
+        return false;
+    }
+    // Datei blockweise lesen; vollstaendige Statements werden gesammelt und
+    // blockweise geparst, damit der Speicher unabhaengig von der Dumpgroesse bleibt.
+    SqlStatementSplitter splitter;
+    WorkerPool pool(worker_thread_count(0));
+    std::unique_ptr<char[]> buffer(new char[kSqlLoadChunkBytes + 1]);
+    size_t filled = 0;
+    uint64_t total_read = 0;
+    std::vector<std::string> batch;
+    size_t batch_bytes = 0;
+    for (;;) {
+        in.read(buffer.get() + filled, static_cast<std::streamsize>(kSqlLoadChunkBytes));
+        size_t got = static_cast<size_t>(in.gcount());
+        if (in.bad()) {
+            error = "SQL-Datei konnte nicht gelesen werden: " + path;
+            return false;
+        }
+        total_read += got;
+        filled += got;
+        bool last = got < kSqlLoadChunkBytes;
+        size_t before = batch.size();
+        size_t used = splitter.feed(buffer.get(), filled, last, batch);
+        for (size_t k = before; k < batch.size(); ++k) batch_bytes += batch[k].size();
+        std::memmove(buffer.get(), buffer.get() + used, filled - used);
+        filled -= used;
+        if (last || batch_bytes >= kSqlLoadBatchBytes) {
+            load_sql_batch(world, batch, pool);
+            batch.clear();
+            batch_bytes = 0;
+        }
+        if (last) break;
+    }
+    if (total_read == 0) {
+        error = "SQL-Datei ist leer.";
+        return false;
+    }
+    if (world.payloads.empty()) {
+        error = "Keine INSERT-Statements gefunden.";
+        return false;
     }
+    db_rebuild_table_payloads(world);
+    db_rebuild_indexes(world);
+    return true;
+}
+
+namespace {
+bool prepare_ingest_rules(const DbIngestConfig &cfg, IngestRules &ingest_rules, std::string &error) {
+    if (!cfg.rules_path.empty()) {
+        std::string rules_error;
+        if (!load_ingest_rules(cfg.rules_path, ingest_rules, rules_error)) {
+            error = "Ingest-Regeln: " + rules_error;
+            return false;
+        }
+    }
+    if (ingest_rules.default_rules.empty()) {
+        IngestRule rule;
+        rule.pattern = ".*_id$";
+        rule.pattern_rule = true;
+        rule.weight = 1.0;
+        rule.type = "foreign_key";
+        rule.pattern_re = std::regex(rule.pattern, std::regex::icase);
+        ingest_rules.default_rules.push_back(std::move(rule));
+    }
+    return true;
+}
+
+// Naechste freie Zelle in wachsenden Ringen um (cx, cy).
+bool find_empty_nearest(const DbWorld &world, int cx, int cy, int &out_x, int &out_y) {
+    int max_r = std::max(world.width, world.height);
+    for (int r = 0; r <= max_r; ++r) {
+        for (int y = cy - r; y <= cy + r; ++y) {
+            if (y < 0 || y >= world.height) continue;
+            bool edge_row = (y == cy - r || y == cy + r);
+            for (int x = cx - r; x <= cx + r; x += (edge_row || r == 0) ? 1 : 2 * r) {
+                if (x < 0 || x >= world.width) continue;
+                if ((*world.cell_payload)[static_cast<size_t>(y) * world.width + x] < 0) {
+                    out_x = x;
+                    out_y = y;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Carrier-Simulation fuer die Payloads in pending. Voller Ingest: leere Welt, was am Ende
+// noch fehlt, wird zufaellig verteilt. Inkrementell: bestehende Platzierungen bleiben,
+// Agenten starten am FK/Trait-Zentrum ihres Payloads, der Rest landet auf der naechsten
+// freien Zelle; Pheromon/Mycel werden dabei nicht weitergerechnet.
+bool run_carrier_ingest(DbWorld &world,
+                        const DbIngestConfig &cfg,
+                        const IngestRules &ingest_rules,
+                        const std::vector<int> &pending,
+                        bool incremental,
+                        std::string &error) {
+    Rng rng(cfg.seed);
+    int spawn_x = cfg.spawn_x >= 0 ? cfg.spawn_x : world.width / 2;
+    int spawn_y = cfg.spawn_y >= 0 ? cfg.spawn_y : world.height / 2;
+    WorkerPool pool(worker_thread_count(cfg.threads));
     size_t pending_index = 0;
 
+    // Jeder Agent hat einen eigenen Zufallsstrom, damit das Layout nicht von der
+    // Reihenfolge der Threads abhaengt.
+    int agent_count = cfg.agent_count;
+    if (incremental) {
+        agent_count = std::max(1, std::min(agent_count, static_cast<int>(pending.size())));
+    }
     std::vector<DbCarrierAgent> agents;
-    agents.reserve(cfg.agent_count);
-    for (int i = 0; i < cfg.agent_count; ++i) {
+    std::vector<Rng> agent_rngs;
+    agents.reserve(agent_count);
+    agent_rngs.reserve(agent_count);
+    for (int i = 0; i < agent_count; ++i) {
         DbCarrierAgent a;
         a.x = static_cast<float>(spawn_x);
         a.y = static_cast<float>(spawn_y);
         agents.push_back(a);
+        agent_rngs.emplace_back(cfg.seed + 0x9E3779B9u * static_cast<uint32_t>(i + 1));
     }
 
     struct TraitCenter {
@@ -1368,7 +2293,9 @@ bool db_run_ingest(DbWorld &world, const DbIngestConfig &cfg, std::string &error
         double sum_y = 0.0;
         double sum_w = 0.0;
     };
-    std::unordered_map<std::string, TraitCenter> trait_centers;
+    std::vector<TraitCenter> trait_centers;
+    std::unordered_map<std::string, int> trait_ids;
+    std::unordered_map<const IngestRule *, std::unordered_map<std::string, bool>> name_matches;
 
     auto trait_key = [&](const std::string &table, const std::string &column, const std::string &value) {
         return to_lower(table) + ":" + to_lower(column) + ":" + to_lower(value);
@@ -1388,203 +2315,277 @@ bool db_run_ingest(DbWorld &world, const DbIngestConfig &cfg, std::string &error
         out = value.substr(at + 1);
         return true;
     };
+    auto rule_matches = [&](const IngestRule &rule, const std::string &name) {
+        auto &cache = name_matches[&rule];
+        auto it = cache.find(name);
+        if (it == cache.end()) {
+            it = cache.emplace(name, std::regex_match(name, rule.pattern_re)).first;
+        }
+        return it->second;
+    };
 
-    GridField phero_accum(world.width, world.height, 0.0f);
-    FieldParams pheromone_params{0.02f, 0.15f};
-
-    for (int step = 0; step < cfg.steps; ++step) {
-        for (auto &agent : agents) {
-            if (agent.payload_index < 0) {
-                if (pending_index < pending.size()) {
-                    agent.payload_index = pending[pending_index++];
-                } else {
-                    continue;
-                }
-            }
-            DbPayload &payload = world.payloads[static_cast<size_t>(agent.payload_index)];
-            if (payload.placed) {
-                agent.payload_index = -1;
-                continue;
-            }
-            bool has_target = false;
-            int tx = spawn_x;
-            int ty = spawn_y;
-            double sum_x = 0.0;
-            double sum_y = 0.0;
-            double sum_w = 0.0;
-            auto add_target = [&](int x, int y, double weight) {
-                if (weight <= 0.0) return;
-                sum_x += static_cast<double>(x) * weight;
-                sum_y += static_cast<double>(y) * weight;
-                sum_w += weight;
-            };
-            for (const auto &fk : payload.foreign_keys) {
-                int64_t key = make_payload_key(fk.table_id, fk.id);
-                auto it = world.payload_positions.find(key);
-                if (it != world.payload_positions.end()) {
-                    add_target(it->second.first, it->second.second, 1.0);
-                }
-            }
-            const std::string table_name = (payload.table_id >= 0 &&
-                                            payload.table_id < static_cast<int>(world.table_names.size()))
-                                             ? world.table_names[static_cast<size_t>(payload.table_id)]
-                                             : std::string();
-            auto table_it = ingest_rules.table_rules.find(to_lower(table_name));
-
-            auto apply_rule = [&](const IngestRule &rule, const std::string &column, const std::string &value) {
-                if (rule.type == "foreign_key") {
-                    int fk_id = 0;
-                    if (!parse_int_value(value, fk_id)) return;
-                    std::string fk_table = fk_table_from_column(column);
-                    int fk_table_id = db_find_table(world, fk_table);
-                    if (fk_table_id < 0) return;
-                    int64_t key = make_payload_key(fk_table_id, fk_id);
-                    auto it = world.payload_positions.find(key);
-                    if (it != world.payload_positions.end()) {
-                        add_target(it->second.first, it->second.second, rule.weight);
-                    }
-                    return;
-                }
+    // Einmal pro Payload beim Aufnehmen: FK-Ziele und greifende Regeln aufloesen.
+    auto build_plan = [&](int payload_index, std::vector<int64_t> &fk_keys, std::vector<IngestHit> &hits) {
+        const DbPayload &payload = world.payloads[static_cast<size_t>(payload_index)];
+        fk_keys.clear();
+        hits.clear();
+        for (const auto &fk : payload.foreign_keys) {
+            fk_keys.push_back(make_payload_key(fk.table_id, fk.id));
+        }
+        const std::string table_name = (payload.table_id >= 0 &&
+                                        payload.table_id < static_cast<int>(world.table_names.size()))
+                                         ? world.table_names[static_cast<size_t>(payload.table_id)]
+                                         : std::string();
+        auto add_hit = [&](const IngestRule &rule, const std::string &column, const std::string &value) {
+            IngestHit hit;
+            hit.rule = &rule;
+            if (rule.type == "foreign_key") {
+                int fk_id = 0;
+                if (!parse_int_value(value, fk_id)) return;
+                int fk_table_id = db_find_table(world, fk_table_from_column(column));
+                if (fk_table_id < 0) return;
+                hit.foreign_key = true;
+                hit.fk_key = make_payload_key(fk_table_id, fk_id);
+            } else {
                 std::string key_value = value;
                 if (rule.type == "domain_cluster") {
                     if (!resolve_domain(value, key_value)) return;
                 }
-                const std::string key = trait_key(table_name, column, key_value);
-                auto it = trait_centers.find(key);
-                if (it != trait_centers.end() && it->second.sum_w > 0.0) {
-                    int cx = static_cast<int>(std::round(it->second.sum_x / it->second.sum_w));
-                    int cy = static_cast<int>(std::round(it->second.sum_y / it->second.sum_w));
-                    add_target(cx, cy, rule.weight);
+                auto inserted = trait_ids.emplace(trait_key(table_name, column, key_value),
+                                                  static_cast<int>(trait_centers.size()));
+                if (inserted.second) {
+                    trait_centers.emplace_back();
                 }
-            };
-
-            for (const auto &rule : ingest_rules.default_rules) {
+                hit.trait = inserted.first->second;
+            }
+            hits.push_back(hit);
+        };
+        auto add_rules = [&](const std::vector<IngestRule> &rules) {
+            for (const auto &rule : rules) {
                 if (rule.pattern_rule) {
                     for (const auto &f : payload.fields) {
-                        if (std::regex_match(f.name, rule.pattern_re)) {
-                            apply_rule(rule, f.name, f.value);
+                        if (rule_matches(rule, f.name)) {
+                            add_hit(rule, f.name, f.value);
                         }
                     }
                 } else if (!rule.column.empty()) {
-                    std::string value;
-                    if (get_field_value(payload, rule.column, value)) {
-                        apply_rule(rule, rule.column, value);
-                    }
-                }
-            }
-            if (table_it != ingest_rules.table_rules.end()) {
-                for (const auto &rule : table_it->second) {
-                    if (rule.pattern_rule) {
-                        for (const auto &f : payload.fields) {
-                            if (std::regex_match(f.name, rule.pattern_re)) {
-                                apply_rule(rule, f.name, f.value);
-                            }
-                        }
-                    } else if (!rule.column.empty()) {
-                        std::string value;
-                        if (get_field_value(payload, rule.column, value)) {
-                            apply_rule(rule, rule.column, value);
-                        }
+                    std::string value;
+                    if (get_field_value(payload, rule.column, value)) {
+                        add_hit(rule, rule.column, value);
                     }
                 }
             }
-            if (sum_w > 0.0) {
-                tx = static_cast<int>(std::round(sum_x / sum_w));
-                ty = static_cast<int>(std::round(sum_y / sum_w));
-                has_target = true;
+        };
+        add_rules(ingest_rules.default_rules);
+        auto table_it = ingest_rules.table_rules.find(to_lower(table_name));
+        if (table_it != ingest_rules.table_rules.end()) {
+            add_rules(table_it->second);
+        }
+    };
+
+    // Gewichtetes Zentrum aus FK-Zielen und Trait-Zentren; false ohne Ziel.
+    auto compute_target = [&](const std::vector<int64_t> &fk_keys, const std::vector<IngestHit> &hits,
+                              int &tx, int &ty) {
+        double sum_x = 0.0;
+        double sum_y = 0.0;
+        double sum_w = 0.0;
+        auto add_target = [&](int x, int y, double weight) {
+            if (weight <= 0.0) return;
+            sum_x += static_cast<double>(x) * weight;
+            sum_y += static_cast<double>(y) * weight;
+            sum_w += weight;
+        };
+        for (int64_t key : fk_keys) {
+            auto it = world.payload_positions.find(key);
+            if (it != world.payload_positions.end()) {
+                add_target(it->second.first, it->second.second, 1.0);
             }
-            float dx = static_cast<float>(tx) - agent.x;
-            float dy = static_cast<float>(ty) - agent.y;
-            float dist = std::sqrt(dx * dx + dy * dy);
-            if (dist > 0.001f) {
-                float step_len = 1.0f;
-                float jitter = rng.uniform(-0.35f, 0.35f);
-                agent.x += (dx / dist) * step_len + jitter;
-                agent.y += (dy / dist) * step_len + jitter;
-            } else {
-                agent.x += rng.uniform(-1.0f, 1.0f);
-                agent.y += rng.uniform(-1.0f, 1.0f);
-            }
-            int cx = std::max(0, std::min(world.width - 1, static_cast<int>(std::round(agent.x))));
-            int cy = std::max(0, std::min(world.height - 1, static_cast<int>(std::round(agent.y))));
-            int place_x = -1;
-            int place_y = -1;
-            bool allow_place = has_target ? (dist <= 2.5f) : (rng.uniform(0.0f, 1.0f) < 0.1f);
-            if (allow_place && find_empty_near(world, cx, cy, 2, place_x, place_y)) {
-                db_place_payload(world, agent.payload_index, place_x, place_y);
-                for (const auto &rule : ingest_rules.default_rules) {
-                    if (rule.type == "foreign_key") continue;
-                    if (rule.pattern_rule) {
-                        for (const auto &f : payload.fields) {
-                            if (!std::regex_match(f.name, rule.pattern_re)) continue;
-                            std::string key_value = f.value;
-                            if (rule.type == "domain_cluster") {
-                                if (!resolve_domain(f.value, key_value)) continue;
-                            }
-                            const std::string key = trait_key(table_name, f.name, key_value);
-                            auto &center = trait_centers[key];
-                            center.sum_x += place_x * rule.weight;
-                            center.sum_y += place_y * rule.weight;
-                            center.sum_w += rule.weight;
-                        }
-                    } else if (!rule.column.empty()) {
-                        std::string value;
-                        if (!get_field_value(payload, rule.column, value)) continue;
-                        std::string key_value = value;
-                        if (rule.type == "domain_cluster") {
-                            if (!resolve_domain(value, key_value)) continue;
-                        }
-                        const std::string key = trait_key(table_name, rule.column, key_value);
-                        auto &center = trait_centers[key];
-                        center.sum_x += place_x * rule.weight;
-                        center.sum_y += place_y * rule.weight;
-                        center.sum_w += rule.weight;
-                    }
+        }
+        for (const auto &hit : hits) {
+            if (hit.foreign_key) {
+                auto it = world.payload_positions.find(hit.fk_key);
+                if (it != world.payload_positions.end()) {
+                    add_target(it->second.first, it->second.second, hit.rule->weight);
                 }
-                if (table_it != ingest_rules.table_rules.end()) {
-                    for (const auto &rule : table_it->second) {
-                        if (rule.type == "foreign_key") continue;
-                        if (rule.pattern_rule) {
-                            for (const auto &f : payload.fields) {
-                                if (!std::regex_match(f.name, rule.pattern_re)) continue;
-                                std::string key_value = f.value;
-                                if (rule.type == "domain_cluster") {
-                                    if (!resolve_domain(f.value, key_value)) continue;
-                                }
-                                const std::string key = trait_key(table_name, f.name, key_value);
-                                auto &center = trait_centers[key];
-                                center.sum_x += place_x * rule.weight;
-                                center.sum_y += place_y * rule.weight;
-                                center.sum_w += rule.weight;
-                            }
-                        } else if (!rule.column.empty()) {
-                            std::string value;
-                            if (!get_field_value(payload, rule.column, value)) continue;
-                            std::string key_value = value;
-                            if (rule.type == "domain_cluster") {
-                                if (!resolve_domain(value, key_value)) continue;
-                            }
-                            const std::string key = trait_key(table_name, rule.column, key_value);
-                            auto &center = trait_centers[key];
-                            center.sum_x += place_x * rule.weight;
-                            center.sum_y += place_y * rule.weight;
-                            center.sum_w += rule.weight;
-                        }
-                    }
+                continue;
+            }
+            const TraitCenter &center = trait_centers[static_cast<size_t>(hit.trait)];
+            if (center.sum_w > 0.0) {
+                int cx = static_cast<int>(std::round(center.sum_x / center.sum_w));
+                int cy = static_cast<int>(std::round(center.sum_y / center.sum_w));
+                add_target(cx, cy, hit.rule->weight);
+            }
+        }
+        if (sum_w <= 0.0) return false;
+        tx = static_cast<int>(std::round(sum_x / sum_w));
+        ty = static_cast<int>(std::round(sum_y / sum_w));
+        return true;
+    };
+
+    // Bewegung eines Agenten; liest nur Positionen/Trait-Zentren vom Schrittbeginn.
+    auto move_agent = [&](size_t ai) {
+        DbCarrierAgent &agent = agents[ai];
+        agent.want_place = false;
+        agent.place_x = -1;
+        agent.place_y = -1;
+        if (agent.payload_index < 0) return;
+        Rng &agent_rng = agent_rngs[ai];
+        int tx = spawn_x;
+        int ty = spawn_y;
+        bool has_target = compute_target(agent.fk_keys, agent.hits, tx, ty);
+        float dx = static_cast<float>(tx) - agent.x;
+        float dy = static_cast<float>(ty) - agent.y;
+        float dist = std::sqrt(dx * dx + dy * dy);
+        if (dist > 0.001f) {
+            float step_len = 1.0f;
+            float jitter = agent_rng.uniform(-0.35f, 0.35f);
+            agent.x += (dx / dist) * step_len + jitter;
+            agent.y += (dy / dist) * step_len + jitter;
+        } else {
+            agent.x += agent_rng.uniform(-1.0f, 1.0f);
+            agent.y += agent_rng.uniform(-1.0f, 1.0f);
+        }
+        agent.cell_x = std::max(0, std::min(world.width - 1, static_cast<int>(std::round(agent.x))));
+        agent.cell_y = std::max(0, std::min(world.height - 1, static_cast<int>(std::round(agent.y))));
+        agent.want_place = has_target ? (dist <= 2.5f) : (agent_rng.uniform(0.0f, 1.0f) < 0.1f);
+    };
+
+    const int band_count = (world.height + kIngestBandRows - 1) / kIngestBandRows;
+    // Detached once up front; the band workers below write cells in parallel.
+    std::vector<int> &cells = world.cell_payload.edit();
+    std::vector<std::vector<int>> band_agents(static_cast<size_t>(band_count));
+    std::vector<int> active_bands;
+    const size_t agent_block = 64;
+    const size_t agent_blocks = (agents.size() + agent_block - 1) / agent_block;
+
+    GridField phero_counts(world.width, world.height, 0.0f);
+    GridField phero_accum(world.width, world.height, 0.0f);
+    FieldParams pheromone_params{0.02f, 0.15f};
+
+    bool has_trait_rules = false;
+    auto scan_trait_rules = [&](const std::vector<IngestRule> &rules) {
+        for (const auto &rule : rules) {
+            if (rule.type != "foreign_key") has_trait_rules = true;
+        }
+    };
+    scan_trait_rules(ingest_rules.default_rules);
+    for (const auto &pair : ingest_rules.table_rules) {
+        scan_trait_rules(pair.second);
+    }
+    if (incremental && has_trait_rules) {
+        // Trait-Zentren aus den bestehenden Platzierungen aufbauen.
+        std::vector<int64_t> fk_keys;
+        std::vector<IngestHit> hits;
+        for (size_t i = 0; i < world.payloads.size(); ++i) {
+            const DbPayload &payload = world.payloads[i];
+            if (!payload.placed) continue;
+            build_plan(static_cast<int>(i), fk_keys, hits);
+            for (const auto &hit : hits) {
+                if (hit.foreign_key) continue;
+                TraitCenter &center = trait_centers[static_cast<size_t>(hit.trait)];
+                center.sum_x += payload.x * hit.rule->weight;
+                center.sum_y += payload.y * hit.rule->weight;
+                center.sum_w += hit.rule->weight;
+            }
+        }
+    }
+
+    for (int step = 0; step < cfg.steps; ++step) {
+        bool carrying = false;
+        for (auto &agent : agents) {
+            if (agent.payload_index < 0 && pending_index < pending.size()) {
+                agent.payload_index = pending[pending_index++];
+                build_plan(agent.payload_index, agent.fk_keys, agent.hits);
+                if (incremental) {
+                    int tx = spawn_x;
+                    int ty = spawn_y;
+                    compute_target(agent.fk_keys, agent.hits, tx, ty);
+                    agent.x = static_cast<float>(tx);
+                    agent.y = static_cast<float>(ty);
                 }
-                agent.payload_index = -1;
             }
+            carrying = carrying || agent.payload_index >= 0;
         }
+        if (incremental && !carrying) break;
+
+        pool.run(agent_blocks, [&](size_t block) {
+            size_t end = std::min(agents.size(), (block + 1) * agent_block);
+            for (size_t ai = block * agent_block; ai < end; ++ai) {
+                move_agent(ai);
+            }
+        });
+
+        // Zellen reservieren: jedes Band bearbeitet seine Agenten in fester Reihenfolge.
+        for (auto &band : band_agents) {
+            band.clear();
+        }
+        for (size_t ai = 0; ai < agents.size(); ++ai) {
+            if (agents[ai].want_place) {
+                band_agents[static_cast<size_t>(agents[ai].cell_y / kIngestBandRows)].push_back(static_cast<int>(ai));
+            }
+        }
+        for (int parity = 0; parity < 2; ++parity) {
+            active_bands.clear();
+            for (int b = parity; b < band_count; b += 2) {
+                if (!band_agents[static_cast<size_t>(b)].empty()) active_bands.push_back(b);
+            }
+            pool.run(active_bands.size(), [&](size_t k) {
+                for (int ai : band_agents[static_cast<size_t>(active_bands[k])]) {
+                    DbCarrierAgent &agent = agents[static_cast<size_t>(ai)];
+                    int place_x = -1;
+                    int place_y = -1;
+                    if (find_empty_near(world, agent.cell_x, agent.cell_y, 2, place_x, place_y)) {
+                        cells[static_cast<size_t>(place_y) * world.width + place_x] = agent.payload_index;
+                        agent.place_x = place_x;
+                        agent.place_y = place_y;
+                    }
+                }
+            });
+        }
 
-        phero_accum.fill(0.0f);
-        for (const auto &field : world.table_pheromones) {
-            for (size_t i = 0; i < field.data.size(); ++i) {
-                phero_accum.data[i] += field.data[i];
+        // Platzierungen und Trait-Zentren in Agentenreihenfolge uebernehmen.
+        for (auto &agent : agents) {
+            if (agent.place_x < 0) continue;
+            commit_placement(world, agent.payload_index, agent.place_x, agent.place_y);
+            const DbPayload &payload = world.payloads[static_cast<size_t>(agent.payload_index)];
+            if (payload.table_id >= 0 && payload.table_id < static_cast<int>(world.table_pheromones.size())) {
+                phero_counts.at(agent.place_x, agent.place_y) += 1.0f;
             }
+            for (const auto &hit : agent.hits) {
+                if (hit.foreign_key) continue;
+                TraitCenter &center = trait_centers[static_cast<size_t>(hit.trait)];
+                center.sum_x += agent.place_x * hit.rule->weight;
+                center.sum_y += agent.place_y * hit.rule->weight;
+                center.sum_w += hit.rule->weight;
+            }
+            agent.payload_index = -1;
         }
+
+        if (incremental) continue;
+        // Summe der Tabellen-Pheromone, inkrementell gefuehrt statt pro Schritt neu summiert.
+        phero_accum.data = phero_counts.data;
         diffuse_and_evaporate(phero_accum, pheromone_params);
         world.mycel.update(SimParams{}, phero_accum, world.data_density);
     }
+    if (incremental) {
+        std::vector<int64_t> fk_keys;
+        std::vector<IngestHit> hits;
+        for (int index : pending) {
+            if (world.payloads[static_cast<size_t>(index)].placed) continue;
+            build_plan(index, fk_keys, hits);
+            int tx = spawn_x;
+            int ty = spawn_y;
+            compute_target(fk_keys, hits, tx, ty);
+            int px = -1;
+            int py = -1;
+            if (!find_empty_nearest(world, tx, ty, px, py)) {
+                error = "Nicht genug freie Zellen fuer alle Payloads.";
+                return false;
+            }
+            commit_placement(world, index, px, py);
+        }
+        return true;
+    }
     size_t placed_count = 0;
     for (const auto &p : world.payloads) {
         if (p.placed) {
@@ -1596,7 +2597,7 @@ bool db_run_ingest(DbWorld &world, const DbIngestConfig &cfg, std::string &error
         free_cells.reserve(static_cast<size_t>(world.width) * world.height);
         for (int y = 0; y < world.height; ++y) {
             for (int x = 0; x < world.width; ++x) {
-                if (world.cell_payload[static_cast<size_t>(y) * world.width + x] < 0) {
+                if ((*world.cell_payload)[static_cast<size_t>(y) * world.width + x] < 0) {
                     free_cells.push_back(y * world.width + x);
                 }
             }
@@ -1606,8 +2607,7 @@ bool db_run_ingest(DbWorld &world, const DbIngestConfig &cfg, std::string &error
             return false;
         }
         for (size_t i = 0; i < world.payloads.size(); ++i) {
-            DbPayload &payload = world.payloads[i];
-            if (payload.placed) continue;
+            if (world.payloads[i].placed) continue;
             int pick = rng.uniform_int(0, static_cast<int>(free_cells.size() - 1));
             int idx = free_cells[static_cast<size_t>(pick)];
             free_cells[static_cast<size_t>(pick)] = free_cells.back();
@@ -1622,8 +2622,36 @@ bool db_run_ingest(DbWorld &world, const DbIngestConfig &cfg, std::string &error
     }
     return true;
 }
+} // namespace
+
+bool db_run_ingest(DbWorld &world, const DbIngestConfig &cfg, std::string &error) {
+    if (world.width <= 0 || world.height <= 0) {
+        error = "Ungueltige Rastergroesse.";
+        return false;
+    }
+    if (world.payloads.empty()) {
+        error = "Keine Payloads vorhanden.";
+        return false;
+    }
+    IngestRules ingest_rules;
+    if (!prepare_ingest_rules(cfg, ingest_rules, error)) {
+        return false;
+    }
+    db_init_world(world, world.width, world.height);
+    std::vector<int> pending;
+    pending.reserve(world.payloads.size());
+    for (size_t i = 0; i < world.payloads.size(); ++i) {
+        // Alte Positionen (z.B. aus einem geladenen Snapshot) sind nach db_init_world ungueltig.
+        DbPayload &p = world.payloads.mut(i);
+        p.placed = false;
+        p.x = -1;
+        p.y = -1;
+        pending.push_back(static_cast<int>(i));
+    }
+    return run_carrier_ingest(world, cfg, ingest_rules, pending, false, error);
+}
 
-bool db_save_myco(const std::string &path, const DbWorld &world, std::string &error) {
+bool db_save_myco1(const std::string &path, const DbWorld &world, std::string &error) {
     if (db_has_pending_delta(world)) {
         error = "Delta-Writes ausstehend: bitte merge ausfuehren, bevor gespeichert wird.";
         return false;
@@ -1660,10 +2688,24 @@ bool db_save_myco(const std::string &path, const DbWorld &world, std::string &er
             out << fk.table_id << "\t" << fk.id << "\t" << escape_string(fk.column) << "\n";
         }
     }
+    std::vector<const DbIndex *> indexes;
+    for (const auto &pair : world.indexes) {
+        indexes.push_back(&*pair.second);
+    }
+    std::sort(indexes.begin(), indexes.end(), [](const DbIndex *a, const DbIndex *b) { return a->name < b->name; });
+    out << "indexes " << indexes.size() << "\n";
+    for (const DbIndex *index : indexes) {
+        out << escape_string(index->name) << "\t" << escape_string(index->table) << "\t"
+            << (index->unique ? 1 : 0) << "\t" << index->columns.size();
+        for (const auto &c : index->columns) {
+            out << "\t" << escape_string(c);
+        }
+        out << "\n";
+    }
     return true;
 }
 
-bool db_load_myco(const std::string &path, DbWorld &world, std::string &error) {
+bool db_load_myco1(const std::string &path, DbWorld &world, std::string &error) {
     std::ifstream in(path);
     if (!in.is_open()) {
         error = "MYCO-Datei konnte nicht geoeffnet werden: " + path;
@@ -1854,9 +2896,41 @@ bool db_load_myco(const std::string &path, DbWorld &world, std::string &error) {
         p.placed = (p.x >= 0 && p.y >= 0);
         world.payloads.push_back(std::move(p));
     }
+    if (std::getline(in, line) && line.rfind("indexes", 0) == 0) {
+        std::stringstream ss(line);
+        std::string tag;
+        size_t count = 0;
+        ss >> tag >> count;
+        for (size_t i = 0; i < count; ++i) {
+            if (!std::getline(in, line)) {
+                error = "MYCO-Indexliste unvollstaendig.";
+                return false;
+            }
+            std::stringstream row(trim(line));
+            std::vector<std::string> parts;
+            std::string part;
+            while (std::getline(row, part, '\t')) {
+                parts.push_back(part);
+            }
+            if (parts.size() < 5) {
+                error = "MYCO-Indexzeile ungueltig.";
+                return false;
+            }
+            DbIndex index;
+            index.name = unescape_string(parts[0]);
+            index.table = unescape_string(parts[1]);
+            index.unique = parts[2] == "1";
+            for (size_t c = 4; c < parts.size(); ++c) {
+                index.columns.push_back(unescape_string(parts[c]));
+            }
+            world.indexes[to_lower(index.name)] = DbCow<DbIndex>(std::move(index));
+        }
+    }
+    db_rebuild_table_payloads(world);
+    db_rebuild_indexes(world);
     db_init_world(world, width, height);
     for (size_t i = 0; i < world.payloads.size(); ++i) {
-        DbPayload &p = world.payloads[i];
+        const DbPayload &p = world.payloads[i];
         if (p.placed && p.x >= 0 && p.y >= 0) {
             db_place_payload(world, static_cast<int>(i), p.x, p.y);
         }
@@ -1906,42 +2980,26 @@ std::vector<int> db_execute_query(const DbWorld &world, const DbQuery &q, int ra
         }
     }
     if (pk_query) {
-        int64_t key = make_payload_key(table_id, target_id);
-        auto dit = world.delta_index_by_key.find(key);
-        if (dit != world.delta_index_by_key.end() && !payload_tombstoned(world, key)) {
-            out.push_back(dit->second);
-            return out;
-        }
-        auto it = world.payload_positions.find(key);
-        if (it != world.payload_positions.end() && world.width > 0 && world.height > 0) {
-            int px = it->second.first;
-            int py = it->second.second;
-            if (px >= 0 && py >= 0 && px < world.width && py < world.height) {
-                int idx = world.cell_payload[static_cast<size_t>(py) * world.width + px];
-                if (idx >= 0 && idx < static_cast<int>(world.payloads.size())) {
-                    const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
-                    if (!p.is_delta && p.table_id == table_id && p.id == target_id &&
-                        !payload_tombstoned(world, key)) {
-                        out.push_back(idx);
-                        return out;
-                    }
-                }
-            }
-        }
+        // The key maps cover every row, so a miss needs no scan.
+        int idx = db_find_payload(world, table_id, target_id);
+        if (idx >= 0) out.push_back(idx);
+        return out;
     }
-    std::vector<int> base_hits;
-    for (size_t i = 0; i < world.payloads.size(); ++i) {
-        const DbPayload &p = world.payloads[i];
+    // A single-column index narrows the field match to its candidate payloads.
+    const std::vector<int> *scan_rows = &db_table_payloads(world, table_id);
+    std::vector<int> scan;
+    const DbIndex *index = db_find_index(world, table_id, where_col, true);
+    if (index && db_index_lookup_equal(*index, q.value, scan)) {
+        std::sort(scan.begin(), scan.end());
+        scan_rows = &scan;
+    }
+    for (int i : *scan_rows) {
+        const DbPayload &p = world.payloads[static_cast<size_t>(i)];
         if (!p.is_delta) continue;
         if (p.table_id != table_id) continue;
-        int64_t key = make_payload_key(p.table_id, p.id);
-        if (payload_tombstoned(world, key)) continue;
-        if (pk_query && p.id == target_id) {
-            out.push_back(static_cast<int>(i));
-            continue;
-        }
+        if (db_payload_hidden(world, i)) continue;
         if (match_field(p, where_col, q.value)) {
-            out.push_back(static_cast<int>(i));
+            out.push_back(i);
         }
     }
     if (fk_query) {
@@ -1953,42 +3011,28 @@ std::vector<int> db_execute_query(const DbWorld &world, const DbQuery &q, int ra
             if (it != world.payload_positions.end()) {
                 int px = it->second.first;
                 int py = it->second.second;
-                int x0 = std::max(0, px - radius);
-                int x1 = std::min(world.width - 1, px + radius);
-                int y0 = std::max(0, py - radius);
-                int y1 = std::min(world.height - 1, py + radius);
-                for (int y = y0; y <= y1; ++y) {
-                    for (int x = x0; x <= x1; ++x) {
-                        int idx = world.cell_payload[static_cast<size_t>(y) * world.width + x];
-                        if (idx < 0) continue;
-                        const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
-                        if (p.table_id != table_id) continue;
-                        if (p.is_delta) continue;
-                        int64_t pkey = make_payload_key(p.table_id, p.id);
-                        if (payload_tombstoned(world, pkey) || base_overridden(world, pkey)) continue;
-                        for (const auto &fk : p.foreign_keys) {
-                            if (fk.table_id == parent_id && fk.id == target_id) {
-                                out.push_back(idx);
-                                break;
-                            }
+                scan_table_cells(world, table_id, px - radius, py - radius, px + radius, py + radius, [&](int idx, int, int) {
+                    const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
+                    if (p.table_id != table_id) return;
+                    if (p.is_delta) return;
+                    if (db_payload_hidden(world, idx)) return;
+                    for (const auto &fk : p.foreign_keys) {
+                        if (fk.table_id == parent_id && fk.id == target_id) {
+                            out.push_back(idx);
+                            break;
                         }
                     }
-                }
+                });
             }
         }
     }
-    for (size_t i = 0; i < world.payloads.size(); ++i) {
-        const DbPayload &p = world.payloads[i];
+    for (int i : *scan_rows) {
+        const DbPayload &p = world.payloads[static_cast<size_t>(i)];
         if (p.is_delta) continue;
         if (p.table_id != table_id) continue;
-        int64_t key = make_payload_key(p.table_id, p.id);
-        if (payload_tombstoned(world, key) || base_overridden(world, key)) continue;
-        if (pk_query && p.id == target_id) {
-            out.push_back(static_cast<int>(i));
-            continue;
-        }
+        if (db_payload_hidden(world, i)) continue;
         if (match_field(p, where_col, q.value)) {
-            out.push_back(static_cast<int>(i));
+            out.push_back(i);
         }
     }
     return out;
@@ -2019,146 +3063,272 @@ std::vector<int> db_execute_query_focus(const DbWorld &world, const DbQuery &q,
             pk_query = true;
         }
     }
+    if (pk_query) {
+        // The key maps cover every row, so a miss needs no scan.
+        int idx = db_find_payload(world, table_id, target_id);
+        if (idx >= 0) out.push_back(idx);
+        return out;
+    }
     int fk_table_id = -1;
-    if (fk_query && !pk_query) {
+    if (fk_query) {
         std::string parent_table = fk_table_from_column(q.column);
         fk_table_id = db_find_table(world, parent_table);
     }
-
-    if (pk_query) {
-        int64_t key = make_payload_key(table_id, target_id);
-        auto dit = world.delta_index_by_key.find(key);
-        if (dit != world.delta_index_by_key.end() && !payload_tombstoned(world, key)) {
-            out.push_back(dit->second);
-            return out;
-        }
-        auto it = world.payload_positions.find(key);
-        if (it != world.payload_positions.end() && world.width > 0 && world.height > 0) {
-            int px = it->second.first;
-            int py = it->second.second;
-            if (px >= 0 && py >= 0 && px < world.width && py < world.height) {
-                int idx = world.cell_payload[static_cast<size_t>(py) * world.width + px];
-                if (idx >= 0 && idx < static_cast<int>(world.payloads.size())) {
-                    const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
-                    if (!p.is_delta && p.table_id == table_id && p.id == target_id &&
-                        !payload_tombstoned(world, key)) {
-                        out.push_back(idx);
-                        return out;
-                    }
-                }
-            }
-        }
-    }
-    for (size_t i = 0; i < world.payloads.size(); ++i) {
-        const DbPayload &p = world.payloads[i];
+    for (int i : db_table_payloads(world, table_id)) {
+        const DbPayload &p = world.payloads[static_cast<size_t>(i)];
         if (!p.is_delta) continue;
         if (p.table_id != table_id) continue;
-        int64_t key = make_payload_key(p.table_id, p.id);
-        if (payload_tombstoned(world, key)) continue;
-        if (pk_query && p.id == target_id) {
-            out.push_back(static_cast<int>(i));
-            continue;
-        }
+        if (db_payload_hidden(world, i)) continue;
         if (fk_query && fk_table_id >= 0) {
             for (const auto &fk : p.foreign_keys) {
                 if (fk.table_id == fk_table_id && fk.id == target_id) {
-                    out.push_back(static_cast<int>(i));
+                    out.push_back(i);
                     break;
                 }
             }
             continue;
         }
         if (match_field(p, where_col, q.value)) {
-            out.push_back(static_cast<int>(i));
+            out.push_back(i);
         }
     }
 
-    for (int y = y0; y <= y1; ++y) {
-        for (int x = x0; x <= x1; ++x) {
-            int idx = world.cell_payload[static_cast<size_t>(y) * world.width + x];
-            if (idx < 0 || idx >= static_cast<int>(world.payloads.size())) continue;
-            const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
-            if (p.table_id != table_id) continue;
-            if (p.is_delta) continue;
-            int64_t key = make_payload_key(p.table_id, p.id);
-            if (payload_tombstoned(world, key) || base_overridden(world, key)) continue;
-            if (pk_query && p.id == target_id) {
-                out.push_back(idx);
-                continue;
-            }
-            if (fk_query && fk_table_id >= 0) {
-                for (const auto &fk : p.foreign_keys) {
-                    if (fk.table_id == fk_table_id && fk.id == target_id) {
-                        out.push_back(idx);
-                        break;
-                    }
+    scan_table_cells(world, table_id, x0, y0, x1, y1, [&](int idx, int, int) {
+        const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
+        if (p.table_id != table_id) return;
+        if (p.is_delta) return;
+        if (db_payload_hidden(world, idx)) return;
+        if (fk_query && fk_table_id >= 0) {
+            for (const auto &fk : p.foreign_keys) {
+                if (fk.table_id == fk_table_id && fk.id == target_id) {
+                    out.push_back(idx);
+                    break;
                 }
-                continue;
-            }
-            if (match_field(p, where_col, q.value)) {
-                out.push_back(idx);
             }
+            return;
         }
-    }
+        if (match_field(p, where_col, q.value)) {
+            out.push_back(idx);
+        }
+    });
     return out;
 }
 
-bool db_apply_insert_sql(DbWorld &world, const std::string &stmt, int &rows, std::string &error) {
-    rows = 0;
-    SqlInsert insert;
-    if (!parse_insert_statement(stmt, insert)) {
-        error = "INSERT: ungueltiges Statement.";
+namespace {
+
+// Upserts one built row into the delta store: a fresh slot, or in place of the key's delta.
+bool insert_payload(DbWorld &world, DbPayload payload, std::string &error) {
+    int64_t key = make_payload_key(payload.table_id, payload.id);
+    payload.is_delta = true;
+    payload.placed = false;
+    payload.x = -1;
+    payload.y = -1;
+    if (unique_conflict(world, payload, error)) {
         return false;
     }
-    for (const auto &row : insert.rows) {
-        DbPayload payload;
-        if (!build_payload_from_row(world, insert.table, insert.columns, row, payload, error)) {
+    bool had_prev = false;
+    DbPayload prev_payload;
+    auto it_prev = world.delta_index_by_key.find(key);
+    if (it_prev != world.delta_index_by_key.end()) {
+        had_prev = true;
+        prev_payload = world.payloads[static_cast<size_t>(it_prev->second)];
+    }
+    bool prev_tombstone = world.tombstones.find(key) != world.tombstones.end();
+    world.tombstones.erase(key);
+    auto it = world.delta_index_by_key.find(key);
+    if (it != world.delta_index_by_key.end()) {
+        index_payload(world, it->second, false);
+        world.payloads.mut(static_cast<size_t>(it->second)) = std::move(payload);
+        index_payload(world, it->second, true);
+    } else {
+        int idx = static_cast<int>(world.payloads.size());
+        world.payloads.push_back(std::move(payload));
+        world.delta_index_by_key[key] = idx;
+        track_payload(world, idx);
+        index_payload(world, idx, true);
+    }
+    refresh_key_status(world, key);
+    DbDeltaOp op;
+    op.kind = DbDeltaOp::INSERT;
+    op.key = key;
+    op.had_prev = had_prev;
+    op.prev_payload = std::move(prev_payload);
+    op.prev_tombstone = prev_tombstone;
+    world.delta_history.push_back(std::move(op));
+    return true;
+}
+
+// Multi-row INSERTs from this size on take the batch path (one undo entry for the statement).
+constexpr size_t kBulkInsertMinRows = 64;
+
+// Builds the payloads of a batch with the rules of build_payload_from_row, but resolves the
+// column list and the id column once and hands out missing ids from a running maximum.
+bool build_payload_batch(DbWorld &world,
+                         const std::string &table,
+                         const std::vector<std::string> &columns,
+                         std::vector<std::vector<std::string>> &rows,
+                         const std::vector<uint8_t> &nulls,
+                         std::vector<DbPayload> &out,
+                         std::string &error) {
+    int table_id = db_add_table(world, table);
+    std::vector<std::string> use_cols = columns;
+    if (use_cols.empty() && !rows.empty()) {
+        if (table_id >= 0 && table_id < static_cast<int>(world.table_columns.size()) &&
+            !world.table_columns[static_cast<size_t>(table_id)].empty()) {
+            use_cols = world.table_columns[static_cast<size_t>(table_id)];
+        } else {
+            for (size_t i = 0; i < rows.front().size(); ++i) {
+                use_cols.push_back("col" + std::to_string(i));
+            }
+        }
+    }
+    for (const auto &row : rows) {
+        if (row.size() != use_cols.size()) {
+            error = columns.empty() ? "INSERT: Werteanzahl passt nicht." : "INSERT: Spaltenanzahl passt nicht.";
             return false;
         }
-        int64_t key = make_payload_key(payload.table_id, payload.id);
+    }
+    int id_col = -1;
+    for (size_t ci = 0; ci < use_cols.size(); ++ci) {
+        ensure_column(world, table_id, use_cols[ci]);
+        if (id_col < 0 && (ieq(use_cols[ci], "id") || is_pk_column(use_cols[ci], table))) {
+            id_col = static_cast<int>(ci);
+        }
+    }
+    if (!nulls.empty() && nulls.size() != rows.size() * use_cols.size()) {
+        error = "INSERT: NULL-Maske passt nicht.";
+        return false;
+    }
+    int max_id = next_payload_id(world, table_id) - 1;
+    out.clear();
+    out.reserve(rows.size());
+    for (size_t r = 0; r < rows.size(); ++r) {
+        auto &row = rows[r];
+        const uint8_t *row_nulls = nulls.empty() ? nullptr : &nulls[r * use_cols.size()];
+        auto present = [&](size_t ci) { return !row_nulls || !row_nulls[ci]; };
+        DbPayload payload;
+        payload.table_id = table_id;
         payload.is_delta = true;
-        payload.placed = false;
-        payload.x = -1;
-        payload.y = -1;
-        bool had_prev = false;
-        DbPayload prev_payload;
-        auto it_prev = world.delta_index_by_key.find(key);
-        if (it_prev != world.delta_index_by_key.end()) {
-            had_prev = true;
-            prev_payload = world.payloads[static_cast<size_t>(it_prev->second)];
-        }
-        bool prev_tombstone = world.tombstones.find(key) != world.tombstones.end();
-        world.tombstones.erase(key);
-        auto it = world.delta_index_by_key.find(key);
-        if (it != world.delta_index_by_key.end()) {
-            world.payloads[static_cast<size_t>(it->second)] = std::move(payload);
-        } else {
-            int idx = static_cast<int>(world.payloads.size());
-            world.payloads.push_back(std::move(payload));
-            world.delta_index_by_key[key] = idx;
+        int id_value = 0;
+        bool found_id = id_col >= 0 && present(static_cast<size_t>(id_col)) &&
+                        parse_int_value(row[static_cast<size_t>(id_col)], id_value);
+        if (!found_id && !row.empty() && present(0)) {
+            found_id = parse_int_value(row.front(), id_value);
         }
-        DbDeltaOp op;
-        op.kind = DbDeltaOp::INSERT;
-        op.key = key;
-        op.had_prev = had_prev;
-        op.prev_payload = std::move(prev_payload);
-        op.prev_tombstone = prev_tombstone;
-        world.delta_history.push_back(std::move(op));
+        payload.id = found_id ? id_value : max_id + 1;
+        max_id = std::max(max_id, payload.id);
+        payload.fields.reserve(use_cols.size());
+        for (size_t ci = 0; ci < use_cols.size(); ++ci) {
+            if (!present(ci)) continue;
+            DbField field;
+            field.name = use_cols[ci];
+            field.value = std::move(row[ci]);
+            payload.fields.push_back(std::move(field));
+        }
+        rebuild_foreign_keys(world, payload);
+        payload.raw_data = build_raw_data(payload.fields);
+        out.push_back(std::move(payload));
+    }
+    return true;
+}
+
+// Appends a batch of new keys as one block under a single BULK_INSERT undo entry. A batch that
+// touches a key with a delta or tombstone, or repeats a key, goes through the per-row upsert.
+bool insert_payload_batch(DbWorld &world, std::vector<DbPayload> &batch, int &rows, std::string &error) {
+    bool fresh = true;
+    std::unordered_set<int64_t> keys;
+    keys.reserve(batch.size());
+    for (const auto &p : batch) {
+        int64_t key = make_payload_key(p.table_id, p.id);
+        if (!keys.insert(key).second || world.delta_index_by_key.count(key) || payload_tombstoned(world, key)) {
+            fresh = false;
+            break;
+        }
+    }
+    if (!fresh) {
+        for (auto &p : batch) {
+            if (!insert_payload(world, std::move(p), error)) {
+                return false;
+            }
+            rows++;
+        }
+        return true;
+    }
+    // The entry grows with the block, so a failed row is undone with everything before it.
+    DbDeltaOp op;
+    op.kind = DbDeltaOp::BULK_INSERT;
+    op.first_payload = static_cast<int>(world.payloads.size());
+    world.delta_history.push_back(std::move(op));
+    DbDeltaOp &entry = world.delta_history.back();
+    world.payloads.reserve(world.payloads.size() + batch.size());
+    world.delta_index_by_key.reserve(world.delta_index_by_key.size() + batch.size());
+    for (auto &p : batch) {
+        if (unique_conflict(world, p, error)) {
+            return false;
+        }
+        int64_t key = make_payload_key(p.table_id, p.id);
+        int idx = static_cast<int>(world.payloads.size());
+        world.payloads.push_back(std::move(p));
+        world.delta_index_by_key.emplace(key, idx);
+        track_payload(world, idx);
+        index_payload(world, idx, true);
+        refresh_key_status(world, key);
+        entry.key = key;
+        entry.payload_count++;
         rows++;
     }
     return true;
 }
 
-bool db_apply_update_sql(DbWorld &world, const std::string &stmt, int &rows, std::string &error) {
-    rows = 0;
-    std::string table;
-    std::vector<std::pair<std::string, std::string>> sets;
-    std::string where_col;
-    std::string where_val;
-    if (!parse_update_statement(stmt, table, sets, where_col, where_val)) {
-        error = "UPDATE: ungueltiges Statement.";
+bool bulk_insert(DbWorld &world,
+                 const std::string &table,
+                 const std::vector<std::string> &columns,
+                 std::vector<std::vector<std::string>> &rows,
+                 const std::vector<uint8_t> &nulls,
+                 int &inserted,
+                 std::string &error) {
+    inserted = 0;
+    std::vector<DbPayload> batch;
+    if (!build_payload_batch(world, table, columns, rows, nulls, batch, error)) {
         return false;
     }
+    return insert_payload_batch(world, batch, inserted, error);
+}
+
+bool apply_insert(DbWorld &world,
+                  const std::string &table,
+                  const std::vector<std::string> &columns,
+                  std::vector<std::vector<std::string>> &values,
+                  int &rows,
+                  std::string &error) {
+    rows = 0;
+    if (values.size() >= kBulkInsertMinRows) {
+        for (auto &row : values) {
+            for (auto &value : row) value = strip_quotes(value);
+        }
+        return bulk_insert(world, table, columns, values, {}, rows, error);
+    }
+    for (const auto &row : values) {
+        DbPayload payload;
+        if (!build_payload_from_row(world, table, columns, row, payload, error)) {
+            return false;
+        }
+        if (!insert_payload(world, std::move(payload), error)) {
+            return false;
+        }
+        rows++;
+    }
+    return true;
+}
+
+bool apply_update(DbWorld &world,
+                  const std::string &table,
+                  const std::vector<std::pair<std::string, std::string>> &sets,
+                  std::string where_col,
+                  std::string where_val,
+                  int &rows,
+                  std::string &error) {
+    rows = 0;
     where_col = strip_table_prefix(where_col);
     where_val = strip_quotes(where_val);
     int table_id = db_find_table(world, table);
@@ -2171,18 +3341,35 @@ bool db_apply_update_sql(DbWorld &world, const std::string &stmt, int &rows, std
     if (pk_query && !parse_int_value(where_val, target_id)) {
         pk_query = false;
     }
-    for (size_t i = 0; i < world.payloads.size(); ++i) {
-        DbPayload &p = world.payloads[i];
-        if (!p.is_delta) continue;
-        if (p.table_id != table_id) continue;
+    // A primary-key WHERE resolves its row through the key maps; anything else scans the table.
+    std::vector<int> delta_hits;
+    std::vector<int> base_hits;
+    if (pk_query) {
+        int idx = db_find_payload(world, table_id, target_id);
+        if (idx >= 0) (world.payloads[static_cast<size_t>(idx)].is_delta ? delta_hits : base_hits).push_back(idx);
+    } else {
+        for (int i : db_table_payloads(world, table_id)) {
+            const DbPayload &p = world.payloads[static_cast<size_t>(i)];
+            if (p.table_id != table_id) continue;
+            if (db_payload_hidden(world, i)) continue;
+            if (!match_field(p, where_col, where_val)) continue;
+            (p.is_delta ? delta_hits : base_hits).push_back(i);
+        }
+    }
+    for (int i : delta_hits) {
+        const DbPayload &p = world.payloads[static_cast<size_t>(i)];
         int64_t key = make_payload_key(p.table_id, p.id);
-        if (payload_tombstoned(world, key)) continue;
-        bool match = pk_query ? (p.id == target_id) : match_field(p, where_col, where_val);
-        if (!match) continue;
         DbPayload prev_payload = p;
-        if (!apply_set_fields(world, p, sets, table, error)) {
+        DbPayload updated = p;
+        if (!apply_set_fields(world, updated, sets, table, error)) {
+            return false;
+        }
+        if (unique_conflict(world, updated, error)) {
             return false;
         }
+        index_payload(world, i, false);
+        world.payloads.mut(static_cast<size_t>(i)) = std::move(updated);
+        index_payload(world, i, true);
         DbDeltaOp op;
         op.kind = DbDeltaOp::UPDATE;
         op.key = key;
@@ -2192,17 +3379,6 @@ bool db_apply_update_sql(DbWorld &world, const std::string &stmt, int &rows, std
         world.delta_history.push_back(std::move(op));
         rows++;
     }
-    std::vector<int> base_hits;
-    for (size_t i = 0; i < world.payloads.size(); ++i) {
-        const DbPayload &p = world.payloads[i];
-        if (p.is_delta) continue;
-        if (p.table_id != table_id) continue;
-        int64_t key = make_payload_key(p.table_id, p.id);
-        if (payload_tombstoned(world, key) || base_overridden(world, key)) continue;
-        bool match = pk_query ? (p.id == target_id) : match_field(p, where_col, where_val);
-        if (!match) continue;
-        base_hits.push_back(static_cast<int>(i));
-    }
     for (int idx : base_hits) {
         const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
         int64_t key = make_payload_key(p.table_id, p.id);
@@ -2214,14 +3390,22 @@ bool db_apply_update_sql(DbWorld &world, const std::string &stmt, int &rows, std
         if (!apply_set_fields(world, updated, sets, table, error)) {
             return false;
         }
+        if (unique_conflict(world, updated, error)) {
+            return false;
+        }
         auto it = world.delta_index_by_key.find(key);
         if (it != world.delta_index_by_key.end()) {
-            world.payloads[static_cast<size_t>(it->second)] = std::move(updated);
+            index_payload(world, it->second, false);
+            world.payloads.mut(static_cast<size_t>(it->second)) = std::move(updated);
+            index_payload(world, it->second, true);
         } else {
             int idx = static_cast<int>(world.payloads.size());
             world.payloads.push_back(std::move(updated));
             world.delta_index_by_key[key] = idx;
+            track_payload(world, idx);
+            index_payload(world, idx, true);
         }
+        refresh_key_status(world, key);
         DbDeltaOp op;
         op.kind = DbDeltaOp::UPDATE;
         op.key = key;
@@ -2233,15 +3417,13 @@ bool db_apply_update_sql(DbWorld &world, const std::string &stmt, int &rows, std
     return true;
 }
 
-bool db_apply_delete_sql(DbWorld &world, const std::string &stmt, int &rows, std::string &error) {
+bool apply_delete(DbWorld &world,
+                  const std::string &table,
+                  std::string where_col,
+                  std::string where_val,
+                  int &rows,
+                  std::string &error) {
     rows = 0;
-    std::string table;
-    std::string where_col;
-    std::string where_val;
-    if (!parse_delete_statement(stmt, table, where_col, where_val)) {
-        error = "DELETE: ungueltiges Statement.";
-        return false;
-    }
     where_col = strip_table_prefix(where_col);
     where_val = strip_quotes(where_val);
     int table_id = db_find_table(world, table);
@@ -2254,14 +3436,23 @@ bool db_apply_delete_sql(DbWorld &world, const std::string &stmt, int &rows, std
     if (pk_query && !parse_int_value(where_val, target_id)) {
         pk_query = false;
     }
-    for (size_t i = 0; i < world.payloads.size(); ++i) {
-        const DbPayload &p = world.payloads[i];
-        if (p.table_id != table_id) continue;
+    std::vector<int> hits;
+    if (pk_query) {
+        int idx = db_find_payload(world, table_id, target_id);
+        if (idx >= 0) hits.push_back(idx);
+    } else {
+        for (int i : db_table_payloads(world, table_id)) {
+            const DbPayload &p = world.payloads[static_cast<size_t>(i)];
+            if (p.table_id != table_id) continue;
+            if (db_payload_hidden(world, i)) continue;
+            if (match_field(p, where_col, where_val)) hits.push_back(i);
+        }
+    }
+    for (int i : hits) {
+        // Rows sharing a key go with the first of them.
+        if (db_payload_hidden(world, i)) continue;
+        const DbPayload &p = world.payloads[static_cast<size_t>(i)];
         int64_t key = make_payload_key(p.table_id, p.id);
-        if (payload_tombstoned(world, key)) continue;
-        if (!p.is_delta && base_overridden(world, key)) continue;
-        bool match = pk_query ? (p.id == target_id) : match_field(p, where_col, where_val);
-        if (!match) continue;
         DbDeltaOp op;
         op.kind = DbDeltaOp::DELETE;
         op.key = key;
@@ -2269,49 +3460,25 @@ bool db_apply_delete_sql(DbWorld &world, const std::string &stmt, int &rows, std
         op.prev_tombstone = payload_tombstoned(world, key);
         world.delta_history.push_back(std::move(op));
         world.tombstones.insert(key);
+        refresh_key_status(world, key);
         rows++;
     }
     return true;
 }
 
-bool db_merge_delta(DbWorld &world, const DbIngestConfig &cfg, std::string &error) {
-    if (!db_has_pending_delta(world)) {
-        return true;
-    }
-    if (cfg.agent_count <= 0 || cfg.steps <= 0) {
-        error = "Merge-Config ungueltig (agents/steps).";
-        return false;
-    }
-    std::unordered_set<int64_t> delta_keys;
-    delta_keys.reserve(world.delta_index_by_key.size());
-    for (const auto &pair : world.delta_index_by_key) {
-        delta_keys.insert(pair.first);
-    }
-    std::vector<DbPayload> merged;
-    merged.reserve(world.payloads.size());
-    for (const auto &p : world.payloads) {
-        int64_t key = make_payload_key(p.table_id, p.id);
-        if (payload_tombstoned(world, key)) continue;
-        if (!p.is_delta) {
-            if (delta_keys.find(key) != delta_keys.end()) continue;
-            merged.push_back(p);
-            continue;
-        }
-        DbPayload copy = p;
-        copy.is_delta = false;
-        copy.placed = false;
-        copy.x = -1;
-        copy.y = -1;
-        merged.push_back(std::move(copy));
+bool apply_dml(DbWorld &world, DbDmlStatement &stmt, int &rows, std::string &error) {
+    switch (stmt.kind) {
+        case DbDmlStatement::INSERT:
+            return apply_insert(world, stmt.table, stmt.columns, stmt.rows, rows, error);
+        case DbDmlStatement::UPDATE:
+            return apply_update(world, stmt.table, stmt.sets, stmt.where_col, stmt.where_val, rows, error);
+        case DbDmlStatement::DELETE:
+            return apply_delete(world, stmt.table, stmt.where_col, stmt.where_val, rows, error);
     }
-    world.payloads.swap(merged);
-    world.delta_index_by_key.clear();
-    world.tombstones.clear();
-    world.delta_history.clear();
-    return db_run_ingest(world, cfg, error);
+    return false;
 }
 
-bool db_undo_last_delta(DbWorld &world, std::string &error) {
+bool undo_delta_op(DbWorld &world, std::string &error) {
     if (world.delta_history.empty()) {
         error = "Kein Undo verfuegbar.";
         return false;
@@ -2321,10 +3488,13 @@ bool db_undo_last_delta(DbWorld &world, std::string &error) {
     if (op.kind == DbDeltaOp::INSERT) {
         auto it = world.delta_index_by_key.find(op.key);
         if (it != world.delta_index_by_key.end()) {
+            index_payload(world, it->second, false);
             if (op.had_prev) {
-                world.payloads[static_cast<size_t>(it->second)] = op.prev_payload;
+                world.payloads.mut(static_cast<size_t>(it->second)) = op.prev_payload;
+                index_payload(world, it->second, true);
             } else {
-                deactivate_payload(world.payloads[static_cast<size_t>(it->second)]);
+                untrack_payload(world, it->second);
+                release_delta_slot(world, it->second);
                 world.delta_index_by_key.erase(it);
             }
         }
@@ -2333,17 +3503,22 @@ bool db_undo_last_delta(DbWorld &world, std::string &error) {
         } else {
             world.tombstones.erase(op.key);
         }
+        refresh_key_status(world, op.key);
         return true;
     }
     if (op.kind == DbDeltaOp::UPDATE) {
         auto it = world.delta_index_by_key.find(op.key);
         if (op.had_prev) {
             if (it != world.delta_index_by_key.end()) {
-                world.payloads[static_cast<size_t>(it->second)] = op.prev_payload;
+                index_payload(world, it->second, false);
+                world.payloads.mut(static_cast<size_t>(it->second)) = op.prev_payload;
+                index_payload(world, it->second, true);
             }
         } else {
             if (it != world.delta_index_by_key.end()) {
-                deactivate_payload(world.payloads[static_cast<size_t>(it->second)]);
+                index_payload(world, it->second, false);
+                untrack_payload(world, it->second);
+                release_delta_slot(world, it->second);
                 world.delta_index_by_key.erase(it);
             }
         }
@@ -2352,6 +3527,19 @@ bool db_undo_last_delta(DbWorld &world, std::string &error) {
         } else {
             world.tombstones.erase(op.key);
         }
+        refresh_key_status(world, op.key);
+        return true;
+    }
+    if (op.kind == DbDeltaOp::BULK_INSERT) {
+        for (int i = op.first_payload + op.payload_count - 1; i >= op.first_payload; --i) {
+            const DbPayload &p = world.payloads[static_cast<size_t>(i)];
+            int64_t key = make_payload_key(p.table_id, p.id);
+            index_payload(world, i, false);
+            untrack_payload(world, i);
+            release_delta_slot(world, i);
+            world.delta_index_by_key.erase(key);
+            refresh_key_status(world, key);
+        }
         return true;
     }
     if (op.kind == DbDeltaOp::DELETE) {
@@ -2360,11 +3548,601 @@ bool db_undo_last_delta(DbWorld &world, std::string &error) {
         } else {
             world.tombstones.erase(op.key);
         }
+        refresh_key_status(world, op.key);
         return true;
     }
     error = "Undo fehlgeschlagen.";
     return false;
 }
+
+// Undoes ops until the history is back at `mark`.
+bool undo_to(DbWorld &world, size_t mark, std::string &error) {
+    while (world.delta_history.size() > mark) {
+        if (!undo_delta_op(world, error)) return false;
+    }
+    return true;
+}
+
+// Visible row state of one key for the WAL: the delta, else the live base payload, else deleted.
+DbWalRecord wal_record_for(const DbWorld &world, int64_t key) {
+    DbWalRecord rec;
+    rec.key = key;
+    if (payload_tombstoned(world, key)) {
+        rec.deleted = true;
+        return rec;
+    }
+    auto it = world.delta_index_by_key.find(key);
+    if (it != world.delta_index_by_key.end()) {
+        rec.payload = world.payloads[static_cast<size_t>(it->second)];
+        return rec;
+    }
+    int base = base_payload_index(world, key);
+    if (base >= 0) {
+        rec.payload = world.payloads[static_cast<size_t>(base)];
+        return rec;
+    }
+    rec.deleted = true;
+    return rec;
+}
+
+// Keys an undo entry touches; read them before undoing a BULK_INSERT, which releases its slots.
+std::vector<int64_t> op_keys(const DbWorld &world, const DbDeltaOp &op) {
+    if (op.kind != DbDeltaOp::BULK_INSERT) return {op.key};
+    std::vector<int64_t> keys;
+    keys.reserve(static_cast<size_t>(op.payload_count));
+    for (int i = op.first_payload; i < op.first_payload + op.payload_count; ++i) {
+        const DbPayload &p = world.payloads[static_cast<size_t>(i)];
+        keys.push_back(make_payload_key(p.table_id, p.id));
+    }
+    return keys;
+}
+
+// Logs the final state of every key touched since `first_op` as one WAL frame.
+bool log_ops(DbWorld &world, size_t first_op, std::string &error) {
+    if (!world.wal || first_op >= world.delta_history.size()) return true;
+    std::vector<DbWalRecord> records;
+    std::unordered_set<int64_t> seen;
+    for (size_t i = first_op; i < world.delta_history.size(); ++i) {
+        for (int64_t key : op_keys(world, world.delta_history[i])) {
+            if (seen.insert(key).second) {
+                records.push_back(wal_record_for(world, key));
+            }
+        }
+    }
+    return db_wal_append(world, records, error);
+}
+
+// Without autocommit the first write opens the transaction; returns the statement's undo mark.
+size_t begin_statement(DbWorld &world) {
+    if (!world.autocommit && !world.txn_active) {
+        world.txn_active = true;
+        world.txn_start = world.delta_history.size();
+        world.txn_savepoints.clear();
+    }
+    return world.delta_history.size();
+}
+
+// A failed statement leaves no partial rows behind; outside a transaction it commits at once.
+bool finish_statement(DbWorld &world, size_t mark, bool ok, int &rows, std::string &error) {
+    if (ok && (world.txn_active || log_ops(world, mark, error))) {
+        return true;
+    }
+    std::string undo_error;
+    undo_to(world, mark, undo_error);
+    rows = 0;
+    return false;
+}
+
+} // namespace
+
+bool db_parse_dml(const std::string &stmt, DbDmlStatement &out, std::string &error) {
+    out = DbDmlStatement{};
+    std::string lower = to_lower(trim(stmt));
+    if (lower.rfind("insert", 0) == 0) {
+        SqlInsert insert;
+        if (!parse_insert_statement(stmt, insert)) {
+            error = "INSERT: ungueltiges Statement.";
+            return false;
+        }
+        out.kind = DbDmlStatement::INSERT;
+        out.table = std::move(insert.table);
+        out.columns = std::move(insert.columns);
+        out.rows = std::move(insert.rows);
+        return true;
+    }
+    if (lower.rfind("update", 0) == 0) {
+        out.kind = DbDmlStatement::UPDATE;
+        if (!parse_update_statement(stmt, out.table, out.sets, out.where_col, out.where_val)) {
+            error = "UPDATE: ungueltiges Statement.";
+            return false;
+        }
+        return true;
+    }
+    if (lower.rfind("delete", 0) == 0) {
+        out.kind = DbDmlStatement::DELETE;
+        if (!parse_delete_statement(stmt, out.table, out.where_col, out.where_val)) {
+            error = "DELETE: ungueltiges Statement.";
+            return false;
+        }
+        return true;
+    }
+    error = "SQL: INSERT, UPDATE oder DELETE erwartet.";
+    return false;
+}
+
+bool db_apply_dml(DbWorld &world, DbDmlStatement &stmt, int &rows, std::string &error) {
+    size_t mark = begin_statement(world);
+    return finish_statement(world, mark, apply_dml(world, stmt, rows, error), rows, error);
+}
+
+bool db_apply_insert_sql(DbWorld &world, const std::string &stmt, int &rows, std::string &error) {
+    DbDmlStatement parsed;
+    if (!db_parse_dml(stmt, parsed, error) || parsed.kind != DbDmlStatement::INSERT) {
+        error = "INSERT: ungueltiges Statement.";
+        return false;
+    }
+    return db_apply_dml(world, parsed, rows, error);
+}
+
+bool db_bulk_insert(DbWorld &world,
+                    const std::string &table,
+                    const std::vector<std::string> &columns,
+                    std::vector<std::vector<std::string>> &rows,
+                    const std::vector<uint8_t> &nulls,
+                    int &inserted,
+                    std::string &error) {
+    if (table.empty()) {
+        error = "INSERT: Tabelle fehlt.";
+        return false;
+    }
+    size_t mark = begin_statement(world);
+    return finish_statement(world, mark, bulk_insert(world, table, columns, rows, nulls, inserted, error), inserted, error);
+}
+
+bool db_apply_update_sql(DbWorld &world, const std::string &stmt, int &rows, std::string &error) {
+    DbDmlStatement parsed;
+    if (!db_parse_dml(stmt, parsed, error) || parsed.kind != DbDmlStatement::UPDATE) {
+        error = "UPDATE: ungueltiges Statement.";
+        return false;
+    }
+    return db_apply_dml(world, parsed, rows, error);
+}
+
+bool db_apply_delete_sql(DbWorld &world, const std::string &stmt, int &rows, std::string &error) {
+    DbDmlStatement parsed;
+    if (!db_parse_dml(stmt, parsed, error) || parsed.kind != DbDmlStatement::DELETE) {
+        error = "DELETE: ungueltiges Statement.";
+        return false;
+    }
+    return db_apply_dml(world, parsed, rows, error);
+}
+
+bool db_merge_delta(DbWorld &world, const DbIngestConfig &cfg, std::string &error) {
+    if (world.txn_active) {
+        error = "Merge waehrend einer Transaktion nicht moeglich.";
+        return false;
+    }
+    if (!db_has_pending_delta(world)) {
+        return true;
+    }
+    if (cfg.agent_count <= 0 || cfg.steps <= 0) {
+        error = "Merge-Config ungueltig (agents/steps).";
+        return false;
+    }
+    IngestRules ingest_rules;
+    if (!prepare_ingest_rules(cfg, ingest_rules, error)) {
+        return false;
+    }
+    // Entfernte Basiszeilen (Tombstone oder von einem Delta ueberschrieben) geben ihre Zelle frei.
+    struct FreedCell {
+        int x = -1;
+        int y = -1;
+        int table_id = -1;
+        int64_t key = 0;
+    };
+    std::vector<FreedCell> freed;
+    std::vector<DbPayload> rows = world.payloads.release();
+    std::vector<int> remap(rows.size(), -1);
+    std::vector<int> fresh;
+    size_t dropped = 0;
+    bool base_placed = true;
+    std::vector<DbPayload> merged;
+    merged.reserve(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        DbPayload &p = rows[i];
+        if (p.table_id < 0) continue; // delta slot released by undo
+        int64_t key = make_payload_key(p.table_id, p.id);
+        if (db_payload_hidden(world, static_cast<int>(i))) {
+            if (!p.is_delta) dropped++;
+            if (p.placed) freed.push_back({p.x, p.y, p.table_id, key});
+            continue;
+        }
+        remap[i] = static_cast<int>(merged.size());
+        if (!p.is_delta) {
+            base_placed = base_placed && p.placed;
+            merged.push_back(std::move(p));
+            continue;
+        }
+        p.is_delta = false;
+        p.placed = false;
+        p.x = -1;
+        p.y = -1;
+        fresh.push_back(static_cast<int>(merged.size()));
+        merged.push_back(std::move(p));
+    }
+    world.payloads.assign(std::move(merged));
+    world.delta_index_by_key.clear();
+    world.tombstones.clear();
+    world.delta_history.clear();
+    db_rebuild_table_payloads(world);
+    db_rebuild_indexes(world);
+
+    // Ab cfg.relayout_percent geaenderter Payloads lohnt sich ein komplettes Re-Layout.
+    size_t changed = dropped + fresh.size();
+    bool grid_ok = world.width > 0 && world.height > 0 &&
+                   world.cell_payload->size() == static_cast<size_t>(world.width) * world.height;
+    bool full = cfg.relayout_percent <= 0 || !base_placed || !grid_ok ||
+                changed * 100 >= static_cast<size_t>(cfg.relayout_percent) * std::max<size_t>(1, world.payloads.size());
+    if (full) {
+        return db_run_ingest(world, cfg, error);
+    }
+    for (const auto &cell : freed) {
+        if (cell.x < 0 || cell.y < 0 || cell.x >= world.width || cell.y >= world.height) continue;
+        world.data_density.at(cell.x, cell.y) = 0.0f;
+        if (cell.table_id >= 0 && cell.table_id < static_cast<int>(world.table_pheromones.size())) {
+            float &v = world.table_pheromones[static_cast<size_t>(cell.table_id)].at(cell.x, cell.y);
+            v = std::max(0.0f, v - 1.0f);
+        }
+        auto it = world.payload_positions.find(cell.key);
+        if (it != world.payload_positions.end() && it->second.first == cell.x && it->second.second == cell.y) {
+            world.payload_positions.erase(it);
+        }
+    }
+    for (int &cell : world.cell_payload.edit()) {
+        if (cell >= 0) {
+            cell = (static_cast<size_t>(cell) < remap.size()) ? remap[static_cast<size_t>(cell)] : -1;
+        }
+    }
+    world.tile_index.reset();
+    return run_carrier_ingest(world, cfg, ingest_rules, fresh, true, error);
+}
+
+bool db_undo_last_delta(DbWorld &world, std::string &error) {
+    if (world.delta_history.empty()) {
+        error = "Kein Undo verfuegbar.";
+        return false;
+    }
+    if (world.txn_active && world.delta_history.size() <= world.txn_start) {
+        error = "Undo nur innerhalb der laufenden Transaktion.";
+        return false;
+    }
+    std::vector<int64_t> keys = op_keys(world, world.delta_history.back());
+    if (!undo_delta_op(world, error)) {
+        return false;
+    }
+    if (world.txn_active) {
+        while (!world.txn_savepoints.empty() && world.txn_savepoints.back().second > world.delta_history.size()) {
+            world.txn_savepoints.pop_back();
+        }
+        return true;
+    }
+    if (!world.wal) {
+        return true;
+    }
+    std::vector<DbWalRecord> records;
+    records.reserve(keys.size());
+    for (int64_t key : keys) {
+        records.push_back(wal_record_for(world, key));
+    }
+    return db_wal_append(world, records, error);
+}
+
+bool db_begin_tx(DbWorld &world, std::string &error) {
+    if (world.txn_active) {
+        error = "Transaktion laeuft bereits.";
+        return false;
+    }
+    world.txn_active = true;
+    world.txn_start = world.delta_history.size();
+    world.txn_savepoints.clear();
+    return true;
+}
+
+bool db_commit_tx(DbWorld &world, std::string &error) {
+    if (!world.txn_active) {
+        error = "Keine aktive Transaktion.";
+        return false;
+    }
+    // Stays open when the WAL write fails, so COMMIT can be retried or rolled back.
+    if (!log_ops(world, world.txn_start, error)) {
+        return false;
+    }
+    world.txn_active = false;
+    world.txn_savepoints.clear();
+    return true;
+}
+
+bool db_rollback_tx(DbWorld &world, std::string &error) {
+    if (!world.txn_active) {
+        error = "Keine aktive Transaktion.";
+        return false;
+    }
+    if (!undo_to(world, world.txn_start, error)) {
+        return false;
+    }
+    world.txn_active = false;
+    world.txn_savepoints.clear();
+    return true;
+}
+
+bool db_savepoint_tx(DbWorld &world, const std::string &name, std::string &error) {
+    if (name.empty()) {
+        error = "SAVEPOINT: Name fehlt.";
+        return false;
+    }
+    if (!world.txn_active) {
+        if (world.autocommit) {
+            error = "SAVEPOINT nur innerhalb einer Transaktion.";
+            return false;
+        }
+        begin_statement(world);
+    }
+    world.txn_savepoints.emplace_back(to_lower(name), world.delta_history.size());
+    return true;
+}
+
+bool db_rollback_to_savepoint(DbWorld &world, const std::string &name, std::string &error) {
+    if (!world.txn_active) {
+        error = "Keine aktive Transaktion.";
+        return false;
+    }
+    std::string key = to_lower(name);
+    for (size_t i = world.txn_savepoints.size(); i-- > 0;) {
+        if (world.txn_savepoints[i].first != key) continue;
+        if (!undo_to(world, world.txn_savepoints[i].second, error)) {
+            return false;
+        }
+        world.txn_savepoints.resize(i + 1);
+        return true;
+    }
+    error = "Savepoint nicht gefunden: " + name;
+    return false;
+}
+
+bool db_set_autocommit(DbWorld &world, bool enabled, std::string &error) {
+    if (enabled && world.txn_active && !db_commit_tx(world, error)) {
+        return false;
+    }
+    world.autocommit = enabled;
+    return true;
+}
+
+void db_apply_wal_record(DbWorld &world, const DbWalRecord &record) {
+    int table_id = static_cast<int>(record.key >> 32);
+    mark_columns_dirty(world, table_id);
+    if (record.deleted) {
+        world.tombstones.insert(record.key);
+        refresh_key_status(world, record.key);
+        return;
+    }
+    DbPayload payload = record.payload;
+    payload.is_delta = true;
+    payload.placed = false;
+    payload.x = -1;
+    payload.y = -1;
+    world.tombstones.erase(record.key);
+    auto it = world.delta_index_by_key.find(record.key);
+    if (it != world.delta_index_by_key.end()) {
+        index_payload(world, it->second, false);
+        world.payloads.mut(static_cast<size_t>(it->second)) = std::move(payload);
+        index_payload(world, it->second, true);
+    } else {
+        int idx = static_cast<int>(world.payloads.size());
+        world.payloads.push_back(std::move(payload));
+        world.delta_index_by_key[record.key] = idx;
+        track_payload(world, idx);
+        index_payload(world, idx, true);
+    }
+    refresh_key_status(world, record.key);
+}
+
+bool db_publish_snapshot(DbSnapshotStore &store, DbWorld &world, std::string &error) {
+    if (world.txn_active) {
+        error = "Snapshot: offene Transaktion, erst COMMIT oder ROLLBACK.";
+        return false;
+    }
+    db_refresh_column_store(world);
+    // Base rows run up to the first delta or released slot; the writer only rewrites rows behind them.
+    size_t base = world.payloads.shared_size();
+    while (base < world.payloads.size()) {
+        const DbPayload &p = world.payloads[base];
+        if (p.is_delta || p.table_id < 0) break;
+        ++base;
+    }
+    world.payloads.share_base(base);
+    // Only what SQL reads. Payload base block, column stores, grid, tile index, base key maps and
+    // indexes are shared; the undo log, WAL, pheromones, density, mycel and positions stay behind.
+    auto snapshot = std::make_shared<DbWorldSnapshot>();
+    DbWorld &view = snapshot->world;
+    view.width = world.width;
+    view.height = world.height;
+    view.cell_payload = world.cell_payload;
+    view.table_names = world.table_names;
+    view.table_columns = world.table_columns;
+    view.table_constraints = world.table_constraints;
+    view.table_active = world.table_active;
+    view.payloads = world.payloads;
+    view.table_payloads = world.table_payloads;
+    view.table_max_id = world.table_max_id;
+    view.table_store = world.table_store;
+    view.tile_index = world.tile_index;
+    view.table_lookup = world.table_lookup;
+    view.delta_index_by_key = world.delta_index_by_key;
+    view.tombstones = world.tombstones;
+    view.base_index_by_key = world.base_index_by_key;
+    view.base_key_next = world.base_key_next;
+    view.payload_status = world.payload_status;
+    view.default_limit = world.default_limit;
+    view.views = world.views;
+    view.indexes = world.indexes;
+    view.autocommit = world.autocommit;
+    snapshot->version = ++store.published;
+    std::atomic_store(&store.current, std::shared_ptr<const DbWorldSnapshot>(std::move(snapshot)));
+    return true;
+}
+
+std::shared_ptr<const DbWorldSnapshot> db_acquire_snapshot(const DbSnapshotStore &store) {
+    return std::atomic_load(&store.current);
+}
+
+bool db_apply_create_index_sql(DbWorld &world, const std::string &stmt, std::string &error) {
+    DbIndex index;
+    bool if_not_exists = false;
+    if (!parse_create_index_statement(stmt, index, if_not_exists)) {
+        error = "CREATE INDEX: ungueltiges Statement.";
+        return false;
+    }
+    int table_id = db_find_table(world, index.table);
+    if (table_id < 0) {
+        error = "CREATE INDEX: Tabelle nicht gefunden.";
+        return false;
+    }
+    index.table = world.table_names[static_cast<size_t>(table_id)];
+    std::string key = to_lower(index.name);
+    if (world.indexes.find(key) != world.indexes.end()) {
+        if (if_not_exists) {
+            return true;
+        }
+        error = "CREATE INDEX: Index existiert bereits: " + index.name;
+        return false;
+    }
+    const auto &cols = world.table_columns[static_cast<size_t>(table_id)];
+    if (!cols.empty()) {
+        for (auto &col : index.columns) {
+            auto it = std::find_if(cols.begin(), cols.end(), [&](const std::string &c) { return ieq(c, col); });
+            if (it == cols.end()) {
+                error = "CREATE INDEX: Spalte nicht gefunden: " + col;
+                return false;
+            }
+            col = *it;
+        }
+    }
+    for (int i : db_table_payloads(world, table_id)) {
+        index_insert(index, world.payloads[static_cast<size_t>(i)], i);
+    }
+    if (index.unique) {
+        for (const auto &bucket : index.hash) {
+            int live = 0;
+            for (int idx : bucket.second) {
+                if (payload_live(world, idx)) live++;
+            }
+            if (live > 1) {
+                error = "CREATE INDEX: doppelte Werte fuer UNIQUE-Index " + index.name;
+                return false;
+            }
+        }
+    }
+    world.indexes[key] = DbCow<DbIndex>(std::move(index));
+    return true;
+}
+
+bool db_apply_drop_index_sql(DbWorld &world, const std::string &stmt, std::string &error) {
+    std::string name;
+    bool if_exists = false;
+    if (!parse_drop_index_statement(stmt, name, if_exists)) {
+        error = "DROP INDEX: ungueltiges Statement.";
+        return false;
+    }
+    auto it = world.indexes.find(to_lower(name));
+    if (it == world.indexes.end()) {
+        if (if_exists) {
+            return true;
+        }
+        error = "DROP INDEX: Index nicht gefunden: " + name;
+        return false;
+    }
+    world.indexes.erase(it);
+    return true;
+}
+
+void db_rebuild_indexes(DbWorld &world) {
+    for (auto &pair : world.indexes) {
+        // Rebuilt into a fresh index; published snapshots keep the old one.
+        const DbIndex &old = *pair.second;
+        DbIndex index;
+        index.name = old.name;
+        index.table = old.table;
+        index.columns = old.columns;
+        index.unique = old.unique;
+        int table_id = db_find_table(world, index.table);
+        if (table_id >= 0) {
+            for (int i : db_table_payloads(world, table_id)) {
+                index_insert(index, world.payloads[static_cast<size_t>(i)], i);
+            }
+        }
+        pair.second = DbCow<DbIndex>(std::move(index));
+    }
+}
+
+const DbIndex *db_find_index(const DbWorld &world, int table_id, const std::string &column, bool single_column) {
+    const DbIndex *best = nullptr;
+    for (const auto &pair : world.indexes) {
+        const DbIndex &index = *pair.second;
+        if (index.columns.empty() || !ieq(index.columns.front(), column)) continue;
+        if (single_column && index.columns.size() != 1) continue;
+        if (db_find_table(world, index.table) != table_id) continue;
+        if (!best || index.columns.size() < best->columns.size()) {
+            best = &index;
+        }
+    }
+    return best;
+}
+
+bool db_index_lookup_equal(const DbIndex &index, const std::string &value, std::vector<int> &out) {
+    if (index.columns.size() != 1) {
+        return false;
+    }
+    double num = 0.0;
+    if (index_number(value, num)) {
+        // Numbers compare with a 1e-9 tolerance in SQL, so probe the ordered side.
+        DbIndexKey low;
+        low.numeric = true;
+        low.number = num - 1e-9;
+        DbIndexKey high;
+        high.numeric = true;
+        high.number = num + 1e-9;
+        for (auto it = index.ordered.lower_bound(low); it != index.ordered.end() && !(high < it->first); ++it) {
+            out.push_back(it->second);
+        }
+        return true;
+    }
+    auto it = index.hash.find(index_hash_part(value));
+    if (it != index.hash.end()) {
+        out.insert(out.end(), it->second.begin(), it->second.end());
+    }
+    return true;
+}
+
+bool db_index_lookup_range(const DbIndex &index, const std::string &low, const std::string &high, std::vector<int> &out) {
+    DbIndexKey low_key = make_index_key(low);
+    DbIndexKey high_key = make_index_key(high);
+    // Text bounds compare raw strings across all values, which the numeric-first order cannot serve.
+    if (!low_key.numeric || !high_key.numeric) {
+        return false;
+    }
+    for (auto it = index.ordered.lower_bound(low_key); it != index.ordered.end() && !(high_key < it->first); ++it) {
+        out.push_back(it->second);
+    }
+    // Non-numeric values still fall back to a text comparison against the bounds.
+    DbIndexKey low_text;
+    low_text.text = low;
+    DbIndexKey high_text;
+    high_text.text = high;
+    for (auto it = index.ordered.lower_bound(low_text); it != index.ordered.end() && !(high_text < it->first); ++it) {
+        out.push_back(it->second);
+    }
+    return true;
+}
 
 bool db_save_cluster_ppm(const std::string &path, const DbWorld &world, int scale, std::string &error) {
     if (world.width <= 0 || world.height <= 0) {
@@ -2397,7 +4175,7 @@ bool db_save_cluster_ppm(const std::string &path, const DbWorld &world, int scal
     for (int y = 0; y < world.height; ++y) {
         for (int sy = 0; sy < scale; ++sy) {
             for (int x = 0; x < world.width; ++x) {
-                int idx = world.cell_payload[static_cast<size_t>(y) * world.width + x];
+                int idx = (*world.cell_payload)[static_cast<size_t>(y) * world.width + x];
                 int color = 0;
                 if (idx >= 0 && idx < static_cast<int>(world.payloads.size())) {
                     const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
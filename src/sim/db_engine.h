@@ -5,6 +5,9 @@
 #include "rng.h"
 
 #include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -36,11 +39,61 @@ struct DbTableConstraints {
     std::vector<std::string> checks;
 };
 
+// Ordered index key: numeric values sort before text, mirroring the SQL compare rules.
+struct DbIndexKey {
+    bool numeric = false;
+    double number = 0.0;
+    std::string text;
+
+    bool operator<(const DbIndexKey &other) const {
+        if (numeric != other.numeric) return numeric;
+        if (numeric) return number < other.number;
+        return text < other.text;
+    }
+};
+
 struct DbIndex {
     std::string name;
     std::string table;
     std::vector<std::string> columns;
     bool unique = false;
+    // Payload indices; hash over all columns for equality, ordered over the leading column for ranges.
+    std::unordered_map<std::string, std::vector<int>> hash;
+    std::multimap<DbIndexKey, int> ordered;
+};
+
+// Typed column of one table. INT64 columns keep only the values; DOUBLE and TEXT columns keep
+// per-row dictionary codes, with the number parsed once per dictionary entry.
+struct DbColumn {
+    enum Kind { INT64, DOUBLE, TEXT } kind = INT64;
+    std::string name;
+    std::vector<uint8_t> present;
+    std::vector<int64_t> ints;
+    std::vector<uint32_t> codes;
+    std::vector<std::string> dictionary;
+    std::vector<double> dictionary_numbers;
+    std::vector<uint8_t> dictionary_numeric;
+};
+
+// Column-major read copy of one table, rows in db_table_payloads order (x/y are -1 when unplaced).
+struct DbColumnTable {
+    std::vector<int> payload_index;
+    std::vector<int> x;
+    std::vector<int> y;
+    std::vector<uint8_t> delta;
+    std::vector<DbColumn> columns;
+    std::unordered_map<std::string, int> column_lookup;
+};
+
+// Coarse grid over cell_payload: one bit per table per tile that holds a placed payload of it.
+// Bits may outlive a freed cell; scans still check the cell itself.
+constexpr int kDbTileSize = 8;
+
+struct DbTileIndex {
+    int tiles_x = 0;
+    int tiles_y = 0;
+    size_t table_words = 0;
+    std::vector<uint64_t> table_bits;
 };
 
 struct DbView {
@@ -60,38 +113,134 @@ struct DbPayload {
     bool is_delta = false;
 };
 
+// Copy-on-write value: copies of a DbWorld share it until one side calls edit().
+template <typename T>
+class DbCow {
+public:
+    DbCow() : value_(std::make_shared<T>()) {}
+    explicit DbCow(T value) : value_(std::make_shared<T>(std::move(value))) {}
+
+    const T &operator*() const { return *value_; }
+    const T *operator->() const { return value_.get(); }
+    T &edit() {
+        if (value_.use_count() > 1) value_ = std::make_shared<T>(*value_);
+        return *value_;
+    }
+
+private:
+    std::shared_ptr<T> value_;
+};
+
+// Payload rows in index order. A leading block of base rows can be shared with published
+// snapshots (share_base); the rows behind it are owned. Reads are const, writes go through mut(),
+// which detaches a shared block first.
+class DbPayloadList {
+public:
+    class const_iterator {
+    public:
+        const_iterator(const DbPayloadList *list, size_t pos) : list_(list), pos_(pos) {}
+        const DbPayload &operator*() const { return (*list_)[pos_]; }
+        const DbPayload *operator->() const { return &(*list_)[pos_]; }
+        const_iterator &operator++() {
+            ++pos_;
+            return *this;
+        }
+        bool operator!=(const const_iterator &other) const { return pos_ != other.pos_; }
+        bool operator==(const const_iterator &other) const { return pos_ == other.pos_; }
+
+    private:
+        const DbPayloadList *list_;
+        size_t pos_;
+    };
+
+    size_t size() const { return base_size_ + own_.size(); }
+    bool empty() const { return size() == 0; }
+    const DbPayload &operator[](size_t i) const { return i < base_size_ ? (*base_)[i] : own_[i - base_size_]; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    DbPayload &mut(size_t i);
+    void push_back(DbPayload payload) { own_.push_back(std::move(payload)); }
+    void reserve(size_t count) { own_.reserve(count > base_size_ ? count - base_size_ : 0); }
+    void resize(size_t count);
+    void clear();
+    void assign(std::vector<DbPayload> rows);
+    // Hands out all rows and leaves the list empty; copies only a block still shared elsewhere.
+    std::vector<DbPayload> release();
+    // Moves the first `count` rows into the shared block; copies of the list share them from then on.
+    void share_base(size_t count);
+    size_t shared_size() const { return base_size_; }
+
+private:
+    std::shared_ptr<std::vector<DbPayload>> base_;
+    size_t base_size_ = 0;
+    std::vector<DbPayload> own_;
+};
+
 struct DbDeltaOp {
-    enum Kind { INSERT, UPDATE, DELETE } kind = INSERT;
+    enum Kind { INSERT, UPDATE, DELETE, BULK_INSERT } kind = INSERT;
     int64_t key = 0;
     bool had_prev = false;
     DbPayload prev_payload;
     bool prev_tombstone = false;
+    // BULK_INSERT: fresh delta rows appended at payloads[first_payload, first_payload + payload_count).
+    int first_payload = -1;
+    int payload_count = 0;
 };
 
+// Row state written to the WAL at commit: the visible payload of the key, or deleted.
+struct DbWalRecord {
+    int64_t key = 0;
+    bool deleted = false;
+    DbPayload payload;
+};
+
+struct DbWalState;
+
+// Status bits per payload index (DbWorld::payload_status), kept in step with the delta store so
+// scans test visibility with one load instead of hashing the payload key.
+constexpr uint8_t kDbPayloadDelta = 1;      // delta row (mirrors DbPayload::is_delta)
+constexpr uint8_t kDbPayloadTombstoned = 2; // key deleted, or a delta slot released by undo
+constexpr uint8_t kDbPayloadOverridden = 4; // base row shadowed by a delta of the same key
+constexpr uint8_t kDbPayloadHidden = kDbPayloadTombstoned | kDbPayloadOverridden;
+
 struct DbWorld {
     int width = 0;
     int height = 0;
-    std::vector<int> cell_payload;
+    DbCow<std::vector<int>> cell_payload;
     std::vector<std::string> table_names;
     std::vector<std::vector<std::string>> table_columns;
     std::vector<DbTableConstraints> table_constraints;
     std::vector<bool> table_active;
     std::vector<GridField> table_pheromones;
-    std::vector<DbPayload> payloads;
+    DbPayloadList payloads;
+    std::vector<std::vector<int>> table_payloads;
+    std::vector<int> table_max_id;
+    // Immutable once built, so published snapshots share them; nullptr while stale.
+    std::vector<std::shared_ptr<const DbColumnTable>> table_store;
+    std::shared_ptr<const DbTileIndex> tile_index;
     GridField data_density;
     MycelNetwork mycel;
     std::unordered_map<std::string, int> table_lookup;
     std::unordered_map<int64_t, std::pair<int, int>> payload_positions;
     std::unordered_map<int64_t, int> delta_index_by_key;
     std::unordered_set<int64_t> tombstones;
+    // Key-based view of the base rows; scans use payload_status instead of the three key maps.
+    // Tables without an id column can repeat a key: base_index_by_key holds the first base row,
+    // base_key_next chains the others (-1 at the end).
+    DbCow<std::unordered_map<int64_t, int>> base_index_by_key;
+    DbCow<std::vector<int>> base_key_next;
+    std::vector<uint8_t> payload_status;
     int default_limit = -1;
     std::vector<DbDeltaOp> delta_history;
     std::unordered_map<std::string, DbView> views;
-    std::unordered_map<std::string, DbIndex> indexes;
+    std::unordered_map<std::string, DbCow<DbIndex>> indexes;
     bool autocommit = true;
     bool txn_active = false;
     size_t txn_start = 0;
     std::vector<std::pair<std::string, size_t>> txn_savepoints;
+    // Attached by db_wal_open; without it committed deltas live only in memory.
+    std::shared_ptr<DbWalState> wal;
 };
 
 struct DbIngestConfig {
@@ -101,6 +250,8 @@ struct DbIngestConfig {
     int spawn_x = -1;
     int spawn_y = -1;
     std::string rules_path;
+    int threads = 0; // Worker-Threads fuer den Ingest, 0 = automatisch
+    int relayout_percent = 25; // Merge: volles Re-Layout ab diesem Anteil geaenderter Payloads, 0 = immer
 };
 
 struct DbQuery {
@@ -111,14 +262,39 @@ struct DbQuery {
 
 int db_add_table(DbWorld &world, const std::string &name);
 int db_find_table(const DbWorld &world, const std::string &name);
+// Payload indices of one table in payload order (deltas included); filter visibility yourself.
+const std::vector<int> &db_table_payloads(const DbWorld &world, int table_id);
+// Also rebuilds base_index_by_key and payload_status from the delta store.
+void db_rebuild_table_payloads(DbWorld &world);
+// True for tombstoned rows, base rows shadowed by a delta and released delta slots.
+inline bool db_payload_hidden(const DbWorld &world, int payload_index) {
+    return (world.payload_status[static_cast<size_t>(payload_index)] & kDbPayloadHidden) != 0;
+}
+// Rebuilds the column store of every table changed since the last refresh, and the tile index
+// once placements have moved.
+void db_refresh_column_store(DbWorld &world);
+// nullptr while the table's column store is stale.
+const DbColumnTable *db_column_table(const DbWorld &world, int table_id);
+// Visible payloads of one table within `radius` of (cx, cy), deltas included, in payload order.
+// Walks only the tiles of the focus square that hold the table; returns false while the tile
+// index is stale or when the square is larger than a plain scan of the table.
+bool db_focus_payloads(const DbWorld &world, int table_id, int cx, int cy, int radius, std::vector<int> &out);
+// Runs fn(0..count-1) on up to `threads` worker threads (0 = automatisch) and returns when all are done.
+void db_parallel_for(size_t count, int threads, const std::function<void(size_t)> &fn);
 void db_init_world(DbWorld &world, int width, int height);
 bool db_place_payload(DbWorld &world, int payload_index, int x, int y);
 
 bool db_load_sql(const std::string &path, DbWorld &world, std::string &error);
 bool db_run_ingest(DbWorld &world, const DbIngestConfig &cfg, std::string &error);
 
+// .myco snapshots: saving writes binary MYCO2, loading accepts MYCO2 and the older MYCO1 text format.
 bool db_save_myco(const std::string &path, const DbWorld &world, std::string &error);
 bool db_load_myco(const std::string &path, DbWorld &world, std::string &error);
+// 2 for MYCO2, 1 for MYCO1, 0 if the file is unreadable or not a snapshot.
+int db_myco_version(const std::string &path);
+// MYCO1 text format, kept for migration and diffable exports.
+bool db_save_myco1(const std::string &path, const DbWorld &world, std::string &error);
+bool db_load_myco1(const std::string &path, DbWorld &world, std::string &error);
 bool db_save_cluster_ppm(const std::string &path, const DbWorld &world, int scale, std::string &error);
 
 bool db_parse_query(const std::string &query, DbQuery &out);
@@ -126,12 +302,38 @@ std::vector<int> db_execute_query(const DbWorld &world, const DbQuery &q, int ra
 std::vector<int> db_execute_query_focus(const DbWorld &world, const DbQuery &q, int center_x, int center_y, int radius);
 
 int64_t db_payload_key(int table_id, int id);
+// Visible payload of one key in O(1): its delta, else its first base row; -1 when deleted or absent.
+int db_find_payload(const DbWorld &world, int table_id, int id);
 size_t db_delta_count(const DbWorld &world);
 bool db_has_pending_delta(const DbWorld &world);
+
 bool db_merge_delta(DbWorld &world, const DbIngestConfig &cfg, std::string &error);
 bool db_apply_insert_sql(DbWorld &world, const std::string &stmt, int &rows, std::string &error);
+// Inserts plain (unquoted) values as one batch with a single undo entry; placement waits for the next merge.
+// `nulls` is empty or holds one flag per cell (row-major); a flagged cell is left out of its row and reads as NULL.
+bool db_bulk_insert(DbWorld &world,
+                    const std::string &table,
+                    const std::vector<std::string> &columns,
+                    std::vector<std::vector<std::string>> &rows,
+                    const std::vector<uint8_t> &nulls,
+                    int &inserted,
+                    std::string &error);
 bool db_apply_update_sql(DbWorld &world, const std::string &stmt, int &rows, std::string &error);
 bool db_apply_delete_sql(DbWorld &world, const std::string &stmt, int &rows, std::string &error);
+// Parsed INSERT/UPDATE/DELETE. Values keep their SQL form (quoted text, numbers, NULL), so a
+// prepared statement can parse once and replace its parameter slots before each run.
+struct DbDmlStatement {
+    enum Kind { INSERT, UPDATE, DELETE } kind = INSERT;
+    std::string table;
+    std::vector<std::string> columns;                        // INSERT, may be empty
+    std::vector<std::vector<std::string>> rows;              // INSERT
+    std::vector<std::pair<std::string, std::string>> sets;   // UPDATE
+    std::string where_col;                                   // UPDATE/DELETE
+    std::string where_val;
+};
+bool db_parse_dml(const std::string &stmt, DbDmlStatement &out, std::string &error);
+// Runs one parsed statement with the same undo/WAL handling as db_apply_*_sql; may consume stmt.rows.
+bool db_apply_dml(DbWorld &world, DbDmlStatement &stmt, int &rows, std::string &error);
 bool db_undo_last_delta(DbWorld &world, std::string &error);
 bool db_apply_create_table_sql(DbWorld &world, const std::string &stmt, std::string &error);
 bool db_apply_drop_table_sql(DbWorld &world, const std::string &stmt, std::string &error);
@@ -141,9 +343,52 @@ bool db_apply_create_view_sql(DbWorld &world, const std::string &stmt, std::stri
 bool db_apply_drop_view_sql(DbWorld &world, const std::string &stmt, std::string &error);
 bool db_apply_create_index_sql(DbWorld &world, const std::string &stmt, std::string &error);
 bool db_apply_drop_index_sql(DbWorld &world, const std::string &stmt, std::string &error);
+void db_rebuild_indexes(DbWorld &world);
+const DbIndex *db_find_index(const DbWorld &world, int table_id, const std::string &column, bool single_column);
+bool db_index_lookup_equal(const DbIndex &index, const std::string &value, std::vector<int> &out);
+bool db_index_lookup_range(const DbIndex &index, const std::string &low, const std::string &high, std::vector<int> &out);
 bool db_begin_tx(DbWorld &world, std::string &error);
 bool db_commit_tx(DbWorld &world, std::string &error);
 bool db_rollback_tx(DbWorld &world, std::string &error);
 bool db_savepoint_tx(DbWorld &world, const std::string &name, std::string &error);
 bool db_rollback_to_savepoint(DbWorld &world, const std::string &name, std::string &error);
 bool db_set_autocommit(DbWorld &world, bool enabled, std::string &error);
+
+// Write-ahead log <snapshot>.wal: every commit (or autocommit statement) appends one checksummed
+// frame with the final state of the rows it touched. db_load_myco replays the frames that belong
+// to the loaded snapshot; a torn last frame is dropped.
+// db_wal_open attaches the log to a world loaded from `myco_path`; sync_every N fsyncs after every
+// N commits (0 = only on db_wal_sync, checkpoint and close).
+bool db_wal_open(DbWorld &world, const std::string &myco_path, int sync_every, std::string &error);
+bool db_wal_append(DbWorld &world, const std::vector<DbWalRecord> &records, std::string &error);
+bool db_wal_sync(DbWorld &world, std::string &error);
+void db_wal_close(DbWorld &world);
+// Re-applies one logged row state as a delta (WAL replay).
+void db_apply_wal_record(DbWorld &world, const DbWalRecord &record);
+// Merges the deltas, rewrites the snapshot of the attached WAL and starts an empty log for it.
+bool db_checkpoint(DbWorld &world, const DbIngestConfig &cfg, std::string &error);
+
+// Read-only version of a world for concurrent readers. A reader pins the version it got from
+// db_acquire_snapshot through the shared_ptr; the version is freed when its last reader lets go.
+// The world holds what SQL reads; pheromones, density, mycel and payload positions stay empty.
+struct DbWorldSnapshot {
+    uint64_t version = 0;
+    DbWorld world;
+};
+
+// Publication point between one writer and any number of reader threads. The writer keeps
+// mutating its own DbWorld and calls db_publish_snapshot at commit boundaries; readers never see a
+// half-applied statement and never wait for the writer. `current` is only accessed through the
+// std::atomic_load/atomic_store overloads for shared_ptr.
+struct DbSnapshotStore {
+    std::shared_ptr<const DbWorldSnapshot> current;
+    uint64_t published = 0;
+};
+
+// Publishes the committed state of `world` (column store refreshed, without undo log and WAL) as a
+// new version. Base payloads, column stores, grid and unchanged indexes are shared with the writer;
+// only the delta overlay and the per-row bookkeeping are copied. Fails while a transaction is open.
+// Writer thread only.
+bool db_publish_snapshot(DbSnapshotStore &store, DbWorld &world, std::string &error);
+// Latest published version, or nullptr before the first publish. Safe from any thread.
+std::shared_ptr<const DbWorldSnapshot> db_acquire_snapshot(const DbSnapshotStore &store);
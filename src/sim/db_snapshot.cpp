@@ -0,0 +1,989 @@
+#include "db_engine.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// MYCO2 layout (little endian, sections 8-byte aligned):
+//   header   magic "MYCO2\0\0\0", version, width, height, section count, directory checksum
+//   directory one entry per section: kind, offset, size, FNV-1a checksum of the section bytes
+//   STRINGS  count, offsets[count + 1], blob (deduplicated table/column/field names and values)
+//   TABLES   per table: name id, column count, column ids
+//   PAYLOADS fixed records (id, table, x, y, raw id, field/fk ranges)
+//   FIELDS   (name id, value id) pairs, FKEYS (table, id, column id) records
+//   INDEXES  per index: name id, table id, unique flag, column count, column ids
+//   CELLS    width * height payload indices (-1 = free), the spatial cell map
+namespace {
+
+const char kMyco2Magic[8] = {'M', 'Y', 'C', 'O', '2', '\0', '\0', '\0'};
+const uint32_t kMyco2Version = 1;
+
+enum SectionKind : uint32_t {
+    SECTION_STRINGS = 1,
+    SECTION_TABLES = 2,
+    SECTION_PAYLOADS = 3,
+    SECTION_FIELDS = 4,
+    SECTION_FKEYS = 5,
+    SECTION_INDEXES = 6,
+    SECTION_CELLS = 7,
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    uint32_t section_count;
+    uint64_t directory_checksum;
+};
+
+struct SectionEntry {
+    uint32_t kind;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+struct PayloadRecord {
+    int32_t id;
+    int32_t table_id;
+    int32_t x;
+    int32_t y;
+    uint32_t raw_sid;
+    uint32_t placed;
+    uint64_t first_field;
+    uint64_t first_fk;
+    uint32_t field_count;
+    uint32_t fk_count;
+};
+
+struct FieldRecord {
+    uint32_t name_sid;
+    uint32_t value_sid;
+};
+
+struct ForeignKeyRecord {
+    int32_t table_id;
+    int32_t id;
+    uint32_t column_sid;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 32, "MYCO2 header layout");
+static_assert(sizeof(SectionEntry) == 32, "MYCO2 directory layout");
+static_assert(sizeof(PayloadRecord) == 48, "MYCO2 payload layout");
+
+std::string to_lower_ascii(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+uint64_t fnv1a(const unsigned char *data, size_t size) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+class SectionWriter {
+public:
+    template <typename T>
+    void put(const T &value) {
+        const char *p = reinterpret_cast<const char *>(&value);
+        bytes.insert(bytes.end(), p, p + sizeof(T));
+    }
+    void put_bytes(const void *data, size_t size) {
+        const char *p = static_cast<const char *>(data);
+        bytes.insert(bytes.end(), p, p + size);
+    }
+    void align() {
+        while (bytes.size() % 8 != 0) bytes.push_back('\0');
+    }
+    std::vector<char> bytes;
+};
+
+class StringTable {
+public:
+    uint32_t id(const std::string &s) {
+        auto it = ids.find(s);
+        if (it != ids.end()) return it->second;
+        uint32_t next = static_cast<uint32_t>(strings.size());
+        auto inserted = ids.emplace(s, next);
+        strings.push_back(&inserted.first->first);
+        return next;
+    }
+    void write(SectionWriter &w) const {
+        w.put(static_cast<uint64_t>(strings.size()));
+        uint64_t offset = 0;
+        for (const std::string *s : strings) {
+            w.put(offset);
+            offset += s->size();
+        }
+        w.put(offset);
+        for (const std::string *s : strings) {
+            w.put_bytes(s->data(), s->size());
+        }
+        w.align();
+    }
+
+private:
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<const std::string *> strings;
+};
+
+// Read-only view of the whole file; mmap where available so sections are read in place.
+class MappedFile {
+public:
+    ~MappedFile() { close(); }
+
+    bool open(const std::string &path, std::string &error) {
+#if defined(_WIN32)
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            error = "MYCO-Datei konnte nicht geoeffnet werden: " + path;
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size)) {
+            error = "MYCO-Dateigroesse unbekannt: " + path;
+            return false;
+        }
+        size_ = static_cast<size_t>(size.QuadPart);
+        if (size_ == 0) return true;
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) {
+            error = "MYCO-Datei konnte nicht gemappt werden: " + path;
+            return false;
+        }
+        data_ = static_cast<const unsigned char *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            error = "MYCO-Datei konnte nicht geoeffnet werden: " + path;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd_, &st) != 0) {
+            error = "MYCO-Dateigroesse unbekannt: " + path;
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ == 0) return true;
+        void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        data_ = (p == MAP_FAILED) ? nullptr : static_cast<const unsigned char *>(p);
+#endif
+        if (!data_) {
+            error = "MYCO-Datei konnte nicht gemappt werden: " + path;
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#if defined(_WIN32)
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) munmap(const_cast<unsigned char *>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const unsigned char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const unsigned char *data_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+// Bounds-checked cursor over one section.
+struct SectionReader {
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+
+    template <typename T>
+    bool get(T &out) {
+        if (size - pos < sizeof(T)) return false;
+        std::memcpy(&out, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+    // Start of count records of T, or nullptr if the section is too short.
+    template <typename T>
+    const unsigned char *take(uint64_t count) {
+        if (count > (size - pos) / sizeof(T)) return nullptr;
+        const unsigned char *p = data + pos;
+        pos += static_cast<size_t>(count) * sizeof(T);
+        return p;
+    }
+};
+
+struct StringView {
+    const unsigned char *offsets = nullptr;
+    const unsigned char *blob = nullptr;
+    uint64_t count = 0;
+    uint64_t blob_size = 0;
+
+    bool get(uint32_t sid, std::string &out) const {
+        if (sid >= count) return false;
+        uint64_t range[2];
+        std::memcpy(range, offsets + static_cast<size_t>(sid) * sizeof(uint64_t), sizeof(range));
+        if (range[0] > range[1] || range[1] > blob_size) return false;
+        out.assign(reinterpret_cast<const char *>(blob + range[0]), static_cast<size_t>(range[1] - range[0]));
+        return true;
+    }
+};
+
+template <typename T>
+T read_record(const unsigned char *base, size_t i) {
+    T out;
+    std::memcpy(&out, base + i * sizeof(T), sizeof(T));
+    return out;
+}
+
+bool load_myco2(const MappedFile &file, const std::string &path, DbWorld &world, std::string &error) {
+    const unsigned char *data = file.data();
+    size_t size = file.size();
+    FileHeader header;
+    if (size < sizeof(header)) {
+        error = "MYCO2-Header unvollstaendig: " + path;
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != kMyco2Version) {
+        error = "MYCO2-Version " + std::to_string(header.version) + " nicht unterstuetzt.";
+        return false;
+    }
+    if (header.width <= 0 || header.height <= 0) {
+        error = "MYCO-Dimension ungueltig.";
+        return false;
+    }
+    size_t dir_bytes = static_cast<size_t>(header.section_count) * sizeof(SectionEntry);
+    if (header.section_count > 64 || size - sizeof(header) < dir_bytes) {
+        error = "MYCO2-Verzeichnis unvollstaendig.";
+        return false;
+    }
+    const unsigned char *dir = data + sizeof(header);
+    if (fnv1a(dir, dir_bytes) != header.directory_checksum) {
+        error = "MYCO2-Verzeichnis: Pruefsumme falsch.";
+        return false;
+    }
+    SectionReader sections[8];
+    for (uint32_t i = 0; i < header.section_count; ++i) {
+        SectionEntry entry = read_record<SectionEntry>(dir, i);
+        if (entry.offset > size || entry.size > size - entry.offset) {
+            error = "MYCO2-Abschnitt " + std::to_string(entry.kind) + " ausserhalb der Datei.";
+            return false;
+        }
+        const unsigned char *begin = data + entry.offset;
+        if (fnv1a(begin, static_cast<size_t>(entry.size)) != entry.checksum) {
+            error = "MYCO2-Abschnitt " + std::to_string(entry.kind) + ": Pruefsumme falsch.";
+            return false;
+        }
+        if (entry.kind < 8) {
+            sections[entry.kind] = SectionReader{begin, static_cast<size_t>(entry.size), 0};
+        }
+    }
+    for (uint32_t kind = SECTION_STRINGS; kind <= SECTION_CELLS; ++kind) {
+        if (!sections[kind].data) {
+            error = "MYCO2-Abschnitt " + std::to_string(kind) + " fehlt.";
+            return false;
+        }
+    }
+    auto corrupt = [&](const char *what) {
+        error = std::string("MYCO2-Abschnitt ") + what + " beschaedigt.";
+        return false;
+    };
+
+    StringView strings;
+    {
+        SectionReader &r = sections[SECTION_STRINGS];
+        if (!r.get(strings.count) || strings.count >= r.size || !(strings.offsets = r.take<uint64_t>(strings.count + 1))) {
+            return corrupt("STRINGS");
+        }
+        std::memcpy(&strings.blob_size, strings.offsets + static_cast<size_t>(strings.count) * sizeof(uint64_t), sizeof(uint64_t));
+        if (!(strings.blob = r.take<char>(strings.blob_size))) return corrupt("STRINGS");
+    }
+
+    world = DbWorld{};
+    world.width = header.width;
+    world.height = header.height;
+    {
+        SectionReader &r = sections[SECTION_TABLES];
+        uint32_t table_count = 0;
+        if (!r.get(table_count)) return corrupt("TABLES");
+        world.table_names.resize(table_count);
+        world.table_columns.resize(table_count);
+        for (uint32_t t = 0; t < table_count; ++t) {
+            uint32_t name_sid = 0;
+            uint32_t column_count = 0;
+            if (!r.get(name_sid) || !r.get(column_count) || !strings.get(name_sid, world.table_names[t])) return corrupt("TABLES");
+            auto &cols = world.table_columns[t];
+            cols.resize(column_count);
+            for (uint32_t c = 0; c < column_count; ++c) {
+                uint32_t sid = 0;
+                if (!r.get(sid) || !strings.get(sid, cols[c])) return corrupt("TABLES");
+            }
+            world.table_lookup[to_lower_ascii(world.table_names[t])] = static_cast<int>(t);
+        }
+    }
+
+    uint64_t field_total = 0;
+    uint64_t fk_total = 0;
+    const unsigned char *fields = nullptr;
+    const unsigned char *fkeys = nullptr;
+    if (!sections[SECTION_FIELDS].get(field_total) || !(fields = sections[SECTION_FIELDS].take<FieldRecord>(field_total))) {
+        return corrupt("FIELDS");
+    }
+    if (!sections[SECTION_FKEYS].get(fk_total) || !(fkeys = sections[SECTION_FKEYS].take<ForeignKeyRecord>(fk_total))) {
+        return corrupt("FKEYS");
+    }
+    {
+        SectionReader &r = sections[SECTION_PAYLOADS];
+        uint64_t payload_count = 0;
+        const unsigned char *records = nullptr;
+        if (!r.get(payload_count) || !(records = r.take<PayloadRecord>(payload_count))) return corrupt("PAYLOADS");
+        world.payloads.resize(static_cast<size_t>(payload_count));
+        for (size_t i = 0; i < world.payloads.size(); ++i) {
+            PayloadRecord rec = read_record<PayloadRecord>(records, i);
+            if (rec.first_field > field_total || rec.field_count > field_total - rec.first_field ||
+                rec.first_fk > fk_total || rec.fk_count > fk_total - rec.first_fk) {
+                return corrupt("PAYLOADS");
+            }
+            DbPayload &p = world.payloads.mut(i);
+            p.id = rec.id;
+            p.table_id = rec.table_id;
+            p.x = rec.x;
+            p.y = rec.y;
+            p.placed = rec.placed != 0;
+            if (!strings.get(rec.raw_sid, p.raw_data)) return corrupt("PAYLOADS");
+            p.fields.resize(rec.field_count);
+            for (uint32_t f = 0; f < rec.field_count; ++f) {
+                FieldRecord fr = read_record<FieldRecord>(fields, static_cast<size_t>(rec.first_field + f));
+                if (!strings.get(fr.name_sid, p.fields[f].name) || !strings.get(fr.value_sid, p.fields[f].value)) {
+                    return corrupt("FIELDS");
+                }
+            }
+            p.foreign_keys.resize(rec.fk_count);
+            for (uint32_t f = 0; f < rec.fk_count; ++f) {
+                ForeignKeyRecord kr = read_record<ForeignKeyRecord>(fkeys, static_cast<size_t>(rec.first_fk + f));
+                DbForeignKey &fk = p.foreign_keys[f];
+                fk.table_id = kr.table_id;
+                fk.id = kr.id;
+                if (!strings.get(kr.column_sid, fk.column)) return corrupt("FKEYS");
+            }
+        }
+    }
+    {
+        SectionReader &r = sections[SECTION_INDEXES];
+        uint32_t index_count = 0;
+        if (!r.get(index_count)) return corrupt("INDEXES");
+        for (uint32_t i = 0; i < index_count; ++i) {
+            DbIndex index;
+            uint32_t name_sid = 0;
+            uint32_t table_sid = 0;
+            uint32_t unique = 0;
+            uint32_t column_count = 0;
+            if (!r.get(name_sid) || !r.get(table_sid) || !r.get(unique) || !r.get(column_count) ||
+                !strings.get(name_sid, index.name) || !strings.get(table_sid, index.table)) {
+                return corrupt("INDEXES");
+            }
+            index.unique = unique != 0;
+            index.columns.resize(column_count);
+            for (uint32_t c = 0; c < column_count; ++c) {
+                uint32_t sid = 0;
+                if (!r.get(sid) || !strings.get(sid, index.columns[c])) return corrupt("INDEXES");
+            }
+            world.indexes[to_lower_ascii(index.name)] = DbCow<DbIndex>(std::move(index));
+        }
+    }
+    size_t cell_count = static_cast<size_t>(header.width) * static_cast<size_t>(header.height);
+    const unsigned char *cells = sections[SECTION_CELLS].take<int32_t>(cell_count);
+    if (!cells) return corrupt("CELLS");
+
+    db_rebuild_table_payloads(world);
+    db_rebuild_indexes(world);
+    db_init_world(world, header.width, header.height);
+    for (size_t c = 0; c < cell_count; ++c) {
+        int32_t payload_index = read_record<int32_t>(cells, c);
+        if (payload_index < 0) continue;
+        int x = static_cast<int>(c % static_cast<size_t>(header.width));
+        int y = static_cast<int>(c / static_cast<size_t>(header.width));
+        if (!db_place_payload(world, payload_index, x, y)) return corrupt("CELLS");
+    }
+    return true;
+}
+
+// WAL layout (little endian): header magic "MYCOWAL1", version, stamp of the snapshot it extends;
+// then one frame per commit: record count, body size, FNV-1a of the body, body. A body record is
+// key and deleted flag, for live rows followed by id, table, raw data, fields and foreign keys
+// (strings as u32 length + bytes).
+const char kWalMagic[8] = {'M', 'Y', 'C', 'O', 'W', 'A', 'L', '1'};
+const uint32_t kWalVersion = 1;
+
+struct WalHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t snapshot_stamp;
+};
+
+struct WalFrameHeader {
+    uint32_t record_count;
+    uint32_t reserved;
+    uint64_t body_size;
+    uint64_t checksum;
+};
+
+static_assert(sizeof(WalHeader) == 24, "WAL header layout");
+static_assert(sizeof(WalFrameHeader) == 24, "WAL frame layout");
+
+std::string wal_path_for(const std::string &myco_path) {
+    return myco_path + ".wal";
+}
+
+// Identifies the snapshot a WAL extends: the MYCO2 directory checksum (it covers every section
+// checksum), for MYCO1 a hash of the whole file.
+bool snapshot_stamp(const std::string &path, uint64_t &out) {
+    MappedFile file;
+    std::string ignored;
+    if (!file.open(path, ignored) || file.size() < sizeof(FileHeader)) return false;
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMyco2Magic, sizeof(header.magic)) == 0) {
+        out = header.directory_checksum;
+    } else {
+        out = fnv1a(file.data(), file.size());
+    }
+    return true;
+}
+
+void put_wal_string(SectionWriter &w, const std::string &s) {
+    w.put(static_cast<uint32_t>(s.size()));
+    w.put_bytes(s.data(), s.size());
+}
+
+bool get_wal_string(SectionReader &r, std::string &out) {
+    uint32_t size = 0;
+    const unsigned char *p = nullptr;
+    if (!r.get(size) || !(p = r.take<char>(size))) return false;
+    out.assign(reinterpret_cast<const char *>(p), size);
+    return true;
+}
+
+void encode_wal_record(SectionWriter &w, const DbWalRecord &rec) {
+    w.put(rec.key);
+    w.put(static_cast<uint8_t>(rec.deleted ? 1 : 0));
+    if (rec.deleted) return;
+    const DbPayload &p = rec.payload;
+    w.put(static_cast<int32_t>(p.id));
+    w.put(static_cast<int32_t>(p.table_id));
+    put_wal_string(w, p.raw_data);
+    w.put(static_cast<uint32_t>(p.fields.size()));
+    for (const auto &f : p.fields) {
+        put_wal_string(w, f.name);
+        put_wal_string(w, f.value);
+    }
+    w.put(static_cast<uint32_t>(p.foreign_keys.size()));
+    for (const auto &fk : p.foreign_keys) {
+        w.put(static_cast<int32_t>(fk.table_id));
+        w.put(static_cast<int32_t>(fk.id));
+        put_wal_string(w, fk.column);
+    }
+}
+
+bool decode_wal_record(SectionReader &r, DbWalRecord &rec) {
+    uint8_t deleted = 0;
+    if (!r.get(rec.key) || !r.get(deleted)) return false;
+    rec.deleted = deleted != 0;
+    if (rec.deleted) return true;
+    DbPayload &p = rec.payload;
+    int32_t id = 0;
+    int32_t table_id = 0;
+    uint32_t count = 0;
+    if (!r.get(id) || !r.get(table_id) || !get_wal_string(r, p.raw_data) || !r.get(count)) return false;
+    p.id = id;
+    p.table_id = table_id;
+    for (uint32_t i = 0; i < count; ++i) {
+        DbField f;
+        if (!get_wal_string(r, f.name) || !get_wal_string(r, f.value)) return false;
+        p.fields.push_back(std::move(f));
+    }
+    if (!r.get(count)) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        DbForeignKey fk;
+        int32_t fk_table = 0;
+        int32_t fk_id = 0;
+        if (!r.get(fk_table) || !r.get(fk_id) || !get_wal_string(r, fk.column)) return false;
+        fk.table_id = fk_table;
+        fk.id = fk_id;
+        p.foreign_keys.push_back(std::move(fk));
+    }
+    return true;
+}
+
+// Calls on_frame for every intact frame and returns the length of the intact prefix
+// (0 when the log is missing, foreign or belongs to another snapshot).
+template <typename Fn>
+size_t scan_wal(const MappedFile &file, uint64_t stamp, Fn &&on_frame) {
+    const unsigned char *data = file.data();
+    size_t size = file.size();
+    WalHeader header;
+    if (!data || size < sizeof(header)) return 0;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kWalMagic, sizeof(header.magic)) != 0 || header.version != kWalVersion ||
+        header.snapshot_stamp != stamp) {
+        return 0;
+    }
+    size_t pos = sizeof(header);
+    std::vector<DbWalRecord> records;
+    while (size - pos >= sizeof(WalFrameHeader)) {
+        WalFrameHeader frame;
+        std::memcpy(&frame, data + pos, sizeof(frame));
+        size_t body_pos = pos + sizeof(frame);
+        if (frame.body_size > size - body_pos) break;
+        const unsigned char *body = data + body_pos;
+        if (fnv1a(body, static_cast<size_t>(frame.body_size)) != frame.checksum) break;
+        SectionReader r{body, static_cast<size_t>(frame.body_size), 0};
+        records.clear();
+        bool ok = true;
+        for (uint32_t i = 0; i < frame.record_count && ok; ++i) {
+            DbWalRecord rec;
+            ok = decode_wal_record(r, rec);
+            records.push_back(std::move(rec));
+        }
+        if (!ok || r.pos != r.size || !on_frame(records)) break;
+        pos = body_pos + static_cast<size_t>(frame.body_size);
+    }
+    return pos;
+}
+
+bool sync_file(std::FILE *f) {
+    if (std::fflush(f) != 0) return false;
+#if defined(_WIN32)
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+bool truncate_file(std::FILE *f, uint64_t size) {
+#if defined(_WIN32)
+    return _chsize_s(_fileno(f), static_cast<__int64>(size)) == 0;
+#else
+    return ftruncate(fileno(f), static_cast<off_t>(size)) == 0;
+#endif
+}
+
+bool replace_file(const std::string &from, const std::string &to) {
+#if defined(_WIN32)
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+bool replay_wal(const std::string &myco_path, DbWorld &world, std::string &error) {
+    MappedFile file;
+    std::string ignored;
+    if (!file.open(wal_path_for(myco_path), ignored)) return true;
+    uint64_t stamp = 0;
+    if (!snapshot_stamp(myco_path, stamp)) return true;
+    bool ok = true;
+    scan_wal(file, stamp, [&](const std::vector<DbWalRecord> &records) {
+        for (const auto &rec : records) {
+            int table_id = static_cast<int>(rec.key >> 32);
+            if (table_id < 0 || table_id >= static_cast<int>(world.table_names.size())) {
+                error = "WAL passt nicht zum Snapshot (Tabelle " + std::to_string(table_id) + ").";
+                ok = false;
+                return false;
+            }
+            db_apply_wal_record(world, rec);
+        }
+        return true;
+    });
+    return ok;
+}
+
+} // namespace
+
+struct DbWalState {
+    std::string snapshot_path;
+    std::string path;
+    std::FILE *file = nullptr;
+    uint64_t size = 0;
+    int sync_every = 1;
+    int unsynced = 0;
+
+    ~DbWalState() {
+        if (file) {
+            sync_file(file);
+            std::fclose(file);
+        }
+    }
+};
+
+namespace {
+
+// Starts an empty log for the snapshot with `stamp`, replacing whatever was there.
+bool start_wal(DbWalState &wal, uint64_t stamp, std::string &error) {
+    if (wal.file) {
+        std::fclose(wal.file);
+    }
+    wal.file = std::fopen(wal.path.c_str(), "wb");
+    if (!wal.file) {
+        error = "WAL konnte nicht angelegt werden: " + wal.path;
+        return false;
+    }
+    WalHeader header = {};
+    std::memcpy(header.magic, kWalMagic, sizeof(header.magic));
+    header.version = kWalVersion;
+    header.snapshot_stamp = stamp;
+    if (std::fwrite(&header, sizeof(header), 1, wal.file) != 1 || !sync_file(wal.file)) {
+        error = "WAL konnte nicht geschrieben werden: " + wal.path;
+        return false;
+    }
+    wal.size = sizeof(header);
+    wal.unsynced = 0;
+    return true;
+}
+
+} // namespace
+
+int db_myco_version(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[8] = {};
+    if (!in.read(magic, sizeof(magic))) {
+        return 0;
+    }
+    if (std::memcmp(magic, kMyco2Magic, sizeof(magic)) == 0) {
+        return 2;
+    }
+    if (std::memcmp(magic, "MYCO1", 5) == 0) {
+        return 1;
+    }
+    return 0;
+}
+
+bool db_save_myco(const std::string &path, const DbWorld &world, std::string &error) {
+    if (db_has_pending_delta(world)) {
+        error = "Delta-Writes ausstehend: bitte merge ausfuehren, bevor gespeichert wird.";
+        return false;
+    }
+    StringTable strings;
+    SectionWriter tables;
+    tables.put(static_cast<uint32_t>(world.table_names.size()));
+    for (size_t t = 0; t < world.table_names.size(); ++t) {
+        const auto &cols = (t < world.table_columns.size()) ? world.table_columns[t] : std::vector<std::string>{};
+        tables.put(strings.id(world.table_names[t]));
+        tables.put(static_cast<uint32_t>(cols.size()));
+        for (const auto &c : cols) {
+            tables.put(strings.id(c));
+        }
+    }
+    tables.align();
+
+    SectionWriter payloads;
+    SectionWriter fields;
+    SectionWriter fkeys;
+    uint64_t field_total = 0;
+    uint64_t fk_total = 0;
+    for (const auto &p : world.payloads) {
+        field_total += p.fields.size();
+        fk_total += p.foreign_keys.size();
+    }
+    payloads.put(static_cast<uint64_t>(world.payloads.size()));
+    fields.put(field_total);
+    fkeys.put(fk_total);
+    payloads.bytes.reserve(8 + world.payloads.size() * sizeof(PayloadRecord));
+    fields.bytes.reserve(8 + static_cast<size_t>(field_total) * sizeof(FieldRecord));
+    uint64_t next_field = 0;
+    uint64_t next_fk = 0;
+    for (const auto &p : world.payloads) {
+        PayloadRecord rec = {};
+        rec.id = p.id;
+        rec.table_id = p.table_id;
+        rec.x = p.x;
+        rec.y = p.y;
+        rec.raw_sid = strings.id(p.raw_data);
+        rec.placed = p.placed ? 1 : 0;
+        rec.first_field = next_field;
+        rec.first_fk = next_fk;
+        rec.field_count = static_cast<uint32_t>(p.fields.size());
+        rec.fk_count = static_cast<uint32_t>(p.foreign_keys.size());
+        payloads.put(rec);
+        for (const auto &f : p.fields) {
+            fields.put(FieldRecord{strings.id(f.name), strings.id(f.value)});
+        }
+        for (const auto &fk : p.foreign_keys) {
+            fkeys.put(ForeignKeyRecord{fk.table_id, fk.id, strings.id(fk.column), 0});
+        }
+        next_field += p.fields.size();
+        next_fk += p.foreign_keys.size();
+    }
+    payloads.align();
+    fields.align();
+    fkeys.align();
+
+    std::vector<const DbIndex *> indexes;
+    for (const auto &pair : world.indexes) {
+        indexes.push_back(&*pair.second);
+    }
+    std::sort(indexes.begin(), indexes.end(), [](const DbIndex *a, const DbIndex *b) { return a->name < b->name; });
+    SectionWriter index_section;
+    index_section.put(static_cast<uint32_t>(indexes.size()));
+    for (const DbIndex *index : indexes) {
+        index_section.put(strings.id(index->name));
+        index_section.put(strings.id(index->table));
+        index_section.put(static_cast<uint32_t>(index->unique ? 1 : 0));
+        index_section.put(static_cast<uint32_t>(index->columns.size()));
+        for (const auto &c : index->columns) {
+            index_section.put(strings.id(c));
+        }
+    }
+    index_section.align();
+
+    SectionWriter cells;
+    size_t cell_count = static_cast<size_t>(world.width) * static_cast<size_t>(world.height);
+    cells.bytes.reserve(cell_count * sizeof(int32_t));
+    const std::vector<int> &grid = *world.cell_payload;
+    for (size_t c = 0; c < cell_count; ++c) {
+        cells.put(static_cast<int32_t>(c < grid.size() ? grid[c] : -1));
+    }
+
+    SectionWriter string_section;
+    strings.write(string_section);
+
+    const std::pair<SectionKind, const SectionWriter *> order[] = {
+        {SECTION_STRINGS, &string_section},
+        {SECTION_TABLES, &tables},
+        {SECTION_PAYLOADS, &payloads},
+        {SECTION_FIELDS, &fields},
+        {SECTION_FKEYS, &fkeys},
+        {SECTION_INDEXES, &index_section},
+        {SECTION_CELLS, &cells},
+    };
+    const uint32_t section_count = static_cast<uint32_t>(sizeof(order) / sizeof(order[0]));
+    std::vector<SectionEntry> directory;
+    uint64_t offset = sizeof(FileHeader) + section_count * sizeof(SectionEntry);
+    offset = (offset + 7) / 8 * 8;
+    uint64_t data_start = offset;
+    for (const auto &entry : order) {
+        const auto &bytes = entry.second->bytes;
+        SectionEntry e = {};
+        e.kind = entry.first;
+        e.offset = offset;
+        e.size = bytes.size();
+        e.checksum = fnv1a(reinterpret_cast<const unsigned char *>(bytes.data()), bytes.size());
+        directory.push_back(e);
+        offset += (bytes.size() + 7) / 8 * 8;
+    }
+    FileHeader header = {};
+    std::memcpy(header.magic, kMyco2Magic, sizeof(header.magic));
+    header.version = kMyco2Version;
+    header.width = world.width;
+    header.height = world.height;
+    header.section_count = section_count;
+    header.directory_checksum = fnv1a(reinterpret_cast<const unsigned char *>(directory.data()),
+                                      directory.size() * sizeof(SectionEntry));
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        error = "MYCO-Datei konnte nicht geschrieben werden: " + path;
+        return false;
+    }
+    const char zeros[8] = {};
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(directory.data()), static_cast<std::streamsize>(directory.size() * sizeof(SectionEntry)));
+    out.write(zeros, static_cast<std::streamsize>(data_start - sizeof(header) - directory.size() * sizeof(SectionEntry)));
+    for (const auto &entry : order) {
+        const auto &bytes = entry.second->bytes;
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        out.write(zeros, static_cast<std::streamsize>((8 - bytes.size() % 8) % 8));
+    }
+    if (!out) {
+        error = "MYCO-Datei konnte nicht geschrieben werden: " + path;
+        return false;
+    }
+    return true;
+}
+
+bool db_load_myco(const std::string &path, DbWorld &world, std::string &error) {
+    int version = db_myco_version(path);
+    if (version == 1) {
+        return db_load_myco1(path, world, error) && replay_wal(path, world, error);
+    }
+    if (version != 2) {
+        std::ifstream probe(path);
+        error = probe.is_open() ? "MYCO-Header ungueltig." : "MYCO-Datei konnte nicht geoeffnet werden: " + path;
+        return false;
+    }
+    {
+        MappedFile file;
+        if (!file.open(path, error) || !load_myco2(file, path, world, error)) {
+            return false;
+        }
+    }
+    return replay_wal(path, world, error);
+}
+
+bool db_wal_open(DbWorld &world, const std::string &myco_path, int sync_every, std::string &error) {
+    if (world.txn_active) {
+        error = "WAL: Transaktion laeuft noch.";
+        return false;
+    }
+    uint64_t stamp = 0;
+    if (!snapshot_stamp(myco_path, stamp)) {
+        error = "WAL: Snapshot nicht lesbar: " + myco_path;
+        return false;
+    }
+    auto wal = std::make_shared<DbWalState>();
+    wal->snapshot_path = myco_path;
+    wal->path = wal_path_for(myco_path);
+    wal->sync_every = std::max(0, sync_every);
+    size_t intact = 0;
+    {
+        MappedFile file;
+        std::string ignored;
+        if (file.open(wal->path, ignored)) {
+            intact = scan_wal(file, stamp, [](const std::vector<DbWalRecord> &) { return true; });
+        }
+    }
+    if (intact == 0) {
+        if (!start_wal(*wal, stamp, error)) return false;
+    } else {
+        // Frames were replayed by db_load_myco; a torn tail is cut before appending.
+        wal->file = std::fopen(wal->path.c_str(), "r+b");
+        if (!wal->file || !truncate_file(wal->file, intact) || std::fseek(wal->file, 0, SEEK_END) != 0) {
+            error = "WAL konnte nicht geoeffnet werden: " + wal->path;
+            return false;
+        }
+        wal->size = intact;
+    }
+    world.wal = std::move(wal);
+    return true;
+}
+
+bool db_wal_append(DbWorld &world, const std::vector<DbWalRecord> &records, std::string &error) {
+    if (!world.wal || records.empty()) {
+        return true;
+    }
+    DbWalState &wal = *world.wal;
+    if (!wal.file) {
+        error = "WAL nicht geoeffnet: " + wal.path;
+        return false;
+    }
+    SectionWriter body;
+    for (const auto &rec : records) {
+        encode_wal_record(body, rec);
+    }
+    WalFrameHeader frame = {};
+    frame.record_count = static_cast<uint32_t>(records.size());
+    frame.body_size = body.bytes.size();
+    frame.checksum = fnv1a(reinterpret_cast<const unsigned char *>(body.bytes.data()), body.bytes.size());
+    SectionWriter out;
+    out.bytes.reserve(sizeof(frame) + body.bytes.size());
+    out.put(frame);
+    out.put_bytes(body.bytes.data(), body.bytes.size());
+    // One write per commit; fsync only every sync_every commits.
+    if (std::fwrite(out.bytes.data(), 1, out.bytes.size(), wal.file) != out.bytes.size() || std::fflush(wal.file) != 0) {
+        std::clearerr(wal.file);
+        truncate_file(wal.file, wal.size);
+        std::fseek(wal.file, 0, SEEK_END);
+        error = "WAL konnte nicht geschrieben werden: " + wal.path;
+        return false;
+    }
+    wal.size += out.bytes.size();
+    wal.unsynced++;
+    if (wal.sync_every > 0 && wal.unsynced >= wal.sync_every) {
+        return db_wal_sync(world, error);
+    }
+    return true;
+}
+
+bool db_wal_sync(DbWorld &world, std::string &error) {
+    if (!world.wal || !world.wal->file) {
+        return true;
+    }
+    if (!sync_file(world.wal->file)) {
+        error = "WAL: fsync fehlgeschlagen: " + world.wal->path;
+        return false;
+    }
+    world.wal->unsynced = 0;
+    return true;
+}
+
+void db_wal_close(DbWorld &world) {
+    world.wal.reset();
+}
+
+bool db_checkpoint(DbWorld &world, const DbIngestConfig &cfg, std::string &error) {
+    if (!world.wal) {
+        error = "Checkpoint: kein WAL geoeffnet.";
+        return false;
+    }
+    if (world.txn_active) {
+        error = "Checkpoint waehrend einer Transaktion nicht moeglich.";
+        return false;
+    }
+    if (!db_merge_delta(world, cfg, error)) {
+        return false;
+    }
+    DbWalState &wal = *world.wal;
+    // The new snapshot is complete on disk before the log is reset; a crash in between leaves a
+    // log with the old stamp, which the next load ignores.
+    std::string tmp = wal.snapshot_path + ".tmp";
+    if (!db_save_myco(tmp, world, error)) {
+        return false;
+    }
+    std::FILE *f = std::fopen(tmp.c_str(), "r+b");
+    bool synced = f && sync_file(f);
+    if (f) std::fclose(f);
+    if (!synced || !replace_file(tmp, wal.snapshot_path)) {
+        std::remove(tmp.c_str());
+        error = "Checkpoint: Snapshot konnte nicht ersetzt werden: " + wal.snapshot_path;
+        return false;
+    }
+    uint64_t stamp = 0;
+    if (!snapshot_stamp(wal.snapshot_path, stamp)) {
+        error = "Checkpoint: Snapshot nicht lesbar: " + wal.snapshot_path;
+        return false;
+    }
+    return start_wal(wal, stamp, error);
+}
@@ -5,6 +5,8 @@
 #include <cmath>
 #include <cstring>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <regex>
 #include <sstream>
@@ -152,6 +154,252 @@ struct Parser {
     }
 };
 
+// Parsed forms keyed by their source text. Repeated statements, correlated subqueries
+// and per-row CASE/function expressions reuse them instead of re-tokenizing.
+constexpr size_t kParseCacheLimit = 512;
+
+template <typename T>
+struct ParseCache {
+    std::unordered_map<std::string, std::shared_ptr<const T>> entries;
+
+    std::shared_ptr<const T> find(const std::string &key) const {
+        auto it = entries.find(key);
+        return it == entries.end() ? nullptr : it->second;
+    }
+    void put(const std::string &key, std::shared_ptr<const T> value) {
+        if (entries.size() >= kParseCacheLimit) {
+            entries.clear();
+        }
+        entries[key] = std::move(value);
+    }
+};
+
+// Collapses whitespace outside quotes so formatting differences share one cache entry.
+// Literals are copied with the tokenizer's rules, so a backslash pair never ends one.
+std::string normalize_sql_key(const std::string &sql) {
+    std::string out;
+    out.reserve(sql.size());
+    char quote = 0;
+    bool pending_space = false;
+    for (size_t i = 0; i < sql.size(); ++i) {
+        char c = sql[i];
+        if (quote) {
+            out.push_back(c);
+            if (c == '\\' && i + 1 < sql.size()) {
+                out.push_back(sql[++i]);
+            } else if (c == quote) {
+                quote = 0;
+            }
+            continue;
+        }
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            pending_space = !out.empty();
+            continue;
+        }
+        if (pending_space) {
+            out.push_back(' ');
+            pending_space = false;
+        }
+        if (c == '\'' || c == '"') quote = c;
+        out.push_back(c);
+    }
+    return out;
+}
+
+std::string strip_quotes(const std::string &s);
+
+// LIKE/REGEXP pattern compiled once: literal shapes become prefix/suffix/contains checks,
+// other LIKE patterns keep the lower-cased pattern for the wildcard matcher, REGEXP keeps the regex.
+struct TextPattern {
+    enum Kind { EXACT, PREFIX, SUFFIX, CONTAINS, LIKE_WILDCARD, REGEX, INVALID } kind = EXACT;
+    std::string needle;
+    std::regex re;
+};
+
+char lower_char(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+// Literal `needle` has no wildcard; the leading/trailing flags say whether it was anchored.
+void set_literal_pattern(TextPattern &pat, std::string needle, bool open_start, bool open_end) {
+    pat.needle = std::move(needle);
+    if (open_start && open_end) {
+        pat.kind = TextPattern::CONTAINS;
+    } else if (open_end) {
+        pat.kind = TextPattern::PREFIX;
+    } else if (open_start) {
+        pat.kind = TextPattern::SUFFIX;
+    } else {
+        pat.kind = TextPattern::EXACT;
+    }
+}
+
+std::shared_ptr<const TextPattern> compile_like(const std::string &pattern) {
+    auto pat = std::make_shared<TextPattern>();
+    std::string p = to_lower(pattern);
+    size_t begin = 0;
+    size_t end = p.size();
+    while (begin < end && p[begin] == '%') begin++;
+    while (end > begin && p[end - 1] == '%') end--;
+    std::string core = p.substr(begin, end - begin);
+    if (core.find_first_of("%_") == std::string::npos) {
+        set_literal_pattern(*pat, std::move(core), begin > 0, end < p.size());
+    } else {
+        pat->kind = TextPattern::LIKE_WILDCARD;
+        pat->needle = std::move(p);
+    }
+    return pat;
+}
+
+std::shared_ptr<const TextPattern> compile_regexp(const std::string &pattern) {
+    auto pat = std::make_shared<TextPattern>();
+    bool anchor_start = !pattern.empty() && pattern.front() == '^';
+    bool anchor_end = pattern.size() > (anchor_start ? 1u : 0u) && pattern.back() == '$';
+    std::string core = pattern.substr(anchor_start ? 1 : 0);
+    if (anchor_end) core.pop_back();
+    if (core.find_first_of("\\^$.|?*+()[]{}") == std::string::npos) {
+        set_literal_pattern(*pat, to_lower(core), !anchor_start, !anchor_end);
+        return pat;
+    }
+    try {
+        pat->re = std::regex(pattern, std::regex_constants::icase);
+        pat->kind = TextPattern::REGEX;
+    } catch (...) {
+        pat->kind = TextPattern::INVALID;
+    }
+    return pat;
+}
+
+// Pattern whose text is only known per row (e.g. a column on the right-hand side).
+const TextPattern &cached_pattern(const std::string &pattern, bool regexp) {
+    thread_local ParseCache<TextPattern> like_cache;
+    thread_local ParseCache<TextPattern> regexp_cache;
+    ParseCache<TextPattern> &cache = regexp ? regexp_cache : like_cache;
+    auto hit = cache.find(pattern);
+    if (!hit) {
+        hit = regexp ? compile_regexp(pattern) : compile_like(pattern);
+        cache.put(pattern, hit);
+    }
+    return *hit;
+}
+
+bool ieq_span(const char *text, const std::string &lower, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (lower_char(text[i]) != lower[i]) return false;
+    }
+    return true;
+}
+
+// SQL LIKE on an already lower-cased text and pattern: '%' any run, '_' one character.
+bool like_wildcard_match(const std::string &t, const std::string &p) {
+    size_t ti = 0, pi = 0, star = std::string::npos, match = 0;
+    while (ti < t.size()) {
+        if (pi < p.size() && (p[pi] == '_' || p[pi] == t[ti])) {
+            pi++;
+            ti++;
+            continue;
+        }
+        if (pi < p.size() && p[pi] == '%') {
+            star = pi++;
+            match = ti;
+            continue;
+        }
+        if (star != std::string::npos) {
+            pi = star + 1;
+            ti = ++match;
+            continue;
+        }
+        return false;
+    }
+    while (pi < p.size() && p[pi] == '%') pi++;
+    return pi == p.size();
+}
+
+// Case-insensitive for both LIKE and REGEXP.
+bool pattern_match(const TextPattern &pat, const std::string &text) {
+    const std::string &n = pat.needle;
+    switch (pat.kind) {
+        case TextPattern::EXACT:
+            return text.size() == n.size() && ieq_span(text.data(), n, n.size());
+        case TextPattern::PREFIX:
+            return text.size() >= n.size() && ieq_span(text.data(), n, n.size());
+        case TextPattern::SUFFIX:
+            return text.size() >= n.size() && ieq_span(text.data() + text.size() - n.size(), n, n.size());
+        case TextPattern::CONTAINS:
+        case TextPattern::LIKE_WILDCARD: {
+            if (pat.kind == TextPattern::CONTAINS && n.empty()) return true;
+            thread_local std::string lowered;
+            lowered.resize(text.size());
+            std::transform(text.begin(), text.end(), lowered.begin(), lower_char);
+            if (pat.kind == TextPattern::CONTAINS) return lowered.find(n) != std::string::npos;
+            return like_wildcard_match(lowered, n);
+        }
+        case TextPattern::REGEX:
+            return std::regex_search(text, pat.re);
+        case TextPattern::INVALID:
+            return false;
+    }
+    return false;
+}
+
+struct Cell {
+    std::string text;
+    bool is_null = true;
+    bool has_number = false;
+    double number = 0.0;
+    // Slot padding for a column this row does not have (differs from a NULL value).
+    bool absent = false;
+};
+
+// Prepared statements replace each ? by a parameter slot token ("\x1f<n>") before parsing. Plans
+// keep the slot and read the value bound on this thread when they run, so one parse (and every
+// cached subquery/function/CASE form) serves all executions.
+constexpr char kParamMark = '\x1f';
+thread_local const std::vector<Cell> *bound_params = nullptr;
+
+struct BoundParamScope {
+    explicit BoundParamScope(const std::vector<Cell> *params) : prev(bound_params) { bound_params = params; }
+    ~BoundParamScope() { bound_params = prev; }
+    BoundParamScope(const BoundParamScope &) = delete;
+    BoundParamScope &operator=(const BoundParamScope &) = delete;
+    const std::vector<Cell> *prev;
+};
+
+std::string param_token(size_t slot) {
+    return std::string(1, kParamMark) + std::to_string(slot);
+}
+
+// Slot index of a parameter token, or -1.
+int param_slot(const std::string &text) {
+    if (text.size() < 2 || text[0] != kParamMark) return -1;
+    int slot = 0;
+    for (size_t i = 1; i < text.size(); ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(text[i])) || slot > 100000) return -1;
+        slot = slot * 10 + (text[i] - '0');
+    }
+    return slot;
+}
+
+// The bound value of a slot; NULL when nothing is bound.
+const Cell &param_cell(int slot) {
+    static const Cell null_cell;
+    if (!bound_params || slot < 0 || static_cast<size_t>(slot) >= bound_params->size()) return null_cell;
+    return (*bound_params)[static_cast<size_t>(slot)];
+}
+
+// Runs fn like db_parallel_for, with the caller's bound parameters visible to the workers.
+void parallel_for_bound(size_t count, const std::function<void(size_t)> &fn) {
+    const std::vector<Cell> *params = bound_params;
+    if (!params) {
+        db_parallel_for(count, 0, fn);
+        return;
+    }
+    db_parallel_for(count, 0, [&](size_t i) {
+        BoundParamScope scope(params);
+        fn(i);
+    });
+}
+
 struct Expr {
     enum Kind { VALUE, COMPARE, AND, OR, NOT, IN_LIST, IN_SUBQUERY, BETWEEN, LIKE, REGEXP, EXISTS, IS_NULL } kind = VALUE;
     std::string op;
@@ -160,6 +408,16 @@ struct Expr {
     std::vector<std::string> list;
     std::string subquery;
     bool negate = false;
+    std::shared_ptr<const TextPattern> pattern; // LIKE/REGEXP, compiled while parsing
+    // Filled by compile_expr after parsing. A VALUE is a literal cell, a column key, a
+    // parameter slot or DYNAMIC (CASE/function text evaluated per row).
+    enum Operand { DYNAMIC, LITERAL, COLUMN, PARAM } operand = DYNAMIC;
+    std::string key;              // COLUMN: lower-cased lookup key
+    bool bare_literal = false;    // COLUMN: a NULL/missing value reads as the raw text
+    Cell literal;
+    int slot = -1;                // PARAM operand, or a LIKE/REGEXP pattern bound per execution
+    std::vector<Cell> literals;   // BETWEEN bounds, IN list entries
+    std::vector<int> slots;       // per entry of literals: parameter slot or -1; empty without parameters
     std::unique_ptr<Expr> lhs;
     std::unique_ptr<Expr> rhs;
 };
@@ -200,6 +458,8 @@ struct SqlQuery {
     std::vector<OrderBy> order_by;
     int limit = -1;
     int offset = 0;
+    int limit_slot = -1;  // LIMIT ? / OFFSET ?
+    int offset_slot = -1;
 };
 
 bool parse_identifier(Parser &p, std::string &out) {
@@ -438,6 +698,8 @@ std::unique_ptr<Expr> parse_compare(Parser &p) {
         expr->kind = Expr::LIKE;
         expr->lhs = std::move(left);
         expr->value = p.consume();
+        expr->slot = param_slot(expr->value);
+        if (expr->slot < 0) expr->pattern = compile_like(strip_quotes(expr->value));
         if (negated) {
             auto wrap = std::make_unique<Expr>();
             wrap->kind = Expr::NOT;
@@ -451,6 +713,8 @@ std::unique_ptr<Expr> parse_compare(Parser &p) {
         expr->kind = Expr::REGEXP;
         expr->lhs = std::move(left);
         expr->value = p.consume();
+        expr->slot = param_slot(expr->value);
+        if (expr->slot < 0) expr->pattern = compile_regexp(strip_quotes(expr->value));
         if (negated) {
             auto wrap = std::make_unique<Expr>();
             wrap->kind = Expr::NOT;
@@ -507,6 +771,24 @@ std::unique_ptr<Expr> parse_expr(Parser &p) {
     return left;
 }
 
+bool parse_query(const std::string &sql, SqlQuery &out);
+void compile_expr(Expr *expr);
+
+// Parsed SELECT for the given text, or nullptr when it does not parse.
+std::shared_ptr<const SqlQuery> cached_query(const std::string &sql) {
+    thread_local ParseCache<SqlQuery> cache;
+    std::string key = normalize_sql_key(sql);
+    if (auto hit = cache.find(key)) {
+        return hit;
+    }
+    auto q = std::make_shared<SqlQuery>();
+    if (!parse_query(sql, *q)) {
+        return nullptr;
+    }
+    cache.put(key, q);
+    return q;
+}
+
 bool parse_query(const std::string &sql, SqlQuery &out) {
     Parser p;
     p.tokens = tokenize(sql);
@@ -594,6 +876,7 @@ bool parse_query(const std::string &sql, SqlQuery &out) {
     }
     if (p.match("where")) {
         out.where_expr = parse_expr(p);
+        compile_expr(out.where_expr.get());
     }
     if (p.match("group")) {
         if (!p.match("by")) return false;
@@ -606,6 +889,7 @@ bool parse_query(const std::string &sql, SqlQuery &out) {
     }
     if (p.match("having")) {
         out.having_expr = parse_expr(p);
+        compile_expr(out.having_expr.get());
     }
     if (p.match("order")) {
         if (!p.match("by")) return false;
@@ -630,23 +914,66 @@ bool parse_query(const std::string &sql, SqlQuery &out) {
         }
     }
     if (p.match("limit")) {
-        out.limit = std::stoi(p.consume());
+        std::string t = p.consume();
+        out.limit_slot = param_slot(t);
+        if (out.limit_slot < 0) out.limit = std::stoi(t);
     }
     if (p.match("offset")) {
-        out.offset = std::stoi(p.consume());
+        std::string t = p.consume();
+        out.offset_slot = param_slot(t);
+        if (out.offset_slot < 0) out.offset = std::stoi(t);
     }
     return true;
 }
 
-struct Cell {
-    std::string text;
-    bool is_null = true;
-    bool has_number = false;
-    double number = 0.0;
+// Column keys of one row shape. "col", "table.col" and "alias.col" share a slot, and all rows
+// read from one table share one schema, so a row only carries its cells.
+struct RowSchema {
+    std::unordered_map<std::string, int> slots;
+    std::vector<std::string> keys;
+    int slot_count = 0;
+
+    int slot(const std::string &key) const {
+        auto it = slots.find(key);
+        return it == slots.end() ? -1 : it->second;
+    }
+
+    // Existing keys keep their slot; slot < 0 opens a new one.
+    int add(const std::string &key, int slot = -1) {
+        auto it = slots.find(key);
+        if (it != slots.end()) return it->second;
+        if (slot < 0) slot = slot_count;
+        slot_count = std::max(slot_count, slot + 1);
+        slots.emplace(key, slot);
+        keys.push_back(key);
+        return slot;
+    }
 };
 
 struct Row {
-    std::unordered_map<std::string, Cell> values;
+    std::shared_ptr<RowSchema> schema;
+    std::vector<Cell> cells;
+
+    const Cell *find(const std::string &key) const {
+        if (!schema) return nullptr;
+        int s = schema->slot(key);
+        if (s < 0 || s >= static_cast<int>(cells.size()) || cells[static_cast<size_t>(s)].absent) return nullptr;
+        return &cells[static_cast<size_t>(s)];
+    }
+
+    // Sets one key in its own slot; copies the schema first if other rows share it.
+    void set(const std::string &key, const Cell &c) {
+        if (!schema) {
+            schema = std::make_shared<RowSchema>();
+        } else if (schema.use_count() > 1) {
+            schema = std::make_shared<RowSchema>(*schema);
+        }
+        size_t s = static_cast<size_t>(schema->add(key));
+        if (s >= cells.size()) {
+            cells.resize(s + 1, Cell{"", true, false, 0.0, true});
+        }
+        cells[s] = c;
+    }
 };
 
 std::vector<std::string> split_args(const std::string &s);
@@ -707,7 +1034,7 @@ void collect_unknown_where_columns(const Expr *expr, const Row &schema_row, std:
         const std::string &raw = lhs->value;
         if (!is_unquoted_identifier_token(raw)) return;
         std::string key = to_lower(raw);
-        if (schema_row.values.find(key) == schema_row.values.end()) {
+        if (!schema_row.find(key)) {
             out.insert(raw);
         }
     };
@@ -759,6 +1086,84 @@ Cell make_cell(const std::string &val, bool is_null) {
     return c;
 }
 
+// Classifies a VALUE the way eval_value reads it, so rows skip re-parsing the raw text.
+void compile_operand(Expr &e) {
+    const std::string &raw = e.value;
+    e.slot = param_slot(raw);
+    if (e.slot >= 0) {
+        e.operand = Expr::PARAM;
+        return;
+    }
+    if (!raw.empty() && (raw.front() == '\'' || raw.front() == '"')) {
+        e.operand = Expr::LITERAL;
+        e.literal = make_cell(strip_quotes(raw), false);
+        return;
+    }
+    std::string lower = to_lower(raw);
+    if (lower.rfind("case", 0) == 0 && lower.size() >= 3 &&
+        lower.find(" end") != std::string::npos) {
+        return;
+    }
+    double num = 0.0;
+    if (parse_number(raw, num)) {
+        e.operand = Expr::LITERAL;
+        e.literal = make_cell(raw, false);
+        return;
+    }
+    if (raw.find('(') != std::string::npos && raw.back() == ')') {
+        return;
+    }
+    e.operand = Expr::COLUMN;
+    e.key = lower;
+    if (raw.find('.') == std::string::npos) {
+        e.bare_literal = true;
+        e.literal = make_cell(raw, false);
+    }
+}
+
+void compile_expr(Expr *expr) {
+    if (!expr) return;
+    compile_expr(expr->lhs.get());
+    compile_expr(expr->rhs.get());
+    switch (expr->kind) {
+        case Expr::VALUE:
+            compile_operand(*expr);
+            break;
+        case Expr::BETWEEN:
+            expr->literals = {make_cell(strip_quotes(expr->value), false), make_cell(strip_quotes(expr->value2), false)};
+            expr->slots = {param_slot(expr->value), param_slot(expr->value2)};
+            break;
+        case Expr::IN_LIST:
+            expr->literals.clear();
+            expr->slots.clear();
+            for (const auto &v : expr->list) {
+                expr->literals.push_back(make_cell(strip_quotes(v), false));
+                expr->slots.push_back(param_slot(v));
+            }
+            break;
+        default:
+            break;
+    }
+    if (std::all_of(expr->slots.begin(), expr->slots.end(), [](int slot) { return slot < 0; })) {
+        expr->slots.clear();
+    }
+}
+
+// BETWEEN bound / IN entry i with its parameter resolved.
+const Cell &list_literal(const Expr *expr, size_t i) {
+    if (!expr->slots.empty() && expr->slots[i] >= 0) return param_cell(expr->slots[i]);
+    return expr->literals[i];
+}
+
+// LIKE/REGEXP pattern; a bound pattern is compiled once per distinct value. nullptr for a NULL parameter.
+const TextPattern *expr_pattern(const Expr *expr) {
+    if (expr->pattern) return expr->pattern.get();
+    if (expr->slot < 0) return nullptr;
+    const Cell &c = param_cell(expr->slot);
+    if (c.is_null) return nullptr;
+    return &cached_pattern(c.text, expr->kind == Expr::REGEXP);
+}
+
 std::string strip_quotes(const std::string &s) {
     if (s.size() >= 2) {
         char a = s.front();
@@ -771,46 +1176,22 @@ std::string strip_quotes(const std::string &s) {
 }
 
 Cell get_value(const Row &row, const Row *outer, const std::string &name) {
+    if (!name.empty() && name[0] == kParamMark) {
+        int slot = param_slot(name);
+        if (slot >= 0) return param_cell(slot);
+    }
     std::string key = to_lower(name);
-    auto it = row.values.find(key);
-    if (it != row.values.end()) {
-        return it->second;
+    if (const Cell *c = row.find(key)) {
+        return *c;
     }
     if (outer) {
-        auto it2 = outer->values.find(key);
-        if (it2 != outer->values.end()) {
-            return it2->second;
+        if (const Cell *c = outer->find(key)) {
+            return *c;
         }
     }
     return Cell{"" , true, false, 0.0};
 }
 
-bool like_match(const std::string &text, const std::string &pattern) {
-    std::string t = to_lower(text);
-    std::string p = to_lower(pattern);
-    size_t ti = 0, pi = 0, star = std::string::npos, match = 0;
-    while (ti < t.size()) {
-        if (pi < p.size() && (p[pi] == '_' || p[pi] == t[ti])) {
-            pi++;
-            ti++;
-            continue;
-        }
-        if (pi < p.size() && p[pi] == '%') {
-            star = pi++;
-            match = ti;
-            continue;
-        }
-        if (star != std::string::npos) {
-            pi = star + 1;
-            ti = ++match;
-            continue;
-        }
-        return false;
-    }
-    while (pi < p.size() && p[pi] == '%') pi++;
-    return pi == p.size();
-}
-
 bool eval_expr(const Expr *expr, const Row &row,
                const DbWorld &world,
                bool use_focus,
@@ -852,15 +1233,39 @@ std::vector<std::string> split_args(const std::string &s) {
     return args;
 }
 
-Cell eval_function(const std::string &raw, const Row &row, const Row *outer) {
+struct FunctionCall {
+    bool valid = false;
+    std::string fname;
+    std::string args_str;
+    std::vector<std::string> args;
+};
+
+std::shared_ptr<const FunctionCall> function_call_for(const std::string &raw) {
+    thread_local ParseCache<FunctionCall> cache;
+    if (auto hit = cache.find(raw)) {
+        return hit;
+    }
+    auto call = std::make_shared<FunctionCall>();
     size_t open = raw.find('(');
     size_t close = raw.rfind(')');
-    if (open == std::string::npos || close == std::string::npos || close <= open) {
+    if (open != std::string::npos && close != std::string::npos && close > open) {
+        call->valid = true;
+        call->fname = to_lower(raw.substr(0, open));
+        call->args_str = raw.substr(open + 1, close - open - 1);
+        call->args = split_args(call->args_str);
+    }
+    cache.put(raw, call);
+    return call;
+}
+
+Cell eval_function(const std::string &raw, const Row &row, const Row *outer) {
+    std::shared_ptr<const FunctionCall> call = function_call_for(raw);
+    if (!call->valid) {
         return Cell{"", true, false, 0.0};
     }
-    std::string fname = to_lower(raw.substr(0, open));
-    std::string args_str = raw.substr(open + 1, close - open - 1);
-    std::vector<std::string> args = split_args(args_str);
+    const std::string &fname = call->fname;
+    const std::string &args_str = call->args_str;
+    const std::vector<std::string> &args = call->args;
     auto eval_arg = [&](const std::string &a) -> Cell {
         if (!a.empty() && (a.front() == '\'' || a.front() == '"')) {
             return make_cell(strip_quotes(a), false);
@@ -978,16 +1383,10 @@ Cell eval_function(const std::string &raw, const Row &row, const Row *outer) {
     return Cell{"", true, false, 0.0};
 }
 
-bool eval_case_condition(const std::vector<Token> &tokens,
-                         size_t start,
-                         size_t end,
+bool eval_case_condition(const std::vector<std::string> &parts,
                          const Row &row,
                          const Row *outer) {
-    if (start >= end) return false;
-    std::vector<std::string> parts;
-    for (size_t i = start; i < end; ++i) {
-        parts.push_back(tokens[i].text);
-    }
+    if (parts.empty()) return false;
     if (parts.size() >= 3 && ieq(parts[1], "is")) {
         bool is_not = false;
         size_t idx = 2;
@@ -1023,15 +1422,8 @@ bool eval_case_condition(const std::vector<Token> &tokens,
     if (b.has_number) nb = b.number;
     if (op == "=") return a.text == b.text;
     if (op == "!=" || op == "<>") return a.text != b.text;
-    if (op == "like") return like_match(a.text, b.text);
-    if (op == "regexp") {
-        try {
-            std::regex re(b.text, std::regex::icase);
-            return std::regex_search(a.text, re);
-        } catch (...) {
-            return false;
-        }
-    }
+    if (op == "like") return pattern_match(cached_pattern(b.text, false), a.text);
+    if (op == "regexp") return pattern_match(cached_pattern(b.text, true), a.text);
     if (a_num && b_num) {
         if (op == "<") return na < nb;
         if (op == "<=") return na <= nb;
@@ -1045,71 +1437,106 @@ bool eval_case_condition(const std::vector<Token> &tokens,
     return false;
 }
 
-Cell eval_case_expr(const std::string &raw, const Row &row, const Row *outer) {
+// CASE expression split once into its WHEN/ELSE steps; FAIL ends evaluation with NULL.
+struct CaseExprPlan {
+    struct Step {
+        enum Kind { WHEN, ELSE, FAIL } kind = FAIL;
+        std::vector<std::string> condition;
+        std::string value;
+    };
+    std::vector<Step> steps;
+};
+
+std::shared_ptr<const CaseExprPlan> case_plan_for(const std::string &raw) {
+    thread_local ParseCache<CaseExprPlan> cache;
+    if (auto hit = cache.find(raw)) {
+        return hit;
+    }
+    auto plan = std::make_shared<CaseExprPlan>();
     Parser p;
     p.tokens = tokenize(raw);
     if (!p.match("case")) {
-        return Cell{"", true, false, 0.0};
+        plan->steps.push_back({});
+        cache.put(raw, plan);
+        return plan;
     }
     while (!p.eof()) {
         if (p.match("when")) {
-            size_t cond_start = p.pos;
+            CaseExprPlan::Step step;
             while (!p.eof() && !ieq(p.peek(), "then")) {
-                p.consume();
+                step.condition.push_back(p.consume());
             }
-            size_t cond_end = p.pos;
-            if (!p.match("then")) return Cell{"", true, false, 0.0};
-            size_t val_start = p.pos;
-            while (!p.eof() && !ieq(p.peek(), "when") && !ieq(p.peek(), "else") && !ieq(p.peek(), "end")) {
-                p.consume();
+            if (!p.match("then")) {
+                plan->steps.push_back({});
+                break;
             }
-            size_t val_end = p.pos;
-            if (eval_case_condition(p.tokens, cond_start, cond_end, row, outer)) {
-                std::string val;
-                for (size_t i = val_start; i < val_end; ++i) {
-                    if (!val.empty()) val.push_back(' ');
-                    val += p.tokens[i].text;
-                }
-                if (val.empty()) return Cell{"", true, false, 0.0};
-                if (!val.empty() && (val.front() == '\'' || val.front() == '"')) {
-                    return make_cell(strip_quotes(val), false);
-                }
-                if (val.find('(') != std::string::npos && val.back() == ')') {
-                    return eval_function(val, row, outer);
-                }
-                Cell c = get_value(row, outer, val);
-                if (!c.is_null) return c;
-                return make_cell(val, false);
+            step.kind = CaseExprPlan::Step::WHEN;
+            while (!p.eof() && !ieq(p.peek(), "when") && !ieq(p.peek(), "else") && !ieq(p.peek(), "end")) {
+                if (!step.value.empty()) step.value.push_back(' ');
+                step.value += p.consume();
             }
+            plan->steps.push_back(std::move(step));
             continue;
         }
         if (p.match("else")) {
-            std::string val;
+            CaseExprPlan::Step step;
+            step.kind = CaseExprPlan::Step::ELSE;
             while (!p.eof() && !ieq(p.peek(), "end")) {
-                if (!val.empty()) val.push_back(' ');
-                val += p.consume();
-            }
-            if (!val.empty() && (val.front() == '\'' || val.front() == '"')) {
-                return make_cell(strip_quotes(val), false);
+                if (!step.value.empty()) step.value.push_back(' ');
+                step.value += p.consume();
             }
-            if (val.find('(') != std::string::npos && val.back() == ')') {
-                return eval_function(val, row, outer);
-            }
-            Cell c = get_value(row, outer, val);
-            if (!c.is_null) return c;
-            return make_cell(val, false);
+            plan->steps.push_back(std::move(step));
+            break;
         }
         if (p.match("end")) {
             break;
         }
         p.consume();
     }
+    cache.put(raw, plan);
+    return plan;
+}
+
+Cell eval_case_expr(const std::string &raw, const Row &row, const Row *outer) {
+    std::shared_ptr<const CaseExprPlan> plan = case_plan_for(raw);
+    for (const auto &step : plan->steps) {
+        if (step.kind == CaseExprPlan::Step::FAIL) {
+            break;
+        }
+        if (step.kind == CaseExprPlan::Step::WHEN && !eval_case_condition(step.condition, row, outer)) {
+            continue;
+        }
+        const std::string &val = step.value;
+        if (step.kind == CaseExprPlan::Step::WHEN && val.empty()) return Cell{"", true, false, 0.0};
+        if (!val.empty() && (val.front() == '\'' || val.front() == '"')) {
+            return make_cell(strip_quotes(val), false);
+        }
+        if (val.find('(') != std::string::npos && val.back() == ')') {
+            return eval_function(val, row, outer);
+        }
+        Cell c = get_value(row, outer, val);
+        if (!c.is_null) return c;
+        return make_cell(val, false);
+    }
     return Cell{"", true, false, 0.0};
 }
 
 Cell eval_value(const Expr *expr, const Row &row, const Row *outer) {
     if (!expr) return Cell{"", true, false, 0.0};
     if (expr->kind == Expr::VALUE) {
+        if (expr->operand == Expr::LITERAL) {
+            return expr->literal;
+        }
+        if (expr->operand == Expr::PARAM) {
+            return param_cell(expr->slot);
+        }
+        if (expr->operand == Expr::COLUMN) {
+            const Cell *c = row.find(expr->key);
+            if (!c && outer) c = outer->find(expr->key);
+            if (c && !c->is_null) return *c;
+            if (expr->bare_literal) return expr->literal;
+            return c ? *c : Cell{"", true, false, 0.0};
+        }
         std::string raw = expr->value;
         if (!raw.empty() && (raw.front() == '\'' || raw.front() == '"')) {
             return make_cell(strip_quotes(raw), false);
@@ -1197,9 +1624,9 @@ bool eval_expr(const Expr *expr,
         }
         case Expr::BETWEEN: {
             Cell a = eval_value(expr->lhs.get(), row, outer);
-            Cell b = make_cell(strip_quotes(expr->value), false);
-            Cell c = make_cell(strip_quotes(expr->value2), false);
-            if (a.is_null) return false;
+            const Cell &b = list_literal(expr, 0);
+            const Cell &c = list_literal(expr, 1);
+            if (a.is_null || b.is_null || c.is_null) return false;
             if (a.has_number && b.has_number && c.has_number) {
                 return a.number >= b.number && a.number <= c.number;
             }
@@ -1208,9 +1635,8 @@ bool eval_expr(const Expr *expr,
         case Expr::IN_LIST: {
             Cell a = eval_value(expr->lhs.get(), row, outer);
             if (a.is_null) return false;
-            for (const auto &v : expr->list) {
-                Cell b = make_cell(strip_quotes(v), false);
-                if (compare_cells(a, b, "=")) return true;
+            for (size_t i = 0; i < expr->literals.size(); ++i) {
+                if (compare_cells(a, list_literal(expr, i), "=")) return true;
             }
             return false;
         }
@@ -1233,21 +1659,19 @@ bool eval_expr(const Expr *expr,
         }
         case Expr::LIKE: {
             Cell a = eval_value(expr->lhs.get(), row, outer);
-            if (a.is_null) return false;
-            std::string pat = strip_quotes(expr->value);
-            return like_match(a.text, pat);
+            const TextPattern *pattern = expr_pattern(expr);
+            if (a.is_null || !pattern) return false;
+            return pattern_match(*pattern, a.text);
         }
         case Expr::REGEXP: {
             Cell a = eval_value(expr->lhs.get(), row, outer);
-            if (a.is_null) return false;
-            std::string pat = strip_quotes(expr->value);
-            try {
-                std::regex re(pat, std::regex_constants::icase);
-                return std::regex_search(a.text, re);
-            } catch (...) {
+            const TextPattern *pattern = expr_pattern(expr);
+            if (a.is_null || !pattern) return false;
+            if (pattern->kind == TextPattern::INVALID) {
                 error = "REGEXP-Pattern ungueltig.";
                 return false;
             }
+            return pattern_match(*pattern, a.text);
         }
         case Expr::EXISTS: {
             DbSqlResult sub;
@@ -1304,77 +1728,1260 @@ bool in_focus(const DbPayload &p, int focus_x, int focus_y, int radius) {
     return (dx * dx + dy * dy) <= radius * radius;
 }
 
-Row make_row_for_payload(const DbWorld &world, const DbPayload &p, const std::string &alias) {
+bool payload_visible(const DbWorld &world, int payload_index, bool use_focus, int focus_x, int focus_y, int radius) {
+    if (db_payload_hidden(world, payload_index)) return false;
+    const DbPayload &p = world.payloads[static_cast<size_t>(payload_index)];
+    return p.is_delta || !use_focus || in_focus(p, focus_x, focus_y, radius);
+}
+
+const Cell kAbsentCell{"", true, false, 0.0, true};
+
+int add_column_keys(RowSchema &schema, const std::string &col_key, const std::string &table_key, const std::string &alias_key) {
+    int slot = schema.add(col_key);
+    schema.add(table_key + "." + col_key, slot);
+    schema.add(alias_key + "." + col_key, slot);
+    return slot;
+}
+
+// Rows of one table share `schema`; new columns extend it, shorter rows read them as absent.
+Row make_row_for_payload(const DbWorld &world, const DbPayload &p, const std::string &alias, const std::shared_ptr<RowSchema> &schema) {
     Row row;
+    row.schema = schema;
     std::string table = world.table_names[static_cast<size_t>(p.table_id)];
     std::string table_key = to_lower(table);
     std::string alias_key = to_lower(alias.empty() ? table : alias);
     for (const auto &f : p.fields) {
-        std::string col_key = to_lower(f.name);
-        Cell c = make_cell(f.value, false);
-        row.values[col_key] = c;
-        row.values[table_key + "." + col_key] = c;
-        row.values[alias_key + "." + col_key] = c;
+        size_t slot = static_cast<size_t>(add_column_keys(*schema, to_lower(f.name), table_key, alias_key));
+        if (slot >= row.cells.size()) {
+            row.cells.resize(slot + 1, kAbsentCell);
+        }
+        row.cells[slot] = make_cell(f.value, false);
     }
     return row;
 }
 
-std::vector<Row> rows_for_table(const DbWorld &world,
-                                const std::string &table_name,
-                                const std::string &alias,
-                                bool use_focus,
-                                int focus_x,
-                                int focus_y,
-                                int radius,
-                                const std::unordered_map<std::string, DbSqlResult> &cte_map) {
-    std::vector<Row> rows;
-    auto it_cte = cte_map.find(to_lower(table_name));
-    if (it_cte != cte_map.end()) {
-        const DbSqlResult &res = it_cte->second;
-        for (const auto &r : res.rows) {
-            Row row;
-            for (size_t i = 0; i < r.size() && i < res.columns.size(); ++i) {
-                Cell c = make_cell(r[i], false);
-                std::string col_key = to_lower(res.columns[i]);
-                row.values[col_key] = c;
-                if (!alias.empty()) {
-                    row.values[to_lower(alias) + "." + col_key] = c;
-                }
-            }
-            rows.push_back(std::move(row));
-        }
-        return rows;
+Cell column_cell(const DbColumn &col, size_t r) {
+    if (col.kind == DbColumn::INT64) {
+        int64_t v = col.ints[r];
+        return Cell{std::to_string(v), false, true, static_cast<double>(v)};
     }
-    int table_id = db_find_table(world, table_name);
-    if (table_id < 0) return rows;
-    for (const auto &p : world.payloads) {
-        if (p.table_id != table_id) continue;
-        int64_t key = db_payload_key(p.table_id, p.id);
-        if (world.tombstones.find(key) != world.tombstones.end()) continue;
-        if (!p.is_delta) {
-            if (world.delta_index_by_key.find(key) != world.delta_index_by_key.end()) continue;
-            if (use_focus && !in_focus(p, focus_x, focus_y, radius)) continue;
-        }
-        rows.push_back(make_row_for_payload(world, p, alias));
-    }
-    return rows;
-}
-
-Cell get_cell_by_name(const Row &row, const Row *outer, const std::string &name) {
-    return get_value(row, outer, name);
+    uint32_t code = col.codes[r];
+    return Cell{col.dictionary[code], false, col.dictionary_numeric[code] != 0, col.dictionary_numbers[code]};
 }
 
-std::string make_group_key(const Row &row, const Row *outer, const std::vector<std::string> &cols) {
-    std::string key;
-    for (size_t i = 0; i < cols.size(); ++i) {
-        if (i > 0) key.push_back('|');
-        Cell c = get_cell_by_name(row, outer, cols[i]);
-        key += c.is_null ? "NULL" : c.text;
+// Slot i of the schema is column i of the store.
+std::shared_ptr<RowSchema> column_row_schema(const DbWorld &world, const DbColumnTable &store, int table_id, const std::string &alias) {
+    auto schema = std::make_shared<RowSchema>();
+    std::string table = world.table_names[static_cast<size_t>(table_id)];
+    std::string table_key = to_lower(table);
+    std::string alias_key = to_lower(alias.empty() ? table : alias);
+    for (const auto &col : store.columns) {
+        add_column_keys(*schema, col.name, table_key, alias_key);
     }
-    return key;
+    return schema;
 }
 
-Cell resolve_order_cell(const std::vector<std::string> &columns,
+// Same row as make_row_for_payload, read from the column store without reparsing numbers.
+Row make_row_for_column(const DbColumnTable &store, size_t r, const std::shared_ptr<RowSchema> &schema) {
+    Row row;
+    row.schema = schema;
+    row.cells.reserve(store.columns.size());
+    for (const auto &col : store.columns) {
+        row.cells.push_back(col.present[r] ? column_cell(col, r) : kAbsentCell);
+    }
+    return row;
+}
+
+// Rows of a CTE or FROM subquery result; keys are "col" and, with an alias, "alias.col".
+std::vector<Row> rows_for_result(const DbSqlResult &res, const std::string &alias) {
+    std::vector<Row> rows;
+    auto schema = std::make_shared<RowSchema>();
+    std::vector<int> slots;
+    for (const auto &col : res.columns) {
+        std::string col_key = to_lower(col);
+        int slot = schema->add(col_key);
+        if (!alias.empty()) {
+            schema->add(to_lower(alias) + "." + col_key, slot);
+        }
+        slots.push_back(slot);
+    }
+    rows.reserve(res.rows.size());
+    for (const auto &r : res.rows) {
+        Row row;
+        row.schema = schema;
+        row.cells.assign(static_cast<size_t>(schema->slot_count), kAbsentCell);
+        for (size_t i = 0; i < r.size() && i < slots.size(); ++i) {
+            row.cells[static_cast<size_t>(slots[i])] = make_cell(r[i], false);
+        }
+        rows.push_back(std::move(row));
+    }
+    return rows;
+}
+
+// Builds rows for payloads of one table, from the column store when it is current.
+struct TableRowBuilder {
+    const DbWorld *world = nullptr;
+    int table_id = -1;
+    std::string alias;
+    const DbColumnTable *store = nullptr;
+    std::shared_ptr<RowSchema> column_schema;
+    std::shared_ptr<RowSchema> payload_schema = std::make_shared<RowSchema>();
+
+    TableRowBuilder(const DbWorld &w, int table, const std::string &row_alias)
+        : world(&w), table_id(table), alias(row_alias), store(db_column_table(w, table)) {
+        if (store) {
+            column_schema = column_row_schema(w, *store, table_id, alias);
+        }
+    }
+
+    Row make(int idx) const {
+        if (store) {
+            auto it = std::lower_bound(store->payload_index.begin(), store->payload_index.end(), idx);
+            if (it != store->payload_index.end() && *it == idx) {
+                return make_row_for_column(*store, static_cast<size_t>(it - store->payload_index.begin()), column_schema);
+            }
+        }
+        return make_row_for_payload(*world, world->payloads[static_cast<size_t>(idx)], alias, payload_schema);
+    }
+};
+
+std::vector<Row> rows_for_table(const DbWorld &world,
+                                const std::string &table_name,
+                                const std::string &alias,
+                                bool use_focus,
+                                int focus_x,
+                                int focus_y,
+                                int radius,
+                                const std::unordered_map<std::string, DbSqlResult> &cte_map) {
+    std::vector<Row> rows;
+    auto it_cte = cte_map.find(to_lower(table_name));
+    if (it_cte != cte_map.end()) {
+        return rows_for_result(it_cte->second, alias);
+    }
+    int table_id = db_find_table(world, table_name);
+    if (table_id < 0) return rows;
+    std::vector<int> focused;
+    if (use_focus && db_focus_payloads(world, table_id, focus_x, focus_y, radius, focused)) {
+        TableRowBuilder builder(world, table_id, alias);
+        rows.reserve(focused.size());
+        for (int idx : focused) {
+            rows.push_back(builder.make(idx));
+        }
+        return rows;
+    }
+    if (const DbColumnTable *store = db_column_table(world, table_id)) {
+        auto schema = column_row_schema(world, *store, table_id, alias);
+        for (size_t r = 0; r < store->payload_index.size(); ++r) {
+            if (!payload_visible(world, store->payload_index[r], use_focus, focus_x, focus_y, radius)) continue;
+            rows.push_back(make_row_for_column(*store, r, schema));
+        }
+        return rows;
+    }
+    auto schema = std::make_shared<RowSchema>();
+    for (int idx : db_table_payloads(world, table_id)) {
+        if (!payload_visible(world, idx, use_focus, focus_x, focus_y, radius)) continue;
+        rows.push_back(make_row_for_payload(world, world.payloads[static_cast<size_t>(idx)], alias, schema));
+    }
+    return rows;
+}
+
+// Resolves "col", "table.col" or "alias.col" to a column of the FROM table.
+bool index_column_name(const Expr *expr, const std::string &table, const std::string &alias, std::string &column) {
+    if (!expr || expr->kind != Expr::VALUE) return false;
+    const std::string &raw = expr->value;
+    if (!is_unquoted_identifier_token(raw)) return false;
+    size_t dot = raw.find('.');
+    if (dot == std::string::npos) {
+        column = raw;
+        return true;
+    }
+    std::string prefix = raw.substr(0, dot);
+    if (!ieq(prefix, table) && (alias.empty() || !ieq(prefix, alias))) return false;
+    column = raw.substr(dot + 1);
+    return !column.empty() && column.find('.') == std::string::npos;
+}
+
+bool is_literal_operand(const Expr *expr) {
+    if (!expr || expr->kind != Expr::VALUE || expr->value.empty()) return false;
+    const std::string &raw = expr->value;
+    if (raw.front() == '\'' || raw.front() == '"' || expr->operand == Expr::PARAM) return true;
+    double num = 0.0;
+    return parse_number(raw, num);
+}
+
+// Text of a literal or of a bound parameter (empty for NULL).
+std::string literal_text(const std::string &raw) {
+    int slot = param_slot(raw);
+    return slot >= 0 ? param_cell(slot).text : strip_quotes(raw);
+}
+
+bool index_lookup_conjunct(const DbWorld &world,
+                           int table_id,
+                           const Expr *expr,
+                           const std::string &table,
+                           const std::string &alias,
+                           std::vector<int> &out) {
+    std::string column;
+    if (expr->kind == Expr::COMPARE) {
+        if (expr->op != "=") return false;
+        const Expr *col_side = expr->lhs.get();
+        const Expr *val_side = expr->rhs.get();
+        if (!is_literal_operand(val_side)) std::swap(col_side, val_side);
+        if (!is_literal_operand(val_side) || !index_column_name(col_side, table, alias, column)) return false;
+        const DbIndex *index = db_find_index(world, table_id, column, true);
+        return index && db_index_lookup_equal(*index, literal_text(val_side->value), out);
+    }
+    if (expr->kind == Expr::IN_LIST) {
+        if (!index_column_name(expr->lhs.get(), table, alias, column)) return false;
+        const DbIndex *index = db_find_index(world, table_id, column, true);
+        if (!index) return false;
+        for (const auto &v : expr->list) {
+            if (!db_index_lookup_equal(*index, literal_text(v), out)) return false;
+        }
+        return true;
+    }
+    if (expr->kind == Expr::BETWEEN) {
+        if (!index_column_name(expr->lhs.get(), table, alias, column)) return false;
+        const DbIndex *index = db_find_index(world, table_id, column, false);
+        return index && db_index_lookup_range(*index, literal_text(expr->value), literal_text(expr->value2), out);
+    }
+    return false;
+}
+
+void collect_conjuncts(const Expr *expr, std::vector<const Expr *> &out) {
+    if (!expr) return;
+    if (expr->kind == Expr::AND) {
+        collect_conjuncts(expr->lhs.get(), out);
+        collect_conjuncts(expr->rhs.get(), out);
+        return;
+    }
+    out.push_back(expr);
+}
+
+// Candidate payloads from the most selective indexed equality/IN/BETWEEN conjunct of WHERE.
+// The full WHERE is still evaluated on the candidates; false means a plain table scan.
+bool index_candidates(const DbWorld &world,
+                      const SqlQuery &q,
+                      const std::string &alias,
+                      const Row *outer,
+                      bool use_focus,
+                      int focus_x,
+                      int focus_y,
+                      int radius,
+                      const std::unordered_map<std::string, DbSqlResult> &cte_map,
+                      std::vector<int> &out) {
+    if (world.indexes.empty() || !q.where_expr || !q.joins.empty()) return false;
+    if (cte_map.find(to_lower(q.from_table)) != cte_map.end()) return false;
+    int table_id = db_find_table(world, q.from_table);
+    if (table_id < 0) return false;
+    std::vector<const Expr *> conjuncts;
+    collect_conjuncts(q.where_expr.get(), conjuncts);
+    bool found = false;
+    for (const Expr *expr : conjuncts) {
+        std::vector<int> hits;
+        if (!index_lookup_conjunct(world, table_id, expr, q.from_table, alias, hits)) continue;
+        // Rows without the column see the bare name as a literal; only prune if that cannot match.
+        Row missing;
+        std::string probe_error;
+        if (eval_expr(expr, missing, outer, world, use_focus, focus_x, focus_y, radius, probe_error)) continue;
+        if (!found || hits.size() < out.size()) {
+            out.swap(hits);
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool numeric_compare(double a, double b, const std::string &op, bool &out) {
+    if (op == "=") out = std::abs(a - b) < 1e-9;
+    else if (op == "!=" || op == "<>") out = std::abs(a - b) > 1e-9;
+    else if (op == "<") out = a < b;
+    else if (op == "<=") out = a <= b;
+    else if (op == ">") out = a > b;
+    else if (op == ">=") out = a >= b;
+    else return false;
+    return true;
+}
+
+std::string mirror_compare_op(const std::string &op) {
+    if (op == "<") return ">";
+    if (op == "<=") return ">=";
+    if (op == ">") return "<";
+    if (op == ">=") return "<=";
+    return op;
+}
+
+// INT64 columns against numeric literals; other literals leave the conjunct to the full WHERE.
+bool int_column_filter(const DbColumn &col, const Expr *expr, bool column_left, std::vector<uint8_t> &selected) {
+    std::vector<double> literals;
+    std::string op;
+    if (expr->kind == Expr::COMPARE) {
+        const Expr *lit = column_left ? expr->rhs.get() : expr->lhs.get();
+        literals.push_back(0.0);
+        if (!parse_number(literal_text(lit->value), literals.back())) return false;
+        op = column_left ? expr->op : mirror_compare_op(expr->op);
+        bool probe = false;
+        if (!numeric_compare(0.0, 0.0, op, probe)) return false;
+    } else if (expr->kind == Expr::BETWEEN) {
+        double lo = 0.0;
+        double hi = 0.0;
+        if (!parse_number(literal_text(expr->value), lo) || !parse_number(literal_text(expr->value2), hi)) return false;
+        literals = {lo, hi};
+    } else if (expr->kind == Expr::IN_LIST) {
+        for (const auto &v : expr->list) {
+            literals.push_back(0.0);
+            if (!parse_number(literal_text(v), literals.back())) return false;
+        }
+    } else {
+        return false;
+    }
+    for (size_t r = 0; r < selected.size(); ++r) {
+        if (!selected[r] || !col.present[r]) continue;
+        double v = static_cast<double>(col.ints[r]);
+        bool keep = false;
+        if (expr->kind == Expr::COMPARE) {
+            numeric_compare(v, literals.front(), op, keep);
+        } else if (expr->kind == Expr::BETWEEN) {
+            keep = v >= literals[0] && v <= literals[1];
+        } else {
+            for (double lit : literals) {
+                if (std::abs(v - lit) < 1e-9) {
+                    keep = true;
+                    break;
+                }
+            }
+        }
+        if (!keep) selected[r] = 0;
+    }
+    return true;
+}
+
+// Narrows the selection by one single-column conjunct. Text columns evaluate the conjunct once
+// per dictionary entry with the regular expression evaluator; rows without the column stay selected.
+bool column_filter_conjunct(const DbWorld &world,
+                            const DbColumnTable &store,
+                            const Expr *expr,
+                            const std::string &table,
+                            const std::string &alias,
+                            std::vector<uint8_t> &selected) {
+    const Expr *col_expr = nullptr;
+    bool column_left = true;
+    switch (expr->kind) {
+        case Expr::COMPARE:
+            if (is_literal_operand(expr->rhs.get())) {
+                col_expr = expr->lhs.get();
+            } else if (is_literal_operand(expr->lhs.get())) {
+                col_expr = expr->rhs.get();
+                column_left = false;
+            }
+            break;
+        case Expr::BETWEEN:
+        case Expr::IN_LIST:
+        case Expr::LIKE:
+        case Expr::REGEXP:
+            col_expr = expr->lhs.get();
+            break;
+        default:
+            break;
+    }
+    std::string column;
+    if (!col_expr || !index_column_name(col_expr, table, alias, column)) return false;
+    auto it = store.column_lookup.find(to_lower(column));
+    if (it == store.column_lookup.end()) return false;
+    const DbColumn &col = store.columns[static_cast<size_t>(it->second)];
+    if (col.kind == DbColumn::INT64) {
+        return int_column_filter(col, expr, column_left, selected);
+    }
+    std::vector<uint8_t> entry_match(col.dictionary.size(), 0);
+    std::string key = to_lower(col_expr->value);
+    Row probe;
+    std::string probe_error;
+    const TextPattern *pattern = expr_pattern(expr);
+    for (size_t d = 0; d < col.dictionary.size(); ++d) {
+        if (pattern && pattern->kind != TextPattern::INVALID) {
+            entry_match[d] = pattern_match(*pattern, col.dictionary[d]) ? 1 : 0;
+            continue;
+        }
+        probe.set(key, Cell{col.dictionary[d], false, col.dictionary_numeric[d] != 0, col.dictionary_numbers[d]});
+        entry_match[d] = eval_expr(expr, probe, nullptr, world, false, 0, 0, 0, probe_error) ? 1 : 0;
+        // Errors (e.g. a bad REGEXP) are reported by the full WHERE pass.
+        if (!probe_error.empty()) return false;
+    }
+    for (size_t r = 0; r < selected.size(); ++r) {
+        if (selected[r] && col.present[r] && !entry_match[col.codes[r]]) {
+            selected[r] = 0;
+        }
+    }
+    return true;
+}
+
+// Candidate payloads from scanning the typed column store with the single-column conjuncts of WHERE.
+// Like index_candidates the result is a superset; false means no conjunct could be used.
+bool column_candidates(const DbWorld &world,
+                       const SqlQuery &q,
+                       const std::string &alias,
+                       const std::unordered_map<std::string, DbSqlResult> &cte_map,
+                       std::vector<int> &out) {
+    if (!q.where_expr || !q.joins.empty()) return false;
+    if (cte_map.find(to_lower(q.from_table)) != cte_map.end()) return false;
+    const DbColumnTable *store = db_column_table(world, db_find_table(world, q.from_table));
+    if (!store) return false;
+    std::vector<const Expr *> conjuncts;
+    collect_conjuncts(q.where_expr.get(), conjuncts);
+    std::vector<uint8_t> selected(store->payload_index.size(), 1);
+    bool used = false;
+    for (const Expr *expr : conjuncts) {
+        if (column_filter_conjunct(world, *store, expr, q.from_table, alias, selected)) {
+            used = true;
+        }
+    }
+    if (!used) return false;
+    out.clear();
+    for (size_t r = 0; r < selected.size(); ++r) {
+        if (selected[r]) out.push_back(store->payload_index[r]);
+    }
+    return true;
+}
+
+std::vector<Row> rows_for_candidates(const DbWorld &world,
+                                     const std::string &table_name,
+                                     const std::string &alias,
+                                     std::vector<int> candidates,
+                                     bool use_focus,
+                                     int focus_x,
+                                     int focus_y,
+                                     int radius) {
+    std::vector<Row> rows;
+    int table_id = db_find_table(world, table_name);
+    TableRowBuilder builder(world, table_id, alias);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    for (int idx : candidates) {
+        const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
+        if (p.table_id != table_id) continue;
+        if (!payload_visible(world, idx, use_focus, focus_x, focus_y, radius)) continue;
+        rows.push_back(builder.make(idx));
+    }
+    if (rows.empty()) {
+        // Keep one row for the column layout; WHERE rejects it like the full scan would.
+        for (int idx : db_table_payloads(world, table_id)) {
+            if (!payload_visible(world, idx, use_focus, focus_x, focus_y, radius)) continue;
+            rows.push_back(builder.make(idx));
+            break;
+        }
+    }
+    return rows;
+}
+
+using JoinSchemaCache = std::map<std::pair<const RowSchema *, const RowSchema *>, std::shared_ptr<RowSchema>>;
+
+// Left cells followed by right cells; on key collisions the left slot wins.
+Row combine_rows(const Row &left, const Row &right, JoinSchemaCache &cache) {
+    static const RowSchema empty_schema;
+    const RowSchema &ls = left.schema ? *left.schema : empty_schema;
+    const RowSchema &rs = right.schema ? *right.schema : empty_schema;
+    std::shared_ptr<RowSchema> &schema = cache[{&ls, &rs}];
+    if (!schema) {
+        schema = std::make_shared<RowSchema>(ls);
+        int offset = ls.slot_count;
+        for (const auto &key : rs.keys) {
+            schema->add(key, offset + rs.slot(key));
+        }
+        schema->slot_count = offset + rs.slot_count;
+    }
+    Row row;
+    row.schema = schema;
+    row.cells.reserve(static_cast<size_t>(schema->slot_count));
+    row.cells = left.cells;
+    row.cells.resize(static_cast<size_t>(ls.slot_count), kAbsentCell);
+    row.cells.insert(row.cells.end(), right.cells.begin(), right.cells.end());
+    row.cells.resize(static_cast<size_t>(schema->slot_count), kAbsentCell);
+    return row;
+}
+
+bool cell_number(const Cell &c, double &out) {
+    if (c.has_number) {
+        out = c.number;
+        return true;
+    }
+    return parse_number(c.text, out);
+}
+
+// Numbers equal within 1e-9 land in the same or a neighbouring bucket. Beyond 4e9 adjacent
+// doubles are further apart than the tolerance, so the bit pattern is an exact key there.
+bool join_number_bucket(double v, int64_t &bucket, bool &exact) {
+    if (std::isnan(v)) return false;
+    exact = !(std::abs(v) < 4e9);
+    if (exact) {
+        double norm = (v == 0.0) ? 0.0 : v;
+        std::memcpy(&bucket, &norm, sizeof(bucket));
+    } else {
+        bucket = static_cast<int64_t>(std::floor(v * 1e9));
+    }
+    return true;
+}
+
+// Sorted merge when both key columns are numeric and non-decreasing (e.g. id-ordered tables).
+bool merge_join_pairs(const std::vector<Cell> &outer_keys,
+                      const std::vector<Cell> &inner_keys,
+                      std::vector<std::pair<size_t, size_t>> &pairs) {
+    auto numeric_sorted = [](const std::vector<Cell> &keys, std::vector<double> &out) {
+        out.resize(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i].is_null || !cell_number(keys[i], out[i]) || std::isnan(out[i])) return false;
+            if (i > 0 && out[i] < out[i - 1]) return false;
+        }
+        return true;
+    };
+    std::vector<double> a;
+    std::vector<double> b;
+    if (!numeric_sorted(outer_keys, a) || !numeric_sorted(inner_keys, b)) return false;
+    size_t start = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        while (start < b.size() && a[i] - b[start] >= 1e-9) ++start;
+        for (size_t j = start; j < b.size() && b[j] - a[i] < 1e-9; ++j) {
+            if (std::abs(a[i] - b[j]) < 1e-9) pairs.emplace_back(i, j);
+        }
+    }
+    return true;
+}
+
+// Matching (outer, inner) index pairs of an equi-join, ordered like the nested loop
+// (outer-major, inner ascending). Falls back to a hash join built on the smaller side;
+// every candidate is confirmed with compare_cells, so semantics match the nested loop.
+std::vector<std::pair<size_t, size_t>> equi_join_pairs(const std::vector<Cell> &outer_keys,
+                                                       const std::vector<Cell> &inner_keys) {
+    std::vector<std::pair<size_t, size_t>> pairs;
+    if (merge_join_pairs(outer_keys, inner_keys, pairs)) {
+        return pairs;
+    }
+    pairs.clear();
+    bool build_inner = inner_keys.size() <= outer_keys.size();
+    const std::vector<Cell> &build = build_inner ? inner_keys : outer_keys;
+    const std::vector<Cell> &probe = build_inner ? outer_keys : inner_keys;
+    std::unordered_map<int64_t, std::vector<size_t>> near_buckets;
+    std::unordered_map<int64_t, std::vector<size_t>> exact_buckets;
+    std::unordered_map<std::string, std::vector<size_t>> text_buckets;
+    for (size_t i = 0; i < build.size(); ++i) {
+        const Cell &c = build[i];
+        if (c.is_null) continue;
+        double num = 0.0;
+        if (cell_number(c, num)) {
+            int64_t bucket = 0;
+            bool exact = false;
+            if (join_number_bucket(num, bucket, exact)) {
+                (exact ? exact_buckets : near_buckets)[bucket].push_back(i);
+            }
+        } else {
+            text_buckets[to_lower(c.text)].push_back(i);
+        }
+    }
+    auto emit = [&](size_t probe_index, const std::vector<size_t> &hits) {
+        for (size_t build_index : hits) {
+            const Cell &pc = probe[probe_index];
+            const Cell &bc = build[build_index];
+            if (!compare_cells(pc, bc, "=")) continue;
+            if (build_inner) {
+                pairs.emplace_back(probe_index, build_index);
+            } else {
+                pairs.emplace_back(build_index, probe_index);
+            }
+        }
+    };
+    for (size_t i = 0; i < probe.size(); ++i) {
+        const Cell &c = probe[i];
+        if (c.is_null) continue;
+        double num = 0.0;
+        if (cell_number(c, num)) {
+            int64_t bucket = 0;
+            bool exact = false;
+            if (!join_number_bucket(num, bucket, exact)) continue;
+            if (exact) {
+                auto it = exact_buckets.find(bucket);
+                if (it != exact_buckets.end()) emit(i, it->second);
+            } else {
+                for (int64_t b = bucket - 1; b <= bucket + 1; ++b) {
+                    auto it = near_buckets.find(b);
+                    if (it != near_buckets.end()) emit(i, it->second);
+                }
+            }
+        } else {
+            auto it = text_buckets.find(to_lower(c.text));
+            if (it != text_buckets.end()) emit(i, it->second);
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+Cell get_cell_by_name(const Row &row, const Row *outer, const std::string &name) {
+    return get_value(row, outer, name);
+}
+
+enum class AggFunc { COUNT_STAR, COUNT, SUM, AVG, MIN, MAX };
+
+// Aggregates of one GROUP BY query from SELECT and HAVING, deduplicated case-insensitively.
+struct AggPlan {
+    std::vector<AggSpec> specs;
+    std::vector<AggFunc> funcs;
+    std::vector<std::string> keys;
+
+    int find(const std::string &raw) const {
+        std::string key = to_lower(raw);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] == key) return static_cast<int>(i);
+        }
+        return -1;
+    }
+};
+
+// GROUP BY, or aggregates only (one group over all rows).
+bool is_group_query(const SqlQuery &q) {
+    if (!q.group_by.empty()) return true;
+    bool has_aggregate = false;
+    for (const auto &item : q.select_items) {
+        if (item.kind != SelectItem::AGG) return false;
+        has_aggregate = true;
+    }
+    return has_aggregate;
+}
+
+// GROUP BY columns with SELECT aliases of plain columns replaced by the column.
+std::vector<std::string> grouping_columns(const SqlQuery &q) {
+    std::vector<std::string> cols = q.group_by;
+    for (auto &gb : cols) {
+        for (const auto &item : q.select_items) {
+            if (!item.alias.empty() && ieq(item.alias, gb) && item.kind == SelectItem::COLUMN) {
+                gb = item.column;
+            }
+        }
+    }
+    return cols;
+}
+
+AggPlan build_agg_plan(const SqlQuery &q) {
+    AggPlan plan;
+    auto add = [&](const AggSpec &spec) {
+        if (plan.find(spec.raw) >= 0) return;
+        AggFunc func = AggFunc::MAX;
+        if (ieq(spec.func, "count")) {
+            func = spec.column == "*" ? AggFunc::COUNT_STAR : AggFunc::COUNT;
+        } else if (ieq(spec.func, "sum")) {
+            func = AggFunc::SUM;
+        } else if (ieq(spec.func, "avg")) {
+            func = AggFunc::AVG;
+        } else if (ieq(spec.func, "min")) {
+            func = AggFunc::MIN;
+        }
+        plan.specs.push_back(spec);
+        plan.funcs.push_back(func);
+        plan.keys.push_back(to_lower(spec.raw));
+    };
+    for (const auto &item : q.select_items) {
+        if (item.kind != SelectItem::AGG) continue;
+        AggSpec spec;
+        spec.raw = item.raw;
+        spec.func = item.func;
+        spec.column = item.column;
+        add(spec);
+    }
+    if (q.having_expr) {
+        std::vector<AggSpec> having_specs;
+        collect_agg_specs(q.having_expr.get(), having_specs);
+        for (const auto &spec : having_specs) {
+            add(spec);
+        }
+    }
+    return plan;
+}
+
+void accumulate(AggState &state, AggFunc func, const Cell &c) {
+    switch (func) {
+        case AggFunc::COUNT_STAR:
+            state.count++;
+            break;
+        case AggFunc::COUNT:
+            if (!c.is_null) state.count++;
+            break;
+        case AggFunc::SUM:
+        case AggFunc::AVG: {
+            double val = 0.0;
+            if (c.has_number) {
+                val = c.number;
+            } else if (!c.text.empty()) {
+                parse_number(c.text, val);
+            }
+            state.sum += val;
+            state.count_num++;
+            break;
+        }
+        case AggFunc::MIN:
+            update_minmax(state.min_val, c, true);
+            state.has_min = true;
+            break;
+        case AggFunc::MAX:
+            update_minmax(state.max_val, c, false);
+            state.has_max = true;
+            break;
+    }
+}
+
+// Folds a later partial into `dst`; partials are merged in row order.
+void merge_agg_state(AggState &dst, const AggState &src) {
+    dst.count += src.count;
+    dst.sum += src.sum;
+    dst.count_num += src.count_num;
+    if (src.has_min) {
+        update_minmax(dst.min_val, src.min_val, true);
+        dst.has_min = true;
+    }
+    if (src.has_max) {
+        update_minmax(dst.max_val, src.max_val, false);
+        dst.has_max = true;
+    }
+}
+
+const Cell kNullCell{"", true, false, 0.0};
+
+// Column read by name; the slot is resolved once per row schema instead of once per row.
+struct CellRef {
+    std::string key;
+    const RowSchema *schema = nullptr;
+    int slot = -1;
+
+    explicit CellRef(const std::string &name) : key(to_lower(name)) {}
+
+    const Cell &get(const Row &row, const Row *outer) {
+        if (row.schema.get() != schema) {
+            schema = row.schema.get();
+            slot = schema ? schema->slot(key) : -1;
+        }
+        if (slot >= 0 && slot < static_cast<int>(row.cells.size()) && !row.cells[static_cast<size_t>(slot)].absent) {
+            return row.cells[static_cast<size_t>(slot)];
+        }
+        if (outer) {
+            if (const Cell *c = outer->find(key)) return *c;
+        }
+        return kNullCell;
+    }
+};
+
+// WHERE runs over batches of rows: column operands bind their slot once per row schema and
+// every predicate narrows a selection vector of row positions, so the tree is walked once
+// per batch. Subquery predicates still evaluate row by row.
+constexpr size_t kFilterBatchRows = 1024;
+
+struct FilterNode {
+    const Expr *expr = nullptr;
+    std::unique_ptr<FilterNode> lhs;
+    std::unique_ptr<FilterNode> rhs;
+    // Slot-bound column operands: expr->lhs/expr->rhs, or expr itself for a bare VALUE.
+    std::unique_ptr<CellRef> lhs_ref;
+    std::unique_ptr<CellRef> rhs_ref;
+};
+
+std::unique_ptr<CellRef> column_ref_for(const Expr *e) {
+    if (!e || e->kind != Expr::VALUE || e->operand != Expr::COLUMN) return nullptr;
+    return std::make_unique<CellRef>(e->key);
+}
+
+std::unique_ptr<FilterNode> build_filter(const Expr *expr) {
+    if (!expr) return nullptr;
+    auto node = std::make_unique<FilterNode>();
+    node->expr = expr;
+    switch (expr->kind) {
+        case Expr::AND:
+        case Expr::OR:
+        case Expr::NOT:
+            node->lhs = build_filter(expr->lhs.get());
+            node->rhs = build_filter(expr->rhs.get());
+            break;
+        case Expr::VALUE:
+            node->lhs_ref = column_ref_for(expr);
+            break;
+        default:
+            node->lhs_ref = column_ref_for(expr->lhs.get());
+            node->rhs_ref = column_ref_for(expr->rhs.get());
+            break;
+    }
+    return node;
+}
+
+// Same value eval_value yields; scratch holds CASE/function results.
+const Cell &operand_cell(const Expr *e, CellRef *ref, const Row &row, const Row *outer, Cell &scratch) {
+    if (ref) {
+        const Cell &c = ref->get(row, outer);
+        if (!c.is_null || !e->bare_literal) return c;
+        return e->literal;
+    }
+    if (e && e->kind == Expr::VALUE && e->operand == Expr::LITERAL) {
+        return e->literal;
+    }
+    if (e && e->kind == Expr::VALUE && e->operand == Expr::PARAM) {
+        return param_cell(e->slot);
+    }
+    scratch = eval_value(e, row, outer);
+    return scratch;
+}
+
+struct FilterContext {
+    const std::vector<Row> &rows;
+    const Row *outer;
+    const DbWorld &world;
+    bool use_focus;
+    int focus_x;
+    int focus_y;
+    int radius;
+    std::string &error;
+};
+
+// Keeps the positions in sel (ascending) whose row satisfies node, like eval_expr per row.
+void filter_batch(FilterNode *node, FilterContext &ctx, std::vector<uint32_t> &sel) {
+    if (!node || sel.empty()) return;
+    const Expr *expr = node->expr;
+    Cell scratch_a;
+    Cell scratch_b;
+    auto keep_if = [&](auto &&pred) {
+        size_t n = 0;
+        for (uint32_t i : sel) {
+            if (pred(ctx.rows[i])) sel[n++] = i;
+            if (!ctx.error.empty()) break;
+        }
+        sel.resize(n);
+    };
+    auto lhs_cell = [&](const Row &row) -> const Cell & {
+        return operand_cell(expr->lhs.get(), node->lhs_ref.get(), row, ctx.outer, scratch_a);
+    };
+    switch (expr->kind) {
+        case Expr::AND:
+            filter_batch(node->lhs.get(), ctx, sel);
+            if (ctx.error.empty()) filter_batch(node->rhs.get(), ctx, sel);
+            return;
+        case Expr::OR: {
+            std::vector<uint32_t> left = sel;
+            filter_batch(node->lhs.get(), ctx, left);
+            if (!ctx.error.empty()) return;
+            std::vector<uint32_t> right;
+            std::set_difference(sel.begin(), sel.end(), left.begin(), left.end(), std::back_inserter(right));
+            filter_batch(node->rhs.get(), ctx, right);
+            sel.clear();
+            std::merge(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(sel));
+            return;
+        }
+        case Expr::NOT: {
+            if (!node->lhs) {
+                sel.clear();
+                return;
+            }
+            std::vector<uint32_t> inner = sel;
+            filter_batch(node->lhs.get(), ctx, inner);
+            std::vector<uint32_t> rest;
+            std::set_difference(sel.begin(), sel.end(), inner.begin(), inner.end(), std::back_inserter(rest));
+            sel.swap(rest);
+            return;
+        }
+        case Expr::COMPARE:
+            keep_if([&](const Row &row) {
+                const Cell &b = operand_cell(expr->rhs.get(), node->rhs_ref.get(), row, ctx.outer, scratch_b);
+                return compare_cells(lhs_cell(row), b, expr->op);
+            });
+            return;
+        case Expr::BETWEEN: {
+            const Cell &lo = list_literal(expr, 0);
+            const Cell &hi = list_literal(expr, 1);
+            if (lo.is_null || hi.is_null) {
+                sel.clear();
+                return;
+            }
+            keep_if([&](const Row &row) {
+                const Cell &a = lhs_cell(row);
+                if (a.is_null) return false;
+                if (a.has_number && lo.has_number && hi.has_number) {
+                    return a.number >= lo.number && a.number <= hi.number;
+                }
+                return a.text >= lo.text && a.text <= hi.text;
+            });
+            return;
+        }
+        case Expr::IN_LIST:
+            keep_if([&](const Row &row) {
+                const Cell &a = lhs_cell(row);
+                if (a.is_null) return false;
+                for (size_t i = 0; i < expr->literals.size(); ++i) {
+                    if (compare_cells(a, list_literal(expr, i), "=")) return true;
+                }
+                return false;
+            });
+            return;
+        case Expr::REGEXP:
+        case Expr::LIKE: {
+            const TextPattern *pattern = expr_pattern(expr);
+            if (!pattern) {
+                sel.clear();
+                return;
+            }
+            if (pattern->kind == TextPattern::INVALID) {
+                ctx.error = "REGEXP-Pattern ungueltig.";
+                sel.clear();
+                return;
+            }
+            keep_if([&](const Row &row) {
+                const Cell &a = lhs_cell(row);
+                return !a.is_null && pattern_match(*pattern, a.text);
+            });
+            return;
+        }
+        case Expr::IS_NULL:
+            keep_if([&](const Row &row) {
+                const Cell &a = lhs_cell(row);
+                bool is_null = a.is_null || a.text.empty();
+                return expr->negate ? !is_null : is_null;
+            });
+            return;
+        case Expr::VALUE:
+            keep_if([&](const Row &row) {
+                const Cell &v = operand_cell(expr, node->lhs_ref.get(), row, ctx.outer, scratch_a);
+                if (v.is_null) return false;
+                if (v.has_number) return std::abs(v.number) > 1e-9;
+                std::string t = to_lower(v.text);
+                return !t.empty() && t != "0" && t != "false" && t != "null";
+            });
+            return;
+        default:
+            keep_if([&](const Row &row) {
+                return eval_expr(expr, row, ctx.outer, ctx.world, ctx.use_focus, ctx.focus_x, ctx.focus_y, ctx.radius, ctx.error);
+            });
+            return;
+    }
+}
+
+// GROUP BY compares the cell texts; NULL groups with the text "NULL".
+const std::string &group_text(const Cell &c) {
+    static const std::string null_text = "NULL";
+    return c.is_null ? null_text : c.text;
+}
+
+uint64_t mix_hash(uint64_t h, uint64_t v) {
+    return (h ^ v) * 0x100000001B3ull + (h >> 29);
+}
+
+bool key_part_equal(const std::string *a, const std::string &b) { return *a == b; }
+bool key_part_equal(const std::string &a, const std::string &b) { return a == b; }
+bool key_part_equal(uint64_t a, uint64_t b) { return a == b; }
+const std::string &key_part_value(const std::string *a) { return *a; }
+const std::string &key_part_value(const std::string &a) { return a; }
+uint64_t key_part_value(uint64_t a) { return a; }
+
+// Hash aggregation table: groups in first-seen order, each with one AggState per aggregate.
+template <typename Part>
+struct GroupTable {
+    size_t width = 0;
+    size_t agg_count = 0;
+    std::vector<Part> keys;
+    std::vector<uint64_t> hashes;
+    std::vector<size_t> first_row;
+    std::vector<AggState> states;
+    std::unordered_map<uint64_t, int> heads;
+    std::vector<int> chain;
+
+    size_t size() const { return first_row.size(); }
+
+    AggState *group_states(size_t g) { return states.data() + g * agg_count; }
+
+    // Group of the `width` key parts; a new group remembers `row` as its first row.
+    template <typename Probe>
+    size_t find_or_add(const Probe *key, uint64_t hash, size_t row) {
+        auto it = heads.find(hash);
+        int head = it == heads.end() ? -1 : it->second;
+        for (int g = head; g >= 0; g = chain[static_cast<size_t>(g)]) {
+            size_t base = static_cast<size_t>(g) * width;
+            size_t i = 0;
+            while (i < width && key_part_equal(key[i], keys[base + i])) i++;
+            if (i == width) return static_cast<size_t>(g);
+        }
+        size_t g = first_row.size();
+        for (size_t i = 0; i < width; ++i) {
+            keys.push_back(key_part_value(key[i]));
+        }
+        hashes.push_back(hash);
+        first_row.push_back(row);
+        states.resize(states.size() + agg_count);
+        chain.push_back(head);
+        heads[hash] = static_cast<int>(g);
+        return g;
+    }
+
+    void merge(GroupTable &other) {
+        for (size_t og = 0; og < other.size(); ++og) {
+            size_t g = find_or_add(other.keys.data() + og * width, other.hashes[og], other.first_row[og]);
+            AggState *dst = group_states(g);
+            const AggState *src = other.group_states(og);
+            for (size_t a = 0; a < agg_count; ++a) {
+                merge_agg_state(dst[a], src[a]);
+            }
+        }
+    }
+};
+
+// Below this many rows per partition the aggregation stays on the calling thread.
+constexpr size_t kAggPartitionRows = 64 * 1024;
+
+size_t agg_partition_count(size_t rows) {
+    return std::max<size_t>(1, std::min<size_t>(16, rows / kAggPartitionRows));
+}
+
+// Splits [0, rows) into `parts` ranges, aggregates each with fn(range, table) and merges in order.
+template <typename Part, typename Fn>
+void aggregate_partitions(size_t rows, size_t width, size_t agg_count, GroupTable<Part> &out, Fn &&fn) {
+    size_t parts = agg_partition_count(rows);
+    std::vector<GroupTable<Part>> partials(parts);
+    for (auto &t : partials) {
+        t.width = width;
+        t.agg_count = agg_count;
+    }
+    parallel_for_bound(parts, [&](size_t p) {
+        fn(rows * p / parts, rows * (p + 1) / parts, partials[p]);
+    });
+    out = std::move(partials.front());
+    for (size_t p = 1; p < parts; ++p) {
+        out.merge(partials[p]);
+    }
+}
+
+// One finished group: its first row and one state per AggPlan entry.
+struct GroupResult {
+    Row first;
+    std::vector<AggState> states;
+};
+
+// Hash aggregation over materialized rows (joins, subqueries, WHERE results).
+std::vector<GroupResult> group_rows(const std::vector<Row> &rows,
+                                    const std::vector<std::string> &group_cols,
+                                    const AggPlan &plan,
+                                    const Row *outer) {
+    GroupTable<std::string> table;
+    aggregate_partitions(rows.size(), group_cols.size(), plan.specs.size(), table,
+                         [&](size_t begin, size_t end, GroupTable<std::string> &part) {
+        std::vector<CellRef> key_refs;
+        for (const auto &col : group_cols) key_refs.emplace_back(col);
+        std::vector<CellRef> agg_refs;
+        for (const auto &spec : plan.specs) agg_refs.emplace_back(spec.column);
+        std::vector<const std::string *> key(group_cols.size());
+        std::hash<std::string> hasher;
+        for (size_t r = begin; r < end; ++r) {
+            const Row &row = rows[r];
+            uint64_t h = 0;
+            for (size_t k = 0; k < key_refs.size(); ++k) {
+                key[k] = &group_text(key_refs[k].get(row, outer));
+                h = mix_hash(h, hasher(*key[k]));
+            }
+            AggState *states = part.group_states(part.find_or_add(key.data(), h, r));
+            for (size_t a = 0; a < plan.funcs.size(); ++a) {
+                AggFunc func = plan.funcs[a];
+                accumulate(states[a], func, func == AggFunc::COUNT_STAR ? kNullCell : agg_refs[a].get(row, outer));
+            }
+        }
+    });
+    std::vector<GroupResult> groups(table.size());
+    for (size_t g = 0; g < table.size(); ++g) {
+        groups[g].first = rows[table.first_row[g]];
+        groups[g].states.assign(table.group_states(g), table.group_states(g) + plan.specs.size());
+    }
+    return groups;
+}
+
+// Store column named by a GROUP BY or aggregate argument ("col", "table.col" or "alias.col").
+const DbColumn *store_column(const DbColumnTable &store, const std::string &name, const std::string &table, const std::string &alias) {
+    std::string column = name;
+    size_t dot = name.find('.');
+    if (dot != std::string::npos) {
+        std::string prefix = name.substr(0, dot);
+        if (!ieq(prefix, table) && !ieq(prefix, alias)) return nullptr;
+        column = name.substr(dot + 1);
+    }
+    auto it = store.column_lookup.find(to_lower(column));
+    return it == store.column_lookup.end() ? nullptr : &store.columns[static_cast<size_t>(it->second)];
+}
+
+// Typed key part of one store cell: the int64 value or the dictionary code. Absent cells read as
+// NULL and share the group of a stored "NULL" text, like the row path.
+struct StoreKeyColumn {
+    const DbColumn *col = nullptr;
+    uint64_t absent_code = 0;
+    bool absent_flag = false;
+};
+
+// min/max of one store column, compared like update_minmax without building cells per row.
+struct StoreExtreme {
+    bool set = false;
+    size_t row = 0;
+};
+
+bool store_cell_better(const DbColumn &col, size_t r, size_t best, bool is_min) {
+    if (col.kind == DbColumn::INT64) {
+        double a = static_cast<double>(col.ints[r]);
+        double b = static_cast<double>(col.ints[best]);
+        return is_min ? a < b : a > b;
+    }
+    uint32_t ca = col.codes[r];
+    uint32_t cb = col.codes[best];
+    if (col.dictionary_numeric[ca] && col.dictionary_numeric[cb]) {
+        return is_min ? col.dictionary_numbers[ca] < col.dictionary_numbers[cb]
+                      : col.dictionary_numbers[ca] > col.dictionary_numbers[cb];
+    }
+    return is_min ? col.dictionary[ca] < col.dictionary[cb] : col.dictionary[ca] > col.dictionary[cb];
+}
+
+// GROUP BY straight from the column store: typed keys and accumulators, no rows are built except
+// one per group. Only for a plain table scan without WHERE whose group columns and aggregate
+// arguments are all store columns; returns false otherwise.
+bool group_column_store(const DbWorld &world,
+                        const SqlQuery &q,
+                        const std::string &alias,
+                        const std::vector<std::string> &group_cols,
+                        const AggPlan &plan,
+                        bool use_focus,
+                        int focus_x,
+                        int focus_y,
+                        int radius,
+                        const std::unordered_map<std::string, DbSqlResult> &cte_map,
+                        const Row *outer,
+                        std::vector<GroupResult> &groups) {
+    if (outer || q.where_expr || !q.joins.empty() || !q.from_subquery.empty()) return false;
+    if (cte_map.find(to_lower(q.from_table)) != cte_map.end()) return false;
+    int table_id = db_find_table(world, q.from_table);
+    const DbColumnTable *store = db_column_table(world, table_id);
+    if (!store || group_cols.size() > 64) return false;
+    std::vector<StoreKeyColumn> key_cols;
+    for (const auto &gb : group_cols) {
+        StoreKeyColumn kc;
+        kc.col = store_column(*store, gb, q.from_table, alias);
+        if (!kc.col) return false;
+        kc.absent_flag = true;
+        if (kc.col->kind != DbColumn::INT64) {
+            auto it = std::find(kc.col->dictionary.begin(), kc.col->dictionary.end(), "NULL");
+            kc.absent_code = static_cast<uint64_t>(it - kc.col->dictionary.begin());
+            kc.absent_flag = it == kc.col->dictionary.end();
+        }
+        key_cols.push_back(kc);
+    }
+    std::vector<const DbColumn *> agg_cols;
+    for (size_t a = 0; a < plan.specs.size(); ++a) {
+        const DbColumn *col = nullptr;
+        if (plan.funcs[a] != AggFunc::COUNT_STAR) {
+            col = store_column(*store, plan.specs[a].column, q.from_table, alias);
+            if (!col) return false;
+        }
+        agg_cols.push_back(col);
+    }
+
+    std::vector<size_t> visible;
+    visible.reserve(store->payload_index.size());
+    for (size_t r = 0; r < store->payload_index.size(); ++r) {
+        if (payload_visible(world, store->payload_index[r], use_focus, focus_x, focus_y, radius)) visible.push_back(r);
+    }
+    groups.clear();
+    if (visible.empty()) return true;
+
+    // Key: one part per group column plus a bit mask of absent INT64/dictionary-less cells.
+    size_t width = key_cols.size() + 1;
+    size_t agg_count = plan.specs.size();
+    GroupTable<uint64_t> table;
+    size_t parts = agg_partition_count(visible.size());
+    std::vector<GroupTable<uint64_t>> partials(parts);
+    std::vector<std::vector<StoreExtreme>> part_extremes(parts);
+    parallel_for_bound(parts, [&](size_t p) {
+        GroupTable<uint64_t> &part = partials[p];
+        std::vector<StoreExtreme> &ext = part_extremes[p];
+        part.width = width;
+        part.agg_count = agg_count;
+        std::vector<uint64_t> key(width);
+        size_t begin = visible.size() * p / parts;
+        size_t end = visible.size() * (p + 1) / parts;
+        for (size_t v = begin; v < end; ++v) {
+            size_t r = visible[v];
+            uint64_t mask = 0;
+            uint64_t h = 0;
+            for (size_t k = 0; k < key_cols.size(); ++k) {
+                const StoreKeyColumn &kc = key_cols[k];
+                const DbColumn &col = *kc.col;
+                uint64_t part_value = 0;
+                if (!col.present[r]) {
+                    part_value = kc.absent_code;
+                    if (kc.absent_flag) mask |= uint64_t(1) << (k % 64);
+                } else if (col.kind == DbColumn::INT64) {
+                    part_value = static_cast<uint64_t>(col.ints[r]);
+                } else {
+                    part_value = col.codes[r];
+                }
+                key[k] = part_value;
+                h = mix_hash(h, part_value * 0x9E3779B97F4A7C15ull);
+            }
+            key[width - 1] = mask;
+            h = mix_hash(h, mask);
+            size_t g = part.find_or_add(key.data(), h, r);
+            if (ext.size() < part.size() * agg_count) ext.resize(part.size() * agg_count);
+            AggState *states = part.group_states(g);
+            for (size_t a = 0; a < agg_count; ++a) {
+                AggState &st = states[a];
+                const DbColumn *col = agg_cols[a];
+                switch (plan.funcs[a]) {
+                    case AggFunc::COUNT_STAR:
+                        st.count++;
+                        break;
+                    case AggFunc::COUNT:
+                        if (col->present[r]) st.count++;
+                        break;
+                    case AggFunc::SUM:
+                    case AggFunc::AVG:
+                        if (col->present[r]) {
+                            if (col->kind == DbColumn::INT64) {
+                                st.sum += static_cast<double>(col->ints[r]);
+                            } else if (col->dictionary_numeric[col->codes[r]]) {
+                                st.sum += col->dictionary_numbers[col->codes[r]];
+                            }
+                        }
+                        st.count_num++;
+                        break;
+                    case AggFunc::MIN:
+                    case AggFunc::MAX: {
+                        bool is_min = plan.funcs[a] == AggFunc::MIN;
+                        (is_min ? st.has_min : st.has_max) = true;
+                        StoreExtreme &e = ext[g * agg_count + a];
+                        if (col->present[r] && (!e.set || store_cell_better(*col, r, e.row, is_min))) {
+                            e.set = true;
+                            e.row = r;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+        // Turn the extreme rows into cells once per group.
+        for (size_t g = 0; g < part.size(); ++g) {
+            for (size_t a = 0; a < agg_count; ++a) {
+                const StoreExtreme &e = ext[g * agg_count + a];
+                if (!e.set) continue;
+                AggState &st = part.group_states(g)[a];
+                (plan.funcs[a] == AggFunc::MIN ? st.min_val : st.max_val) = column_cell(*agg_cols[a], e.row);
+            }
+        }
+    });
+    table = std::move(partials.front());
+    for (size_t p = 1; p < parts; ++p) {
+        table.merge(partials[p]);
+    }
+
+    auto schema = column_row_schema(world, *store, table_id, alias);
+    groups.resize(table.size());
+    for (size_t g = 0; g < table.size(); ++g) {
+        groups[g].first = make_row_for_column(*store, table.first_row[g], schema);
+        groups[g].states.assign(table.group_states(g), table.group_states(g) + agg_count);
+    }
+    return true;
+}
+
+Cell resolve_order_cell(const std::vector<std::string> &columns,
                         const std::vector<std::string> &row_values,
                         const Row &row_meta,
                         const Row *outer,
@@ -1398,47 +3005,213 @@ Cell resolve_order_cell(const std::vector<std::string> &columns,
     return get_cell_by_name(row_meta, outer, key);
 }
 
-bool apply_order(const std::vector<SqlQuery::OrderBy> &order_by,
-                 const std::vector<std::string> &columns,
-                 const std::vector<std::string> &a,
-                 const std::vector<std::string> &b,
-                 const Row &meta_a,
-                 const Row *outer_a,
-                 const Row &meta_b,
-                 const Row *outer_b) {
-    for (const auto &ob : order_by) {
-        Cell ca = resolve_order_cell(columns, a, meta_a, outer_a, ob.key);
-        Cell cb = resolve_order_cell(columns, b, meta_b, outer_b, ob.key);
-        if (ob.nulls_last && ca.is_null != cb.is_null) {
-            return ca.is_null ? false : true;
-        }
-        if (ca.is_null && cb.is_null) continue;
-        double na = 0.0;
-        double nb = 0.0;
-        bool a_num = ca.has_number || parse_number(ca.text, na);
-        bool b_num = cb.has_number || parse_number(cb.text, nb);
-        if (ca.has_number) na = ca.number;
-        if (cb.has_number) nb = cb.number;
-        if (a_num && b_num) {
-            if (na == nb) continue;
-            return ob.asc ? (na < nb) : (na > nb);
-        }
-        if (ca.text == cb.text) continue;
-        if (ob.asc) {
-            return ca.text < cb.text;
-        }
-        return ca.text > cb.text;
+// ORDER BY operand of one row, resolved once before sorting. `text` points into the
+// output row or into a cell of its row meta, so both must stay put while sorting.
+struct OrderKey {
+    const std::string *text = nullptr;
+    double number = 0.0;
+    bool is_null = false;
+    bool has_number = false;
+};
+
+// Output column an ORDER BY key refers to (1-based position or name), -1 for the row meta.
+int order_key_column(const std::vector<std::string> &columns, const std::string &key) {
+    bool digits = !key.empty() && std::all_of(key.begin(), key.end(), [](unsigned char c) { return c >= '0' && c <= '9'; });
+    if (digits) {
+        int idx = std::stoi(key);
+        if (idx > 0 && static_cast<size_t>(idx) <= columns.size()) {
+            return idx - 1;
+        }
+    }
+    std::string key_lower = to_lower(key);
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (to_lower(columns[i]) == key_lower) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// Keys laid out row by row (order_by.size() per row).
+std::vector<OrderKey> build_order_keys(const std::vector<SqlQuery::OrderBy> &order_by,
+                                       const std::vector<std::string> &columns,
+                                       const std::vector<std::vector<std::string>> &rows,
+                                       const std::vector<Row> &meta,
+                                       const Row *outer) {
+    size_t width = order_by.size();
+    std::vector<int> sources(width);
+    std::vector<CellRef> refs;
+    refs.reserve(width);
+    for (size_t k = 0; k < width; ++k) {
+        sources[k] = order_key_column(columns, order_by[k].key);
+        refs.emplace_back(order_by[k].key);
+    }
+    std::vector<OrderKey> keys(rows.size() * width);
+    for (size_t r = 0; r < rows.size(); ++r) {
+        for (size_t k = 0; k < width; ++k) {
+            OrderKey &key = keys[r * width + k];
+            int col = sources[k];
+            if (col >= 0 && static_cast<size_t>(col) < rows[r].size()) {
+                key.text = &rows[r][static_cast<size_t>(col)];
+                key.has_number = parse_number(*key.text, key.number);
+                continue;
+            }
+            const Cell &c = refs[k].get(meta[r], outer);
+            key.text = &c.text;
+            key.is_null = c.is_null;
+            key.has_number = c.has_number;
+            key.number = c.number;
+            if (!key.has_number) key.has_number = parse_number(c.text, key.number);
+        }
+    }
+    return keys;
+}
+
+bool order_keys_less(const std::vector<SqlQuery::OrderBy> &order_by, const OrderKey *a, const OrderKey *b) {
+    for (size_t k = 0; k < order_by.size(); ++k) {
+        const OrderKey &ka = a[k];
+        const OrderKey &kb = b[k];
+        const auto &ob = order_by[k];
+        if (ob.nulls_last && ka.is_null != kb.is_null) {
+            return !ka.is_null;
+        }
+        if (ka.is_null && kb.is_null) continue;
+        if (ka.has_number && kb.has_number) {
+            if (ka.number == kb.number) continue;
+            return ob.asc ? (ka.number < kb.number) : (ka.number > kb.number);
+        }
+        int cmp = ka.text->compare(*kb.text);
+        if (cmp == 0) continue;
+        return ob.asc ? cmp < 0 : cmp > 0;
     }
     return false;
 }
+
+// Sorted row order; ties keep their input order. With keep < rows only the first
+// `keep` positions are sorted (bounded heap via partial_sort) and returned.
+std::vector<size_t> order_rows(const std::vector<SqlQuery::OrderBy> &order_by,
+                               const std::vector<std::string> &columns,
+                               const std::vector<std::vector<std::string>> &rows,
+                               const std::vector<Row> &meta,
+                               const Row *outer,
+                               size_t keep) {
+    std::vector<OrderKey> keys = build_order_keys(order_by, columns, rows, meta, outer);
+    size_t width = order_by.size();
+    std::vector<size_t> idx(rows.size());
+    for (size_t i = 0; i < idx.size(); ++i) idx[i] = i;
+    auto less = [&](size_t ia, size_t ib) {
+        const OrderKey *ka = keys.data() + ia * width;
+        const OrderKey *kb = keys.data() + ib * width;
+        if (order_keys_less(order_by, ka, kb)) return true;
+        if (order_keys_less(order_by, kb, ka)) return false;
+        return ia < ib;
+    };
+    if (keep < idx.size()) {
+        std::partial_sort(idx.begin(), idx.begin() + static_cast<std::ptrdiff_t>(keep), idx.end(), less);
+        idx.resize(keep);
+    } else {
+        std::sort(idx.begin(), idx.end(), less);
+    }
+    return idx;
+}
+
+std::string normalize_col(const std::string &col, const std::string &table, const std::string &alias) {
+    if (col.find('.') != std::string::npos) {
+        return col;
+    }
+    if (!alias.empty()) return alias + "." + col;
+    return table + "." + col;
+}
+
+// Plain SELECT lists without grouping, DISTINCT or ORDER BY can emit rows as they pass WHERE.
+bool streamable_query(const SqlQuery &q) {
+    if (!q.group_by.empty() || q.distinct || !q.order_by.empty() || !q.distinct_on.empty()) {
+        return false;
+    }
+    for (const auto &item : q.select_items) {
+        if (item.kind == SelectItem::AGG) return false;
+    }
+    return true;
+}
+
+int bound_count(int slot, int fallback) {
+    const Cell &c = param_cell(slot);
+    return c.has_number ? static_cast<int>(c.number) : fallback;
+}
+
+int effective_limit(const SqlQuery &q, const DbWorld &world) {
+    int limit = q.limit_slot >= 0 ? bound_count(q.limit_slot, -1) : q.limit;
+    if (limit < 0 && world.default_limit >= 0) {
+        return world.default_limit;
+    }
+    return limit;
+}
+
+int effective_offset(const SqlQuery &q) {
+    return q.offset_slot >= 0 ? bound_count(q.offset_slot, 0) : q.offset;
+}
+
+bool select_has_star(const SqlQuery &q) {
+    for (const auto &item : q.select_items) {
+        if (item.kind == SelectItem::STAR) return true;
+    }
+    return false;
+}
 
-std::string normalize_col(const std::string &col, const std::string &table, const std::string &alias) {
-    if (col.find('.') != std::string::npos) {
-        return col;
+// Output columns of a plain SELECT; SELECT * takes the schema order of the first row.
+std::vector<std::string> plain_output_columns(const SqlQuery &q, bool has_star, const Row *first) {
+    std::vector<std::string> columns;
+    if (has_star) {
+        if (first && first->schema) {
+            for (const auto &key : first->schema->keys) {
+                if (key.find('.') == std::string::npos && first->find(key)) {
+                    columns.push_back(key);
+                }
+            }
+        }
+        return columns;
     }
-    if (!alias.empty()) return alias + "." + col;
-    return table + "." + col;
+    for (const auto &item : q.select_items) {
+        columns.push_back(item.alias.empty() ? item.raw : item.alias);
+    }
+    return columns;
+}
+
+bool project_plain_row(const SqlQuery &q,
+                       bool has_star,
+                       const std::vector<std::string> &output_columns,
+                       const Row &row,
+                       const Row *outer,
+                       std::vector<std::string> &out_row,
+                       std::string &error) {
+    out_row.clear();
+    if (has_star) {
+        out_row.reserve(output_columns.size());
+        for (const auto &col : output_columns) {
+            Cell c = get_cell_by_name(row, outer, col);
+            out_row.push_back(c.is_null ? "" : c.text);
+        }
+        return true;
+    }
+    for (const auto &item : q.select_items) {
+        if (item.kind == SelectItem::AGG) {
+            error = "Aggregates ohne GROUP BY nicht erlaubt.";
+            return false;
+        }
+        Cell c;
+        if (item.kind == SelectItem::FUNC) {
+            std::string lower = to_lower(item.raw);
+            if (lower.rfind("case", 0) == 0) {
+                c = eval_case_expr(item.raw, row, outer);
+            } else {
+                c = eval_function(item.raw, row, outer);
+            }
+        } else {
+            c = get_cell_by_name(row, outer, item.column);
+        }
+        out_row.push_back(c.is_null ? "" : c.text);
+    }
+    return true;
 }
+
 bool execute_single_sql(const DbWorld &world,
                         const std::string &sql,
                         bool use_focus,
@@ -1449,37 +3222,51 @@ bool execute_single_sql(const DbWorld &world,
                         const Row *outer,
                         DbSqlResult &out,
                         std::vector<Row> &out_meta,
-                        std::string &error) {
-    SqlQuery q;
-    if (!parse_query(sql, q)) {
-        error = "SQL-Parser: ungueltige Query.";
-        return false;
-    }
+                        std::string &error);
+
+bool execute_query(const DbWorld &world,
+                   const SqlQuery &q,
+                   bool use_focus,
+                   int focus_x,
+                   int focus_y,
+                   int radius,
+                   const std::unordered_map<std::string, DbSqlResult> &cte_map,
+                   const Row *outer,
+                   DbSqlResult &out,
+                   std::vector<Row> &out_meta,
+                   std::string &error) {
 
     std::string from_alias = q.from_alias.empty() ? q.from_table : q.from_alias;
     std::vector<Row> rows;
-    if (!q.from_subquery.empty()) {
+    bool group_query = is_group_query(q);
+    std::vector<std::string> group_cols = grouping_columns(q);
+    AggPlan agg_plan;
+    std::vector<GroupResult> groups;
+    bool store_grouped = false;
+    if (group_query) {
+        agg_plan = build_agg_plan(q);
+        store_grouped = group_column_store(world, q, from_alias, group_cols, agg_plan, use_focus, focus_x, focus_y, radius,
+                                           cte_map, outer, groups);
+    }
+    if (store_grouped) {
+        // Aggregated from the column store; no rows to build or filter.
+    } else if (!q.from_subquery.empty()) {
         DbSqlResult sub_result;
         std::vector<Row> sub_meta;
         if (!execute_single_sql(world, q.from_subquery, use_focus, focus_x, focus_y, radius, cte_map, outer, sub_result, sub_meta, error)) {
             return false;
         }
-        for (const auto &r : sub_result.rows) {
-            Row row;
-            for (size_t i = 0; i < r.size() && i < sub_result.columns.size(); ++i) {
-                Cell c = make_cell(r[i], false);
-                std::string col_key = to_lower(sub_result.columns[i]);
-                row.values[col_key] = c;
-                if (!from_alias.empty()) {
-                    row.values[to_lower(from_alias) + "." + col_key] = c;
-                }
-            }
-            rows.push_back(std::move(row));
-        }
+        rows = rows_for_result(sub_result, from_alias);
     } else {
-        rows = rows_for_table(world, q.from_table, from_alias, use_focus, focus_x, focus_y, radius, cte_map);
+        std::vector<int> candidates;
+        if (index_candidates(world, q, from_alias, outer, use_focus, focus_x, focus_y, radius, cte_map, candidates) ||
+            column_candidates(world, q, from_alias, cte_map, candidates)) {
+            rows = rows_for_candidates(world, q.from_table, from_alias, std::move(candidates), use_focus, focus_x, focus_y, radius);
+        } else {
+            rows = rows_for_table(world, q.from_table, from_alias, use_focus, focus_x, focus_y, radius, cte_map);
+        }
     }
-    if (rows.empty()) {
+    if (store_grouped ? groups.empty() : rows.empty()) {
         out.columns.clear();
         out.rows.clear();
         return true;
@@ -1497,107 +3284,101 @@ bool execute_single_sql(const DbWorld &world,
         std::string alias = join.alias.empty() ? join.table : join.alias;
         std::vector<Row> right_rows = rows_for_table(world, join.table, alias, use_focus, focus_x, focus_y, radius, cte_map);
         std::vector<Row> next;
+        JoinSchemaCache join_schemas;
         if (join.kind == JoinClause::CROSS) {
             for (const auto &lrow : rows) {
                 for (const auto &rrow : right_rows) {
-                    Row combined = lrow;
-                    combined.values.insert(rrow.values.begin(), rrow.values.end());
-                    next.push_back(std::move(combined));
-                }
-            }
-        } else if (join.kind == JoinClause::RIGHT) {
-            for (const auto &rrow : right_rows) {
-                bool matched = false;
-                Cell rv = get_cell_by_name(rrow, outer, join.right_col);
-                for (const auto &lrow : rows) {
-                    Cell lv = get_cell_by_name(lrow, outer, join.left_col);
-                    if (compare_cells(lv, rv, "=")) {
-                        Row combined = lrow;
-                        combined.values.insert(rrow.values.begin(), rrow.values.end());
-                        next.push_back(std::move(combined));
-                        matched = true;
-                    }
-                }
-                if (!matched) {
-                    Row combined = rrow;
-                    next.push_back(std::move(combined));
+                    next.push_back(combine_rows(lrow, rrow, join_schemas));
                 }
             }
         } else {
+            // Join keys are read once per row; RIGHT JOIN keeps the right side as the outer loop.
+            bool right_outer = join.kind == JoinClause::RIGHT;
+            std::vector<Cell> left_keys;
+            std::vector<Cell> right_keys;
+            left_keys.reserve(rows.size());
+            right_keys.reserve(right_rows.size());
             for (const auto &lrow : rows) {
+                left_keys.push_back(get_cell_by_name(lrow, outer, join.left_col));
+            }
+            for (const auto &rrow : right_rows) {
+                right_keys.push_back(get_cell_by_name(rrow, outer, join.right_col));
+            }
+            const std::vector<Row> &outer_rows = right_outer ? right_rows : rows;
+            std::vector<std::pair<size_t, size_t>> pairs =
+                right_outer ? equi_join_pairs(right_keys, left_keys) : equi_join_pairs(left_keys, right_keys);
+            bool keep_unmatched = join.kind == JoinClause::LEFT || right_outer;
+            size_t p = 0;
+            for (size_t o = 0; o < outer_rows.size(); ++o) {
                 bool matched = false;
-                Cell lv = get_cell_by_name(lrow, outer, join.left_col);
-                for (const auto &rrow : right_rows) {
-                    Cell rv = get_cell_by_name(rrow, outer, join.right_col);
-                    if (compare_cells(lv, rv, "=")) {
-                        Row combined = lrow;
-                        combined.values.insert(rrow.values.begin(), rrow.values.end());
-                        next.push_back(std::move(combined));
-                        matched = true;
+                for (; p < pairs.size() && pairs[p].first == o; ++p) {
+                    size_t inner = pairs[p].second;
+                    if (right_outer) {
+                        next.push_back(combine_rows(rows[inner], right_rows[o], join_schemas));
+                    } else {
+                        next.push_back(combine_rows(rows[o], right_rows[inner], join_schemas));
                     }
+                    matched = true;
                 }
-                if (!matched && join.kind == JoinClause::LEFT) {
-                    Row combined = lrow;
-                    next.push_back(std::move(combined));
+                if (!matched && keep_unmatched) {
+                    next.push_back(outer_rows[o]);
                 }
             }
         }
         rows.swap(next);
     }
 
+    // LIMIT pushdown: plain selects stop filtering once OFFSET + LIMIT rows have passed.
+    size_t row_cap = rows.size();
+    int limit = effective_limit(q, world);
+    if (limit > 0 && streamable_query(q)) {
+        row_cap = static_cast<size_t>(std::max(0, effective_offset(q))) + static_cast<size_t>(limit);
+    }
     if (q.where_expr) {
+        std::unique_ptr<FilterNode> filter = build_filter(q.where_expr.get());
+        FilterContext ctx{rows, outer, world, use_focus, focus_x, focus_y, radius, error};
         std::vector<Row> filtered;
-        for (const auto &row : rows) {
-            if (eval_expr(q.where_expr.get(), row, outer, world, use_focus, focus_x, focus_y, radius, error)) {
-                filtered.push_back(row);
+        std::vector<uint32_t> sel;
+        size_t begin = 0;
+        while (begin < rows.size() && filtered.size() < row_cap) {
+            // Batches never reach past the row that could complete OFFSET + LIMIT.
+            size_t end = std::min(rows.size(), begin + std::min(kFilterBatchRows, row_cap - filtered.size()));
+            sel.resize(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                sel[i - begin] = static_cast<uint32_t>(i);
             }
+            filter_batch(filter.get(), ctx, sel);
             if (!error.empty()) {
                 return false;
             }
+            for (uint32_t i : sel) {
+                filtered.push_back(std::move(rows[i]));
+            }
+            begin = end;
         }
         rows.swap(filtered);
+    } else if (rows.size() > row_cap) {
+        rows.resize(row_cap);
     }
 
     std::vector<std::string> output_columns;
     std::vector<std::vector<std::string>> output_rows;
     std::vector<Row> output_meta;
 
-    bool has_group = !q.group_by.empty();
-    bool has_aggregate = false;
-    bool has_nonagg_select = false;
-    for (const auto &item : q.select_items) {
-        if (item.kind == SelectItem::AGG) {
-            has_aggregate = true;
-        } else {
-            has_nonagg_select = true;
-        }
-    }
-    bool has_aggregate_only = !has_group && has_aggregate && !has_nonagg_select;
-    std::vector<std::string> group_cols = q.group_by;
-    if (has_group || has_aggregate_only) {
-        if (has_group) {
-            for (auto &gb : group_cols) {
-                for (const auto &item : q.select_items) {
-                    if (!item.alias.empty() && ieq(item.alias, gb) && item.kind == SelectItem::COLUMN) {
-                        gb = item.column;
-                    }
-                }
-            }
-        }
-        std::unordered_map<std::string, std::vector<Row>> groups;
-        for (const auto &row : rows) {
-            std::string key = make_group_key(row, outer, group_cols);
-            groups[key].push_back(row);
-        }
-        if (has_aggregate_only && groups.empty()) {
-            groups[""] = std::vector<Row>{};
-        }
+    if (group_query) {
         for (const auto &item : q.select_items) {
             if (item.kind == SelectItem::STAR) {
                 error = "SELECT * ist mit GROUP BY nicht erlaubt.";
                 return false;
             }
         }
+        if (!store_grouped) {
+            groups = group_rows(rows, group_cols, agg_plan, outer);
+            if (groups.empty() && q.group_by.empty()) {
+                groups.emplace_back();
+                groups.back().states.resize(agg_plan.specs.size());
+            }
+        }
         output_columns.clear();
         for (const auto &item : q.select_items) {
             if (!item.alias.empty()) {
@@ -1609,151 +3390,66 @@ bool execute_single_sql(const DbWorld &world,
             }
         }
 
-        for (const auto &pair : groups) {
-            const auto &grows = pair.second;
+        for (const auto &group : groups) {
+            const Row &first = group.first;
             Row agg_row;
-            std::unordered_map<std::string, AggState> agg;
-            std::vector<AggSpec> agg_specs;
-            {
-                std::unordered_map<std::string, bool> seen;
-                for (const auto &item : q.select_items) {
-                    if (item.kind != SelectItem::AGG) continue;
-                    AggSpec spec;
-                    spec.raw = item.raw;
-                    spec.func = item.func;
-                    spec.column = item.column;
-                    std::string key = to_lower(spec.raw);
-                    if (!seen[key]) {
-                        seen[key] = true;
-                        agg_specs.push_back(spec);
-                    }
-                }
-                if (q.having_expr) {
-                    std::vector<AggSpec> having_specs;
-                    collect_agg_specs(q.having_expr.get(), having_specs);
-                    for (const auto &spec : having_specs) {
-                        std::string key = to_lower(spec.raw);
-                        if (!seen[key]) {
-                            seen[key] = true;
-                            agg_specs.push_back(spec);
-                        }
-                    }
-                }
-            }
-
-            for (const auto &spec : agg_specs) {
-                agg[spec.raw] = AggState{};
-            }
             for (const auto &gb : group_cols) {
-                Cell c = get_cell_by_name(grows.front(), outer, gb);
-                agg_row.values[to_lower(gb)] = c;
+                Cell c = get_cell_by_name(first, outer, gb);
+                agg_row.set(to_lower(gb), c);
             }
-
-            for (const auto &row : grows) {
-                for (const auto &spec : agg_specs) {
-                    AggState &state = agg[spec.raw];
-                    if (ieq(spec.func, "count")) {
-                        if (spec.column == "*") {
-                            state.count++;
-                        } else {
-                            Cell c = get_cell_by_name(row, outer, spec.column);
-                            if (!c.is_null) state.count++;
-                        }
-                    } else if (ieq(spec.func, "sum") || ieq(spec.func, "avg")) {
-                        Cell c = get_cell_by_name(row, outer, spec.column);
-                        double val = 0.0;
-                        // FIX: Versuche immer zu parsen, wenn has_number false ist
-                        if (c.has_number) {
-                            val = c.number;
-                        } else {
-                            parse_number(c.text, val);
-                        }
-                        state.sum += val;
-                        state.count_num++;
-                    } else if (ieq(spec.func, "min")) {
-                        Cell c = get_cell_by_name(row, outer, spec.column);
-                        update_minmax(state.min_val, c, true);
-                        state.has_min = true;
-                    } else if (ieq(spec.func, "max")) {
-                        Cell c = get_cell_by_name(row, outer, spec.column);
-                        update_minmax(state.max_val, c, false);
-                        state.has_max = true;
+            auto agg_cell = [&](size_t a) {
+                const AggState &state = group.states[a];
+                switch (agg_plan.funcs[a]) {
+                    case AggFunc::COUNT_STAR:
+                    case AggFunc::COUNT:
+                        return make_cell(std::to_string(state.count), false);
+                    case AggFunc::SUM:
+                        return make_cell(std::to_string(state.sum), false);
+                    case AggFunc::AVG: {
+                        double avg = (state.count_num > 0) ? (state.sum / static_cast<double>(state.count_num)) : 0.0;
+                        return make_cell(std::to_string(avg), false);
                     }
+                    case AggFunc::MIN:
+                        return state.min_val;
+                    case AggFunc::MAX:
+                        break;
                 }
-            }
+                return state.max_val;
+            };
 
             std::vector<std::string> out_row;
             out_row.reserve(q.select_items.size());
             for (const auto &item : q.select_items) {
                 if (item.kind == SelectItem::AGG) {
-                    const AggState &state = agg[item.raw];
-                    if (ieq(item.func, "count")) {
-                        out_row.push_back(std::to_string(state.count));
-                        agg_row.values[to_lower(item.raw)] = make_cell(std::to_string(state.count), false);
-                        if (!item.alias.empty()) {
-                            agg_row.values[to_lower(item.alias)] = make_cell(std::to_string(state.count), false);
-                        }
-                    } else if (ieq(item.func, "sum")) {
-                        out_row.push_back(std::to_string(state.sum));
-                        agg_row.values[to_lower(item.raw)] = make_cell(std::to_string(state.sum), false);
-                        if (!item.alias.empty()) {
-                            agg_row.values[to_lower(item.alias)] = make_cell(std::to_string(state.sum), false);
-                        }
-                    } else if (ieq(item.func, "avg")) {
-                        double avg = (state.count_num > 0) ? (state.sum / static_cast<double>(state.count_num)) : 0.0;
-                        out_row.push_back(std::to_string(avg));
-                        agg_row.values[to_lower(item.raw)] = make_cell(std::to_string(avg), false);
-                        if (!item.alias.empty()) {
-                            agg_row.values[to_lower(item.alias)] = make_cell(std::to_string(avg), false);
-                        }
-                    } else if (ieq(item.func, "min")) {
-                        out_row.push_back(state.min_val.is_null ? "" : state.min_val.text);
-                        agg_row.values[to_lower(item.raw)] = state.min_val;
-                        if (!item.alias.empty()) {
-                            agg_row.values[to_lower(item.alias)] = state.min_val;
-                        }
-                    } else if (ieq(item.func, "max")) {
-                        out_row.push_back(state.max_val.is_null ? "" : state.max_val.text);
-                        agg_row.values[to_lower(item.raw)] = state.max_val;
-                        if (!item.alias.empty()) {
-                            agg_row.values[to_lower(item.alias)] = state.max_val;
-                        }
+                    int a = agg_plan.find(item.raw);
+                    Cell c = a >= 0 ? agg_cell(static_cast<size_t>(a)) : kNullCell;
+                    out_row.push_back(c.is_null ? "" : c.text);
+                    agg_row.set(to_lower(item.raw), c);
+                    if (!item.alias.empty()) {
+                        agg_row.set(to_lower(item.alias), c);
                     }
                 } else {
                     Cell c;
                     if (item.kind == SelectItem::FUNC) {
                         std::string lower = to_lower(item.raw);
                         if (lower.rfind("case", 0) == 0) {
-                            c = eval_case_expr(item.raw, grows.front(), outer);
+                            c = eval_case_expr(item.raw, first, outer);
                         } else {
-                            c = eval_function(item.raw, grows.front(), outer);
+                            c = eval_function(item.raw, first, outer);
                         }
                     } else {
-                        c = get_cell_by_name(grows.front(), outer, item.column);
+                        c = get_cell_by_name(first, outer, item.column);
                     }
                     out_row.push_back(c.is_null ? "" : c.text);
-                    agg_row.values[to_lower(item.column)] = c;
+                    agg_row.set(to_lower(item.column), c);
                     if (!item.alias.empty()) {
-                        agg_row.values[to_lower(item.alias)] = c;
+                        agg_row.set(to_lower(item.alias), c);
                     }
                 }
             }
-            for (const auto &spec : agg_specs) {
-                const AggState &state = agg[spec.raw];
-                std::string key = to_lower(spec.raw);
-                if (agg_row.values.find(key) != agg_row.values.end()) continue;
-                if (ieq(spec.func, "count")) {
-                    agg_row.values[key] = make_cell(std::to_string(state.count), false);
-                } else if (ieq(spec.func, "sum")) {
-                    agg_row.values[key] = make_cell(std::to_string(state.sum), false);
-                } else if (ieq(spec.func, "avg")) {
-                    double avg = (state.count_num > 0) ? (state.sum / static_cast<double>(state.count_num)) : 0.0;
-                    agg_row.values[key] = make_cell(std::to_string(avg), false);
-                } else if (ieq(spec.func, "min")) {
-                    agg_row.values[key] = state.min_val;
-                } else if (ieq(spec.func, "max")) {
-                    agg_row.values[key] = state.max_val;
-                }
+            for (size_t a = 0; a < agg_plan.specs.size(); ++a) {
+                if (agg_row.find(agg_plan.keys[a])) continue;
+                agg_row.set(agg_plan.keys[a], agg_cell(a));
             }
             if (q.having_expr && !eval_expr(q.having_expr.get(), agg_row, outer, world, use_focus, focus_x, focus_y, radius, error)) {
                 if (!error.empty()) {
@@ -1765,102 +3461,55 @@ bool execute_single_sql(const DbWorld &world,
             output_meta.push_back(agg_row);
         }
     } else {
-        output_columns.clear();
-        bool has_star = false;
-        for (const auto &item : q.select_items) {
-            if (item.kind == SelectItem::STAR) {
-                has_star = true;
-                break;
-            }
-        }
-        if (has_star) {
-            if (!rows.empty()) {
-                // FIX: Filter eingebaut UND Klammern korrekt geschlossen
-                for (const auto &pair : rows.front().values) {
-                    if (pair.first.find('.') == std::string::npos) {
-                        output_columns.push_back(pair.first);
-                    }
-                }
-            }
-        } else {
-            for (const auto &item : q.select_items) {
-                if (!item.alias.empty()) {
-                    output_columns.push_back(item.alias);
-                } else {
-                    output_columns.push_back(item.raw);
-                }
-            }
-        }
+        bool has_star = select_has_star(q);
+        output_columns = plain_output_columns(q, has_star, rows.empty() ? nullptr : &rows.front());
+        output_rows.reserve(rows.size());
+        output_meta.reserve(rows.size());
         for (const auto &row : rows) {
             std::vector<std::string> out_row;
-            if (has_star) {
-                out_row.reserve(output_columns.size());
-                for (const auto &col : output_columns) {
-                    Cell c = get_cell_by_name(row, outer, col);
-                    out_row.push_back(c.is_null ? "" : c.text);
-                }
-            } else {
-                for (const auto &item : q.select_items) {
-                    if (item.kind == SelectItem::AGG) {
-                        error = "Aggregates ohne GROUP BY nicht erlaubt.";
-                        return false;
-                    }
-                    Cell c;
-                    if (item.kind == SelectItem::FUNC) {
-                        std::string lower = to_lower(item.raw);
-                        if (lower.rfind("case", 0) == 0) {
-                            c = eval_case_expr(item.raw, row, outer);
-                        } else {
-                            c = eval_function(item.raw, row, outer);
-                        }
-                    } else {
-                        c = get_cell_by_name(row, outer, item.column);
-                    }
-                    out_row.push_back(c.is_null ? "" : c.text);
-                }
+            if (!project_plain_row(q, has_star, output_columns, row, outer, out_row, error)) {
+                return false;
             }
-            output_rows.push_back(out_row);
+            output_rows.push_back(std::move(out_row));
             output_meta.push_back(row);
         }
     }
 
     if (q.distinct) {
         std::vector<std::vector<std::string>> unique_rows;
+        std::vector<Row> unique_meta;
         std::unordered_map<std::string, bool> seen;
-        for (const auto &r : output_rows) {
+        for (size_t r = 0; r < output_rows.size(); ++r) {
             std::string key;
-            for (const auto &v : r) {
+            for (const auto &v : output_rows[r]) {
                 key += v;
                 key.push_back('|');
             }
             if (seen.find(key) == seen.end()) {
                 seen[key] = true;
-                unique_rows.push_back(r);
+                unique_rows.push_back(std::move(output_rows[r]));
+                unique_meta.push_back(std::move(output_meta[r]));
             }
         }
         output_rows.swap(unique_rows);
+        output_meta.swap(unique_meta);
     }
 
     if (!q.order_by.empty()) {
-        std::vector<size_t> order_idx(output_rows.size());
-        for (size_t i = 0; i < order_idx.size(); ++i) order_idx[i] = i;
-        std::sort(order_idx.begin(), order_idx.end(), [&](size_t ia, size_t ib) {
-            return apply_order(q.order_by,
-                               output_columns,
-                               output_rows[ia],
-                               output_rows[ib],
-                               output_meta[ia],
-                               outer,
-                               output_meta[ib],
-                               outer);
-        });
+        // With LIMIT only OFFSET + LIMIT rows need their final place; DISTINCT ON
+        // still has to see every row in order.
+        size_t keep = output_rows.size();
+        if (limit >= 0 && q.distinct_on.empty()) {
+            keep = std::min(keep, static_cast<size_t>(std::max(0, effective_offset(q))) + static_cast<size_t>(limit));
+        }
+        std::vector<size_t> order_idx = order_rows(q.order_by, output_columns, output_rows, output_meta, outer, keep);
         std::vector<std::vector<std::string>> sorted_rows;
         std::vector<Row> sorted_meta;
-        sorted_rows.reserve(output_rows.size());
-        sorted_meta.reserve(output_rows.size());
+        sorted_rows.reserve(order_idx.size());
+        sorted_meta.reserve(order_idx.size());
         for (size_t idx : order_idx) {
-            sorted_rows.push_back(output_rows[idx]);
-            sorted_meta.push_back(output_meta[idx]);
+            sorted_rows.push_back(std::move(output_rows[idx]));
+            sorted_meta.push_back(std::move(output_meta[idx]));
         }
         output_rows.swap(sorted_rows);
         output_meta.swap(sorted_meta);
@@ -1887,38 +3536,58 @@ bool execute_single_sql(const DbWorld &world,
         output_meta.swap(unique_meta);
     }
 
-    int start = std::max(0, q.offset);
+    int start = std::max(0, effective_offset(q));
     int end = static_cast<int>(output_rows.size());
-    int effective_limit = q.limit;
-    if (effective_limit < 0 && world.default_limit >= 0) {
-        effective_limit = world.default_limit;
-    }
-    if (effective_limit >= 0) {
-        end = std::min(end, start + effective_limit);
+    if (limit >= 0) {
+        end = std::min(end, start + limit);
     }
     if (start > 0 || end < static_cast<int>(output_rows.size())) {
         std::vector<std::vector<std::string>> sliced;
         std::vector<Row> sliced_meta;
         for (int i = start; i < end; ++i) {
-            sliced.push_back(output_rows[static_cast<size_t>(i)]);
-            sliced_meta.push_back(output_meta[static_cast<size_t>(i)]);
+            sliced.push_back(std::move(output_rows[static_cast<size_t>(i)]));
+            sliced_meta.push_back(std::move(output_meta[static_cast<size_t>(i)]));
         }
         output_rows.swap(sliced);
         output_meta.swap(sliced_meta);
     }
 
     out.columns = output_columns;
-    out.rows = output_rows;
-    out_meta = output_meta;
+    out.rows = std::move(output_rows);
+    out_meta = std::move(output_meta);
     return true;
 }
 
+bool execute_single_sql(const DbWorld &world,
+                        const std::string &sql,
+                        bool use_focus,
+                        int focus_x,
+                        int focus_y,
+                        int radius,
+                        const std::unordered_map<std::string, DbSqlResult> &cte_map,
+                        const Row *outer,
+                        DbSqlResult &out,
+                        std::vector<Row> &out_meta,
+                        std::string &error) {
+    std::shared_ptr<const SqlQuery> plan = cached_query(sql);
+    if (!plan) {
+        error = "SQL-Parser: ungueltige Query.";
+        return false;
+    }
+    return execute_query(world, *plan, use_focus, focus_x, focus_y, radius, cte_map, outer, out, out_meta, error);
+}
+
 struct UnionPart {
     std::string sql;
     bool all = false;
 };
 
 bool split_union(const std::string &sql, std::vector<UnionPart> &parts) {
+    thread_local ParseCache<std::vector<UnionPart>> cache;
+    if (auto hit = cache.find(sql)) {
+        parts = *hit;
+        return parts.size() > 1;
+    }
     Parser p;
     p.tokens = tokenize(sql);
     std::string current;
@@ -1948,6 +3617,7 @@ bool split_union(const std::string &sql, std::vector<UnionPart> &parts) {
     if (!current.empty()) {
         parts.push_back({current, false});
     }
+    cache.put(sql, std::make_shared<std::vector<UnionPart>>(parts));
     return parts.size() > 1;
 }
 
@@ -2063,6 +3733,55 @@ bool exec_sql_with_outer(const DbWorld &world,
     return execute_single_sql(world, input, use_focus, focus_x, focus_y, radius, cte_map, outer, out, meta, error);
 }
 
+// BEGIN [TRANSACTION] | START TRANSACTION | COMMIT | ROLLBACK [TO [SAVEPOINT] name] | SAVEPOINT name
+bool exec_transaction_sql(DbWorld &world, const std::string &sql, DbSqlResult &out, std::string &error) {
+    enum class TxStatement { BEGIN, COMMIT, ROLLBACK, SAVEPOINT, ROLLBACK_TO };
+    TxStatement kind = TxStatement::BEGIN;
+    Parser p;
+    p.tokens = tokenize(sql);
+    std::string name;
+    if (p.match("begin")) {
+        p.match("transaction");
+        kind = TxStatement::BEGIN;
+    } else if (p.match("start") && p.match("transaction")) {
+        kind = TxStatement::BEGIN;
+    } else if (p.match("commit")) {
+        p.match("transaction");
+        kind = TxStatement::COMMIT;
+    } else if (p.match("savepoint")) {
+        name = p.consume();
+        kind = TxStatement::SAVEPOINT;
+    } else if (p.match("rollback")) {
+        p.match("transaction");
+        kind = TxStatement::ROLLBACK;
+        if (p.match("to")) {
+            p.match("savepoint");
+            name = p.consume();
+            kind = TxStatement::ROLLBACK_TO;
+        }
+    } else {
+        error = "Transaktion: ungueltiges Statement.";
+        return false;
+    }
+    p.match_symbol(";");
+    if (!p.eof()) {
+        error = "Transaktion: unerwartetes Token '" + p.peek() + "'.";
+        return false;
+    }
+    bool ok = false;
+    switch (kind) {
+        case TxStatement::BEGIN: ok = db_begin_tx(world, error); break;
+        case TxStatement::COMMIT: ok = db_commit_tx(world, error); break;
+        case TxStatement::ROLLBACK: ok = db_rollback_tx(world, error); break;
+        case TxStatement::SAVEPOINT: ok = db_savepoint_tx(world, name, error); break;
+        case TxStatement::ROLLBACK_TO: ok = db_rollback_to_savepoint(world, name, error); break;
+    }
+    if (!ok) return false;
+    out.columns = {"transaction"};
+    out.rows = {{world.txn_active ? "active" : "none"}};
+    return true;
+}
+
 } // namespace
 
 bool db_execute_sql(DbWorld &world,
@@ -2089,8 +3808,21 @@ bool db_execute_sql(DbWorld &world,
             error = "SET: ungueltig.";
             return false;
         }
+        if (p.match("autocommit")) {
+            p.match_symbol("=");
+            std::string val = lower_copy(p.consume());
+            bool on = val == "on" || val == "1" || val == "true";
+            if (!on && val != "off" && val != "0" && val != "false") {
+                error = "SET AUTOCOMMIT: ungueltiger Wert.";
+                return false;
+            }
+            if (!db_set_autocommit(world, on, error)) return false;
+            out.columns = {"autocommit"};
+            out.rows = {{on ? "on" : "off"}};
+            return true;
+        }
         if (!p.match("limit")) {
-            error = "SET: nur LIMIT unterstuetzt.";
+            error = "SET: nur LIMIT und AUTOCOMMIT unterstuetzt.";
             return false;
         }
         if (p.match("off")) {
@@ -2112,6 +3844,10 @@ bool db_execute_sql(DbWorld &world,
         out.rows = {{std::to_string(world.default_limit)}};
         return true;
     }
+    if (lower.rfind("begin", 0) == 0 || lower.rfind("start", 0) == 0 || lower.rfind("commit", 0) == 0 ||
+        lower.rfind("rollback", 0) == 0 || lower.rfind("savepoint", 0) == 0) {
+        return exec_transaction_sql(world, sql, out, error);
+    }
     if (lower.rfind("insert", 0) == 0) {
         if (!db_apply_insert_sql(world, sql, rows, error)) return false;
         out.columns = {"rows_affected"};
@@ -2130,5 +3866,358 @@ bool db_execute_sql(DbWorld &world,
         out.rows = {{std::to_string(rows)}};
         return true;
     }
+    if (lower.rfind("create", 0) == 0 || lower.rfind("drop", 0) == 0) {
+        Parser p;
+        p.tokens = tokenize(sql);
+        bool create = p.match("create");
+        if (create) {
+            p.match("unique");
+        } else {
+            p.match("drop");
+        }
+        if (p.match("index")) {
+            bool ok = create ? db_apply_create_index_sql(world, sql, error) : db_apply_drop_index_sql(world, sql, error);
+            if (!ok) return false;
+            out.columns = {"indexes"};
+            out.rows = {{std::to_string(world.indexes.size())}};
+            return true;
+        }
+    }
+    db_refresh_column_store(world);
     return exec_sql_with_outer(world, sql, use_focus, focus_x, focus_y, radius, nullptr, out, error);
 }
+
+bool db_execute_snapshot_sql(const DbWorldSnapshot &snapshot,
+                             const std::string &sql,
+                             bool use_focus,
+                             int focus_x,
+                             int focus_y,
+                             int radius,
+                             DbSqlResult &out,
+                             std::string &error) {
+    // Published snapshots carry a fresh column store, so the read path never touches the world.
+    std::string lower = to_lower(trim(sql));
+    if (lower.rfind("select", 0) != 0 && lower.rfind("with", 0) != 0) {
+        error = "Snapshot: nur SELECT/WITH erlaubt.";
+        return false;
+    }
+    return exec_sql_with_outer(snapshot.world, sql, use_focus, focus_x, focus_y, radius, nullptr, out, error);
+}
+
+// Parsed form of a prepared statement. A single SELECT keeps its query plan, INSERT/UPDATE/DELETE
+// their parsed statement; WITH/UNION and other statements keep the slot-token text, whose parts
+// go through the parse caches on the first run.
+struct DbSqlPlan {
+    enum Kind { QUERY, DML, TEXT } kind = TEXT;
+    std::string sql;
+    std::shared_ptr<const SqlQuery> query;
+    DbDmlStatement dml;
+    size_t param_count = 0;
+};
+
+bool db_prepare_sql(const std::string &sql, DbPreparedSql &out, std::string &error) {
+    out = DbPreparedSql{};
+    std::string trimmed = trim(sql);
+    if (trimmed.empty()) {
+        error = "PREPARE: leeres Statement.";
+        return false;
+    }
+    auto plan = std::make_shared<DbSqlPlan>();
+    std::string &text = plan->sql;
+    char quote = 0;
+    for (size_t i = 0; i < trimmed.size(); ++i) {
+        char c = trimmed[i];
+        if (quote) {
+            text.push_back(c);
+            if (c == '\\' && i + 1 < trimmed.size()) {
+                text.push_back(trimmed[++i]);
+            } else if (c == quote) {
+                quote = 0;
+            }
+            continue;
+        }
+        if (c == kParamMark) {
+            error = "PREPARE: ungueltiges Steuerzeichen im Statement.";
+            return false;
+        }
+        if (c == '\'' || c == '"') {
+            quote = c;
+        } else if (c == '?') {
+            text += param_token(plan->param_count++);
+            continue;
+        }
+        text.push_back(c);
+    }
+    if (quote) {
+        error = "PREPARE: Anfuehrungszeichen nicht geschlossen.";
+        return false;
+    }
+    std::string lower = to_lower(text);
+    std::vector<UnionPart> parts;
+    if (lower.rfind("select", 0) == 0 && !split_union(text, parts)) {
+        auto query = std::make_shared<SqlQuery>();
+        bool ok = false;
+        try {
+            ok = parse_query(text, *query);
+        } catch (...) {
+            ok = false;
+        }
+        if (!ok) {
+            error = "SQL-Parser: ungueltige Query.";
+            return false;
+        }
+        plan->kind = DbSqlPlan::QUERY;
+        plan->query = std::move(query);
+    } else if (lower.rfind("insert", 0) == 0 || lower.rfind("update", 0) == 0 || lower.rfind("delete", 0) == 0) {
+        if (!db_parse_dml(text, plan->dml, error)) return false;
+        plan->kind = DbSqlPlan::DML;
+    } else if (plan->param_count > 0 && lower.rfind("with", 0) != 0 && lower.rfind("select", 0) != 0) {
+        error = "PREPARE: Parameter nur in SELECT, WITH, INSERT, UPDATE und DELETE.";
+        return false;
+    }
+    out.params.resize(plan->param_count);
+    out.plan = std::move(plan);
+    return true;
+}
+
+bool db_bind_sql_param(DbPreparedSql &stmt, int index, const DbSqlParam &value, std::string &error) {
+    if (index < 1 || index > static_cast<int>(stmt.params.size())) {
+        error = "BIND: Parameterindex " + std::to_string(index) + " ausserhalb 1.." + std::to_string(stmt.params.size()) + ".";
+        return false;
+    }
+    stmt.params[static_cast<size_t>(index - 1)] = value;
+    return true;
+}
+
+namespace {
+
+// Value of a parameter as the plan reads it: numbers keep their literal text, NULL is a NULL cell.
+Cell param_value(const DbSqlParam &param) {
+    switch (param.kind) {
+        case DbSqlParam::INT:
+            return make_cell(std::to_string(param.int_value), false);
+        case DbSqlParam::DOUBLE:
+            if (std::isfinite(param.double_value)) {
+                std::ostringstream ss;
+                ss.precision(15);
+                ss << param.double_value;
+                return make_cell(ss.str(), false);
+            }
+            return Cell{};
+        case DbSqlParam::TEXT:
+            return make_cell(param.text, false);
+        default:
+            return Cell{};
+    }
+}
+
+// DML values stay in SQL form: text is quoted (strip_quotes removes exactly that pair), NULL is the word NULL.
+void bind_dml_value(std::string &value, const std::vector<DbSqlParam> &params) {
+    int slot = param_slot(value);
+    if (slot < 0 || static_cast<size_t>(slot) >= params.size()) return;
+    const DbSqlParam &param = params[static_cast<size_t>(slot)];
+    if (param.kind == DbSqlParam::TEXT) {
+        value = "'" + param.text + "'";
+        return;
+    }
+    Cell c = param_value(param);
+    value = c.is_null ? "NULL" : c.text;
+}
+
+} // namespace
+
+bool db_execute_prepared(DbWorld &world,
+                         const DbPreparedSql &stmt,
+                         bool use_focus,
+                         int focus_x,
+                         int focus_y,
+                         int radius,
+                         DbSqlResult &out,
+                         std::string &error) {
+    if (!stmt.plan) {
+        error = "EXECUTE: Statement nicht vorbereitet.";
+        return false;
+    }
+    const DbSqlPlan &plan = *stmt.plan;
+    if (plan.kind == DbSqlPlan::DML) {
+        DbDmlStatement bound = plan.dml;
+        for (auto &row : bound.rows) {
+            for (auto &value : row) bind_dml_value(value, stmt.params);
+        }
+        for (auto &set : bound.sets) bind_dml_value(set.second, stmt.params);
+        bind_dml_value(bound.where_val, stmt.params);
+        int rows = 0;
+        if (!db_apply_dml(world, bound, rows, error)) return false;
+        out.columns = {"rows_affected"};
+        out.rows = {{std::to_string(rows)}};
+        return true;
+    }
+    std::vector<Cell> values;
+    values.reserve(stmt.params.size());
+    for (const auto &param : stmt.params) values.push_back(param_value(param));
+    BoundParamScope scope(&values);
+    if (plan.kind == DbSqlPlan::QUERY) {
+        db_refresh_column_store(world);
+        std::unordered_map<std::string, DbSqlResult> no_ctes;
+        std::vector<Row> meta;
+        out = DbSqlResult{};
+        return execute_query(world, *plan.query, use_focus, focus_x, focus_y, radius, no_ctes, nullptr, out, meta, error);
+    }
+    return db_execute_sql(world, plan.sql, use_focus, focus_x, focus_y, radius, out, error);
+}
+
+struct DbSqlCursorState {
+    const DbWorld *world = nullptr;
+    bool use_focus = false;
+    int focus_x = 0;
+    int focus_y = 0;
+    int radius = 0;
+    std::vector<std::string> columns;
+    // Streaming scan over candidate payloads.
+    bool streaming = false;
+    std::shared_ptr<const SqlQuery> query;
+    std::unique_ptr<TableRowBuilder> builder;
+    // Keeps the builder's column store alive, so a rebuilt store never reuses its address.
+    std::shared_ptr<const DbColumnTable> store;
+    bool has_star = false;
+    bool columns_ready = false;
+    std::vector<int> candidates;
+    size_t position = 0;
+    size_t skip = 0;
+    size_t remaining = 0;
+    std::vector<std::vector<std::string>> pending;
+    // Materialized fallback.
+    DbSqlResult result;
+    size_t next_row = 0;
+};
+
+namespace {
+
+bool cursor_fill(DbSqlCursorState &st, size_t max_rows, std::vector<std::vector<std::string>> &rows, std::string &error) {
+    const DbWorld &world = *st.world;
+    const SqlQuery &q = *st.query;
+    int table_id = st.builder->table_id;
+    if (db_column_table(world, table_id) != st.builder->store) {
+        error = "CURSOR: Daten wurden waehrend des Lesens geaendert.";
+        return false;
+    }
+    while (rows.size() < max_rows && st.remaining > 0 && st.position < st.candidates.size()) {
+        int idx = st.candidates[st.position++];
+        if (static_cast<size_t>(idx) >= world.payloads.size()) {
+            error = "CURSOR: Daten wurden waehrend des Lesens geaendert.";
+            return false;
+        }
+        const DbPayload &p = world.payloads[static_cast<size_t>(idx)];
+        if (p.table_id != table_id) continue;
+        if (!payload_visible(world, idx, st.use_focus, st.focus_x, st.focus_y, st.radius)) continue;
+        Row row = st.builder->make(idx);
+        if (q.where_expr) {
+            bool keep = eval_expr(q.where_expr.get(), row, nullptr, world, st.use_focus, st.focus_x, st.focus_y, st.radius, error);
+            if (!error.empty()) return false;
+            if (!keep) continue;
+        }
+        if (!st.columns_ready) {
+            st.columns = plain_output_columns(q, st.has_star, &row);
+            st.columns_ready = true;
+        }
+        if (st.skip > 0) {
+            st.skip--;
+            continue;
+        }
+        std::vector<std::string> out_row;
+        if (!project_plain_row(q, st.has_star, st.columns, row, nullptr, out_row, error)) {
+            return false;
+        }
+        rows.push_back(std::move(out_row));
+        st.remaining--;
+    }
+    return true;
+}
+
+} // namespace
+
+bool db_cursor_open(DbWorld &world,
+                    const std::string &sql,
+                    bool use_focus,
+                    int focus_x,
+                    int focus_y,
+                    int radius,
+                    DbSqlCursor &out,
+                    std::string &error) {
+    out = DbSqlCursor{};
+    auto st = std::make_shared<DbSqlCursorState>();
+    st->world = &world;
+    st->use_focus = use_focus;
+    st->focus_x = focus_x;
+    st->focus_y = focus_y;
+    st->radius = radius;
+
+    std::string trimmed = trim(sql);
+    bool plain_select = trimmed.size() >= 6 && ieq(trimmed.substr(0, 6), "select");
+    std::vector<UnionPart> parts;
+    if (plain_select && !split_union(trimmed, parts)) {
+        st->query = cached_query(trimmed);
+    }
+    const SqlQuery *q = st->query.get();
+    int table_id = q ? db_find_table(world, q->from_table) : -1;
+    if (q && table_id >= 0 && q->from_subquery.empty() && q->joins.empty() && streamable_query(*q)) {
+        db_refresh_column_store(world);
+        std::string alias = q->from_alias.empty() ? q->from_table : q->from_alias;
+        std::unordered_map<std::string, DbSqlResult> no_ctes;
+        if (index_candidates(world, *q, alias, nullptr, use_focus, focus_x, focus_y, radius, no_ctes, st->candidates) ||
+            column_candidates(world, *q, alias, no_ctes, st->candidates)) {
+            std::sort(st->candidates.begin(), st->candidates.end());
+            st->candidates.erase(std::unique(st->candidates.begin(), st->candidates.end()), st->candidates.end());
+        } else if (!use_focus || !db_focus_payloads(world, table_id, focus_x, focus_y, radius, st->candidates)) {
+            st->candidates = db_table_payloads(world, table_id);
+        }
+        st->streaming = true;
+        st->builder.reset(new TableRowBuilder(world, table_id, alias));
+        st->store = world.table_store[static_cast<size_t>(table_id)];
+        st->has_star = select_has_star(*q);
+        st->columns_ready = !st->has_star;
+        if (st->columns_ready) {
+            st->columns = plain_output_columns(*q, false, nullptr);
+        }
+        int limit = effective_limit(*q, world);
+        st->skip = static_cast<size_t>(std::max(0, effective_offset(*q)));
+        st->remaining = limit >= 0 ? static_cast<size_t>(limit) : st->candidates.size();
+        // SELECT * takes its columns from the first matching row.
+        if (!st->columns_ready && !cursor_fill(*st, 1, st->pending, error)) {
+            return false;
+        }
+    } else {
+        if (!db_execute_sql(world, sql, use_focus, focus_x, focus_y, radius, st->result, error)) {
+            return false;
+        }
+        st->columns = st->result.columns;
+    }
+    out.columns = st->columns;
+    out.state = std::move(st);
+    return true;
+}
+
+bool db_cursor_next(DbSqlCursor &cursor, size_t max_rows, DbSqlResult &batch, std::string &error) {
+    batch.columns = cursor.columns;
+    batch.rows.clear();
+    DbSqlCursorState *st = cursor.state.get();
+    if (!st) {
+        error = "CURSOR: nicht geoeffnet.";
+        return false;
+    }
+    if (max_rows == 0) {
+        return true;
+    }
+    if (!st->streaming) {
+        size_t end = std::min(st->result.rows.size(), st->next_row + max_rows);
+        for (; st->next_row < end; ++st->next_row) {
+            batch.rows.push_back(std::move(st->result.rows[st->next_row]));
+        }
+        return true;
+    }
+    while (!st->pending.empty() && batch.rows.size() < max_rows) {
+        batch.rows.push_back(std::move(st->pending.front()));
+        st->pending.erase(st->pending.begin());
+    }
+    return cursor_fill(*st, max_rows, batch.rows, error);
+}
@@ -2,6 +2,9 @@
 
 #include "db_engine.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -18,3 +21,63 @@ bool db_execute_sql(DbWorld &world,
                     int radius,
                     DbSqlResult &out,
                     std::string &error);
+// Runs a SELECT or WITH statement against a published snapshot; safe on any number of reader
+// threads while the writer keeps applying statements to its own world.
+bool db_execute_snapshot_sql(const DbWorldSnapshot &snapshot,
+                             const std::string &sql,
+                             bool use_focus,
+                             int focus_x,
+                             int focus_y,
+                             int radius,
+                             DbSqlResult &out,
+                             std::string &error);
+
+struct DbSqlParam {
+    enum Kind { NULL_VALUE, INT, DOUBLE, TEXT } kind = NULL_VALUE;
+    int64_t int_value = 0;
+    double double_value = 0.0;
+    std::string text;
+};
+
+struct DbSqlPlan;
+
+// Statement with positional ? placeholders, parsed once at prepare time. Each ? becomes a
+// parameter slot in the parsed plan; execute binds the values into those slots, so a value is
+// never spliced into SQL text or tokenized.
+struct DbPreparedSql {
+    std::shared_ptr<const DbSqlPlan> plan;
+    std::vector<DbSqlParam> params;
+};
+
+bool db_prepare_sql(const std::string &sql, DbPreparedSql &out, std::string &error);
+bool db_bind_sql_param(DbPreparedSql &stmt, int index, const DbSqlParam &value, std::string &error);
+bool db_execute_prepared(DbWorld &world,
+                         const DbPreparedSql &stmt,
+                         bool use_focus,
+                         int focus_x,
+                         int focus_y,
+                         int radius,
+                         DbSqlResult &out,
+                         std::string &error);
+
+struct DbSqlCursorState;
+
+// Pull-based reader over one statement. Plain single-table SELECTs (no JOIN, GROUP BY,
+// DISTINCT or ORDER BY) keep only payload indices and build rows per batch, stopping at
+// LIMIT; everything else is executed once and handed out in slices.
+// The cursor reads the live world, so it must be closed before the world changes.
+struct DbSqlCursor {
+    std::vector<std::string> columns;
+    std::shared_ptr<DbSqlCursorState> state;
+};
+
+bool db_cursor_open(DbWorld &world,
+                    const std::string &sql,
+                    bool use_focus,
+                    int focus_x,
+                    int focus_y,
+                    int radius,
+                    DbSqlCursor &out,
+                    std::string &error);
+// Fills batch.rows with up to max_rows rows; an empty batch marks the end.
+bool db_cursor_next(DbSqlCursor &cursor, size_t max_rows, DbSqlResult &batch, std::string &error);